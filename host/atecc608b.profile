@@ -0,0 +1,52 @@
+# ATECC608B as provisioned for this firmware (host/atecc_emu.c)
+#
+#   address <7-bit>                 I2C address (main.c: 0xC0 >> 1)
+#   serial <9 bytes hex>            SN[0..3] and SN[4..8]
+#   chipmode <byte>                 bit 2 selects the 10 s watchdog
+#   slot <n> <SlotConfig> <KeyConfig>
+#   key <n> generate | <32 bytes hex>
+#   data <n> <hex>                  raw slot contents from offset 0
+#   otp <hex>
+#   counter <0|1> <value>
+#   lock config | data
+#   timing <opcode> <us>            execution time; defaults are the datasheet maxima
+#   max_baud <hz>                   fastest bus the part follows
+
+address 0x60
+serial 01 23 6A 3C 91 02 5D 7E EE
+chipmode 0x00
+
+# Slot 0: TLS client key. P-256 private, external sign and ECDH in the clear,
+# GenKey allowed after the data lock, lockable.
+slot 0 0x2087 0x0033
+key 0 generate
+
+# Slot 2: ECDH/spare private key
+slot 2 0x2087 0x0033
+key 2 generate
+
+# Slot 10: server public key for stored Verify
+slot 10 0x0000 0x0010
+
+# Slot 11: public key validated by the key in slot 10 (ReadKey), PubInfo set
+slot 11 0x000A 0x0012
+
+counter 0 0
+counter 1 0
+
+lock config
+lock data
+
+# Typical execution times measured on an ATECC608B-MAHDA at 25 C (us)
+timing info      500
+timing random    9000
+timing nonce     200
+timing sha       900
+timing genkey    59000
+timing sign      48000
+timing verify    58000
+timing ecdh      38000
+timing read      800
+timing write     7000
+timing counter   7000
+timing lock      8000
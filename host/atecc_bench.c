@@ -0,0 +1,1073 @@
+// Host benchmark driver for the ATECC608B path
+//
+// Runs cryptoauthlib (calib and the atcab API, as built into the firmware)
+// against the software ATECC608B in atecc_emu.c, so changes to wake/idle
+// handling, polling, CRC and bus timing can be measured and checked without
+// a board. Signatures are verified with mbedTLS against the device's public
+// key exactly as the TLS handshake does, ECDH secrets are compared with a
+// host-side computation, and the run exits non-zero on any mismatch or when
+// the sign latency budget is exceeded.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/random.h>
+
+#include "cryptoauthlib.h"
+#include "atecc_emu.h"
+
+#include "mbedtls/ecp.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/sha256.h"
+
+#define BENCH_DEFAULT_COUNT     20
+#define BENCH_SIGN_SLOT         0
+#define BENCH_ECDH_SLOT         2
+#define BENCH_PARENT_SLOT       10   // Signs the validated key (its ReadKey)
+#define BENCH_VALIDATED_SLOT    11
+#define BENCH_CRC_MAX_LENGTH    256
+#define BENCH_CRC_REPS          200000
+
+#ifndef ATECC_BENCH_DEFAULT_PROFILE
+#define ATECC_BENCH_DEFAULT_PROFILE "atecc608b.profile"
+#endif
+
+// Benchmark configuration
+typedef struct {
+    uint32_t count;
+    const char* profile;
+    uint32_t timing_pct;
+    uint32_t sign_budget_us;     // Max sign latency, 0 = not checked
+    bool session;                // Run everything inside one keep-awake session
+    bool async_sign;             // Sign through atcab_sign_submit/poll
+    bool background;             // Competing low-priority thread on the device
+    bool crc;                    // Check and time atCRC only
+    bool zone_cache;             // Check the zone cache and its warm-boot image only
+    uint32_t speed_max_baud;     // Check I2C clock stepping against this part limit only, 0 = off
+    bool profile_dump;           // Print the library's per-opcode profile of the run
+    uint32_t pool_devices;       // Check pooled signing over this many devices only, 0 = off
+} bench_config_t;
+
+// Per-operation latency
+typedef struct {
+    const char* name;
+    bool (*run)(void);
+    uint32_t ok;
+    uint32_t failed;
+    uint64_t total_us;
+    uint32_t max_us;
+} bench_op_t;
+
+// Host side of the key material
+typedef struct {
+    uint8_t sign_pub[ATCA_ECCP256_PUBKEY_SIZE];
+    uint8_t ecdh_pub[ATCA_ECCP256_PUBKEY_SIZE];
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point sign_q;
+    mbedtls_mpi host_d;
+    uint8_t host_pub[ATCA_ECCP256_PUBKEY_SIZE];
+    uint8_t digest[ATCA_SHA256_DIGEST_SIZE];
+    uint8_t signature[ATCA_ECCP256_SIG_SIZE];
+    uint32_t message;
+} bench_keys_t;
+
+static bench_keys_t g_keys;
+
+// Non-blocking signs (-a): how long the library held the caller
+typedef struct {
+    bool enabled;
+    uint32_t signs;
+    uint32_t polls;
+    uint32_t callbacks;
+    uint64_t held_us;
+    uint64_t total_us;
+} bench_async_t;
+
+static bench_async_t g_async;
+
+// Background thread (-b) and how long signs queued behind it
+typedef struct {
+    bool enabled;
+    volatile bool stop;
+    uint32_t ops;
+    uint32_t failed;
+    uint32_t signs;
+    uint64_t wait_us;
+    uint32_t max_wait_us;
+} bench_background_t;
+
+static bench_background_t g_background;
+
+static int bench_rng(void* ctx, unsigned char* out, size_t len)
+{
+    (void)ctx;
+    return (getrandom(out, len, 0) == (ssize_t)len) ? 0 : -1;
+}
+
+static uint64_t bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <count>     iterations of each operation (default %d)\n"
+           "  -c <file>      device profile (default %s)\n"
+           "  -t <percent>   scale the profile's execution and bus times (default 100)\n"
+           "  -z             zero latency, same as -t 0\n"
+           "  -l <us>        fail the run if a sign exceeds this (default: unchecked)\n"
+           "  -s             run every operation inside one keep-awake session\n"
+           "  -a             sign through the non-blocking submit/poll API\n"
+           "  -b             run a background thread on the device; signs queue ahead of it\n"
+           "  -r             check atCRC against the bitwise reference and time both, then exit\n"
+           "  -w             check the zone cache, its invalidation and a warm-boot image, then exit\n"
+           "  -i <hz>        check I2C clock stepping against a part that follows up to <hz>, then exit\n"
+           "  -p             print the library's per-opcode profile and check it against the emulator\n"
+           "  -m <devices>   check pooled signing over several emulated devices and its scaling, then exit\n",
+           prog, BENCH_DEFAULT_COUNT, ATECC_BENCH_DEFAULT_PROFILE);
+}
+
+static bool load_point(const uint8_t pub[ATCA_ECCP256_PUBKEY_SIZE], mbedtls_ecp_point* q)
+{
+    return mbedtls_mpi_read_binary(&q->X, pub, 32) == 0 &&
+           mbedtls_mpi_read_binary(&q->Y, pub + 32, 32) == 0 &&
+           mbedtls_mpi_lset(&q->Z, 1) == 0 &&
+           mbedtls_ecp_check_pubkey(&g_keys.grp, q) == 0;
+}
+
+// A fresh digest per sign, as every handshake signs a different transcript
+static void next_digest(void)
+{
+    char text[32];
+    int len = snprintf(text, sizeof(text), "atecc-bench-%lu", (unsigned long)g_keys.message++);
+    mbedtls_sha256_ret((const unsigned char*)text, (size_t)len, g_keys.digest, 0);
+}
+
+// Operations
+
+static bool op_info(void)
+{
+    uint8_t revision[4];
+    return atcab_info(revision) == ATCA_SUCCESS && revision[2] == 0x60;
+}
+
+static bool op_serial(void)
+{
+    uint8_t serial[ATCA_SERIAL_NUM_SIZE];
+    return atcab_read_serial_number(serial) == ATCA_SUCCESS && serial[0] == 0x01 && serial[1] == 0x23;
+}
+
+static bool op_pubkey(void)
+{
+    uint8_t pub[ATCA_ECCP256_PUBKEY_SIZE];
+    return atcab_get_pubkey(BENCH_SIGN_SLOT, pub) == ATCA_SUCCESS &&
+           memcmp(pub, g_keys.sign_pub, sizeof(pub)) == 0;
+}
+
+static void sign_done(void* arg, ATCA_STATUS status)
+{
+    (void)status;
+    (*(uint32_t*)arg)++;
+}
+
+// Sign as main.c's TLS hooks do: the caller is free while it waits between
+// polls (atca_delay_ms stands in for the yield) and held only inside the
+// submit and poll calls
+static bool sign_async(void)
+{
+    calib_sign_async_t job;
+    uint32_t callbacks = g_async.callbacks;
+
+    uint64_t start = bench_now_us();
+    ATCA_STATUS status = atcab_sign_submit(&job, BENCH_SIGN_SLOT, g_keys.digest, g_keys.signature,
+                                           sign_done, &g_async.callbacks);
+    uint64_t held = bench_now_us() - start;
+
+    while (status == ATCA_SUCCESS || status == ATCA_EXECUTION_PENDING) {
+        atca_delay_ms(atcab_sign_wait_msec(&job));
+
+        uint64_t poll_start = bench_now_us();
+        status = atcab_sign_poll(&job);
+        held += bench_now_us() - poll_start;
+        g_async.polls++;
+
+        if (status != ATCA_EXECUTION_PENDING) {
+            break;
+        }
+    }
+
+    g_async.signs++;
+    g_async.held_us += held;
+    g_async.total_us += bench_now_us() - start;
+
+    // The callback fires exactly once, from the completing poll
+    return status == ATCA_SUCCESS && g_async.callbacks == callbacks + 1;
+}
+
+static bool sign_digest(void)
+{
+    return g_async.enabled ? sign_async()
+                           : atcab_sign(BENCH_SIGN_SLOT, g_keys.digest, g_keys.signature) == ATCA_SUCCESS;
+}
+
+// As main.c's TLS hooks: the sign queues ahead of background work
+static bool sign_urgent(void)
+{
+    uint64_t start = bench_now_us();
+    if (atcab_acquire(ATCA_PRIORITY_URGENT) != ATCA_SUCCESS) {
+        return false;
+    }
+    uint32_t waited = (uint32_t)(bench_now_us() - start);
+
+    g_background.signs++;
+    g_background.wait_us += waited;
+    if (waited > g_background.max_wait_us) {
+        g_background.max_wait_us = waited;
+    }
+
+    bool ok = sign_digest();
+    atcab_relinquish();
+    return ok;
+}
+
+static bool op_sign(void)
+{
+    next_digest();
+    if (!(g_background.enabled ? sign_urgent() : sign_digest())) {
+        return false;
+    }
+
+    // Same check a TLS peer makes on the CertificateVerify signature
+    mbedtls_mpi r, s;
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    bool ok = mbedtls_mpi_read_binary(&r, g_keys.signature, 32) == 0 &&
+              mbedtls_mpi_read_binary(&s, g_keys.signature + 32, 32) == 0 &&
+              mbedtls_ecdsa_verify(&g_keys.grp, g_keys.digest, sizeof(g_keys.digest), &g_keys.sign_q, &r, &s) == 0;
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    return ok;
+}
+
+static bool op_verify(void)
+{
+    bool verified = false;
+    if (atcab_verify_extern(g_keys.digest, g_keys.signature, g_keys.sign_pub, &verified) != ATCA_SUCCESS || !verified) {
+        return false;
+    }
+
+    // A flipped bit in the signature must miscompare
+    uint8_t bad[ATCA_ECCP256_SIG_SIZE];
+    memcpy(bad, g_keys.signature, sizeof(bad));
+    bad[10] ^= 0x01;
+    return atcab_verify_extern(g_keys.digest, bad, g_keys.sign_pub, &verified) == ATCA_SUCCESS && !verified;
+}
+
+static bool op_ecdh(void)
+{
+    uint8_t pms[ATCA_ECCP256_KEY_SIZE];
+    if (atcab_ecdh(BENCH_ECDH_SLOT, g_keys.host_pub, pms) != ATCA_SUCCESS) {
+        return false;
+    }
+
+    mbedtls_ecp_point q;
+    mbedtls_mpi z;
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&z);
+
+    uint8_t expected[ATCA_ECCP256_KEY_SIZE];
+    bool ok = load_point(g_keys.ecdh_pub, &q) &&
+              mbedtls_ecdh_compute_shared(&g_keys.grp, &z, &q, &g_keys.host_d, bench_rng, NULL) == 0 &&
+              mbedtls_mpi_write_binary(&z, expected, sizeof(expected)) == 0 &&
+              memcmp(expected, pms, sizeof(pms)) == 0;
+
+    mbedtls_mpi_free(&z);
+    mbedtls_ecp_point_free(&q);
+    return ok;
+}
+
+static bool op_sha(void)
+{
+    uint8_t message[150];
+    uint8_t digest[ATCA_SHA256_DIGEST_SIZE];
+    uint8_t expected[ATCA_SHA256_DIGEST_SIZE];
+
+    for (size_t i = 0; i < sizeof(message); i++) {
+        message[i] = (uint8_t)(i * 7 + g_keys.message);
+    }
+    mbedtls_sha256_ret(message, sizeof(message), expected, 0);
+
+    return atcab_sha(sizeof(message), message, digest) == ATCA_SUCCESS &&
+           memcmp(digest, expected, sizeof(digest)) == 0;
+}
+
+static bool op_random(void)
+{
+    uint8_t a[ATCA_KEY_SIZE], b[ATCA_KEY_SIZE];
+    return atcab_random(a) == ATCA_SUCCESS && atcab_random(b) == ATCA_SUCCESS &&
+           memcmp(a, b, sizeof(a)) != 0;
+}
+
+static bool op_counter(void)
+{
+    uint32_t before = 0, after = 0;
+    return atcab_counter_read(0, &before) == ATCA_SUCCESS &&
+           atcab_counter_increment(0, &after) == ATCA_SUCCESS &&
+           after == before + 1;
+}
+
+static bench_op_t g_ops[] = {
+    { "info",    op_info,    0, 0, 0, 0 },
+    { "serial",  op_serial,  0, 0, 0, 0 },
+    { "pubkey",  op_pubkey,  0, 0, 0, 0 },
+    { "sign",    op_sign,    0, 0, 0, 0 },
+    { "verify",  op_verify,  0, 0, 0, 0 },
+    { "ecdh",    op_ecdh,    0, 0, 0, 0 },
+    { "sha",     op_sha,     0, 0, 0, 0 },
+    { "random",  op_random,  0, 0, 0, 0 },
+    { "counter", op_counter, 0, 0, 0, 0 }
+};
+
+#define BENCH_OP_COUNT (sizeof(g_ops) / sizeof(g_ops[0]))
+
+// Bulk work that would otherwise interleave with the main thread's commands:
+// each pass holds the device for a SHA and a counter read at low priority
+static void* background_thread(void* arg)
+{
+    (void)arg;
+
+    while (!g_background.stop) {
+        uint8_t message[64];
+        uint8_t digest[ATCA_SHA256_DIGEST_SIZE];
+        uint8_t expected[ATCA_SHA256_DIGEST_SIZE];
+        uint32_t counter = 0;
+
+        memset(message, (int)(g_background.ops & 0xFF), sizeof(message));
+        mbedtls_sha256_ret(message, sizeof(message), expected, 0);
+
+        if (atcab_acquire(ATCA_PRIORITY_BACKGROUND) != ATCA_SUCCESS) {
+            g_background.failed++;
+            continue;
+        }
+        bool ok = atcab_sha(sizeof(message), message, digest) == ATCA_SUCCESS &&
+                  memcmp(digest, expected, sizeof(digest)) == 0 &&
+                  atcab_counter_read(1, &counter) == ATCA_SUCCESS;
+        atcab_relinquish();
+
+        if (ok) {
+            g_background.ops++;
+        } else {
+            g_background.failed++;
+        }
+    }
+    return NULL;
+}
+
+static bool setup_keys(void)
+{
+    mbedtls_ecp_group_init(&g_keys.grp);
+    mbedtls_ecp_point_init(&g_keys.sign_q);
+    mbedtls_mpi_init(&g_keys.host_d);
+
+    if (mbedtls_ecp_group_load(&g_keys.grp, MBEDTLS_ECP_DP_SECP256R1) != 0) {
+        return false;
+    }
+
+    // Public keys are read once, as main.c does when it builds the pk context
+    if (atcab_get_pubkey(BENCH_SIGN_SLOT, g_keys.sign_pub) != ATCA_SUCCESS ||
+        atcab_get_pubkey(BENCH_ECDH_SLOT, g_keys.ecdh_pub) != ATCA_SUCCESS) {
+        printf("ATECC Bench: Cannot read public keys\n");
+        return false;
+    }
+    if (!load_point(g_keys.sign_pub, &g_keys.sign_q)) {
+        printf("ATECC Bench: Slot %d public key is not on P-256\n", BENCH_SIGN_SLOT);
+        return false;
+    }
+
+    // Host ephemeral key, the peer side of each ECDH
+    mbedtls_ecp_point host_q;
+    mbedtls_ecp_point_init(&host_q);
+    bool ok = mbedtls_ecp_gen_keypair(&g_keys.grp, &g_keys.host_d, &host_q, bench_rng, NULL) == 0 &&
+              mbedtls_mpi_write_binary(&host_q.X, g_keys.host_pub, 32) == 0 &&
+              mbedtls_mpi_write_binary(&host_q.Y, g_keys.host_pub + 32, 32) == 0;
+    mbedtls_ecp_point_free(&host_q);
+
+    // Something to verify even if sign is the first op to fail
+    next_digest();
+    return ok;
+}
+
+static void free_keys(void)
+{
+    mbedtls_mpi_free(&g_keys.host_d);
+    mbedtls_ecp_point_free(&g_keys.sign_q);
+    mbedtls_ecp_group_free(&g_keys.grp);
+}
+
+static void print_results(void)
+{
+    printf("\nATECC Bench: %-8s %8s %8s %10s %10s\n", "op", "ok", "failed", "avg us", "max us");
+    for (size_t i = 0; i < BENCH_OP_COUNT; i++) {
+        const bench_op_t* op = &g_ops[i];
+        uint32_t runs = op->ok + op->failed;
+        printf("ATECC Bench: %-8s %8lu %8lu %10lu %10lu\n", op->name,
+               (unsigned long)op->ok, (unsigned long)op->failed,
+               (unsigned long)(runs ? op->total_us / runs : 0), (unsigned long)op->max_us);
+    }
+}
+
+// atCRC must match the bitwise model bit for bit at every length; the timed
+// sizes are a status response, a 32 byte block read, a signature response
+// and an external Verify command
+static bool crc_check(void)
+{
+    static const size_t sizes[] = { 2, 33, 65, 133 };
+    uint8_t data[BENCH_CRC_MAX_LENGTH];
+    uint8_t crc_le[ATCA_CRC_SIZE];
+    bool passed = true;
+
+    for (size_t round = 0; round < 64; round++) {
+        if (bench_rng(NULL, data, sizeof(data)) != 0) {
+            return false;
+        }
+        for (size_t length = 0; length <= sizeof(data); length++) {
+            uint16_t expected = atecc_emu_crc16(data, length);
+            atCRC(length, data, crc_le);
+            if ((uint16_t)(crc_le[0] | (crc_le[1] << 8)) != expected) {
+                printf("ATECC Bench: atCRC mismatch at length %zu: %02x%02x, expected %04x\n",
+                       length, crc_le[1], crc_le[0], expected);
+                passed = false;
+                break;
+            }
+        }
+    }
+    printf("ATECC Bench: atCRC %s the bitwise reference over 0..%d bytes\n",
+           passed ? "matches" : "DIFFERS FROM", BENCH_CRC_MAX_LENGTH);
+
+    printf("ATECC Bench: CRC bytes   atCRC ns  bitwise ns\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        volatile uint16_t sink = 0;
+
+        uint64_t start = bench_now_us();
+        for (uint32_t rep = 0; rep < BENCH_CRC_REPS; rep++) {
+            data[0] = (uint8_t)rep;
+            atCRC(sizes[i], data, crc_le);
+            sink ^= crc_le[0];
+        }
+        uint64_t lib_us = bench_now_us() - start;
+
+        start = bench_now_us();
+        for (uint32_t rep = 0; rep < BENCH_CRC_REPS; rep++) {
+            data[0] = (uint8_t)rep;
+            sink ^= atecc_emu_crc16(data, sizes[i]);
+        }
+        uint64_t ref_us = bench_now_us() - start;
+        (void)sink;
+
+        printf("ATECC Bench: CRC %5zu %10.1f %11.1f\n", sizes[i],
+               1000.0 * (double)lib_us / BENCH_CRC_REPS, 1000.0 * (double)ref_us / BENCH_CRC_REPS);
+    }
+    return passed;
+}
+
+static uint32_t emu_commands(const atecc_emu_t* emu)
+{
+    atecc_emu_stats_t stats;
+    atecc_emu_get_stats(emu, &stats);
+    return stats.commands;
+}
+
+// Config zone reads go to the device once; the image carries them across a
+// re-init (a warm boot); a counter increment, which changes the zone, sends
+// the next read back to the device
+// Reads a public key slot into the cache, validates it with a signature from
+// the sign slot's key (stored as its parent) and reads it again: the second
+// read must reach the device and see the validity bits set
+static bool validate_check(atecc_emu_t* emu, uint32_t* reread)
+{
+    uint8_t parent[ATCA_ECCP256_PUBKEY_SIZE];
+    uint8_t key[ATCA_ECCP256_PUBKEY_SIZE];
+    uint8_t digest[ATCA_SHA256_DIGEST_SIZE];
+    uint8_t signature[ATCA_ECCP256_SIG_SIZE];
+    uint8_t other_data[VERIFY_OTHER_DATA_SIZE] = { 0 };
+    uint8_t config[ATCA_ECC_CONFIG_SIZE];
+    uint8_t before[ATCA_BLOCK_SIZE];
+    uint8_t after[ATCA_BLOCK_SIZE];
+    bool verified = false;
+
+    bool ok = atcab_get_pubkey(BENCH_SIGN_SLOT, parent) == ATCA_SUCCESS &&
+              atcab_get_pubkey(BENCH_ECDH_SLOT, key) == ATCA_SUCCESS &&
+              atcab_write_pubkey(BENCH_PARENT_SLOT, parent) == ATCA_SUCCESS &&
+              atcab_write_pubkey(BENCH_VALIDATED_SLOT, key) == ATCA_SUCCESS &&
+              atcab_random(digest) == ATCA_SUCCESS &&
+              atcab_sign(BENCH_SIGN_SLOT, digest, signature) == ATCA_SUCCESS;
+
+    // Data blocks are cached once the SlotConfig is, and the writes above
+    // emptied the cache. Two reads: the second is served from the cache.
+    ok = ok && atcab_read_config_zone(config) == ATCA_SUCCESS;
+    ok = ok && atcab_read_zone(ATCA_ZONE_DATA, BENCH_VALIDATED_SLOT, 0, 0, before, sizeof(before)) == ATCA_SUCCESS;
+    uint32_t start = emu_commands(emu);
+    ok = ok && atcab_read_zone(ATCA_ZONE_DATA, BENCH_VALIDATED_SLOT, 0, 0, before, sizeof(before)) == ATCA_SUCCESS &&
+         emu_commands(emu) == start;
+
+    ok = ok && atcab_nonce_load(NONCE_MODE_TARGET_TEMPKEY, digest, sizeof(digest)) == ATCA_SUCCESS &&
+         atcab_verify_validate(BENCH_VALIDATED_SLOT, signature, other_data, &verified) == ATCA_SUCCESS && verified;
+
+    start = emu_commands(emu);
+    ok = ok && atcab_read_zone(ATCA_ZONE_DATA, BENCH_VALIDATED_SLOT, 0, 0, after, sizeof(after)) == ATCA_SUCCESS;
+    *reread = emu_commands(emu) - start;
+
+    return ok && (before[0] & 0x0F) == 0x00 && (after[0] & 0x0F) == 0x05 &&
+           memcmp(before + 1, after + 1, sizeof(after) - 1) == 0;
+}
+
+static bool zone_cache_check(atecc_emu_t* emu, ATCAIfaceCfg* cfg)
+{
+    uint8_t config[ATCA_ECC_CONFIG_SIZE];
+    uint8_t again[ATCA_ECC_CONFIG_SIZE];
+    uint8_t image[CALIB_ZONE_CACHE_IMAGE_SIZE];
+    size_t image_size = sizeof(image);
+    uint32_t counter;
+    uint32_t cold, warm, imported, invalidated, validated = 0;
+
+    uint32_t start = emu_commands(emu);
+    bool ok = atcab_read_config_zone(config) == ATCA_SUCCESS;
+    cold = emu_commands(emu) - start;
+
+    start = emu_commands(emu);
+    ok = ok && atcab_read_config_zone(again) == ATCA_SUCCESS && memcmp(config, again, sizeof(config)) == 0;
+    warm = emu_commands(emu) - start;
+
+    ok = ok && atcab_zone_cache_export(image, &image_size) == ATCA_SUCCESS;
+    ok = ok && atcab_release() == ATCA_SUCCESS && atcab_init(cfg) == ATCA_SUCCESS;
+    ok = ok && atcab_zone_cache_import(image, image_size) == ATCA_SUCCESS;
+
+    start = emu_commands(emu);
+    ok = ok && atcab_read_config_zone(again) == ATCA_SUCCESS && memcmp(config, again, sizeof(config)) == 0;
+    imported = emu_commands(emu) - start;
+
+    ok = ok && atcab_counter_increment(1, &counter) == ATCA_SUCCESS;
+    start = emu_commands(emu);
+    ok = ok && atcab_read_config_zone(again) == ATCA_SUCCESS;
+    invalidated = emu_commands(emu) - start;
+
+    // Validate rewrites the validity bits of a cached public key slot
+    ok = ok && validate_check(emu, &validated);
+
+    // A damaged image must be refused
+    image[0] ^= 0x01;
+    ok = ok && atcab_zone_cache_import(image, image_size) == ATCA_RX_CRC_ERROR;
+
+    printf("ATECC Bench: config zone reads: %lu commands cold, %lu cached, %lu after image import, %lu after a counter increment\n",
+           (unsigned long)cold, (unsigned long)warm, (unsigned long)imported, (unsigned long)invalidated);
+    printf("ATECC Bench: slot %d read: %lu commands after Verify(Validate)\n", BENCH_VALIDATED_SLOT,
+           (unsigned long)validated);
+
+    ok = ok && cold > 0 && warm == 0 && imported == 0 && invalidated > 0 && validated > 0;
+    printf("ATECC Bench: zone cache %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+// Average time of a Random (35 byte response) at the current clock
+static uint32_t random_time_us(uint32_t count, uint32_t* failed)
+{
+    uint8_t random[ATCA_KEY_SIZE];
+    uint64_t start = bench_now_us();
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (atcab_random(random) != ATCA_SUCCESS) {
+            (*failed)++;
+        }
+    }
+    return (uint32_t)((bench_now_us() - start) / (count ? count : 1));
+}
+
+// The probe settles on the fastest step the part follows; when the part
+// then stops following it (a degraded bus), failures step the clock back
+// down to the configured 100 kHz and a second probe stays there
+static bool speed_check(atecc_emu_t* emu, ATCAIfaceCfg* cfg, uint32_t max_baud, uint32_t count)
+{
+    static const uint32_t steps[] = { 100000, 400000, 1000000 };
+    uint32_t expected = steps[0];
+    uint32_t baud = 0;
+    uint32_t failed = 0;
+    uint32_t fallback_failures = 0;
+    uint8_t random[ATCA_KEY_SIZE];
+
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        if (steps[i] <= max_baud) {
+            expected = steps[i];
+        }
+    }
+
+    atecc_emu_set_max_baud(emu, max_baud);
+
+    uint32_t base_us = random_time_us(count, &failed);
+    bool ok = atcab_i2c_speed_probe(&baud) == ATCA_SUCCESS && baud == expected;
+    uint32_t fast_us = random_time_us(count, &failed);
+
+    printf("ATECC Bench: part follows %lu Hz, probe settled on %lu Hz (expected %lu)\n",
+           (unsigned long)max_baud, (unsigned long)baud, (unsigned long)expected);
+    printf("ATECC Bench: Random %lu us at 100 kHz, %lu us at %lu Hz\n",
+           (unsigned long)base_us, (unsigned long)fast_us, (unsigned long)baud);
+
+    atecc_emu_set_max_baud(emu, steps[0]);
+    for (uint32_t i = 0; i < 4 && atcab_random(random) != ATCA_SUCCESS; i++) {
+        fallback_failures++;
+    }
+    ok = ok && atcab_random(random) == ATCA_SUCCESS;
+    ok = ok && atcab_i2c_speed_probe(&baud) == ATCA_SUCCESS && baud == steps[0];
+    ok = ok && ATCA_IFACECFG_VALUE(cfg, atcai2c.baud) == steps[0];
+
+    printf("ATECC Bench: part dropped to 100 kHz: %lu failed commands, then %lu Hz after a re-probe\n",
+           (unsigned long)fallback_failures, (unsigned long)baud);
+
+    ok = ok && failed == 0;
+    printf("ATECC Bench: I2C speed stepping %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+// Pooled signing (-m): one emulated part per device, each at its own
+// address and with its own keys
+typedef struct {
+    atecc_emu_t* emu[ATCA_POOL_DEVICES_MAX];
+    ATCAIfaceCfg cfg[ATCA_POOL_DEVICES_MAX];
+    ATCADevice device[ATCA_POOL_DEVICES_MAX];
+    mbedtls_ecp_point pub[ATCA_POOL_DEVICES_MAX];
+    uint32_t count;
+    calib_pool_t pool;
+    uint32_t signs;              // Per thread in the threaded pass
+    volatile uint32_t failed;
+} bench_pool_t;
+
+static bench_pool_t g_pool;
+
+// Checks a pool signature against the public key of the device that made it
+static bool pool_verify(int index, const uint8_t* digest, const uint8_t* signature)
+{
+    if (index < 0 || (uint32_t)index >= g_pool.count) {
+        return false;
+    }
+
+    mbedtls_mpi r, s;
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    bool ok = mbedtls_mpi_read_binary(&r, signature, 32) == 0 &&
+              mbedtls_mpi_read_binary(&s, signature + 32, 32) == 0 &&
+              mbedtls_ecdsa_verify(&g_keys.grp, digest, ATCA_SHA256_DIGEST_SIZE, &g_pool.pub[index], &r, &s) == 0;
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    return ok;
+}
+
+// One caller keeps every device of the pool busy: it submits while a device
+// is free and polls the running signs in between. Returns signs per second.
+static double pool_run_async(uint32_t devices, uint32_t count, uint32_t* failed)
+{
+    calib_sign_async_t jobs[ATCA_POOL_DEVICES_MAX];
+    uint8_t digests[ATCA_POOL_DEVICES_MAX][ATCA_SHA256_DIGEST_SIZE];
+    uint8_t signatures[ATCA_POOL_DEVICES_MAX][ATCA_ECCP256_SIG_SIZE];
+    bool active[ATCA_POOL_DEVICES_MAX] = { false };
+    uint32_t submitted = 0;
+    uint32_t done = 0;
+
+    if (atcab_pool_init(&g_pool.pool, g_pool.device, (uint8_t)devices) != ATCA_SUCCESS) {
+        (*failed)++;
+        return 0.0;
+    }
+
+    uint64_t start = bench_now_us();
+
+    while (done < count) {
+        for (uint32_t i = 0; i < devices && submitted < count; i++) {
+            if (active[i]) {
+                continue;
+            }
+            next_digest();
+            memcpy(digests[i], g_keys.digest, sizeof(digests[i]));
+            ATCA_STATUS status = atcab_pool_sign_submit(&g_pool.pool, &jobs[i], BENCH_SIGN_SLOT, digests[i],
+                                                        signatures[i], NULL, NULL);
+            if (status == ATCA_NO_DEVICES) {
+                break;
+            }
+            submitted++;
+            if (status == ATCA_SUCCESS) {
+                active[i] = true;
+            } else {
+                (*failed)++;
+                done++;
+            }
+        }
+
+        atca_delay_ms(1);
+
+        for (uint32_t i = 0; i < devices; i++) {
+            if (!active[i] || atcab_pool_sign_poll(&g_pool.pool, &jobs[i]) == ATCA_EXECUTION_PENDING) {
+                continue;
+            }
+            if (jobs[i].status != ATCA_SUCCESS ||
+                !pool_verify(atcab_pool_device_index(&g_pool.pool, &jobs[i]), digests[i], signatures[i])) {
+                (*failed)++;
+            }
+            active[i] = false;
+            done++;
+        }
+    }
+
+    double elapsed_s = (double)(bench_now_us() - start) / 1e6;
+
+    printf("ATECC Bench: %lu device(s), one caller: %lu signs in %.3f s, %.1f signs/s, per device",
+           (unsigned long)devices, (unsigned long)count, elapsed_s, (double)count / elapsed_s);
+    for (uint32_t i = 0; i < devices; i++) {
+        printf(" %lu", (unsigned long)g_pool.pool.signs[i]);
+    }
+    printf("\n");
+
+    atcab_pool_release(&g_pool.pool);
+    return (double)count / elapsed_s;
+}
+
+// Blocking atcab_pool_sign from a thread per device, as the tasks of an
+// RTOS build would call it
+static void* pool_thread(void* arg)
+{
+    uint32_t seed = (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t i = 0; i < g_pool.signs; i++) {
+        uint8_t digest[ATCA_SHA256_DIGEST_SIZE];
+        uint8_t signature[ATCA_ECCP256_SIG_SIZE];
+        uint8_t index = 0;
+        char text[40];
+        int len = snprintf(text, sizeof(text), "atecc-pool-%lu-%lu", (unsigned long)seed, (unsigned long)i);
+
+        mbedtls_sha256_ret((const unsigned char*)text, (size_t)len, digest, 0);
+        if (atcab_pool_sign(&g_pool.pool, BENCH_SIGN_SLOT, digest, signature, &index) != ATCA_SUCCESS ||
+            !pool_verify(index, digest, signature)) {
+            __atomic_add_fetch(&g_pool.failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+// Signs must verify against the key of the device the pool chose, spread
+// over every device, and a single caller's throughput must grow with the
+// number of devices
+static bool pool_check(const bench_config_t* bench)
+{
+    uint32_t failed = 0;
+    bool ok = true;
+
+    if (bench->pool_devices > ATCA_POOL_DEVICES_MAX) {
+        printf("ATECC Bench: at most %d pooled devices\n", ATCA_POOL_DEVICES_MAX);
+        return false;
+    }
+
+    mbedtls_ecp_group_init(&g_keys.grp);
+    if (mbedtls_ecp_group_load(&g_keys.grp, MBEDTLS_ECP_DP_SECP256R1) != 0) {
+        return false;
+    }
+
+    g_pool.count = bench->pool_devices;
+    for (uint32_t i = 0; i < g_pool.count && ok; i++) {
+        uint8_t pub[ATCA_ECCP256_PUBKEY_SIZE];
+
+        mbedtls_ecp_point_init(&g_pool.pub[i]);
+        g_pool.emu[i] = atecc_emu_create();
+        ok = g_pool.emu[i] && atecc_emu_load_profile(g_pool.emu[i], bench->profile);
+        if (ok) {
+            atecc_emu_set_address(g_pool.emu[i], (uint8_t)(ATECC_EMU_DEFAULT_ADDRESS + i));
+            atecc_emu_set_timing_scale(g_pool.emu[i], bench->timing_pct);
+            atecc_emu_iface_cfg(g_pool.emu[i], &g_pool.cfg[i]);
+            g_pool.device[i] = newATCADevice(&g_pool.cfg[i]);
+        }
+        ok = ok && g_pool.device[i] &&
+             atcab_get_pubkey_ext(g_pool.device[i], BENCH_SIGN_SLOT, pub) == ATCA_SUCCESS &&
+             load_point(pub, &g_pool.pub[i]);
+    }
+
+    if (!ok) {
+        printf("ATECC Bench: Cannot set up the pooled devices\n");
+    } else {
+        double single = pool_run_async(1, bench->count, &failed);
+        double pooled = pool_run_async(g_pool.count, bench->count * g_pool.count, &failed);
+        double scaling = (single > 0.0) ? pooled / single : 0.0;
+
+        printf("ATECC Bench: %lu devices sign %.2fx as fast as one\n", (unsigned long)g_pool.count, scaling);
+        for (uint32_t i = 0; i < g_pool.count; i++) {
+            ok = ok && g_pool.pool.signs[i] > 0;
+        }
+        // Only the modelled execution time overlaps; at zero latency the
+        // bus and host crypto are all there is
+        if (bench->timing_pct != 0 && g_pool.count > 1 && scaling < (double)g_pool.count / 2.0) {
+            printf("ATECC Bench: pooled signing does not scale\n");
+            ok = false;
+        }
+
+        pthread_t threads[ATCA_POOL_DEVICES_MAX];
+        g_pool.signs = bench->count;
+        ok = ok && atcab_pool_init(&g_pool.pool, g_pool.device, (uint8_t)g_pool.count) == ATCA_SUCCESS;
+        uint64_t start = bench_now_us();
+        for (uint32_t i = 0; ok && i < g_pool.count; i++) {
+            ok = pthread_create(&threads[i], NULL, pool_thread, (void*)(uintptr_t)i) == 0;
+        }
+        for (uint32_t i = 0; ok && i < g_pool.count; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        double elapsed_s = (double)(bench_now_us() - start) / 1e6;
+        printf("ATECC Bench: %lu threads, blocking pool sign: %.1f signs/s, %lu failed\n",
+               (unsigned long)g_pool.count, (double)(g_pool.signs * g_pool.count) / elapsed_s,
+               (unsigned long)g_pool.failed);
+        atcab_pool_release(&g_pool.pool);
+        failed += g_pool.failed;
+    }
+
+    for (uint32_t i = 0; i < g_pool.count; i++) {
+        if (g_pool.device[i]) {
+            deleteATCADevice(&g_pool.device[i]);
+        }
+        atecc_emu_destroy(g_pool.emu[i]);
+        mbedtls_ecp_point_free(&g_pool.pub[i]);
+    }
+    mbedtls_ecp_group_free(&g_keys.grp);
+
+    ok = ok && failed == 0;
+    printf("ATECC Bench: device pool %s\n", ok ? "passed" : "FAILED");
+    return ok;
+}
+
+static const char* opcode_name(uint8_t opcode)
+{
+    switch (opcode) {
+        case ATCA_COUNTER: return "Counter";
+        case ATCA_ECDH:    return "ECDH";
+        case ATCA_GENKEY:  return "GenKey";
+        case ATCA_INFO:    return "Info";
+        case ATCA_LOCK:    return "Lock";
+        case ATCA_NONCE:   return "Nonce";
+        case ATCA_RANDOM:  return "Random";
+        case ATCA_READ:    return "Read";
+        case ATCA_SHA:     return "SHA";
+        case ATCA_SIGN:    return "Sign";
+        case ATCA_VERIFY:  return "Verify";
+        case ATCA_WRITE:   return "Write";
+        default:           return "?";
+    }
+}
+
+// The library's view of the run; every command it counts must have reached
+// the emulator and the other way round
+static bool profile_report(uint32_t emu_commands_run)
+{
+    atca_opcode_stats_t stats[ATCA_PROFILE_OPCODE_COUNT];
+    size_t count = ATCA_PROFILE_OPCODE_COUNT;
+    uint32_t commands = 0;
+
+    if (atcab_get_stats(stats, &count) != ATCA_SUCCESS) {
+        printf("ATECC Bench: atcab_get_stats failed\n");
+        return false;
+    }
+
+    printf("\nATECC Profile: %-8s %6s %6s %6s %6s %6s %8s %8s %8s %8s\n", "opcode", "cmds", "fail",
+           "wake", "polls", "crc", "send us", "exec us", "recv us", "max us");
+    for (size_t i = 0; i < count; i++) {
+        const atca_opcode_stats_t* op = &stats[i];
+        uint32_t n = op->commands ? op->commands : 1;
+        printf("ATECC Profile: %-8s %6lu %6lu %6lu %6lu %6lu %8lu %8lu %8lu %8lu\n", opcode_name(op->opcode),
+               (unsigned long)op->commands, (unsigned long)op->failures, (unsigned long)op->wake_retries,
+               (unsigned long)op->polls, (unsigned long)op->crc_errors, (unsigned long)(op->send_usec / n),
+               (unsigned long)(op->exec_usec / n), (unsigned long)(op->receive_usec / n),
+               (unsigned long)op->max_usec);
+        commands += op->commands;
+    }
+
+    printf("ATECC Profile: %lu commands profiled, %lu reached the emulator\n",
+           (unsigned long)commands, (unsigned long)emu_commands_run);
+    return commands == emu_commands_run;
+}
+
+int main(int argc, char** argv)
+{
+    bench_config_t bench = {
+        .count = BENCH_DEFAULT_COUNT,
+        .profile = ATECC_BENCH_DEFAULT_PROFILE,
+        .timing_pct = 100,
+        .sign_budget_us = 0,
+        .session = false,
+        .async_sign = false,
+        .background = false,
+        .crc = false,
+        .zone_cache = false,
+        .speed_max_baud = 0,
+        .profile_dump = false,
+        .pool_devices = 0
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:t:zl:sabrwi:pm:h")) != -1) {
+        switch (opt) {
+            case 'n': bench.count = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'c': bench.profile = optarg; break;
+            case 't': bench.timing_pct = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'z': bench.timing_pct = 0; break;
+            case 'l': bench.sign_budget_us = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 's': bench.session = true; break;
+            case 'a': bench.async_sign = true; break;
+            case 'b': bench.background = true; break;
+            case 'r': bench.crc = true; break;
+            case 'w': bench.zone_cache = true; break;
+            case 'i': bench.speed_max_baud = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'p': bench.profile_dump = true; break;
+            case 'm': bench.pool_devices = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (bench.crc) {
+        return crc_check() ? 0 : 1;
+    }
+
+    g_async.enabled = bench.async_sign;
+    g_background.enabled = bench.background;
+
+    atecc_emu_t* emu = atecc_emu_create();
+    if (!emu || !atecc_emu_load_profile(emu, bench.profile)) {
+        return 1;
+    }
+    atecc_emu_set_timing_scale(emu, bench.timing_pct);
+
+    if (!atecc_emu_register_hal()) {
+        printf("ATECC Bench: Cannot register emulator HAL\n");
+        return 1;
+    }
+
+    if (bench.pool_devices != 0) {
+        atecc_emu_destroy(emu);
+        return pool_check(&bench) ? 0 : 1;
+    }
+
+    ATCAIfaceCfg cfg;
+    atecc_emu_iface_cfg(emu, &cfg);
+
+    ATCA_STATUS status = atcab_init(&cfg);
+    if (status != ATCA_SUCCESS) {
+        printf("ATECC Bench: atcab_init failed: 0x%02x\n", status);
+        return 1;
+    }
+
+    if (bench.speed_max_baud != 0) {
+        bool passed = speed_check(emu, &cfg, bench.speed_max_baud, bench.count);
+        atcab_release();
+        atecc_emu_destroy(emu);
+        return passed ? 0 : 1;
+    }
+
+    if (bench.zone_cache) {
+        bool passed = zone_cache_check(emu, &cfg);
+        atcab_release();
+        atecc_emu_destroy(emu);
+        return passed ? 0 : 1;
+    }
+
+    if (!setup_keys()) {
+        return 1;
+    }
+
+    // Profile the timed run only
+    if (bench.profile_dump && atcab_reset_stats() != ATCA_SUCCESS) {
+        return 1;
+    }
+    uint32_t emu_commands_start = emu_commands(emu);
+
+    // A whole-run session outlives the device watchdog many times over, so
+    // it also exercises the idle-before-expiry path
+    if (bench.session && atcab_session_begin() != ATCA_SUCCESS) {
+        return 1;
+    }
+
+    pthread_t background;
+    if (bench.background && pthread_create(&background, NULL, background_thread, NULL) != 0) {
+        printf("ATECC Bench: Cannot start background thread\n");
+        return 1;
+    }
+
+    uint64_t start = bench_now_us();
+
+    for (uint32_t i = 0; i < bench.count; i++) {
+        for (size_t j = 0; j < BENCH_OP_COUNT; j++) {
+            bench_op_t* op = &g_ops[j];
+
+            uint64_t op_start = bench_now_us();
+            bool ok = op->run();
+            uint32_t elapsed = (uint32_t)(bench_now_us() - op_start);
+
+            op->total_us += elapsed;
+            if (elapsed > op->max_us) {
+                op->max_us = elapsed;
+            }
+            if (ok) {
+                op->ok++;
+            } else {
+                op->failed++;
+                printf("ATECC Bench: %s failed (iteration %lu)\n", op->name, (unsigned long)i);
+            }
+        }
+    }
+
+    double elapsed_s = (double)(bench_now_us() - start) / 1e6;
+
+    if (bench.background) {
+        g_background.stop = true;
+        pthread_join(background, NULL);
+    }
+
+    if (bench.session) {
+        atcab_session_end();
+    }
+
+    print_results();
+    printf("ATECC Bench: %lu iterations in %.3f s\n", (unsigned long)bench.count, elapsed_s);
+    if (g_async.signs > 0) {
+        printf("ATECC Bench: async sign held the caller %lu of %lu us (%.1f%%), %.1f polls per sign\n",
+               (unsigned long)(g_async.held_us / g_async.signs), (unsigned long)(g_async.total_us / g_async.signs),
+               g_async.total_us ? 100.0 * (double)g_async.held_us / (double)g_async.total_us : 0.0,
+               (double)g_async.polls / (double)g_async.signs);
+    }
+    if (bench.background) {
+        printf("ATECC Bench: background thread %lu ops, %lu failed; signs waited avg %lu us, max %lu us for the device\n",
+               (unsigned long)g_background.ops, (unsigned long)g_background.failed,
+               (unsigned long)(g_background.signs ? g_background.wait_us / g_background.signs : 0),
+               (unsigned long)g_background.max_wait_us);
+    }
+    atecc_emu_print_stats(emu);
+
+    bool passed = g_background.failed == 0;
+    if (bench.profile_dump && !profile_report(emu_commands(emu) - emu_commands_start)) {
+        printf("ATECC Bench: profile does not match the emulator\n");
+        passed = false;
+    }
+    for (size_t i = 0; i < BENCH_OP_COUNT; i++) {
+        passed = passed && g_ops[i].failed == 0;
+    }
+
+    const bench_op_t* sign = &g_ops[3];
+    if (bench.sign_budget_us != 0 && sign->max_us > bench.sign_budget_us) {
+        printf("ATECC Bench: sign latency %lu us over budget %lu us\n",
+               (unsigned long)sign->max_us, (unsigned long)bench.sign_budget_us);
+        passed = false;
+    }
+
+    free_keys();
+    atcab_release();
+    atecc_emu_destroy(emu);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,1523 @@
+// Software ATECC608B behind cryptoauthlib's I2C HAL (host builds only)
+//
+// The model follows the datasheet at the I2C transaction level: a write to
+// address 0 at <= 100 kHz is the wake pulse, word address 0x03 carries a
+// command packet, 0x02/0x01 idle and sleep the part and 0x00 resets the
+// output buffer pointer. While asleep, idle or executing the part NAKs.
+// Cryptography is mbedTLS P-256 and SHA-256; keys never leave the model.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+#include "atecc_emu.h"
+
+#include "mbedtls/ecp.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/sha256.h"
+
+// Device status codes (single-byte responses)
+#define EMU_STATUS_SUCCESS      0x00
+#define EMU_STATUS_MISCOMPARE   0x01
+#define EMU_STATUS_PARSE        0x03
+#define EMU_STATUS_EXECUTION    0x0F
+#define EMU_STATUS_WAKE         0x11
+#define EMU_STATUS_WATCHDOG     0xEE
+#define EMU_STATUS_COMM         0xFF
+
+// I2C word addresses
+#define EMU_WORD_RESET          0x00
+#define EMU_WORD_SLEEP          0x01
+#define EMU_WORD_IDLE           0x02
+#define EMU_WORD_COMMAND        0x03
+
+// Config zone layout
+#define EMU_CFG_REVISION        4U
+#define EMU_CFG_I2C_ADDRESS     16U
+#define EMU_CFG_CHIP_MODE       19U
+#define EMU_CFG_SLOT_CONFIG     20U
+#define EMU_CFG_USER_EXTRA      84U
+#define EMU_CFG_LOCK_VALUE      86U
+#define EMU_CFG_LOCK_CONFIG     87U
+#define EMU_CFG_SLOT_LOCKED     88U
+#define EMU_CFG_KEY_CONFIG      96U
+#define EMU_LOCKED              0x00
+#define EMU_UNLOCKED            0x55
+
+// SlotConfig / KeyConfig bits used by the model
+#define EMU_SLOT_READKEY_EXT_SIGN   0x0001U
+#define EMU_SLOT_READKEY_ECDH       0x0004U
+#define EMU_SLOT_READKEY_ECDH_SLOT  0x0008U  // Compatibility ECDH writes slot N|1
+#define EMU_SLOT_IS_SECRET          0x0080U
+#define EMU_SLOT_WRITE_CONFIG(s)    (((s) >> 12) & 0x0FU)
+#define EMU_SLOT_WRITE_GENKEY       0x2U     // WriteConfig bit: GenKey after data lock
+#define EMU_SLOT_READKEY(s)         ((s) & 0x0FU)
+#define EMU_KEY_PRIVATE             0x0001U
+#define EMU_KEY_PUBINFO             0x0002U
+#define EMU_KEY_TYPE(k)             (((k) >> 2) & 0x07U)
+#define EMU_KEY_TYPE_P256           4U
+#define EMU_KEY_LOCKABLE            0x0020U
+
+// Watchdog from wake, ChipMode bit 2 selects the long one
+#define EMU_WATCHDOG_US             1300000ULL
+#define EMU_WATCHDOG_LONG_US        10000000ULL
+
+// tWLO: SDA must stay low this long for a wake
+#define EMU_WAKE_LOW_MIN_US         60U
+
+#define EMU_MAX_PACKET              (ATCA_CMD_SIZE_MAX + 4U)
+#define EMU_MAX_RESPONSE            ATCA_RSP_SIZE_MAX
+#define EMU_COUNTER_MAX             2097151U
+
+typedef enum {
+    EMU_POWER_SLEEP,
+    EMU_POWER_IDLE,
+    EMU_POWER_AWAKE
+} emu_power_t;
+
+// A 32- or 64-byte volatile buffer (TempKey, Message Digest Buffer)
+typedef struct {
+    uint8_t value[64];
+    bool valid;
+} emu_buffer_t;
+
+struct atecc_emu {
+    // Non-volatile state, set by the profile and by Write/GenKey/Lock
+    uint8_t address;
+    uint8_t config[ATECC_EMU_CONFIG_SIZE];
+    uint8_t otp[ATECC_EMU_OTP_SIZE];
+    uint8_t data[ATECC_EMU_SLOT_COUNT][ATECC_EMU_SLOT_MAX_SIZE];
+    uint8_t private_key[ATECC_EMU_SLOT_COUNT][32];
+    bool key_valid[ATECC_EMU_SLOT_COUNT];
+    uint32_t counter[2];
+
+    // Timing model
+    uint32_t exec_us[256];
+    uint32_t timing_scale_pct;
+    uint32_t baud;
+    uint32_t max_baud;
+
+    // Volatile state, lost on sleep or watchdog expiry
+    emu_power_t power;
+    uint64_t watchdog_at_us;
+    uint64_t busy_until_us;
+    emu_buffer_t tempkey;
+    emu_buffer_t msg_digest;
+    uint8_t tempkey_private[32];
+    bool tempkey_private_valid;
+    mbedtls_sha256_context sha;
+    bool sha_started;
+
+    uint8_t response[EMU_MAX_RESPONSE];
+    size_t response_len;
+    size_t read_pos;
+
+    uint32_t corrupt_responses;
+    atecc_emu_stats_t stats;
+    mbedtls_ecp_group grp;
+};
+
+// Opcode names accepted by the profile's timing lines
+typedef struct {
+    const char* name;
+    uint8_t opcode;
+} emu_opcode_name_t;
+
+static const emu_opcode_name_t g_opcode_names[] = {
+    { "counter", ATCA_COUNTER },
+    { "ecdh",    ATCA_ECDH },
+    { "genkey",  ATCA_GENKEY },
+    { "info",    ATCA_INFO },
+    { "lock",    ATCA_LOCK },
+    { "nonce",   ATCA_NONCE },
+    { "random",  ATCA_RANDOM },
+    { "read",    ATCA_READ },
+    { "sha",     ATCA_SHA },
+    { "sign",    ATCA_SIGN },
+    { "verify",  ATCA_VERIFY },
+    { "write",   ATCA_WRITE }
+};
+
+// Datasheet maximum execution times at ClockDivider 0 (ms), the same
+// figures calib uses for ATECC608-M0 in ATCA_NO_POLL mode. Bench typicals
+// are lower; profiles can override them with measured values.
+static const struct {
+    uint8_t opcode;
+    uint16_t ms;
+} g_exec_ms_608[] = {
+    { ATCA_COUNTER, 25 },
+    { ATCA_ECDH,    75 },
+    { ATCA_GENKEY,  115 },
+    { ATCA_INFO,    5 },
+    { ATCA_LOCK,    35 },
+    { ATCA_NONCE,   20 },
+    { ATCA_RANDOM,  23 },
+    { ATCA_READ,    5 },
+    { ATCA_SHA,     36 },
+    { ATCA_SIGN,    115 },
+    { ATCA_VERIFY,  105 },
+    { ATCA_WRITE,   45 }
+};
+
+// Slots 0-7 hold 36 bytes, slot 8 416 and slots 9-15 72
+static const uint16_t g_slot_size[ATECC_EMU_SLOT_COUNT] = {
+    36, 36, 36, 36, 36, 36, 36, 36, 416, 72, 72, 72, 72, 72, 72, 72
+};
+
+// Factory config zone: serial 0123xxxxxxxxxxxxEE, ATECC608B revision,
+// I2C at 0xC0, every slot and key config zero and both zones unlocked
+static const uint8_t g_factory_config[ATECC_EMU_CONFIG_SIZE] = {
+    0x01, 0x23, 0x00, 0x00, 0x00, 0x00, 0x60, 0x03, 0x00, 0x00, 0x00, 0x00, 0xEE, 0x01, 0x01, 0x00,
+    0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x55, 0x55, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+// Forward declarations
+static ATCA_STATUS emu_hal_init(ATCAIface iface, ATCAIfaceCfg* cfg);
+static ATCA_STATUS emu_hal_post_init(ATCAIface iface);
+static ATCA_STATUS emu_hal_send(ATCAIface iface, uint8_t word_address, uint8_t* txdata, int txlength);
+static ATCA_STATUS emu_hal_receive(ATCAIface iface, uint8_t word_address, uint8_t* rxdata, uint16_t* rxlength);
+static ATCA_STATUS emu_hal_control(ATCAIface iface, uint8_t option, void* param, size_t paramlen);
+static ATCA_STATUS emu_hal_release(void* hal_data);
+static void emu_execute(atecc_emu_t* emu, const uint8_t* packet, size_t length);
+
+static ATCAHAL_t g_emu_hal = {
+    emu_hal_init,
+    emu_hal_post_init,
+    emu_hal_send,
+    emu_hal_receive,
+    emu_hal_control,
+    emu_hal_release
+};
+
+// Platform functions src/hal_pico_i2c.c provides on target (hal_delay_ms/us
+// come from cryptoauthlib's hal_linux.c)
+
+void* hal_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void hal_free(void* ptr)
+{
+    free(ptr);
+}
+
+void atca_delay_ms(uint32_t ms)
+{
+    hal_delay_ms(ms);
+}
+
+void atca_delay_us(uint32_t us)
+{
+    hal_delay_us(us);
+}
+
+// Time and randomness
+
+static uint64_t emu_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void emu_sleep_us(uint64_t us)
+{
+    struct timespec ts = {
+        .tv_sec = (time_t)(us / 1000000ULL),
+        .tv_nsec = (long)((us % 1000000ULL) * 1000ULL)
+    };
+    nanosleep(&ts, NULL);
+}
+
+static int emu_rng(void* ctx, unsigned char* out, size_t len)
+{
+    (void)ctx;
+
+    while (len > 0) {
+        ssize_t got = getrandom(out, len, 0);
+        if (got <= 0) {
+            return -1;
+        }
+        out += got;
+        len -= (size_t)got;
+    }
+    return 0;
+}
+
+// Same polynomial and bit order as the device (and atCRC), kept bitwise and
+// separate so the model checks the library rather than agreeing with it by
+// construction
+uint16_t atecc_emu_crc16(const uint8_t* data, size_t length)
+{
+    uint16_t crc = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        for (uint8_t mask = 0x01; mask != 0; mask <<= 1) {
+            uint8_t data_bit = (data[i] & mask) ? 1 : 0;
+            uint8_t crc_bit = (uint8_t)(crc >> 15);
+            crc <<= 1;
+            if (data_bit != crc_bit) {
+                crc ^= 0x8005;
+            }
+        }
+    }
+    return crc;
+}
+
+// Config zone accessors
+
+static bool emu_config_locked(const atecc_emu_t* emu)
+{
+    return emu->config[EMU_CFG_LOCK_CONFIG] != EMU_UNLOCKED;
+}
+
+static bool emu_data_locked(const atecc_emu_t* emu)
+{
+    return emu->config[EMU_CFG_LOCK_VALUE] != EMU_UNLOCKED;
+}
+
+static uint16_t emu_slot_config(const atecc_emu_t* emu, uint16_t slot)
+{
+    return (uint16_t)(emu->config[EMU_CFG_SLOT_CONFIG + slot * 2] |
+                      (emu->config[EMU_CFG_SLOT_CONFIG + slot * 2 + 1] << 8));
+}
+
+static uint16_t emu_key_config(const atecc_emu_t* emu, uint16_t slot)
+{
+    return (uint16_t)(emu->config[EMU_CFG_KEY_CONFIG + slot * 2] |
+                      (emu->config[EMU_CFG_KEY_CONFIG + slot * 2 + 1] << 8));
+}
+
+static bool emu_slot_locked(const atecc_emu_t* emu, uint16_t slot)
+{
+    uint16_t unlocked = (uint16_t)(emu->config[EMU_CFG_SLOT_LOCKED] |
+                                   (emu->config[EMU_CFG_SLOT_LOCKED + 1] << 8));
+    return (unlocked & (1U << slot)) == 0;
+}
+
+static bool emu_is_p256_private(const atecc_emu_t* emu, uint16_t slot)
+{
+    uint16_t key_config = emu_key_config(emu, slot);
+    return (key_config & EMU_KEY_PRIVATE) && EMU_KEY_TYPE(key_config) == EMU_KEY_TYPE_P256;
+}
+
+// Power state
+
+static void emu_clear_volatile(atecc_emu_t* emu)
+{
+    emu->tempkey.valid = false;
+    emu->msg_digest.valid = false;
+    emu->tempkey_private_valid = false;
+    emu->sha_started = false;
+    emu->response_len = 0;
+    emu->read_pos = 0;
+    emu->busy_until_us = 0;
+}
+
+static void emu_check_watchdog(atecc_emu_t* emu, uint64_t now)
+{
+    if (emu->power == EMU_POWER_AWAKE && now >= emu->watchdog_at_us) {
+        emu->power = EMU_POWER_SLEEP;
+        emu->stats.watchdog_expiries++;
+        emu_clear_volatile(emu);
+    }
+}
+
+static void emu_wake(atecc_emu_t* emu)
+{
+    uint64_t now = emu_now_us();
+
+    emu_check_watchdog(emu, now);
+    if (emu->power == EMU_POWER_AWAKE) {
+        return;
+    }
+
+    // Idle keeps TempKey and the other volatile buffers; sleep already cleared them
+    emu->power = EMU_POWER_AWAKE;
+    emu->watchdog_at_us = now + ((emu->config[EMU_CFG_CHIP_MODE] & 0x04) ? EMU_WATCHDOG_LONG_US : EMU_WATCHDOG_US);
+    emu->response[0] = 0x04;
+    emu->response[1] = EMU_STATUS_WAKE;
+    emu->response[2] = 0x33;
+    emu->response[3] = 0x43;
+    emu->response_len = 4;
+    emu->read_pos = 0;
+    emu->stats.wakes++;
+}
+
+// Bus model: 9 bit times per byte including the address byte. Every
+// emulated part sits on one bus, so transfers to different parts take
+// turns, as under the bus lock in hal_pico_i2c.c.
+static pthread_mutex_t g_emu_bus = PTHREAD_MUTEX_INITIALIZER;
+
+static void emu_bus_transfer(const atecc_emu_t* emu, size_t bytes)
+{
+    if (emu->timing_scale_pct == 0 || emu->baud == 0) {
+        return;
+    }
+    pthread_mutex_lock(&g_emu_bus);
+    emu_sleep_us(((bytes + 1) * 9ULL * 1000000ULL / emu->baud) * emu->timing_scale_pct / 100U);
+    pthread_mutex_unlock(&g_emu_bus);
+}
+
+static bool emu_bus_overspeed(const atecc_emu_t* emu)
+{
+    return emu->max_baud != 0 && emu->baud > emu->max_baud;
+}
+
+// Lifecycle
+
+bool atecc_emu_register_hal(void)
+{
+    ATCAHAL_t* old_hal = NULL;
+    ATCAHAL_t* old_phy = NULL;
+
+    return hal_iface_register_hal(ATCA_I2C_IFACE, &g_emu_hal, &old_hal, NULL, &old_phy) == ATCA_SUCCESS;
+}
+
+atecc_emu_t* atecc_emu_create(void)
+{
+    atecc_emu_t* emu = (atecc_emu_t*)calloc(1, sizeof(atecc_emu_t));
+    if (!emu) {
+        return NULL;
+    }
+
+    emu->address = ATECC_EMU_DEFAULT_ADDRESS;
+    memcpy(emu->config, g_factory_config, sizeof(emu->config));
+    memset(emu->otp, 0xFF, sizeof(emu->otp));
+    memset(emu->data, 0xFF, sizeof(emu->data));
+
+    for (size_t i = 0; i < sizeof(g_exec_ms_608) / sizeof(g_exec_ms_608[0]); i++) {
+        emu->exec_us[g_exec_ms_608[i].opcode] = g_exec_ms_608[i].ms * 1000U;
+    }
+    emu->timing_scale_pct = 100;
+    emu->max_baud = ATECC_EMU_DEFAULT_MAX_BAUD;
+    emu->power = EMU_POWER_SLEEP;
+
+    mbedtls_sha256_init(&emu->sha);
+    mbedtls_ecp_group_init(&emu->grp);
+    if (mbedtls_ecp_group_load(&emu->grp, MBEDTLS_ECP_DP_SECP256R1) != 0) {
+        atecc_emu_destroy(emu);
+        return NULL;
+    }
+
+    return emu;
+}
+
+void atecc_emu_destroy(atecc_emu_t* emu)
+{
+    if (!emu) {
+        return;
+    }
+
+    mbedtls_sha256_free(&emu->sha);
+    mbedtls_ecp_group_free(&emu->grp);
+    free(emu);
+}
+
+void atecc_emu_iface_cfg(atecc_emu_t* emu, ATCAIfaceCfg* cfg)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->iface_type = ATCA_I2C_IFACE;
+    cfg->devtype = ATECC608;
+    ATCA_IFACECFG_VALUE(cfg, atcai2c.address) = emu->address;
+    ATCA_IFACECFG_VALUE(cfg, atcai2c.bus) = 0;
+    ATCA_IFACECFG_VALUE(cfg, atcai2c.baud) = 100000;
+    cfg->wake_delay = 1500;
+    cfg->rx_retries = 20;
+    cfg->cfg_data = emu;
+}
+
+void atecc_emu_set_address(atecc_emu_t* emu, uint8_t address)
+{
+    emu->address = address;
+    emu->config[EMU_CFG_I2C_ADDRESS] = (uint8_t)(address << 1);
+}
+
+void atecc_emu_set_exec_time(atecc_emu_t* emu, uint8_t opcode, uint32_t exec_us)
+{
+    emu->exec_us[opcode] = exec_us;
+}
+
+void atecc_emu_set_timing_scale(atecc_emu_t* emu, uint32_t percent)
+{
+    emu->timing_scale_pct = percent;
+}
+
+void atecc_emu_set_max_baud(atecc_emu_t* emu, uint32_t max_baud)
+{
+    emu->max_baud = max_baud;
+}
+
+void atecc_emu_inject_crc_errors(atecc_emu_t* emu, uint32_t count)
+{
+    emu->corrupt_responses = count;
+}
+
+void atecc_emu_get_stats(const atecc_emu_t* emu, atecc_emu_stats_t* stats)
+{
+    if (stats) {
+        *stats = emu->stats;
+    }
+}
+
+void atecc_emu_print_stats(const atecc_emu_t* emu)
+{
+    const atecc_emu_stats_t* s = &emu->stats;
+
+    printf("ATECC Emulator: %lu commands, %lu wakes, %lu NAKs, %lu watchdog expiries, %.1f ms busy\n",
+           (unsigned long)s->commands, (unsigned long)s->wakes, (unsigned long)s->naks,
+           (unsigned long)s->watchdog_expiries, (double)s->busy_us / 1000.0);
+    printf("ATECC Emulator: %lu CRC errors, %lu parse errors, %lu execution errors\n",
+           (unsigned long)s->crc_errors, (unsigned long)s->parse_errors,
+           (unsigned long)s->execution_errors);
+}
+
+// Profile loading
+
+static size_t parse_hex(const char* text, uint8_t* out, size_t max)
+{
+    size_t count = 0;
+    int high = -1;
+
+    for (; *text; text++) {
+        if (isspace((unsigned char)*text)) {
+            continue;
+        }
+        if (!isxdigit((unsigned char)*text) || count >= max) {
+            return 0;
+        }
+
+        int nibble = isdigit((unsigned char)*text) ? *text - '0' : tolower((unsigned char)*text) - 'a' + 10;
+        if (high < 0) {
+            high = nibble;
+        } else {
+            out[count++] = (uint8_t)((high << 4) | nibble);
+            high = -1;
+        }
+    }
+    return (high < 0) ? count : 0;
+}
+
+static bool emu_set_private_key(atecc_emu_t* emu, uint16_t slot, const uint8_t* scalar)
+{
+    mbedtls_mpi d;
+    mbedtls_mpi_init(&d);
+
+    bool ok = mbedtls_mpi_read_binary(&d, scalar, 32) == 0 &&
+              mbedtls_ecp_check_privkey(&emu->grp, &d) == 0;
+    if (ok) {
+        memcpy(emu->private_key[slot], scalar, 32);
+        emu->key_valid[slot] = true;
+    }
+
+    mbedtls_mpi_free(&d);
+    return ok;
+}
+
+static bool emu_generate_key(atecc_emu_t* emu, uint8_t scalar[32])
+{
+    mbedtls_mpi d;
+    mbedtls_ecp_point q;
+    mbedtls_mpi_init(&d);
+    mbedtls_ecp_point_init(&q);
+
+    bool ok = mbedtls_ecp_gen_keypair(&emu->grp, &d, &q, emu_rng, NULL) == 0 &&
+              mbedtls_mpi_write_binary(&d, scalar, 32) == 0;
+
+    mbedtls_ecp_point_free(&q);
+    mbedtls_mpi_free(&d);
+    return ok;
+}
+
+static bool profile_line(atecc_emu_t* emu, char* line)
+{
+    char* keyword = strtok(line, " \t");
+    char* rest = strtok(NULL, "");
+    uint8_t bytes[ATECC_EMU_SLOT_MAX_SIZE];
+
+    if (!keyword || !rest) {
+        return false;
+    }
+
+    if (strcmp(keyword, "address") == 0) {
+        emu->address = (uint8_t)strtoul(rest, NULL, 0);
+        emu->config[EMU_CFG_I2C_ADDRESS] = (uint8_t)(emu->address << 1);
+        return true;
+    }
+
+    if (strcmp(keyword, "serial") == 0) {
+        if (parse_hex(rest, bytes, sizeof(bytes)) != 9) {
+            return false;
+        }
+        memcpy(&emu->config[0], bytes, 4);
+        memcpy(&emu->config[8], bytes + 4, 5);
+        return true;
+    }
+
+    if (strcmp(keyword, "chipmode") == 0) {
+        emu->config[EMU_CFG_CHIP_MODE] = (uint8_t)strtoul(rest, NULL, 0);
+        return true;
+    }
+
+    if (strcmp(keyword, "max_baud") == 0) {
+        emu->max_baud = (uint32_t)strtoul(rest, NULL, 0);
+        return true;
+    }
+
+    if (strcmp(keyword, "slot") == 0) {
+        char* end;
+        unsigned long slot = strtoul(rest, &end, 0);
+        unsigned long slot_config = strtoul(end, &end, 0);
+        unsigned long key_config = strtoul(end, &end, 0);
+        if (slot >= ATECC_EMU_SLOT_COUNT) {
+            return false;
+        }
+        emu->config[EMU_CFG_SLOT_CONFIG + slot * 2] = (uint8_t)slot_config;
+        emu->config[EMU_CFG_SLOT_CONFIG + slot * 2 + 1] = (uint8_t)(slot_config >> 8);
+        emu->config[EMU_CFG_KEY_CONFIG + slot * 2] = (uint8_t)key_config;
+        emu->config[EMU_CFG_KEY_CONFIG + slot * 2 + 1] = (uint8_t)(key_config >> 8);
+        return true;
+    }
+
+    if (strcmp(keyword, "key") == 0 || strcmp(keyword, "data") == 0) {
+        char* end;
+        unsigned long slot = strtoul(rest, &end, 0);
+        if (slot >= ATECC_EMU_SLOT_COUNT) {
+            return false;
+        }
+
+        if (keyword[0] == 'k') {
+            uint8_t scalar[32];
+            if (strstr(end, "generate")) {
+                return emu_generate_key(emu, scalar) && emu_set_private_key(emu, (uint16_t)slot, scalar);
+            }
+            return parse_hex(end, scalar, sizeof(scalar)) == 32 && emu_set_private_key(emu, (uint16_t)slot, scalar);
+        }
+
+        size_t len = parse_hex(end, bytes, g_slot_size[slot]);
+        if (len == 0) {
+            return false;
+        }
+        memcpy(emu->data[slot], bytes, len);
+        return true;
+    }
+
+    if (strcmp(keyword, "otp") == 0) {
+        size_t len = parse_hex(rest, bytes, ATECC_EMU_OTP_SIZE);
+        if (len == 0) {
+            return false;
+        }
+        memcpy(emu->otp, bytes, len);
+        return true;
+    }
+
+    if (strcmp(keyword, "counter") == 0) {
+        char* end;
+        unsigned long id = strtoul(rest, &end, 0);
+        unsigned long value = strtoul(end, NULL, 0);
+        if (id > 1 || value > EMU_COUNTER_MAX) {
+            return false;
+        }
+        emu->counter[id] = (uint32_t)value;
+        return true;
+    }
+
+    if (strcmp(keyword, "lock") == 0) {
+        if (strstr(rest, "config")) {
+            emu->config[EMU_CFG_LOCK_CONFIG] = EMU_LOCKED;
+            return true;
+        }
+        if (strstr(rest, "data")) {
+            emu->config[EMU_CFG_LOCK_VALUE] = EMU_LOCKED;
+            return true;
+        }
+        return false;
+    }
+
+    if (strcmp(keyword, "timing") == 0) {
+        char* name = strtok(rest, " \t");
+        char* value = strtok(NULL, " \t");
+        if (!name || !value) {
+            return false;
+        }
+        for (size_t i = 0; i < sizeof(g_opcode_names) / sizeof(g_opcode_names[0]); i++) {
+            if (strcmp(name, g_opcode_names[i].name) == 0) {
+                emu->exec_us[g_opcode_names[i].opcode] = (uint32_t)strtoul(value, NULL, 0);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    return false;
+}
+
+bool atecc_emu_load_profile(atecc_emu_t* emu, const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        printf("ATECC Emulator: Cannot open %s\n", path);
+        return false;
+    }
+
+    char line[1024];
+    uint32_t line_no = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+
+        char* start = line;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        if (*start == '\0') {
+            continue;
+        }
+
+        if (!profile_line(emu, start)) {
+            printf("ATECC Emulator: %s:%lu: Invalid line\n", path, (unsigned long)line_no);
+            ok = false;
+        }
+    }
+
+    fclose(f);
+    return ok;
+}
+
+// HAL
+
+static atecc_emu_t* emu_from_iface(ATCAIface iface)
+{
+    return (atecc_emu_t*)atgetifacehaldat(iface);
+}
+
+static ATCA_STATUS emu_hal_init(ATCAIface iface, ATCAIfaceCfg* cfg)
+{
+    if (!iface || !cfg || !cfg->cfg_data) {
+        return ATCA_BAD_PARAM;
+    }
+
+    atecc_emu_t* emu = (atecc_emu_t*)cfg->cfg_data;
+    emu->baud = ATCA_IFACECFG_VALUE(cfg, atcai2c.baud);
+    iface->hal_data = emu;
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS emu_hal_post_init(ATCAIface iface)
+{
+    (void)iface;
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS emu_hal_send(ATCAIface iface, uint8_t word_address, uint8_t* txdata, int txlength)
+{
+    atecc_emu_t* emu = emu_from_iface(iface);
+    if (!emu || txlength < 0) {
+        return ATCA_BAD_PARAM;
+    }
+
+    uint8_t address = ATCA_IFACECFG_VALUE(iface->mIfaceCFG, atcai2c.address);
+    emu_bus_transfer(emu, (size_t)txlength + 1);
+
+    // General call: SDA is held low for the address byte, which wakes the part
+    // only if the bus is slow enough to meet tWLO. Nobody ACKs it.
+    if (address == 0) {
+        if (emu->baud != 0 && 9U * 1000000U / emu->baud >= EMU_WAKE_LOW_MIN_US) {
+            emu_wake(emu);
+        }
+        return ATCA_SUCCESS;
+    }
+
+    uint64_t now = emu_now_us();
+    emu_check_watchdog(emu, now);
+
+    if (address != emu->address || emu->power != EMU_POWER_AWAKE || now < emu->busy_until_us) {
+        emu->stats.naks++;
+        return ATCA_COMM_FAIL;
+    }
+
+    switch (word_address) {
+        case EMU_WORD_RESET:
+            emu->read_pos = 0;
+            break;
+        case EMU_WORD_SLEEP:
+            emu->power = EMU_POWER_SLEEP;
+            emu_clear_volatile(emu);
+            break;
+        case EMU_WORD_IDLE:
+            emu->power = EMU_POWER_IDLE;
+            break;
+        case EMU_WORD_COMMAND:
+            emu_execute(emu, txdata, (size_t)txlength);
+            break;
+        default:
+            emu->stats.naks++;
+            return ATCA_COMM_FAIL;
+    }
+
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS emu_hal_receive(ATCAIface iface, uint8_t word_address, uint8_t* rxdata, uint16_t* rxlength)
+{
+    atecc_emu_t* emu = emu_from_iface(iface);
+    if (!emu || !rxdata || !rxlength) {
+        return ATCA_BAD_PARAM;
+    }
+
+    emu_bus_transfer(emu, *rxlength);
+
+    uint64_t now = emu_now_us();
+    emu_check_watchdog(emu, now);
+
+    if (word_address != emu->address || emu->power != EMU_POWER_AWAKE || now < emu->busy_until_us) {
+        emu->stats.naks++;
+        return ATCA_COMM_FAIL;
+    }
+
+    // Past the end of the output buffer the part clocks out 0xFF
+    for (uint16_t i = 0; i < *rxlength; i++) {
+        rxdata[i] = (emu->read_pos < emu->response_len) ? emu->response[emu->read_pos] : 0xFF;
+        emu->read_pos++;
+    }
+
+    if (emu_bus_overspeed(emu)) {
+        rxdata[*rxlength - 1] ^= 0x01;
+    }
+
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS emu_hal_control(ATCAIface iface, uint8_t option, void* param, size_t paramlen)
+{
+    atecc_emu_t* emu = emu_from_iface(iface);
+    if (!emu) {
+        return ATCA_BAD_PARAM;
+    }
+
+    switch (option) {
+        case ATCA_HAL_CHANGE_BAUD:
+            if (!param || paramlen != sizeof(uint32_t)) {
+                return ATCA_BAD_PARAM;
+            }
+            emu->baud = *(uint32_t*)param;
+            return ATCA_SUCCESS;
+        case ATCA_HAL_CONTROL_WAKE:
+            emu_wake(emu);
+            return ATCA_SUCCESS;
+        case ATCA_HAL_CONTROL_IDLE:
+            emu->power = (emu->power == EMU_POWER_AWAKE) ? EMU_POWER_IDLE : emu->power;
+            return ATCA_SUCCESS;
+        case ATCA_HAL_CONTROL_SLEEP:
+            emu->power = EMU_POWER_SLEEP;
+            emu_clear_volatile(emu);
+            return ATCA_SUCCESS;
+        case ATCA_HAL_CONTROL_SELECT:
+        case ATCA_HAL_CONTROL_DESELECT:
+            return ATCA_SUCCESS;
+        default:
+            return ATCA_UNIMPLEMENTED;
+    }
+}
+
+static ATCA_STATUS emu_hal_release(void* hal_data)
+{
+    (void)hal_data;
+    return ATCA_SUCCESS;
+}
+
+// Command helpers
+
+// Point from a slot scalar or raw X||Y
+static bool emu_public_from_private(atecc_emu_t* emu, const uint8_t* scalar, uint8_t pub[64])
+{
+    mbedtls_mpi d;
+    mbedtls_ecp_point q;
+    mbedtls_mpi_init(&d);
+    mbedtls_ecp_point_init(&q);
+
+    bool ok = mbedtls_mpi_read_binary(&d, scalar, 32) == 0 &&
+              mbedtls_ecp_mul(&emu->grp, &q, &d, &emu->grp.G, emu_rng, NULL) == 0 &&
+              mbedtls_mpi_write_binary(&q.X, pub, 32) == 0 &&
+              mbedtls_mpi_write_binary(&q.Y, pub + 32, 32) == 0;
+
+    mbedtls_ecp_point_free(&q);
+    mbedtls_mpi_free(&d);
+    return ok;
+}
+
+static bool emu_load_point(atecc_emu_t* emu, const uint8_t pub[64], mbedtls_ecp_point* q)
+{
+    return mbedtls_mpi_read_binary(&q->X, pub, 32) == 0 &&
+           mbedtls_mpi_read_binary(&q->Y, pub + 32, 32) == 0 &&
+           mbedtls_mpi_lset(&q->Z, 1) == 0 &&
+           mbedtls_ecp_check_pubkey(&emu->grp, q) == 0;
+}
+
+// Message for Sign/Verify: TempKey or, with the 0x20 mode bit, the Message Digest Buffer
+static emu_buffer_t* emu_message_source(atecc_emu_t* emu, uint8_t mode)
+{
+    return (mode & SIGN_MODE_SOURCE_MSGDIGBUF) ? &emu->msg_digest : &emu->tempkey;
+}
+
+static void emu_random_bytes(atecc_emu_t* emu, uint8_t* out, size_t len)
+{
+    // Before the config zone is locked the RNG returns a fixed pattern
+    if (!emu_config_locked(emu)) {
+        for (size_t i = 0; i < len; i++) {
+            out[i] = (i % 4 < 2) ? 0xFF : 0x00;
+        }
+        return;
+    }
+    (void)emu_rng(NULL, out, len);
+}
+
+// Commands. Each returns a status byte; on success with *out_len > 0 the
+// response carries out[] instead of the status.
+
+static uint8_t emu_cmd_info(atecc_emu_t* emu, uint8_t mode, uint16_t param2, uint8_t* out, size_t* out_len)
+{
+    (void)param2;
+
+    if (mode != INFO_MODE_REVISION) {
+        return EMU_STATUS_PARSE;
+    }
+    memcpy(out, &emu->config[EMU_CFG_REVISION], 4);
+    *out_len = 4;
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_random(atecc_emu_t* emu, uint8_t mode, uint8_t* out, size_t* out_len)
+{
+    if (mode > RANDOM_NO_SEED_UPDATE) {
+        return EMU_STATUS_PARSE;
+    }
+    emu_random_bytes(emu, out, RANDOM_NUM_SIZE);
+    *out_len = RANDOM_NUM_SIZE;
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_nonce(atecc_emu_t* emu, uint8_t mode, const uint8_t* in, size_t in_len,
+                             uint8_t* out, size_t* out_len)
+{
+    emu_buffer_t* target;
+    switch (mode & NONCE_MODE_TARGET_MASK) {
+        case NONCE_MODE_TARGET_TEMPKEY:   target = &emu->tempkey; break;
+        case NONCE_MODE_TARGET_MSGDIGBUF: target = &emu->msg_digest; break;
+        default: return EMU_STATUS_PARSE;
+    }
+
+    uint8_t op = mode & NONCE_MODE_MASK;
+    if (op == NONCE_MODE_PASSTHROUGH) {
+        size_t expected = (mode & NONCE_MODE_INPUT_LEN_64) ? 64 : 32;
+        if (in_len != expected) {
+            return EMU_STATUS_PARSE;
+        }
+        memset(target->value, 0, sizeof(target->value));
+        memcpy(target->value, in, in_len);
+        target->valid = true;
+        return EMU_STATUS_SUCCESS;
+    }
+
+    if (op == NONCE_MODE_INVALID || in_len != NONCE_NUMIN_SIZE || target != &emu->tempkey) {
+        return EMU_STATUS_PARSE;
+    }
+
+    // TempKey = SHA-256(RandOut || NumIn || opcode || mode || 0x00)
+    uint8_t msg[32 + NONCE_NUMIN_SIZE + 3];
+    emu_random_bytes(emu, out, 32);
+    memcpy(msg, out, 32);
+    memcpy(msg + 32, in, NONCE_NUMIN_SIZE);
+    msg[32 + NONCE_NUMIN_SIZE] = ATCA_NONCE;
+    msg[33 + NONCE_NUMIN_SIZE] = mode;
+    msg[34 + NONCE_NUMIN_SIZE] = 0x00;
+
+    memset(emu->tempkey.value, 0, sizeof(emu->tempkey.value));
+    mbedtls_sha256_ret(msg, sizeof(msg), emu->tempkey.value, 0);
+    emu->tempkey.valid = true;
+    *out_len = 32;
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_sha(atecc_emu_t* emu, uint8_t mode, const uint8_t* in, size_t in_len,
+                           uint8_t* out, size_t* out_len)
+{
+    switch (mode & SHA_MODE_MASK) {
+        case SHA_MODE_SHA256_START:
+            if (in_len != 0) {
+                return EMU_STATUS_PARSE;
+            }
+            mbedtls_sha256_starts_ret(&emu->sha, 0);
+            emu->sha_started = true;
+            return EMU_STATUS_SUCCESS;
+
+        case SHA_MODE_SHA256_UPDATE:
+            if (in_len != 64) {
+                return EMU_STATUS_PARSE;
+            }
+            if (!emu->sha_started) {
+                return EMU_STATUS_EXECUTION;
+            }
+            mbedtls_sha256_update_ret(&emu->sha, in, in_len);
+            return EMU_STATUS_SUCCESS;
+
+        case SHA_MODE_SHA256_END: {
+            if (in_len > 63) {
+                return EMU_STATUS_PARSE;
+            }
+            if (!emu->sha_started) {
+                return EMU_STATUS_EXECUTION;
+            }
+
+            // Digest goes to TempKey (0x00) or the Message Digest Buffer (0x40), and out
+            emu_buffer_t* target = NULL;
+            switch (mode & SHA_MODE_TARGET_MASK) {
+                case 0x00: target = &emu->tempkey; break;
+                case 0x40: target = &emu->msg_digest; break;
+                case 0x80: break;
+                default: return EMU_STATUS_PARSE;
+            }
+
+            mbedtls_sha256_update_ret(&emu->sha, in, in_len);
+            mbedtls_sha256_finish_ret(&emu->sha, out);
+            emu->sha_started = false;
+            if (target) {
+                memset(target->value, 0, sizeof(target->value));
+                memcpy(target->value, out, 32);
+                target->valid = true;
+            }
+            *out_len = 32;
+            return EMU_STATUS_SUCCESS;
+        }
+
+        default:
+            return EMU_STATUS_PARSE;
+    }
+}
+
+static uint8_t emu_cmd_genkey(atecc_emu_t* emu, uint8_t mode, uint16_t key_id, size_t in_len,
+                              uint8_t* out, size_t* out_len)
+{
+    if (in_len != 0 || (mode != GENKEY_MODE_PRIVATE && mode != GENKEY_MODE_PUBLIC)) {
+        return EMU_STATUS_PARSE;
+    }
+
+    // Ephemeral key in TempKey for a following ECDH (608 only)
+    if (mode == GENKEY_MODE_PRIVATE && key_id == GENKEY_PRIVATE_TO_TEMPKEY) {
+        if (!emu_generate_key(emu, emu->tempkey_private) ||
+            !emu_public_from_private(emu, emu->tempkey_private, out)) {
+            return EMU_STATUS_EXECUTION;
+        }
+        emu->tempkey_private_valid = true;
+        *out_len = 64;
+        return EMU_STATUS_SUCCESS;
+    }
+
+    if (key_id >= ATECC_EMU_SLOT_COUNT) {
+        return EMU_STATUS_PARSE;
+    }
+    if (!emu_is_p256_private(emu, key_id)) {
+        return EMU_STATUS_EXECUTION;
+    }
+
+    if (mode == GENKEY_MODE_PRIVATE) {
+        if (emu_data_locked(emu) &&
+            (!(EMU_SLOT_WRITE_CONFIG(emu_slot_config(emu, key_id)) & EMU_SLOT_WRITE_GENKEY) ||
+             emu_slot_locked(emu, key_id))) {
+            return EMU_STATUS_EXECUTION;
+        }
+
+        uint8_t scalar[32];
+        if (!emu_generate_key(emu, scalar) || !emu_set_private_key(emu, key_id, scalar)) {
+            return EMU_STATUS_EXECUTION;
+        }
+    }
+
+    if (!emu->key_valid[key_id] || !emu_public_from_private(emu, emu->private_key[key_id], out)) {
+        return EMU_STATUS_EXECUTION;
+    }
+    *out_len = 64;
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_sign(atecc_emu_t* emu, uint8_t mode, uint16_t key_id, size_t in_len,
+                            uint8_t* out, size_t* out_len)
+{
+    if (in_len != 0 || (mode & ~SIGN_MODE_SOURCE_MASK) != SIGN_MODE_EXTERNAL || key_id >= ATECC_EMU_SLOT_COUNT) {
+        return EMU_STATUS_PARSE;
+    }
+
+    emu_buffer_t* message = emu_message_source(emu, mode);
+    if (!emu_config_locked(emu) || !emu_data_locked(emu) || !message->valid ||
+        !emu_is_p256_private(emu, key_id) || !emu->key_valid[key_id] ||
+        !(emu_slot_config(emu, key_id) & EMU_SLOT_READKEY_EXT_SIGN)) {
+        return EMU_STATUS_EXECUTION;
+    }
+
+    mbedtls_mpi d, r, s;
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    bool ok = mbedtls_mpi_read_binary(&d, emu->private_key[key_id], 32) == 0 &&
+              mbedtls_ecdsa_sign(&emu->grp, &r, &s, &d, message->value, 32, emu_rng, NULL) == 0 &&
+              mbedtls_mpi_write_binary(&r, out, 32) == 0 &&
+              mbedtls_mpi_write_binary(&s, out + 32, 32) == 0;
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&d);
+
+    // The signed message is consumed
+    message->valid = false;
+
+    if (!ok) {
+        return EMU_STATUS_EXECUTION;
+    }
+    *out_len = 64;
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_verify(atecc_emu_t* emu, uint8_t mode, uint16_t key_id, const uint8_t* in, size_t in_len)
+{
+    uint8_t op = mode & ~VERIFY_MODE_SOURCE_MASK;
+    uint8_t pub[64];
+    uint16_t target = ATECC_EMU_SLOT_COUNT;
+
+    if (op == VERIFY_MODE_VALIDATE || op == VERIFY_MODE_INVALIDATE) {
+        // Simplified: the signature covers TempKey as loaded, OtherData is not
+        // hashed in. The slot's ReadKey names the public key that signs it.
+        if (key_id >= ATECC_EMU_SLOT_COUNT || in_len != 64 + VERIFY_OTHER_DATA_SIZE) {
+            return EMU_STATUS_PARSE;
+        }
+        uint16_t key_config = emu_key_config(emu, key_id);
+        uint16_t parent = EMU_SLOT_READKEY(emu_slot_config(emu, key_id));
+        uint16_t parent_config = emu_key_config(emu, parent);
+        if ((key_config & EMU_KEY_PRIVATE) || !(key_config & EMU_KEY_PUBINFO) ||
+            EMU_KEY_TYPE(key_config) != EMU_KEY_TYPE_P256 ||
+            (parent_config & EMU_KEY_PRIVATE) || EMU_KEY_TYPE(parent_config) != EMU_KEY_TYPE_P256) {
+            return EMU_STATUS_EXECUTION;
+        }
+        memcpy(pub, &emu->data[parent][4], 32);
+        memcpy(pub + 32, &emu->data[parent][40], 32);
+        target = key_id;
+    } else if (op == VERIFY_MODE_EXTERNAL) {
+        if (key_id != VERIFY_KEY_P256 || in_len != 128) {
+            return EMU_STATUS_PARSE;
+        }
+        memcpy(pub, in + 64, 64);
+    } else if (op == VERIFY_MODE_STORED) {
+        if (key_id >= ATECC_EMU_SLOT_COUNT || in_len != 64) {
+            return EMU_STATUS_PARSE;
+        }
+        uint16_t key_config = emu_key_config(emu, key_id);
+        if ((key_config & EMU_KEY_PRIVATE) || EMU_KEY_TYPE(key_config) != EMU_KEY_TYPE_P256) {
+            return EMU_STATUS_EXECUTION;
+        }
+        // Stored public keys are padded to 36-byte halves: 4 zero bytes before X and Y
+        memcpy(pub, &emu->data[key_id][4], 32);
+        memcpy(pub + 32, &emu->data[key_id][40], 32);
+    } else {
+        return EMU_STATUS_PARSE;
+    }
+
+    emu_buffer_t* message = emu_message_source(emu, mode);
+    if (!message->valid) {
+        return EMU_STATUS_EXECUTION;
+    }
+
+    mbedtls_ecp_point q;
+    mbedtls_mpi r, s;
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    uint8_t status;
+    if (!emu_load_point(emu, pub, &q)) {
+        status = EMU_STATUS_EXECUTION;
+    } else if (mbedtls_mpi_read_binary(&r, in, 32) != 0 || mbedtls_mpi_read_binary(&s, in + 32, 32) != 0 ||
+               mbedtls_ecdsa_verify(&emu->grp, message->value, 32, &q, &r, &s) != 0) {
+        status = EMU_STATUS_MISCOMPARE;
+    } else {
+        status = EMU_STATUS_SUCCESS;
+        // Validity bits are the first four bits of the slot: 0x5 valid, 0xA invalid
+        if (target < ATECC_EMU_SLOT_COUNT) {
+            emu->data[target][0] = (uint8_t)((emu->data[target][0] & 0xF0U) |
+                                             (op == VERIFY_MODE_VALIDATE ? 0x05U : 0x0AU));
+        }
+    }
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_point_free(&q);
+    return status;
+}
+
+static uint8_t emu_cmd_ecdh(atecc_emu_t* emu, uint8_t mode, uint16_t key_id, const uint8_t* in, size_t in_len,
+                            uint8_t* out, size_t* out_len)
+{
+    if (in_len != 64 || (mode & ECDH_MODE_OUTPUT_MASK) == ECDH_MODE_OUTPUT_ENC ||
+        (mode & ECDH_MODE_COPY_MASK) == ECDH_MODE_COPY_EEPROM_SLOT) {
+        return EMU_STATUS_PARSE;
+    }
+
+    const uint8_t* scalar;
+    bool write_slot = false;
+    if ((mode & ECDH_MODE_SOURCE_MASK) == ECDH_MODE_SOURCE_TEMPKEY) {
+        if (!emu->tempkey_private_valid) {
+            return EMU_STATUS_EXECUTION;
+        }
+        scalar = emu->tempkey_private;
+    } else {
+        if (key_id >= ATECC_EMU_SLOT_COUNT) {
+            return EMU_STATUS_PARSE;
+        }
+        uint16_t slot_config = emu_slot_config(emu, key_id);
+        if (!emu_config_locked(emu) || !emu_data_locked(emu) || !emu_is_p256_private(emu, key_id) ||
+            !emu->key_valid[key_id] || !(slot_config & EMU_SLOT_READKEY_ECDH)) {
+            return EMU_STATUS_EXECUTION;
+        }
+        scalar = emu->private_key[key_id];
+        write_slot = (mode & ECDH_MODE_COPY_MASK) == ECDH_MODE_COPY_COMPATIBLE &&
+                     (slot_config & EMU_SLOT_READKEY_ECDH_SLOT);
+    }
+
+    mbedtls_ecp_point q;
+    mbedtls_mpi d, z;
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&z);
+
+    uint8_t secret[32];
+    bool ok = emu_load_point(emu, in, &q) &&
+              mbedtls_mpi_read_binary(&d, scalar, 32) == 0 &&
+              mbedtls_ecdh_compute_shared(&emu->grp, &z, &q, &d, emu_rng, NULL) == 0 &&
+              mbedtls_mpi_write_binary(&z, secret, 32) == 0;
+
+    mbedtls_mpi_free(&z);
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&q);
+
+    if (!ok) {
+        return EMU_STATUS_EXECUTION;
+    }
+
+    if (write_slot) {
+        memcpy(emu->data[key_id | 1], secret, 32);
+    } else if ((mode & ECDH_MODE_COPY_MASK) == ECDH_MODE_COPY_TEMP_KEY) {
+        memset(emu->tempkey.value, 0, sizeof(emu->tempkey.value));
+        memcpy(emu->tempkey.value, secret, 32);
+        emu->tempkey.valid = true;
+    } else {
+        memcpy(out, secret, 32);
+        *out_len = 32;
+    }
+    return EMU_STATUS_SUCCESS;
+}
+
+// Resolves a Read/Write address to zone memory; returns a status byte
+static uint8_t emu_zone_address(atecc_emu_t* emu, uint8_t zone, uint16_t address, size_t len, uint8_t** mem, uint16_t* slot)
+{
+    size_t offset, size;
+
+    *slot = 0;
+    switch (zone & ATCA_ZONE_MASK) {
+        case ATCA_ZONE_CONFIG:
+            offset = (len == 32) ? (size_t)((address >> 3) & 0x1F) * 32 : (size_t)(address & 0xFF) * 4;
+            size = ATECC_EMU_CONFIG_SIZE;
+            *mem = emu->config;
+            break;
+        case ATCA_ZONE_OTP:
+            offset = (len == 32) ? (size_t)((address >> 3) & 0x1F) * 32 : (size_t)(address & 0xFF) * 4;
+            size = ATECC_EMU_OTP_SIZE;
+            *mem = emu->otp;
+            break;
+        case ATCA_ZONE_DATA:
+            *slot = (address >> 3) & 0x0F;
+            offset = (size_t)(address >> 8) * 32 + ((len == 32) ? 0 : (size_t)(address & 0x07) * 4);
+            size = g_slot_size[*slot];
+            *mem = emu->data[*slot];
+            break;
+        default:
+            return EMU_STATUS_PARSE;
+    }
+
+    // A 32-byte access may run past the end of a 72-byte slot's last block;
+    // Write keeps only the bytes inside the slot
+    if (offset >= size || (offset + len > size && (len != 32 || (zone & ATCA_ZONE_MASK) != ATCA_ZONE_DATA))) {
+        return EMU_STATUS_PARSE;
+    }
+    *mem += offset;
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_read(atecc_emu_t* emu, uint8_t zone, uint16_t address, size_t in_len,
+                            uint8_t* out, size_t* out_len)
+{
+    size_t len = (zone & ATCA_ZONE_READWRITE_32) ? 32 : 4;
+    uint8_t* mem;
+    uint16_t slot;
+
+    if (in_len != 0 || (zone & ~READ_ZONE_MASK)) {
+        return EMU_STATUS_PARSE;
+    }
+
+    uint8_t status = emu_zone_address(emu, zone, address, len, &mem, &slot);
+    if (status != EMU_STATUS_SUCCESS) {
+        return status;
+    }
+
+    // Data and OTP are readable only once locked, and never for secrets or private keys
+    uint8_t zone_id = zone & ATCA_ZONE_MASK;
+    if (zone_id != ATCA_ZONE_CONFIG && !emu_data_locked(emu)) {
+        return EMU_STATUS_EXECUTION;
+    }
+    if (zone_id == ATCA_ZONE_DATA &&
+        ((emu_slot_config(emu, slot) & EMU_SLOT_IS_SECRET) || (emu_key_config(emu, slot) & EMU_KEY_PRIVATE))) {
+        return EMU_STATUS_EXECUTION;
+    }
+
+    memcpy(out, mem, len);
+    *out_len = len;
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_write(atecc_emu_t* emu, uint8_t zone, uint16_t address, const uint8_t* in, size_t in_len)
+{
+    size_t len = (zone & ATCA_ZONE_READWRITE_32) ? 32 : 4;
+    uint8_t* mem;
+    uint16_t slot;
+
+    // Encrypted and MAC-authenticated writes are not modelled
+    if ((zone & ATCA_ZONE_ENCRYPTED) || in_len != len) {
+        return EMU_STATUS_PARSE;
+    }
+
+    uint8_t status = emu_zone_address(emu, zone, address, len, &mem, &slot);
+    if (status != EMU_STATUS_SUCCESS) {
+        return status;
+    }
+
+    switch (zone & ATCA_ZONE_MASK) {
+        case ATCA_ZONE_CONFIG: {
+            size_t offset = (size_t)(mem - emu->config);
+            if (emu_config_locked(emu) || offset < 16) {
+                return EMU_STATUS_EXECUTION;
+            }
+            // UserExtra, UserExtraAdd and the lock bytes only change through UpdateExtra/Lock
+            for (size_t i = 0; i < len; i++) {
+                if (offset + i < EMU_CFG_USER_EXTRA || offset + i > EMU_CFG_LOCK_CONFIG) {
+                    mem[i] = in[i];
+                }
+            }
+            return EMU_STATUS_SUCCESS;
+        }
+
+        case ATCA_ZONE_OTP:
+            if (!emu_config_locked(emu) || emu_data_locked(emu) || len != 32) {
+                return EMU_STATUS_EXECUTION;
+            }
+            break;
+
+        default:
+            if (!emu_config_locked(emu) || (!emu_data_locked(emu) && len != 32)) {
+                return EMU_STATUS_EXECUTION;
+            }
+            // After the data lock only WriteConfig Always slots take clear-text writes
+            if (emu_data_locked(emu) &&
+                (EMU_SLOT_WRITE_CONFIG(emu_slot_config(emu, slot)) != 0 ||
+                 (emu_key_config(emu, slot) & EMU_KEY_PRIVATE) || emu_slot_locked(emu, slot))) {
+                return EMU_STATUS_EXECUTION;
+            }
+            if ((size_t)(mem - emu->data[slot]) + len > g_slot_size[slot]) {
+                len = g_slot_size[slot] - (size_t)(mem - emu->data[slot]);
+            }
+            break;
+    }
+
+    memcpy(mem, in, len);
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_counter(atecc_emu_t* emu, uint8_t mode, uint16_t counter_id, size_t in_len,
+                               uint8_t* out, size_t* out_len)
+{
+    if (in_len != 0 || mode > COUNTER_MODE_INCREMENT || counter_id > 1) {
+        return EMU_STATUS_PARSE;
+    }
+
+    if (mode == COUNTER_MODE_INCREMENT) {
+        if (emu->counter[counter_id] >= EMU_COUNTER_MAX) {
+            return EMU_STATUS_EXECUTION;
+        }
+        emu->counter[counter_id]++;
+    }
+
+    uint32_t value = emu->counter[counter_id];
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    *out_len = 4;
+    return EMU_STATUS_SUCCESS;
+}
+
+static uint8_t emu_cmd_lock(atecc_emu_t* emu, uint8_t mode, uint16_t summary, size_t in_len)
+{
+    bool check_summary = !(mode & LOCK_ZONE_NO_CRC);
+
+    if (in_len != 0) {
+        return EMU_STATUS_PARSE;
+    }
+
+    switch (mode & 0x03) {
+        case LOCK_ZONE_CONFIG:
+            if (emu_config_locked(emu)) {
+                return EMU_STATUS_EXECUTION;
+            }
+            if (check_summary && atecc_emu_crc16(emu->config, ATECC_EMU_CONFIG_SIZE) != summary) {
+                return EMU_STATUS_EXECUTION;
+            }
+            emu->config[EMU_CFG_LOCK_CONFIG] = EMU_LOCKED;
+            return EMU_STATUS_SUCCESS;
+
+        case LOCK_ZONE_DATA:
+            if (!emu_config_locked(emu) || emu_data_locked(emu)) {
+                return EMU_STATUS_EXECUTION;
+            }
+            if (check_summary) {
+                // Summary covers the slots in order, then OTP
+                uint8_t image[ATECC_EMU_SLOT_COUNT * ATECC_EMU_SLOT_MAX_SIZE + ATECC_EMU_OTP_SIZE];
+                size_t len = 0;
+                for (uint16_t i = 0; i < ATECC_EMU_SLOT_COUNT; i++) {
+                    memcpy(image + len, emu->data[i], g_slot_size[i]);
+                    len += g_slot_size[i];
+                }
+                memcpy(image + len, emu->otp, ATECC_EMU_OTP_SIZE);
+                len += ATECC_EMU_OTP_SIZE;
+                if (atecc_emu_crc16(image, len) != summary) {
+                    return EMU_STATUS_EXECUTION;
+                }
+            }
+            emu->config[EMU_CFG_LOCK_VALUE] = EMU_LOCKED;
+            return EMU_STATUS_SUCCESS;
+
+        case LOCK_ZONE_DATA_SLOT: {
+            uint16_t slot = (mode >> 2) & 0x0F;
+            if (!emu_data_locked(emu) || !(emu_key_config(emu, slot) & EMU_KEY_LOCKABLE) ||
+                emu_slot_locked(emu, slot)) {
+                return EMU_STATUS_EXECUTION;
+            }
+            emu->config[EMU_CFG_SLOT_LOCKED + slot / 8] &= (uint8_t)~(1U << (slot % 8));
+            return EMU_STATUS_SUCCESS;
+        }
+
+        default:
+            return EMU_STATUS_PARSE;
+    }
+}
+
+// Packet execution
+
+static void emu_respond(atecc_emu_t* emu, uint8_t status, const uint8_t* out, size_t out_len)
+{
+    if (status == EMU_STATUS_SUCCESS && out_len > 0) {
+        memcpy(&emu->response[1], out, out_len);
+    } else {
+        emu->response[1] = status;
+        out_len = 1;
+    }
+
+    emu->response[0] = (uint8_t)(out_len + 3);
+    uint16_t crc = atecc_emu_crc16(emu->response, out_len + 1);
+    emu->response[out_len + 1] = (uint8_t)crc;
+    emu->response[out_len + 2] = (uint8_t)(crc >> 8);
+
+    if (emu->corrupt_responses > 0) {
+        emu->corrupt_responses--;
+        emu->response[out_len + 2] ^= 0xA5;
+    }
+
+    emu->response_len = out_len + 3;
+    emu->read_pos = 0;
+}
+
+static void emu_execute(atecc_emu_t* emu, const uint8_t* packet, size_t length)
+{
+    emu->stats.commands++;
+
+    // count, opcode, param1, param2 (LE), data, CRC (LE)
+    if (!packet || length < ATCA_CMD_SIZE_MIN || length > EMU_MAX_PACKET || packet[0] != length ||
+        emu_bus_overspeed(emu) ||
+        atecc_emu_crc16(packet, length - 2) != (uint16_t)(packet[length - 2] | (packet[length - 1] << 8))) {
+        emu->stats.crc_errors++;
+        emu_respond(emu, EMU_STATUS_COMM, NULL, 0);
+        return;
+    }
+
+    uint8_t opcode = packet[1];
+    uint8_t param1 = packet[2];
+    uint16_t param2 = (uint16_t)(packet[3] | (packet[4] << 8));
+    const uint8_t* in = &packet[5];
+    size_t in_len = length - ATCA_CMD_SIZE_MIN;
+
+    // The part refuses a command that could not finish before the watchdog fires
+    uint64_t now = emu_now_us();
+    uint64_t exec_us = (uint64_t)emu->exec_us[opcode] * emu->timing_scale_pct / 100U;
+    if (now + (uint64_t)emu->exec_us[opcode] > emu->watchdog_at_us) {
+        emu_respond(emu, EMU_STATUS_WATCHDOG, NULL, 0);
+        return;
+    }
+
+    uint8_t out[EMU_MAX_RESPONSE];
+    size_t out_len = 0;
+    uint8_t status;
+
+    switch (opcode) {
+        case ATCA_INFO:    status = emu_cmd_info(emu, param1, param2, out, &out_len); break;
+        case ATCA_RANDOM:  status = emu_cmd_random(emu, param1, out, &out_len); break;
+        case ATCA_NONCE:   status = emu_cmd_nonce(emu, param1, in, in_len, out, &out_len); break;
+        case ATCA_SHA:     status = emu_cmd_sha(emu, param1, in, in_len, out, &out_len); break;
+        case ATCA_GENKEY:  status = emu_cmd_genkey(emu, param1, param2, in_len, out, &out_len); break;
+        case ATCA_SIGN:    status = emu_cmd_sign(emu, param1, param2, in_len, out, &out_len); break;
+        case ATCA_VERIFY:  status = emu_cmd_verify(emu, param1, param2, in, in_len); break;
+        case ATCA_ECDH:    status = emu_cmd_ecdh(emu, param1, param2, in, in_len, out, &out_len); break;
+        case ATCA_READ:    status = emu_cmd_read(emu, param1, param2, in_len, out, &out_len); break;
+        case ATCA_WRITE:   status = emu_cmd_write(emu, param1, param2, in, in_len); break;
+        case ATCA_COUNTER: status = emu_cmd_counter(emu, param1, param2, in_len, out, &out_len); break;
+        case ATCA_LOCK:    status = emu_cmd_lock(emu, param1, param2, in_len); break;
+        default:           status = EMU_STATUS_PARSE; break;
+    }
+
+    if (status == EMU_STATUS_PARSE) {
+        emu->stats.parse_errors++;
+    } else {
+        if (status == EMU_STATUS_EXECUTION) {
+            emu->stats.execution_errors++;
+        }
+        // Parse errors come back at once; everything else runs for the opcode's time
+        emu->busy_until_us = now + exec_us;
+        emu->stats.busy_us += exec_us;
+    }
+
+    emu_respond(emu, status, out, out_len);
+}
@@ -0,0 +1,270 @@
+// Host stress test for src/core_channel.c
+//
+// Runs core_channel_t and core_byte_ring_t between two pthreads, one
+// producer and one consumer, the way core 0 and core 1 share them on
+// target. Every message must arrive once, in order, with its sequence
+// number; every byte of the stream must arrive intact. Odd write and read
+// sizes keep the byte ring's wrap-around copies busy. There is no SIO
+// FIFO on the host, so the channels are built without the doorbell and
+// the consumer waits by polling.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "pico/stdlib.h"
+#include "core_channel.h"
+
+#define STRESS_DEFAULT_MESSAGES     200000U
+#define STRESS_DEFAULT_BYTES        (16U * 1024U * 1024U)
+#define STRESS_WAIT_US              100U
+
+// Sizes that do not divide CORE_BYTE_RING_SIZE, so copies split at the end
+#define STRESS_WRITE_CHUNK          77U
+#define STRESS_READ_CHUNK           53U
+
+typedef struct {
+    uint32_t messages;
+    uint32_t bytes;
+    bool pin;
+} stress_config_t;
+
+static stress_config_t g_config = {
+    .messages = STRESS_DEFAULT_MESSAGES,
+    .bytes = STRESS_DEFAULT_BYTES,
+    .pin = true
+};
+
+static core_channel_t g_channel;
+static core_byte_ring_t g_ring;
+
+// Byte n of the stream; not periodic in the ring size
+static inline uint8_t stream_byte(uint32_t n)
+{
+    return (uint8_t)((n * 7U) ^ (n >> 11));
+}
+
+static void pin_to_cpu(int cpu)
+{
+    if (!g_config.pin) {
+        return;
+    }
+
+    // Producer and consumer on different CPUs, as on the two cores
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 2) {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void* channel_producer(void* arg)
+{
+    (void)arg;
+    pin_to_cpu(0);
+
+    core_msg_t msg = {
+        .type = CORE_MSG_STATUS,
+        .status = { .status = CORE_STATUS_UPLOAD_DONE, .value = 1 }
+    };
+
+    for (uint32_t i = 0; i < g_config.messages;) {
+        msg.status.arg = i;
+        msg.status.value = (int32_t)~i;
+        if (core_channel_push(&g_channel, &msg)) {
+            i++;
+        } else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static bool run_channel(void)
+{
+    core_channel_init(&g_channel, false);
+
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, channel_producer, NULL) != 0) {
+        printf("Channel Stress: Cannot start producer\n");
+        return false;
+    }
+    pin_to_cpu(1);
+
+    uint64_t start = time_us_64();
+    uint32_t expected = 0;
+    uint32_t peeks = 0;
+    bool ok = true;
+    core_msg_t msg, peeked;
+
+    while (ok && expected < g_config.messages) {
+        if (!core_channel_wait(&g_channel, STRESS_WAIT_US)) {
+            continue;
+        }
+
+        // Every so often peek first: it must return what pop then takes
+        bool peek = (expected % 16U) == 0;
+        if (peek && !core_channel_peek(&g_channel, &peeked)) {
+            printf("Channel Stress: peek empty after wait at %lu\n", (unsigned long)expected);
+            ok = false;
+            break;
+        }
+        if (!core_channel_pop(&g_channel, &msg)) {
+            printf("Channel Stress: pop empty after wait at %lu\n", (unsigned long)expected);
+            ok = false;
+            break;
+        }
+        if (peek) {
+            peeks++;
+            if (peeked.seq != msg.seq || peeked.status.arg != msg.status.arg) {
+                printf("Channel Stress: peek %lu != pop %lu\n",
+                       (unsigned long)peeked.seq, (unsigned long)msg.seq);
+                ok = false;
+            }
+        }
+
+        if (msg.type != CORE_MSG_STATUS || msg.seq != expected || msg.status.arg != expected ||
+            msg.status.value != (int32_t)~expected) {
+            printf("Channel Stress: message %lu arrived as seq %lu arg %lu\n",
+                   (unsigned long)expected, (unsigned long)msg.seq, (unsigned long)msg.status.arg);
+            ok = false;
+        }
+        expected++;
+    }
+
+    pthread_join(producer, NULL);
+    double elapsed_s = (double)(time_us_64() - start) / 1e6;
+
+    if (ok && core_channel_count(&g_channel) != 0) {
+        printf("Channel Stress: %lu messages left over\n",
+               (unsigned long)core_channel_count(&g_channel));
+        ok = false;
+    }
+
+    // dropped counts pushes refused on a full ring; the producer retried them
+    printf("Channel Stress: %lu messages in %.3f s (%.2f M/s), %lu full-ring retries, %lu peeks: %s\n",
+           (unsigned long)expected, elapsed_s, elapsed_s > 0.0 ? expected / elapsed_s / 1e6 : 0.0,
+           (unsigned long)core_channel_get_dropped(&g_channel), (unsigned long)peeks,
+           ok ? "OK" : "FAILED");
+
+    return ok;
+}
+
+static void* ring_producer(void* arg)
+{
+    (void)arg;
+    pin_to_cpu(0);
+
+    uint8_t chunk[STRESS_WRITE_CHUNK];
+    uint32_t written = 0;
+
+    while (written < g_config.bytes) {
+        size_t len = 0;
+        for (; len < sizeof(chunk) && written + len < g_config.bytes; len++) {
+            chunk[len] = stream_byte(written + (uint32_t)len);
+        }
+
+        size_t done = core_byte_ring_write(&g_ring, chunk, len);
+        written += (uint32_t)done;
+        if (done == 0) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static bool run_byte_ring(void)
+{
+    core_byte_ring_init(&g_ring, false);
+
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, ring_producer, NULL) != 0) {
+        printf("Ring Stress: Cannot start producer\n");
+        return false;
+    }
+    pin_to_cpu(1);
+
+    uint64_t start = time_us_64();
+    uint8_t chunk[STRESS_READ_CHUNK];
+    uint32_t received = 0;
+    bool ok = true;
+
+    while (ok && received < g_config.bytes) {
+        if (!core_byte_ring_wait(&g_ring, STRESS_WAIT_US)) {
+            continue;
+        }
+
+        size_t len = core_byte_ring_read(&g_ring, chunk, sizeof(chunk));
+        for (size_t i = 0; i < len; i++, received++) {
+            if (chunk[i] != stream_byte(received)) {
+                printf("Ring Stress: byte %lu is 0x%02x, expected 0x%02x\n",
+                       (unsigned long)received, chunk[i], stream_byte(received));
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    pthread_join(producer, NULL);
+    double elapsed_s = (double)(time_us_64() - start) / 1e6;
+
+    if (ok && core_byte_ring_count(&g_ring) != 0) {
+        printf("Ring Stress: %lu bytes left over\n", (unsigned long)core_byte_ring_count(&g_ring));
+        ok = false;
+    }
+    if (ok && core_byte_ring_free(&g_ring) != CORE_BYTE_RING_SIZE) {
+        printf("Ring Stress: empty ring reports %lu bytes free\n",
+               (unsigned long)core_byte_ring_free(&g_ring));
+        ok = false;
+    }
+
+    printf("Ring Stress: %lu bytes in %.3f s (%.1f MB/s): %s\n",
+           (unsigned long)received, elapsed_s,
+           elapsed_s > 0.0 ? received / elapsed_s / 1e6 : 0.0, ok ? "OK" : "FAILED");
+
+    return ok;
+}
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <count>     messages through core_channel (default %u, 0 = skip)\n"
+           "  -b <bytes>     bytes through core_byte_ring (default %u, 0 = skip)\n"
+           "  -u             do not pin producer and consumer to different CPUs\n",
+           prog, STRESS_DEFAULT_MESSAGES, STRESS_DEFAULT_BYTES);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "n:b:uh")) != -1) {
+        switch (opt) {
+            case 'n': g_config.messages = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'b': g_config.bytes = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'u': g_config.pin = false; break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    bool ok = true;
+    if (g_config.messages > 0) {
+        ok = run_channel() && ok;
+    }
+    if (g_config.bytes > 0) {
+        ok = run_byte_ring() && ok;
+    }
+
+    return ok ? 0 : 1;
+}
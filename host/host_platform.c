@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "pico/async_context.h"
+#include "host_platform.h"
+#include "wifi_manager.h"
+
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+#include "lwip/dns.h"
+#include "netif/ethernet.h"
+#include "netif/tapif.h"
+
+// Internal state structure
+typedef struct {
+    bool initialized;
+    struct netif netif;
+    FILE* urandom;
+    async_at_time_worker_t* workers;
+} host_platform_state_t;
+
+static host_platform_state_t g_host_state = {
+    .initialized = false,
+    .urandom = NULL,
+    .workers = NULL
+};
+
+// Opaque on the host; there is a single context
+static async_context_t* const g_host_context = (async_context_t*)&g_host_state;
+
+// Network
+
+bool host_platform_init(const char* ip, const char* netmask, const char* gateway, const char* dns)
+{
+    if (g_host_state.initialized) {
+        return true;
+    }
+
+    ip4_addr_t addr, mask, gw, dns_addr;
+    if (!ip4addr_aton(ip, &addr) || !ip4addr_aton(netmask, &mask) ||
+        !ip4addr_aton(gateway, &gw)) {
+        printf("Host Platform: Invalid address configuration\n");
+        return false;
+    }
+
+    g_host_state.urandom = fopen("/dev/urandom", "rb");
+    if (!g_host_state.urandom) {
+        printf("Host Platform: Cannot open /dev/urandom\n");
+        return false;
+    }
+
+    get_absolute_time();
+    lwip_init();
+
+    // tapif picks up PRECONFIGURED_TAPIF from the environment
+    if (!netif_add(&g_host_state.netif, &addr, &mask, &gw, NULL, tapif_init, ethernet_input)) {
+        printf("Host Platform: tap interface setup failed\n");
+        return false;
+    }
+    netif_set_default(&g_host_state.netif);
+    netif_set_up(&g_host_state.netif);
+    netif_set_link_up(&g_host_state.netif);
+
+    if (dns && ip4addr_aton(dns, &dns_addr)) {
+        ip_addr_t server;
+        ip_addr_copy_from_ip4(server, dns_addr);
+        dns_setserver(0, &server);
+    }
+
+    g_host_state.initialized = true;
+
+    printf("Host Platform: lwIP up on %s\n", ip4addr_ntoa(&addr));
+
+    return true;
+}
+
+void cyw43_arch_poll(void)
+{
+    if (!g_host_state.initialized) {
+        return;
+    }
+
+    tapif_poll(&g_host_state.netif);
+    sys_check_timeouts();
+
+    // Run every worker whose deadline has passed; each is unlinked before it runs
+    uint64_t now = time_us_64();
+    async_at_time_worker_t** link = &g_host_state.workers;
+    while (*link != NULL) {
+        async_at_time_worker_t* worker = *link;
+        if (worker->next_time > now) {
+            link = &worker->next;
+            continue;
+        }
+        *link = worker->next;
+        worker->next = NULL;
+        worker->do_work(g_host_context, worker);
+        link = &g_host_state.workers;
+    }
+}
+
+// Blocking waits (mqtt_manager's wait_for) sleep on WFE on target while the
+// background IRQ delivers callbacks; here the wait itself has to poll
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp)
+{
+    cyw43_arch_poll();
+    if (get_absolute_time() >= timeout_timestamp) {
+        return true;
+    }
+    sleep_us(100);
+    return get_absolute_time() >= timeout_timestamp;
+}
+
+async_context_t* cyw43_arch_async_context(void)
+{
+    return g_host_context;
+}
+
+bool async_context_add_at_time_worker_in_ms(async_context_t* context, async_at_time_worker_t* worker, uint32_t ms)
+{
+    (void)context;
+
+    async_context_remove_at_time_worker(context, worker);
+    worker->next_time = time_us_64() + (uint64_t)ms * 1000;
+    worker->next = g_host_state.workers;
+    g_host_state.workers = worker;
+    return true;
+}
+
+bool async_context_remove_at_time_worker(async_context_t* context, async_at_time_worker_t* worker)
+{
+    (void)context;
+
+    for (async_at_time_worker_t** link = &g_host_state.workers; *link != NULL; link = &(*link)->next) {
+        if (*link == worker) {
+            *link = worker->next;
+            worker->next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+// No radio on the host; upload bursts have no power mode to switch
+void wifi_manager_power_request(void)
+{
+}
+
+void wifi_manager_power_release(void)
+{
+}
+
+// The bench link is a tap device: always good, every record is sent at once
+uint8_t wifi_manager_get_link_score(void)
+{
+    return 100;
+}
+
+wifi_link_class_t wifi_manager_get_link_class(void)
+{
+    return WIFI_LINK_GOOD;
+}
+
+// Entropy source for MBEDTLS_ENTROPY_HARDWARE_ALT (the RP2040 ROSC on target)
+int mbedtls_hardware_poll(void* data, unsigned char* output, size_t len, size_t* olen)
+{
+    (void)data;
+
+    if (!g_host_state.urandom) {
+        *olen = 0;
+        return -1;
+    }
+
+    *olen = fread(output, 1, len, g_host_state.urandom);
+    return (*olen == len) ? 0 : -1;
+}
@@ -0,0 +1,337 @@
+// Host benchmark driver for https_manager
+//
+// Runs the firmware upload path unchanged against lwIP's unix port (tap
+// netif) and a loopback mTLS server, so handshake, memory and latency
+// changes can be measured without flashing a board. The ATECC608B is
+// replaced by a software P-256 key loaded from a file.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "host_platform.h"
+#include "https_manager.h"
+#include "mem_manager.h"
+#include "latency_stats.h"
+
+#include "mbedtls/pk.h"
+#include "mbedtls/ssl.h"
+
+#define BENCH_DEFAULT_COUNT     20
+#define BENCH_DEFAULT_PORT      8443
+#define BENCH_DEFAULT_WARMUP    10
+#define BENCH_MAX_POOLS         16
+
+// Benchmark configuration
+typedef struct {
+    const char* hostname;
+    uint16_t port;
+    uint32_t count;
+    const char* ca_path;
+    const char* cert_path;
+    const char* key_path;
+    const char* ip;
+    const char* netmask;
+    const char* gateway;
+    const char* dns;
+    uint8_t max_fragment_len;
+    bool soak;
+    uint32_t warmup;
+} bench_config_t;
+
+// Arena and lwIP heap high-water marks, taken after the warm-up POSTs
+typedef struct {
+    int pool_count;
+    uint16_t pool_peak[BENCH_MAX_POOLS];
+    uint32_t pool_spills[BENCH_MAX_POOLS];
+    size_t tls_bytes_used;
+    uint32_t lwip_heap_peak;
+} mem_snapshot_t;
+
+static uint8_t* load_file(const char* path, size_t* len)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("HTTPS Bench: Cannot open %s\n", path);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    // mbedTLS PEM parsing wants the terminating NUL counted in the length
+    uint8_t* buf = (uint8_t*)malloc((size_t)size + 1);
+    if (buf && fread(buf, 1, (size_t)size, f) == (size_t)size) {
+        buf[size] = '\0';
+        *len = (size_t)size + 1;
+    } else {
+        free(buf);
+        buf = NULL;
+    }
+
+    fclose(f);
+    return buf;
+}
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options] <server-host>\n"
+           "  -p <port>      server port (default %d)\n"
+           "  -n <count>     number of POSTs (default %d)\n"
+           "  -a <file>      CA certificate (PEM)\n"
+           "  -c <file>      client certificate (PEM)\n"
+           "  -k <file>      client P-256 private key (PEM), stands in for the ATECC\n"
+           "  -i <ip>        lwIP address (default 192.168.7.2)\n"
+           "  -g <ip>        gateway / tap host address (default 192.168.7.1)\n"
+           "  -d <ip>        DNS server (default: gateway)\n"
+           "  -m <code>      max_fragment_length code 0-4 (default 3 = 2048)\n"
+           "  -s             soak: fail if any memory high-water mark moves after the warm-up\n"
+           "  -w <count>     warm-up POSTs before the soak snapshot (default %d)\n",
+           prog, BENCH_DEFAULT_PORT, BENCH_DEFAULT_COUNT, BENCH_DEFAULT_WARMUP);
+}
+
+static void take_snapshot(mem_snapshot_t* snap)
+{
+    mem_stats_t stats;
+    mem_manager_get_stats(&stats);
+
+    snap->pool_count = mem_manager_get_pool_count();
+    if (snap->pool_count > BENCH_MAX_POOLS) {
+        snap->pool_count = BENCH_MAX_POOLS;
+    }
+    for (int i = 0; i < snap->pool_count; i++) {
+        mem_pool_stats_t pool;
+        mem_manager_get_pool_stats(i, &pool);
+        snap->pool_peak[i] = pool.peak;
+        snap->pool_spills[i] = pool.spills;
+    }
+    snap->tls_bytes_used = stats.tls_bytes_used;
+    snap->lwip_heap_peak = stats.lwip_heap_peak;
+}
+
+// Once every connection path has run, nothing should climb: a moving peak
+// or idle usage is a leak or fragmentation that would exhaust the device
+static bool check_soak(const mem_snapshot_t* base, uint32_t posts)
+{
+    mem_snapshot_t now;
+    take_snapshot(&now);
+
+    mem_stats_t stats;
+    mem_manager_get_stats(&stats);
+
+    bool flat = true;
+    for (int i = 0; i < now.pool_count; i++) {
+        mem_pool_stats_t pool;
+        mem_manager_get_pool_stats(i, &pool);
+        bool moved = now.pool_peak[i] != base->pool_peak[i] || now.pool_spills[i] != base->pool_spills[i];
+        printf("HTTPS Bench: [%5u] peak %3u -> %3u of %3u, spills %lu -> %lu%s\n",
+               pool.block_size, base->pool_peak[i], now.pool_peak[i], pool.block_count,
+               (unsigned long)base->pool_spills[i], (unsigned long)now.pool_spills[i],
+               moved ? "  MOVED" : "");
+        flat = flat && !moved;
+    }
+
+    if (now.tls_bytes_used != base->tls_bytes_used) {
+        printf("HTTPS Bench: TLS arena idle usage %u -> %u bytes\n",
+               (unsigned)base->tls_bytes_used, (unsigned)now.tls_bytes_used);
+        flat = false;
+    }
+    if (now.lwip_heap_peak != base->lwip_heap_peak) {
+        printf("HTTPS Bench: lwIP heap peak %lu -> %lu\n",
+               (unsigned long)base->lwip_heap_peak, (unsigned long)now.lwip_heap_peak);
+        flat = false;
+    }
+    if (stats.tls_alloc_failures != 0) {
+        printf("HTTPS Bench: %lu TLS allocations failed\n", (unsigned long)stats.tls_alloc_failures);
+        flat = false;
+    }
+
+    printf("HTTPS Bench: Soak over %lu POSTs after warm-up: %s\n",
+           (unsigned long)posts, flat ? "high-water marks flat" : "FAILED");
+
+    return flat;
+}
+
+// Drives the upload the way the cyw43 background IRQ does on target
+static void wait_done(void)
+{
+    while (https_manager_is_busy()) {
+        cyw43_arch_poll();
+        sleep_us(100);
+    }
+}
+
+static bool wait_idle(uint32_t timeout_ms)
+{
+    uint32_t start = to_ms_since_boot(get_absolute_time());
+
+    while (https_manager_get_state() != HTTPS_STATE_IDLE) {
+        if (to_ms_since_boot(get_absolute_time()) - start > timeout_ms) {
+            return false;
+        }
+        cyw43_arch_poll();
+        https_manager_task();
+        sleep_ms(1);
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bench_config_t bench = {
+        .port = BENCH_DEFAULT_PORT,
+        .count = BENCH_DEFAULT_COUNT,
+        .ca_path = "ca.crt",
+        .cert_path = "client.crt",
+        .key_path = "client.key",
+        .ip = "192.168.7.2",
+        .netmask = "255.255.255.0",
+        .gateway = "192.168.7.1",
+        .dns = NULL,
+        .max_fragment_len = MBEDTLS_SSL_MAX_FRAG_LEN_2048,
+        .soak = false,
+        .warmup = BENCH_DEFAULT_WARMUP
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:n:a:c:k:i:g:d:m:sw:h")) != -1) {
+        switch (opt) {
+            case 'p': bench.port = (uint16_t)atoi(optarg); break;
+            case 'n': bench.count = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'a': bench.ca_path = optarg; break;
+            case 'c': bench.cert_path = optarg; break;
+            case 'k': bench.key_path = optarg; break;
+            case 'i': bench.ip = optarg; break;
+            case 'g': bench.gateway = optarg; break;
+            case 'd': bench.dns = optarg; break;
+            case 'm': bench.max_fragment_len = (uint8_t)atoi(optarg); break;
+            case 's': bench.soak = true; break;
+            case 'w': bench.warmup = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    bench.hostname = argv[optind];
+    if (bench.soak && bench.count <= bench.warmup) {
+        printf("HTTPS Bench: Soak needs more POSTs (-n) than warm-up (-w)\n");
+        return 1;
+    }
+
+    size_t ca_len = 0, cert_len = 0, key_len = 0;
+    uint8_t* ca = load_file(bench.ca_path, &ca_len);
+    uint8_t* cert = load_file(bench.cert_path, &cert_len);
+    uint8_t* key = load_file(bench.key_path, &key_len);
+    if (!ca || !cert || !key) {
+        return 1;
+    }
+
+    // Allocator first so every mbedTLS object lands in the arena, as on target
+    if (!mem_manager_init()) {
+        return 1;
+    }
+    latency_stats_init();
+
+    if (!host_platform_init(bench.ip, bench.netmask, bench.gateway,
+                            bench.dns ? bench.dns : bench.gateway)) {
+        return 1;
+    }
+
+    mbedtls_pk_context client_key;
+    mbedtls_pk_init(&client_key);
+    int ret = mbedtls_pk_parse_key(&client_key, key, key_len, NULL, 0);
+    if (ret != 0) {
+        printf("HTTPS Bench: Failed to parse client key: -0x%04x\n", -ret);
+        return 1;
+    }
+
+    https_config_t https_cfg = {
+        .hostname = bench.hostname,
+        .webhook_token = "host-bench",
+        .port = bench.port,
+        .ca_cert = ca,
+        .ca_cert_len = ca_len,
+        .enable_mtls = true,
+        .client_cert = cert,
+        .client_cert_len = cert_len,
+        .atecc_pk_context = &client_key,
+        .max_fragment_len = bench.max_fragment_len,
+        .include_latency = true,
+        .operation_timeout_ms = 30000
+    };
+
+    if (!https_manager_init(&https_cfg)) {
+        return 1;
+    }
+
+    uint32_t ok = 0;
+    uint64_t busy_us = 0;
+    mem_snapshot_t soak_base = {0};
+
+    for (uint32_t i = 0; i < bench.count; i++) {
+        if (bench.soak && i == bench.warmup) {
+            take_snapshot(&soak_base);
+        }
+
+        https_post_data_t data = {
+            .sample = i,
+            .timestamp = to_ms_since_boot(get_absolute_time()),
+            .device = "host-bench",
+            .cpu = 12.5f,
+            .memory = 48.0f,
+            .disk = 71.25f,
+            .net_in = 1.5f,
+            .net_out = 0.75f,
+            .processes = 128
+        };
+
+        // post_json only starts the upload; the operation timeout bounds wait_done()
+        uint64_t start = time_us_64();
+        bool started = https_manager_post_json(&data);
+        wait_done();
+        busy_us += time_us_64() - start;
+
+        if (started && https_manager_get_state() == HTTPS_STATE_COMPLETE) {
+            ok++;
+        }
+
+        // The manager holds COMPLETE/ERROR for a second before going idle;
+        // that hold-off is not part of the measured upload time
+        if (!wait_idle(5000)) {
+            https_manager_abort();
+        }
+    }
+
+    latency_histogram_t handshakes = {0};
+    latency_stats_get(LATENCY_PHASE_HANDSHAKE, &handshakes);
+
+    double busy_s = (double)busy_us / 1e6;
+    printf("\nHTTPS Bench: %lu/%lu POSTs succeeded in %.3f s busy time\n",
+           (unsigned long)ok, (unsigned long)bench.count, busy_s);
+    if (busy_s > 0.0) {
+        printf("HTTPS Bench: %.2f posts/s, %.2f handshakes/s\n",
+               ok / busy_s, handshakes.count / busy_s);
+    }
+
+    latency_stats_print();
+    mem_manager_print_stats();
+
+    bool soak_ok = !bench.soak || check_soak(&soak_base, bench.count - bench.warmup);
+
+    https_manager_deinit();
+    mbedtls_pk_free(&client_key);
+    free(ca);
+    free(cert);
+    free(key);
+
+    return (ok == bench.count && soak_ok) ? 0 : 1;
+}
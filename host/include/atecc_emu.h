@@ -0,0 +1,81 @@
+#ifndef ATECC_EMU_H
+#define ATECC_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "cryptoauthlib.h"
+
+// Software ATECC608B for host builds. The model replaces the I2C HAL
+// (hal_iface_register_hal), so calib drives it exactly as it drives the
+// chip: wake by general call, word addresses, NAKs while asleep or busy,
+// CRC-checked packets and the device's status codes. Commands take their
+// configured execution time; reading early NAKs like the real part.
+//
+// Modelled opcodes: Info (revision), Random, Nonce, SHA (SHA-256), GenKey,
+// Sign (external), Verify (external/stored), ECDH, Read, Write (clear
+// text), Counter and Lock. Anything else answers with a parse error.
+
+#define ATECC_EMU_SLOT_COUNT        16U
+#define ATECC_EMU_SLOT_MAX_SIZE     416U   // Slot 8
+#define ATECC_EMU_CONFIG_SIZE       128U
+#define ATECC_EMU_OTP_SIZE          64U
+
+// Same form as cfg_atecc608_pico.atcai2c.address in main.c
+#define ATECC_EMU_DEFAULT_ADDRESS   (0xC0 >> 1)
+
+// Fastest bus the part follows; above it transfers are corrupted
+#define ATECC_EMU_DEFAULT_MAX_BAUD  1000000U
+
+typedef struct atecc_emu atecc_emu_t;
+
+typedef struct {
+    uint32_t commands;
+    uint32_t wakes;
+    uint32_t naks;                 // Transfers refused while asleep, idle or busy
+    uint32_t crc_errors;           // Commands answered with 0xFF
+    uint32_t parse_errors;
+    uint32_t execution_errors;
+    uint32_t watchdog_expiries;
+    uint64_t busy_us;              // Modelled execution time
+} atecc_emu_stats_t;
+
+// Must be called before atcab_init; the Linux I2C HAL is replaced
+bool atecc_emu_register_hal(void);
+
+// Device in factory state: config and data zones unlocked, no keys
+atecc_emu_t* atecc_emu_create(void);
+
+void atecc_emu_destroy(atecc_emu_t* emu);
+
+// Applies a profile (see host/atecc608b.profile for the format)
+bool atecc_emu_load_profile(atecc_emu_t* emu, const char* path);
+
+// 7-bit I2C address (the profile's address), so several instances can
+// stand in for parts sharing a bus
+void atecc_emu_set_address(atecc_emu_t* emu, uint8_t address);
+
+// Fills an I2C interface configuration that selects this instance
+void atecc_emu_iface_cfg(atecc_emu_t* emu, ATCAIfaceCfg* cfg);
+
+// Execution time of one opcode, before scaling
+void atecc_emu_set_exec_time(atecc_emu_t* emu, uint8_t opcode, uint32_t exec_us);
+
+// 100 = configured timing, 0 = every command and transfer completes instantly
+void atecc_emu_set_timing_scale(atecc_emu_t* emu, uint32_t percent);
+
+// Fastest bus the part follows from now on (the profile's max_baud)
+void atecc_emu_set_max_baud(atecc_emu_t* emu, uint32_t max_baud);
+
+// Corrupts the CRC of the next count responses
+void atecc_emu_inject_crc_errors(atecc_emu_t* emu, uint32_t count);
+
+// Reference bitwise CRC-16 of the device's packets (0x8005, bytes LSB first)
+uint16_t atecc_emu_crc16(const uint8_t* data, size_t length);
+
+void atecc_emu_get_stats(const atecc_emu_t* emu, atecc_emu_stats_t* stats);
+
+void atecc_emu_print_stats(const atecc_emu_t* emu);
+
+#endif // ATECC_EMU_H
@@ -0,0 +1,18 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// LEDs are not wired on the host; GPIO calls are accepted and ignored
+
+#define GPIO_OUT 1
+#define GPIO_IN  0
+
+static inline void gpio_init(uint32_t gpio) { (void)gpio; }
+
+static inline void gpio_set_dir(uint32_t gpio, bool out) { (void)gpio; (void)out; }
+
+static inline void gpio_put(uint32_t gpio, bool value) { (void)gpio; (void)value; }
+
+#endif // HOST_HARDWARE_GPIO_H
@@ -0,0 +1,8 @@
+#ifndef HOST_PLATFORM_H
+#define HOST_PLATFORM_H
+
+#include <stdbool.h>
+
+bool host_platform_init(const char* ip, const char* netmask, const char* gateway, const char* dns);
+
+#endif // HOST_PLATFORM_H
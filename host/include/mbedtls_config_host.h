@@ -0,0 +1,11 @@
+#ifndef MBEDTLS_CONFIG_HOST_H
+#define MBEDTLS_CONFIG_HOST_H
+
+// Same mbedTLS feature set as the firmware
+#include "mbedtls_config.h"
+
+// No ATECC608B on the host: the client key is a software P-256 key, so
+// mbedTLS's own ECDSA sign is used instead of the override in main.c
+#undef MBEDTLS_ECDSA_SIGN_ALT
+
+#endif // MBEDTLS_CONFIG_HOST_H
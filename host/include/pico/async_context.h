@@ -0,0 +1,23 @@
+#ifndef HOST_PICO_ASYNC_CONTEXT_H
+#define HOST_PICO_ASYNC_CONTEXT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Host stand-in: only the at-time worker subset used by the upload path.
+// Workers are run from cyw43_arch_poll() once their deadline has passed.
+
+typedef struct async_context async_context_t;
+
+typedef struct async_work_on_timeout {
+    struct async_work_on_timeout* next;
+    void (*do_work)(async_context_t* context, struct async_work_on_timeout* timeout);
+    uint64_t next_time;
+    void* user_data;
+} async_at_time_worker_t;
+
+bool async_context_add_at_time_worker_in_ms(async_context_t* context, async_at_time_worker_t* worker, uint32_t ms);
+
+bool async_context_remove_at_time_worker(async_context_t* context, async_at_time_worker_t* worker);
+
+#endif // HOST_PICO_ASYNC_CONTEXT_H
@@ -0,0 +1,17 @@
+#ifndef HOST_PICO_CYW43_ARCH_H
+#define HOST_PICO_CYW43_ARCH_H
+
+#include "pico/async_context.h"
+
+// Host stand-in: "polling the radio" services the tap netif, lwIP timers
+// and due async_context workers. On target this happens in the background IRQ.
+
+void cyw43_arch_poll(void);
+
+async_context_t* cyw43_arch_async_context(void);
+
+static inline void cyw43_arch_lwip_begin(void) {}
+
+static inline void cyw43_arch_lwip_end(void) {}
+
+#endif // HOST_PICO_CYW43_ARCH_H
@@ -0,0 +1,41 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Host stand-in for the subset of pico/stdlib.h used by the upload path
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define PICO_ERROR_TIMEOUT -1
+
+absolute_time_t get_absolute_time(void);
+
+uint32_t to_ms_since_boot(absolute_time_t t);
+
+uint64_t to_us_since_boot(absolute_time_t t);
+
+uint64_t time_us_64(void);
+
+uint32_t time_us_32(void);
+
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+
+void sleep_ms(uint32_t ms);
+
+void sleep_us(uint64_t us);
+
+void busy_wait_ms(uint32_t ms);
+
+void busy_wait_us(uint64_t us);
+
+static inline void tight_loop_contents(void) {}
+
+#endif // HOST_PICO_STDLIB_H
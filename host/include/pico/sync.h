@@ -0,0 +1,16 @@
+#ifndef HOST_PICO_SYNC_H
+#define HOST_PICO_SYNC_H
+
+#include <pthread.h>
+
+typedef struct {
+    pthread_mutex_t mutex;
+} critical_section_t;
+
+void critical_section_init(critical_section_t* crit_sec);
+
+void critical_section_enter_blocking(critical_section_t* crit_sec);
+
+void critical_section_exit(critical_section_t* crit_sec);
+
+#endif // HOST_PICO_SYNC_H
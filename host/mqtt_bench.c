@@ -0,0 +1,234 @@
+// Host benchmark driver for mqtt_manager
+//
+// Runs the firmware MQTT transport unchanged against lwIP's unix port (tap
+// netif) and a local mTLS broker such as mosquitto. One session is opened
+// and kept for the whole run, as on target; every sample is a PUBLISH on
+// it. The ATECC608B is replaced by a software P-256 key loaded from a file.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "host_platform.h"
+#include "mqtt_manager.h"
+#include "mem_manager.h"
+
+#include "mbedtls/pk.h"
+
+#define BENCH_DEFAULT_COUNT     20
+#define BENCH_DEFAULT_PORT      8883
+#define BENCH_DEFAULT_TOPIC     "devices/host-bench/health"
+
+// Benchmark configuration
+typedef struct {
+    const char* hostname;
+    uint16_t port;
+    uint32_t count;
+    const char* topic;
+    uint8_t qos;
+    const char* ca_path;
+    const char* cert_path;
+    const char* key_path;
+    const char* ip;
+    const char* netmask;
+    const char* gateway;
+    const char* dns;
+} bench_config_t;
+
+static uint8_t* load_file(const char* path, size_t* len)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("MQTT Bench: Cannot open %s\n", path);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    // mbedTLS PEM parsing wants the terminating NUL counted in the length
+    uint8_t* buf = (uint8_t*)malloc((size_t)size + 1);
+    if (buf && fread(buf, 1, (size_t)size, f) == (size_t)size) {
+        buf[size] = '\0';
+        *len = (size_t)size + 1;
+    } else {
+        free(buf);
+        buf = NULL;
+    }
+
+    fclose(f);
+    return buf;
+}
+
+// Drives the publish the way the cyw43 background IRQ does on target
+static void wait_done(void)
+{
+    while (mqtt_manager_is_busy()) {
+        cyw43_arch_poll();
+        sleep_us(100);
+    }
+}
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options] <broker-host>\n"
+           "  -p <port>      broker port (default %d)\n"
+           "  -n <count>     number of PUBLISHes (default %d)\n"
+           "  -t <topic>     topic (default %s)\n"
+           "  -q <qos>       0 or 1 (default 1)\n"
+           "  -a <file>      CA certificate (PEM)\n"
+           "  -c <file>      client certificate (PEM)\n"
+           "  -k <file>      client P-256 private key (PEM), stands in for the ATECC\n"
+           "  -i <ip>        lwIP address (default 192.168.7.2)\n"
+           "  -g <ip>        gateway / tap host address (default 192.168.7.1)\n"
+           "  -d <ip>        DNS server (default: gateway)\n",
+           prog, BENCH_DEFAULT_PORT, BENCH_DEFAULT_COUNT, BENCH_DEFAULT_TOPIC);
+}
+
+int main(int argc, char** argv)
+{
+    bench_config_t bench = {
+        .port = BENCH_DEFAULT_PORT,
+        .count = BENCH_DEFAULT_COUNT,
+        .topic = BENCH_DEFAULT_TOPIC,
+        .qos = 1,
+        .ca_path = "ca.crt",
+        .cert_path = "client.crt",
+        .key_path = "client.key",
+        .ip = "192.168.7.2",
+        .netmask = "255.255.255.0",
+        .gateway = "192.168.7.1",
+        .dns = NULL
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:n:t:q:a:c:k:i:g:d:h")) != -1) {
+        switch (opt) {
+            case 'p': bench.port = (uint16_t)atoi(optarg); break;
+            case 'n': bench.count = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 't': bench.topic = optarg; break;
+            case 'q': bench.qos = (uint8_t)atoi(optarg); break;
+            case 'a': bench.ca_path = optarg; break;
+            case 'c': bench.cert_path = optarg; break;
+            case 'k': bench.key_path = optarg; break;
+            case 'i': bench.ip = optarg; break;
+            case 'g': bench.gateway = optarg; break;
+            case 'd': bench.dns = optarg; break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    bench.hostname = argv[optind];
+
+    size_t ca_len = 0, cert_len = 0, key_len = 0;
+    uint8_t* ca = load_file(bench.ca_path, &ca_len);
+    uint8_t* cert = load_file(bench.cert_path, &cert_len);
+    uint8_t* key = load_file(bench.key_path, &key_len);
+    if (!ca || !cert || !key) {
+        return 1;
+    }
+
+    // Allocator first so every mbedTLS object lands in the arena, as on target
+    if (!mem_manager_init()) {
+        return 1;
+    }
+
+    if (!host_platform_init(bench.ip, bench.netmask, bench.gateway,
+                            bench.dns ? bench.dns : bench.gateway)) {
+        return 1;
+    }
+
+    mbedtls_pk_context client_key;
+    mbedtls_pk_init(&client_key);
+    int ret = mbedtls_pk_parse_key(&client_key, key, key_len, NULL, 0);
+    if (ret != 0) {
+        printf("MQTT Bench: Failed to parse client key: -0x%04x\n", -ret);
+        return 1;
+    }
+
+    mqtt_config_t mqtt_cfg = {
+        .hostname = bench.hostname,
+        .port = bench.port,
+        .client_id = "host-bench",
+        .topic = bench.topic,
+        .qos = bench.qos,
+        .ca_cert = ca,
+        .ca_cert_len = ca_len,
+        .enable_mtls = true,
+        .client_cert = cert,
+        .client_cert_len = cert_len,
+        .atecc_pk_context = &client_key,
+        .operation_timeout_ms = 30000
+    };
+
+    if (!mqtt_manager_init(&mqtt_cfg)) {
+        return 1;
+    }
+
+    uint32_t ok = 0;
+    uint64_t first_us = 0;
+    uint64_t steady_us = 0;
+
+    for (uint32_t i = 0; i < bench.count; i++) {
+        https_post_data_t data = {
+            .sample = i,
+            .timestamp = to_ms_since_boot(get_absolute_time()),
+            .device = "host-bench",
+            .cpu = 12.5f,
+            .memory = 48.0f,
+            .disk = 71.25f,
+            .net_in = 1.5f,
+            .net_out = 0.75f,
+            .processes = 128
+        };
+
+        // Timed until sent (QoS 0) or PUBACK (QoS 1); the first one also
+        // pays for DNS, TCP, the mTLS handshake and CONNECT
+        uint64_t start = time_us_64();
+        bool published = mqtt_manager_publish_json(&data);
+        wait_done();
+        published = published && mqtt_manager_publish_succeeded();
+        uint64_t elapsed = time_us_64() - start;
+
+        if (i == 0) {
+            first_us = elapsed;
+        } else {
+            steady_us += elapsed;
+        }
+        if (published) {
+            ok++;
+        }
+
+        mqtt_manager_task();
+        cyw43_arch_poll();
+    }
+
+    printf("\nMQTT Bench: %lu/%lu PUBLISHes succeeded (QoS %u)\n",
+           (unsigned long)ok, (unsigned long)bench.count, bench.qos);
+    printf("MQTT Bench: first (with connect) %.1f ms\n", first_us / 1000.0);
+    if (bench.count > 1) {
+        double steady_s = (double)steady_us / 1e6;
+        printf("MQTT Bench: on the open session %.2f ms each, %.2f publishes/s\n",
+               steady_s * 1000.0 / (bench.count - 1),
+               steady_s > 0.0 ? (bench.count - 1) / steady_s : 0.0);
+    }
+
+    mem_manager_print_stats();
+
+    mqtt_manager_deinit();
+    mbedtls_pk_free(&client_key);
+    free(ca);
+    free(cert);
+    free(key);
+
+    return (ok == bench.count) ? 0 : 1;
+}
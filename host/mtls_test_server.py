@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Loopback mTLS webhook server for the host build of https_manager.
+
+Accepts the same POST /<token> requests as the real webhook endpoint,
+requires a client certificate signed by the given CA, and reports the
+request rate so throughput changes can be compared between builds.
+"""
+
+import argparse
+import json
+import ssl
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class Counter:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.count = 0
+        self.start = None
+
+    def hit(self):
+        with self.lock:
+            if self.start is None:
+                self.start = time.monotonic()
+            self.count += 1
+            elapsed = time.monotonic() - self.start
+            return self.count, elapsed
+
+
+COUNTER = Counter()
+
+
+class WebhookHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length)
+
+        try:
+            payload = json.loads(body)
+        except ValueError:
+            self.send_error(400, "invalid JSON")
+            return
+
+        # Batched uploads arrive as an array of records
+        records = payload if isinstance(payload, list) else [payload]
+        count, elapsed = COUNTER.hit()
+        if self.server.verbose:
+            samples = ",".join(str(r.get("sample")) for r in records)
+            print(f"POST {self.path} sample={samples} "
+                  f"lat={records[-1].get('lat')}")
+        if count % self.server.report_every == 0 and elapsed > 0:
+            print(f"{count} requests, {count / elapsed:.2f} req/s")
+
+        reply = b'{"ok":true}'
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(reply)))
+        if self.headers.get("Connection", "").lower() == "close":
+            self.send_header("Connection", "close")
+            self.close_connection = True
+        self.end_headers()
+        self.wfile.write(reply)
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8443)
+    parser.add_argument("--cert", default="server.crt")
+    parser.add_argument("--key", default="server.key")
+    parser.add_argument("--ca", default="ca.crt", help="CA that signed the client certificate")
+    parser.add_argument("--report-every", type=int, default=10)
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.minimum_version = ssl.TLSVersion.TLSv1_2
+    context.maximum_version = ssl.TLSVersion.TLSv1_2  # mbedTLS 2.28 client
+    context.load_cert_chain(args.cert, args.key)
+    context.load_verify_locations(args.ca)
+    context.verify_mode = ssl.CERT_REQUIRED
+
+    server = ThreadingHTTPServer((args.bind, args.port), WebhookHandler)
+    server.socket = context.wrap_socket(server.socket, server_side=True)
+    server.report_every = max(1, args.report_every)
+    server.verbose = args.verbose
+
+    print(f"mTLS test server listening on {args.bind}:{args.port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        print(f"\n{COUNTER.count} requests total")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,101 @@
+#include <time.h>
+#include <errno.h>
+
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+
+// Host implementations of the pico/stdlib.h time and pico/sync.h critical
+// section subsets. Shared by https_bench and rtos_bench.
+
+static uint64_t g_boot_us = 0;
+
+static uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+// Time
+
+absolute_time_t get_absolute_time(void)
+{
+    if (g_boot_us == 0) {
+        g_boot_us = monotonic_us();
+    }
+    return monotonic_us() - g_boot_us;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t)
+{
+    return (uint32_t)(t / 1000ULL);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t)
+{
+    return t;
+}
+
+uint64_t time_us_64(void)
+{
+    return get_absolute_time();
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)get_absolute_time();
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms)
+{
+    return get_absolute_time() + (uint64_t)ms * 1000ULL;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to)
+{
+    return (int64_t)(to - from);
+}
+
+void sleep_us(uint64_t us)
+{
+    struct timespec ts = {
+        .tv_sec = (time_t)(us / 1000000ULL),
+        .tv_nsec = (long)(us % 1000000ULL) * 1000L
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sleep_us((uint64_t)ms * 1000ULL);
+}
+
+void busy_wait_us(uint64_t us)
+{
+    uint64_t start = monotonic_us();
+    while (monotonic_us() - start < us) {
+    }
+}
+
+void busy_wait_ms(uint32_t ms)
+{
+    busy_wait_us((uint64_t)ms * 1000ULL);
+}
+
+// Synchronisation
+
+void critical_section_init(critical_section_t* crit_sec)
+{
+    pthread_mutex_init(&crit_sec->mutex, NULL);
+}
+
+void critical_section_enter_blocking(critical_section_t* crit_sec)
+{
+    pthread_mutex_lock(&crit_sec->mutex);
+}
+
+void critical_section_exit(critical_section_t* crit_sec)
+{
+    pthread_mutex_unlock(&crit_sec->mutex);
+}
@@ -0,0 +1,219 @@
+// Host benchmark driver for the FreeRTOS task layout (src/rtos_app.c)
+//
+// Runs the ingest and upload tasks unchanged on the FreeRTOS POSIX port. A
+// feeder task stands in for the USB task and writes health-cdc style JSON
+// lines at a fixed rate; the upload callback simulates a transport that
+// takes a fixed time per record. Reports feeder wake-up lateness (scheduling
+// latency), ingest -> upload hand-off latency and throughput, and exits
+// non-zero when a budget is exceeded so it can gate regressions.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_app.h"
+#include "upload_pipeline.h"
+
+#define BENCH_DEFAULT_SAMPLES   200
+#define BENCH_DEFAULT_RATE_HZ   50
+#define BENCH_DEFAULT_UPLOAD_MS 20
+
+// Benchmark configuration
+typedef struct {
+    uint32_t samples;
+    uint32_t rate_hz;
+    uint32_t upload_ms;
+    uint32_t fail_every;         // Fail every Nth upload, 0 = never
+    bool batch;                  // Hand off every pending record as one upload
+    uint32_t latency_budget_us;  // Max hand-off latency, 0 = not checked
+} bench_config_t;
+
+// Feeder measurements
+typedef struct {
+    uint32_t uploads;
+    uint32_t records_delivered;  // Records in uploads the stand-in transport accepted
+    uint32_t lateness_max_us;
+    uint64_t lateness_total_us;
+    uint64_t start_us;
+    uint64_t end_us;
+} bench_result_t;
+
+static bench_config_t g_bench;
+static bench_result_t g_result;
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <count>     samples to feed (default %d)\n"
+           "  -r <hz>        feed rate in samples/s (default %d)\n"
+           "  -u <ms>        simulated upload time per record (default %d)\n"
+           "  -f <n>         fail every n-th upload (default 0 = never)\n"
+           "  -b             hand off all pending records as one batch (default: one per upload)\n"
+           "  -l <us>        fail the run if hand-off latency exceeds this (default: unchecked)\n",
+           prog, BENCH_DEFAULT_SAMPLES, BENCH_DEFAULT_RATE_HZ, BENCH_DEFAULT_UPLOAD_MS);
+}
+
+// Stand-in transport: runs in the upload task
+static bool bench_upload(const https_post_data_t* records, uint32_t count)
+{
+    (void)records;
+
+    vTaskDelay(pdMS_TO_TICKS(g_bench.upload_ms));
+
+    g_result.uploads++;
+    bool delivered = g_bench.fail_every == 0 || (g_result.uploads % g_bench.fail_every) != 0;
+    if (delivered) {
+        g_result.records_delivered += count;
+    }
+    return delivered;
+}
+
+// Stands in for https_manager_batch_size() on a link that drains everything
+static uint32_t bench_batch_size(const https_post_data_t* records, uint32_t pending)
+{
+    (void)records;
+    return pending;
+}
+
+static void bench_command(const char* line)
+{
+    printf("RTOS Bench: Unexpected command line '%s'\n", line);
+}
+
+static bool bench_finish(void)
+{
+    rtos_app_stats_t stats;
+    rtos_app_get_stats(&stats);
+
+    double elapsed_s = (double)(g_result.end_us - g_result.start_us) / 1e6;
+    uint32_t uploads = stats.uploads_ok + stats.uploads_failed;
+
+    printf("\nRTOS Bench: %lu samples in %.3f s (%.1f samples/s), %lu records uploaded (%.1f/s)\n",
+           (unsigned long)g_bench.samples, elapsed_s,
+           elapsed_s > 0.0 ? g_bench.samples / elapsed_s : 0.0,
+           (unsigned long)uploads, elapsed_s > 0.0 ? uploads / elapsed_s : 0.0);
+    printf("RTOS Bench: feeder lateness avg %lu us, max %lu us\n",
+           (unsigned long)(g_result.lateness_total_us / g_bench.samples),
+           (unsigned long)g_result.lateness_max_us);
+    rtos_app_print_stats();
+
+    upload_pipeline_stats_t pipeline;
+    upload_pipeline_get_stats(&pipeline);
+    printf("RTOS Bench: pipeline %lu samples, %lu queued, %lu coalesced, %lu delivered, %lu failed sends\n",
+           (unsigned long)pipeline.samples_aggregated, (unsigned long)pipeline.records_queued,
+           (unsigned long)pipeline.records_coalesced, (unsigned long)g_result.records_delivered,
+           (unsigned long)pipeline.send_failures);
+
+    // A failed upload is retried, so every queued record must reach the transport
+    bool pass = stats.bytes_dropped == 0 && stats.uploads_ok > 0 &&
+                pipeline.samples_aggregated == g_bench.samples &&
+                g_result.records_delivered == pipeline.records_queued;
+    if (g_result.records_delivered != pipeline.records_queued) {
+        printf("RTOS Bench: %lu records lost\n",
+               (unsigned long)(pipeline.records_queued - g_result.records_delivered));
+    }
+    if (g_bench.latency_budget_us != 0 && stats.handoff_max_us > g_bench.latency_budget_us) {
+        printf("RTOS Bench: hand-off latency %lu us over budget %lu us\n",
+               (unsigned long)stats.handoff_max_us, (unsigned long)g_bench.latency_budget_us);
+        pass = false;
+    }
+
+    printf("RTOS Bench: %s\n", pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+// Stands in for the USB task: same priority, feeds CDC lines at a fixed rate
+static void feeder_task(void* arg)
+{
+    (void)arg;
+
+    const TickType_t period = pdMS_TO_TICKS(1000 / g_bench.rate_hz);
+    const uint64_t period_us = (uint64_t)period * 1000000ULL / configTICK_RATE_HZ;
+    char line[160];
+
+    rtos_app_set_link_up(true);
+
+    TickType_t last_wake = xTaskGetTickCount();
+    g_result.start_us = time_us_64();
+    uint64_t expected_us = g_result.start_us;
+
+    for (uint32_t i = 0; i < g_bench.samples; i++) {
+        vTaskDelayUntil(&last_wake, period);
+
+        expected_us += period_us;
+        uint64_t now_us = time_us_64();
+        uint32_t lateness = (now_us > expected_us) ? (uint32_t)(now_us - expected_us) : 0;
+        g_result.lateness_total_us += lateness;
+        if (lateness > g_result.lateness_max_us) {
+            g_result.lateness_max_us = lateness;
+        }
+
+        int len = snprintf(line, sizeof(line),
+                           "{\"cpu\":%.1f,\"memory\":%.1f,\"disk\":71.25,"
+                           "\"net_in\":1.5,\"net_out\":0.75,\"processes\":%lu}\n",
+                           10.0 + (i % 50), 40.0 + (i % 20), (unsigned long)(100 + i % 30));
+        rtos_app_ingest((const uint8_t*)line, (size_t)len, portMAX_DELAY);
+    }
+
+    // Let the last records drain through the upload task; they leave the
+    // pipeline only once delivered
+    do {
+        vTaskDelay(pdMS_TO_TICKS(RTOS_INGEST_IDLE_MS * 2));
+    } while (upload_pipeline_count() > 0);
+
+    g_result.end_us = time_us_64();
+    exit(bench_finish() ? 0 : 1);
+}
+
+int main(int argc, char** argv)
+{
+    g_bench = (bench_config_t){
+        .samples = BENCH_DEFAULT_SAMPLES,
+        .rate_hz = BENCH_DEFAULT_RATE_HZ,
+        .upload_ms = BENCH_DEFAULT_UPLOAD_MS,
+        .fail_every = 0,
+        .batch = false,
+        .latency_budget_us = 0
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:u:f:bl:h")) != -1) {
+        switch (opt) {
+            case 'n': g_bench.samples = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'r': g_bench.rate_hz = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'u': g_bench.upload_ms = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'f': g_bench.fail_every = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'b': g_bench.batch = true; break;
+            case 'l': g_bench.latency_budget_us = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (g_bench.samples == 0 || g_bench.rate_hz == 0 || g_bench.rate_hz > 1000) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    rtos_app_config_t rtos_cfg = {
+        .device = "rtos-bench",
+        .enable_auto_post = true,
+        .min_post_interval_ms = 0,
+        .upload = bench_upload,
+        .batch_size = g_bench.batch ? bench_batch_size : NULL,
+        .on_command = bench_command
+    };
+
+    if (!rtos_app_init(&rtos_cfg) ||
+        !rtos_app_create_task(feeder_task, "feeder", RTOS_STACK_USB, NULL,
+                              RTOS_PRIO_USB, RTOS_CORE_TRANSPORT, NULL)) {
+        return 1;
+    }
+
+    vTaskStartScheduler();
+    return 1;
+}
@@ -365,6 +365,228 @@ ATCA_STATUS atcab_sleep(void)
     return status;
 }
 
+#if CALIB_SESSION_EN
+/** \brief Opens a keep-awake session: the device stays awake across the
+ *         commands up to the matching atcab_session_end_ext.
+ *  \param[in] device  Device context
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_session_begin_ext(ATCADevice device)
+{
+    ATCA_STATUS status = ATCA_UNIMPLEMENTED;
+    ATCADeviceType dev_type = atcab_get_device_type_ext(device);
+
+    if (atcab_is_ca_device(dev_type) || atcab_is_ca2_device(dev_type))
+    {
+#if ATCA_CA_SUPPORT
+        status = calib_session_begin(device);
+#endif
+    }
+    else if (atcab_is_ta_device(dev_type))
+    {
+#if ATCA_TA_SUPPORT
+        status = ATCA_SUCCESS;
+#endif
+    }
+    else
+    {
+        status = ATCA_NOT_INITIALIZED;
+    }
+    return status;
+}
+
+/** \brief Opens a keep-awake session on the default device.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_session_begin(void)
+{
+    return atcab_session_begin_ext(atcab_get_device());
+}
+
+/** \brief Closes a keep-awake session; the outermost end idles the device.
+ *  \param[in] device  Device context
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_session_end_ext(ATCADevice device)
+{
+    ATCA_STATUS status = ATCA_UNIMPLEMENTED;
+    ATCADeviceType dev_type = atcab_get_device_type_ext(device);
+
+    if (atcab_is_ca_device(dev_type) || atcab_is_ca2_device(dev_type))
+    {
+#if ATCA_CA_SUPPORT
+        status = calib_session_end(device);
+#endif
+    }
+    else if (atcab_is_ta_device(dev_type))
+    {
+#if ATCA_TA_SUPPORT
+        status = ATCA_SUCCESS;
+#endif
+    }
+    else
+    {
+        status = ATCA_NOT_INITIALIZED;
+    }
+    return status;
+}
+
+/** \brief Closes a keep-awake session on the default device.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_session_end(void)
+{
+    return atcab_session_end_ext(atcab_get_device());
+}
+#endif
+
+#if CALIB_ZONE_CACHE_EN
+/** \brief Drops every cached zone block of the device.
+ *  \param[in] device  Device context
+ */
+void atcab_zone_cache_invalidate_ext(ATCADevice device)
+{
+    if (atcab_is_ca_device(atcab_get_device_type_ext(device)))
+    {
+        calib_zone_cache_invalidate(device);
+    }
+}
+
+/** \brief Drops every cached zone block of the default device. */
+void atcab_zone_cache_invalidate(void)
+{
+    atcab_zone_cache_invalidate_ext(atcab_get_device());
+}
+
+/** \brief Copies the device's zone cache into a persistable image.
+ *  \param[in]     device      Device context
+ *  \param[out]    image       Receives the image
+ *  \param[in,out] image_size  As input, the size of image. As output, the
+ *                             bytes written (CALIB_ZONE_CACHE_IMAGE_SIZE).
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_zone_cache_export_ext(ATCADevice device, uint8_t* image, size_t* image_size)
+{
+    ATCA_STATUS status = ATCA_UNIMPLEMENTED;
+
+    if (atcab_is_ca_device(atcab_get_device_type_ext(device)))
+    {
+        status = calib_zone_cache_export(device, image, image_size);
+    }
+    return status;
+}
+
+/** \brief Copies the default device's zone cache into a persistable image.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_zone_cache_export(uint8_t* image, size_t* image_size)
+{
+    return atcab_zone_cache_export_ext(atcab_get_device(), image, image_size);
+}
+
+/** \brief Restores a zone cache image from atcab_zone_cache_export_ext.
+ *  \param[in] device      Device context
+ *  \param[in] image       Image to restore
+ *  \param[in] image_size  Size of image
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_zone_cache_import_ext(ATCADevice device, const uint8_t* image, size_t image_size)
+{
+    ATCA_STATUS status = ATCA_UNIMPLEMENTED;
+
+    if (atcab_is_ca_device(atcab_get_device_type_ext(device)))
+    {
+        status = calib_zone_cache_import(device, image, image_size);
+    }
+    return status;
+}
+
+/** \brief Restores a zone cache image into the default device.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_zone_cache_import(const uint8_t* image, size_t image_size)
+{
+    return atcab_zone_cache_import_ext(atcab_get_device(), image, image_size);
+}
+#endif
+
+#if CALIB_PROFILE_EN
+/** \brief Copies the device's per-opcode command profile.
+ *  \param[in]     device  Device context
+ *  \param[out]    stats   Receives the entries
+ *  \param[in,out] count   As input, the entries stats holds. As output, the
+ *                         entries written.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_get_stats_ext(ATCADevice device, atca_opcode_stats_t* stats, size_t* count)
+{
+    ATCA_STATUS status = ATCA_UNIMPLEMENTED;
+
+    if (atcab_is_ca_device(atcab_get_device_type_ext(device)))
+    {
+        status = calib_get_stats(device, stats, count);
+    }
+    return status;
+}
+
+/** \brief Copies the default device's per-opcode command profile.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_get_stats(atca_opcode_stats_t* stats, size_t* count)
+{
+    return atcab_get_stats_ext(atcab_get_device(), stats, count);
+}
+
+/** \brief Clears the device's per-opcode command profile.
+ *  \param[in] device  Device context
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_reset_stats_ext(ATCADevice device)
+{
+    ATCA_STATUS status = ATCA_UNIMPLEMENTED;
+
+    if (atcab_is_ca_device(atcab_get_device_type_ext(device)))
+    {
+        status = calib_reset_stats(device);
+    }
+    return status;
+}
+
+/** \brief Clears the default device's per-opcode command profile.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_reset_stats(void)
+{
+    return atcab_reset_stats_ext(atcab_get_device());
+}
+#endif
+
+#if CALIB_I2C_SPEED_STEP_EN
+/** \brief Raises the I2C clock as far as the device follows it.
+ *  \param[in]  device  Device context
+ *  \param[out] baud    Receives the baud in use afterwards. May be NULL.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_i2c_speed_probe_ext(ATCADevice device, uint32_t* baud)
+{
+    ATCA_STATUS status = ATCA_UNIMPLEMENTED;
+
+    if (atcab_is_ca_device(atcab_get_device_type_ext(device)))
+    {
+        status = calib_i2c_speed_probe(device, baud);
+    }
+    return status;
+}
+
+/** \brief Raises the default device's I2C clock as far as it follows it.
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_i2c_speed_probe(uint32_t* baud)
+{
+    return atcab_i2c_speed_probe_ext(atcab_get_device(), baud);
+}
+#endif
+
 /** \brief Gets the size of the specified zone in bytes.
  *
  * \param[in]  device Device context
@@ -3812,6 +4034,52 @@ ATCA_STATUS atcab_sign(uint16_t key_id, const uint8_t* msg, uint8_t* signature)
 }
 #endif
 
+#if CALIB_ASYNC_EN && CALIB_SIGN_EN && defined(ATCA_USE_ATCAB_FUNCTIONS)
+/** \brief Starts a non-blocking Sign of a 32-byte external message; see
+ *          calib_sign_submit().
+ *
+ *  \param[in]  device     Device context pointer
+ *  \param[out] job        Sign state, owned by the caller until complete
+ *  \param[in]  key_id     Slot of the private key
+ *  \param[in]  msg        32-byte message to be signed
+ *  \param[out] signature  Receives R and S once the job completes
+ *  \param[in]  callback   Completion callback, may be NULL
+ *  \param[in]  cb_arg     Passed to the callback
+ *
+ * \return ATCA_SUCCESS once the sign is running, otherwise an error code.
+ */
+ATCA_STATUS atcab_sign_submit_ext(ATCADevice device, calib_sign_async_t* job, uint16_t key_id, const uint8_t* msg,
+                                  uint8_t* signature, calib_async_cb callback, void* cb_arg)
+{
+    ATCA_STATUS status = ATCA_UNIMPLEMENTED;
+    ATCADeviceType dev_type = atcab_get_device_type_ext(device);
+
+    if (atcab_is_ca_device(dev_type))
+    {
+        status = calib_sign_submit(device, job, key_id, msg, signature, callback, cb_arg);
+    }
+    else if (!atcab_is_ca2_device(dev_type) && !atcab_is_ta_device(dev_type))
+    {
+        status = ATCA_NOT_INITIALIZED;
+    }
+    else
+    {
+        /* No non-blocking path for this device */
+    }
+    return status;
+}
+
+/** \brief Starts a non-blocking Sign on the default device.
+ *
+ * \return ATCA_SUCCESS once the sign is running, otherwise an error code.
+ */
+ATCA_STATUS atcab_sign_submit(calib_sign_async_t* job, uint16_t key_id, const uint8_t* msg,
+                              uint8_t* signature, calib_async_cb callback, void* cb_arg)
+{
+    return atcab_sign_submit_ext(g_atcab_device_ptr, job, key_id, msg, signature, callback, cb_arg);
+}
+#endif
+
 #if ATCAB_SIGN_INTERNAL_EN && defined(ATCA_USE_ATCAB_FUNCTIONS)
 /** \brief Executes Sign command to sign an internally generated message.
  *
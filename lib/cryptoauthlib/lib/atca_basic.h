@@ -66,6 +66,12 @@ bool atcab_is_ta_device(ATCADeviceType dev_type);
 #define atcab_get_addr(...)                     calib_get_addr(__VA_ARGS__)
 #define atca_execute_command(...)               calib_execute_command(__VA_ARGS__)
 
+/* Exclusive use of a device across several calls (ATCA_DEVICE_LOCK_EN) */
+#define atcab_acquire(priority)                 atca_device_acquire(g_atcab_device_ptr, priority)
+#define atcab_acquire_ext                       atca_device_acquire
+#define atcab_relinquish()                      atca_device_relinquish(g_atcab_device_ptr)
+#define atcab_relinquish_ext                    atca_device_relinquish
+
 
 /* Extra AES Block Mode Support */
 #include "crypto/atca_crypto_hw_aes.h"
@@ -83,6 +89,30 @@ ATCA_STATUS atcab_pbkdf2_sha256(const uint32_t iter, const uint16_t slot, const
 ATCA_STATUS atcab_wakeup(void);
 ATCA_STATUS atcab_idle(void);
 ATCA_STATUS atcab_sleep(void);
+#if CALIB_SESSION_EN
+ATCA_STATUS atcab_session_begin(void);
+ATCA_STATUS atcab_session_begin_ext(ATCADevice device);
+ATCA_STATUS atcab_session_end(void);
+ATCA_STATUS atcab_session_end_ext(ATCADevice device);
+#endif
+#if CALIB_ZONE_CACHE_EN
+void atcab_zone_cache_invalidate(void);
+void atcab_zone_cache_invalidate_ext(ATCADevice device);
+ATCA_STATUS atcab_zone_cache_export(uint8_t* image, size_t* image_size);
+ATCA_STATUS atcab_zone_cache_export_ext(ATCADevice device, uint8_t* image, size_t* image_size);
+ATCA_STATUS atcab_zone_cache_import(const uint8_t* image, size_t image_size);
+ATCA_STATUS atcab_zone_cache_import_ext(ATCADevice device, const uint8_t* image, size_t image_size);
+#endif
+#if CALIB_PROFILE_EN
+ATCA_STATUS atcab_get_stats(atca_opcode_stats_t* stats, size_t* count);
+ATCA_STATUS atcab_get_stats_ext(ATCADevice device, atca_opcode_stats_t* stats, size_t* count);
+ATCA_STATUS atcab_reset_stats(void);
+ATCA_STATUS atcab_reset_stats_ext(ATCADevice device);
+#endif
+#if CALIB_I2C_SPEED_STEP_EN
+ATCA_STATUS atcab_i2c_speed_probe(uint32_t* baud);
+ATCA_STATUS atcab_i2c_speed_probe_ext(ATCADevice device, uint32_t* baud);
+#endif
 //ATCA_STATUS atcab_get_addr(uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint16_t* addr);
 ATCA_STATUS atcab_get_zone_size(uint8_t zone, uint16_t slot, size_t* size);
 ATCA_STATUS atcab_get_zone_size_ext(ATCADevice device, uint8_t zone, uint16_t slot, size_t* size);
@@ -269,6 +299,22 @@ ATCA_STATUS atcab_sha_hmac_ext(ATCADevice device, const uint8_t* data, size_t da
 ATCA_STATUS atcab_sign_base(uint8_t mode, uint16_t key_id, uint8_t* signature);
 ATCA_STATUS atcab_sign(uint16_t key_id, const uint8_t* msg, uint8_t* signature);
 ATCA_STATUS atcab_sign_ext(ATCADevice device, uint16_t key_id, const uint8_t* msg, uint8_t* signature);
+#if CALIB_ASYNC_EN && CALIB_SIGN_EN
+ATCA_STATUS atcab_sign_submit(calib_sign_async_t* job, uint16_t key_id, const uint8_t* msg,
+                              uint8_t* signature, calib_async_cb callback, void* cb_arg);
+ATCA_STATUS atcab_sign_submit_ext(ATCADevice device, calib_sign_async_t* job, uint16_t key_id, const uint8_t* msg,
+                                  uint8_t* signature, calib_async_cb callback, void* cb_arg);
+#define atcab_sign_poll                         calib_sign_poll
+#define atcab_sign_wait_msec                    calib_sign_wait_msec
+#if CALIB_POOL_EN
+#define atcab_pool_init                         calib_pool_init
+#define atcab_pool_release                      calib_pool_release
+#define atcab_pool_sign_submit                  calib_pool_sign_submit
+#define atcab_pool_sign_poll                    calib_pool_sign_poll
+#define atcab_pool_sign                         calib_pool_sign
+#define atcab_pool_device_index                 calib_pool_device_index
+#endif
+#endif
 ATCA_STATUS atcab_sign_internal(uint16_t key_id, bool is_invalidate, bool is_full_sn, uint8_t* signature);
 
 /* UpdateExtra command */
@@ -9,6 +9,38 @@
 #define ATCA_ATECC608_SUPPORT
 #define ATCA_I2C_ECC_ADDRESS 0x60
 
+/* Keep-awake sessions (atcab_session_begin/end); hal_get_time_ms() is in
+ * src/hal_pico_i2c.c */
+#define CALIB_SESSION_EN 1
+
+/* Non-blocking execution (calib_execute_submit/poll) for the TLS sign hooks */
+#define CALIB_ASYNC_EN 1
+
+/* Sleep each command's learned execution time, then poll finely */
+#define CALIB_ADAPTIVE_POLL_EN 1
+
+/* Config zone and public data slots are read from RAM after the first time */
+#define CALIB_ZONE_CACHE_EN 1
+
+/* Per-opcode command counts and phase times, dumped by the "atecc" CDC
+ * command; hal_get_time_us() is in src/hal_pico_i2c.c */
+#define CALIB_PROFILE_EN 1
+
+/* main.c probes 400 kHz and 1 MHz after init; hal_pico_i2c.c changes the
+ * clock on ATCA_HAL_CHANGE_BAUD */
+#define CALIB_I2C_SPEED_STEP_EN 1
+
+/* Sign dispatch across several devices (atcab_pool_sign) for boards with
+ * more than one ATECC608B; unused code is dropped at link time */
+#define CALIB_POOL_EN 1
+
+/* The device is used from both cores (init on core 0, TLS signs on core 1);
+ * the mutex and owner id come from src/hal_pico_i2c.c */
+#define ATCA_DEVICE_LOCK_EN 1
+
+/* Slice-by-4 CRC: 2 KB of tables in flash for every command and response */
+#define ATCA_CRC_SLICE4_EN 1
+
 /* \brief How long to wait after an initial wake failure for the POST to
  *         complete.
  * If Power-on self test (POST) is enabled, the self test will run on waking
@@ -141,6 +141,116 @@
 #define ATCA_HEAP
 #endif
 
+/** \def CALIB_SESSION_EN
+ * Enables keep-awake command sessions (atcab_session_begin/end): the device
+ * stays awake between the commands of a session and is idled once at the
+ * end. Requires hal_get_time_ms() from the platform HAL to track the
+ * device watchdog.
+ */
+#ifndef CALIB_SESSION_EN
+#define CALIB_SESSION_EN        (DEFAULT_DISABLED)
+#endif
+
+/** \def CALIB_ASYNC_EN
+ * Enables non-blocking command execution (calib_execute_submit/poll and
+ * calib_sign_submit/poll): the caller gets control back while the device
+ * executes and polls for the response when it suits it. Requires
+ * hal_get_time_ms() from the platform HAL.
+ */
+#ifndef CALIB_ASYNC_EN
+#define CALIB_ASYNC_EN          (DEFAULT_DISABLED)
+#endif
+
+/** \def CALIB_ADAPTIVE_POLL_EN
+ * Learns how long each opcode actually takes on this device (an average of
+ * the observed completion times) and sleeps that long before the first
+ * response read, then polls every ATCA_POLLING_FINE_TIME_USEC instead of
+ * sleeping ATCA_POLLING_INIT_TIME_MSEC and polling every
+ * ATCA_POLLING_FREQUENCY_TIME_MSEC. Has no effect with ATCA_NO_POLL.
+ */
+#ifndef CALIB_ADAPTIVE_POLL_EN
+#define CALIB_ADAPTIVE_POLL_EN  (DEFAULT_DISABLED)
+#endif
+
+/** \def CALIB_ZONE_CACHE_EN
+ * Keeps the 32 byte blocks read from the ATECC608 configuration zone, OTP
+ * zone and readable (not secret) data slots in the device context and serves
+ * later reads from RAM. Every command that can change the EEPROM (Write,
+ * Lock, counter increments, ...) empties the cache.
+ */
+#ifndef CALIB_ZONE_CACHE_EN
+#define CALIB_ZONE_CACHE_EN     (DEFAULT_DISABLED)
+#endif
+
+/** \def CALIB_PROFILE_EN
+ * Counts each opcode's commands, wake retries, busy polls, CRC failures and
+ * failures, and times its send, execution wait and response reads, readable
+ * through calib_get_stats(). Requires hal_get_time_us() from the platform
+ * HAL.
+ */
+#ifndef CALIB_PROFILE_EN
+#define CALIB_PROFILE_EN        (DEFAULT_DISABLED)
+#endif
+
+/** \def CALIB_POOL_EN
+ * Enables calib_pool_sign() and its submit/poll forms: up to
+ * ATCA_POOL_DEVICES_MAX devices, each with its own ATCADevice, sign in
+ * parallel and each sign goes to the least busy one. Requires
+ * CALIB_ASYNC_EN and hal_create_mutex() from the platform HAL.
+ */
+#ifndef CALIB_POOL_EN
+#define CALIB_POOL_EN           (DEFAULT_DISABLED)
+#endif
+
+/** \def CALIB_I2C_SPEED_STEP_EN
+ * Enables calib_i2c_speed_probe(): starting from the configured baud, the
+ * I2C clock is raised a step (400 kHz, then 1 MHz, up to ATCA_I2C_SPEED_MAX)
+ * after each successful Info read. A CRC error or a lost response at a
+ * raised clock drops it back a step for good. Requires ATCA_HAL_CHANGE_BAUD
+ * support in the I2C HAL.
+ */
+#ifndef CALIB_I2C_SPEED_STEP_EN
+#define CALIB_I2C_SPEED_STEP_EN (DEFAULT_DISABLED)
+#endif
+
+/** \def ATCA_I2C_SPEED_MAX
+ * Fastest I2C clock calib_i2c_speed_probe() tries, in Hz.
+ */
+#ifndef ATCA_I2C_SPEED_MAX
+#define ATCA_I2C_SPEED_MAX      1000000u
+#endif
+
+/** \def ATCA_DEVICE_LOCK_EN
+ * Serialises callers of one device across threads, tasks or cores: each
+ * command, session and multi-command operation holds the device through
+ * atca_device_acquire(), and waiters are served by priority. Requires
+ * hal_create_mutex(), hal_get_owner_id() and hal_owner_preempts() from the
+ * platform HAL.
+ */
+#ifndef ATCA_DEVICE_LOCK_EN
+#define ATCA_DEVICE_LOCK_EN     (DEFAULT_DISABLED)
+#endif
+
+/** \def ATCA_CRC_TABLE_EN
+ * Computes the packet CRC a byte at a time from a 512 byte constant table
+ * instead of a bit at a time. Disable for the smallest flash footprint.
+ */
+#ifndef ATCA_CRC_TABLE_EN
+#define ATCA_CRC_TABLE_EN       (DEFAULT_ENABLED)
+#endif
+
+/** \def ATCA_CRC_SLICE4_EN
+ * Computes the packet CRC four bytes at a time (slice-by-4). Adds three
+ * more 512 byte tables on top of ATCA_CRC_TABLE_EN.
+ */
+#ifndef ATCA_CRC_SLICE4_EN
+#define ATCA_CRC_SLICE4_EN      (DEFAULT_DISABLED)
+#endif
+
+#if ATCA_CRC_SLICE4_EN && !ATCA_CRC_TABLE_EN
+#error "ATCA_CRC_SLICE4_EN requires ATCA_CRC_TABLE_EN"
+#endif
+
 /** \def ATCA_UNUSED_VAR_CHECK
  * Enables removal of compiler warning due to unused variables
  */
@@ -104,6 +104,36 @@ ATCA_STATUS initATCADevice(ATCAIfaceCfg *cfg, ATCADevice ca_dev)
         return status;
     }
 
+#if CALIB_ADAPTIVE_POLL_EN
+    (void)memset(ca_dev->poll_opcode, 0, sizeof(ca_dev->poll_opcode));
+    (void)memset(ca_dev->poll_estimate_usec, 0, sizeof(ca_dev->poll_estimate_usec));
+#endif
+
+#if CALIB_ZONE_CACHE_EN
+    (void)memset(ca_dev->zone_cache, 0, sizeof(ca_dev->zone_cache));
+    ca_dev->zone_cache_next = 0;
+#endif
+
+#if CALIB_PROFILE_EN
+    (void)memset(ca_dev->profile, 0, sizeof(ca_dev->profile));
+#endif
+
+#if CALIB_I2C_SPEED_STEP_EN
+    ca_dev->i2c_baud_base = (ATCA_I2C_IFACE == cfg->iface_type) ? ATCA_IFACECFG_I2C_BAUD(cfg) : 0u;
+    ca_dev->i2c_baud_ceiling = ATCA_I2C_SPEED_MAX;
+#endif
+
+#if ATCA_DEVICE_LOCK_EN
+    ca_dev->lock_depth = 0;
+    (void)memset(ca_dev->lock_waiting, 0, sizeof(ca_dev->lock_waiting));
+    if (ATCA_SUCCESS != (status = hal_create_mutex(&ca_dev->lock_mutex, "atca_device_lock")))
+    {
+        ca_dev->lock_mutex = NULL;
+        (void)releaseATCAIface(&ca_dev->mIface);
+        return ATCA_TRACE(status, "hal_create_mutex - failed");
+    }
+#endif
+
     return ATCA_SUCCESS;
 }
 
@@ -134,7 +164,179 @@ ATCA_STATUS releaseATCADevice(ATCADevice ca_dev)
         ca_dev->session_cb = NULL;
     }
 
+    if (NULL != ca_dev->lock_mutex)
+    {
+        (void)hal_destroy_mutex(ca_dev->lock_mutex);
+        ca_dev->lock_mutex = NULL;
+    }
+
     return releaseATCAIface(&ca_dev->mIface);
 }
 
+/** \brief Whether a caller at the given priority must leave a free device to
+ *         a queued one: anyone waiting in a higher class, or in the same
+ *         class while the caller has not queued yet.
+ */
+static bool atca_device_outranked(ATCADevice dev, uint8_t priority, bool queued)
+{
+    bool outranked = (!queued && (0u < dev->lock_waiting[priority]));
+    uint8_t higher;
+
+    for (higher = priority + 1u; higher < (uint8_t)ATCA_PRIORITY_COUNT; higher++)
+    {
+        outranked = outranked || (0u < dev->lock_waiting[higher]);
+    }
+
+    return outranked;
+}
+
+/** \brief Takes the device for the calling thread, task or core until the
+ *         matching atca_device_relinquish(). Acquires nest for the holder.
+ *         While the device is held elsewhere the caller queues by priority
+ *         and retries every ATCA_DEVICE_LOCK_RETRY_MSEC (atca_delay_ms, so
+ *         it yields where the platform does); within a class the order is
+ *         not defined. A caller that has preempted the holder
+ *         (hal_owner_preempts(), e.g. an interrupt over the holding thread on
+ *         the same core) fails at once instead, since the holder cannot run
+ *         to relinquish until it returns. Without ATCA_DEVICE_LOCK_EN this
+ *         does nothing.
+ *
+ *  \param[in] dev       Device context
+ *  \param[in] priority  Queue class; the latency-critical caller uses
+ *                       ATCA_PRIORITY_URGENT
+ *  \return ATCA_SUCCESS once held, ATCA_TIMEOUT after
+ *          ATCA_DEVICE_LOCK_TIMEOUT_MSEC, ATCA_FUNC_FAIL when the caller has
+ *          preempted the holder, otherwise an error code.
+ */
+ATCA_STATUS atca_device_acquire(ATCADevice dev, ATCAPriority priority)
+{
+    ATCA_STATUS status = ATCA_EXECUTION_PENDING;
+    uint8_t prio = (uint8_t)priority;
+    uint32_t owner;
+    uint32_t start;
+    bool queued = false;
+
+    if ((NULL == dev) || (prio >= (uint8_t)ATCA_PRIORITY_COUNT))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "Invalid device or priority");
+    }
+
+    if (NULL == dev->lock_mutex)
+    {
+        return ATCA_SUCCESS;
+    }
+
+    owner = hal_get_owner_id();
+    start = hal_get_time_ms();
+
+    while (ATCA_EXECUTION_PENDING == status)
+    {
+        if (ATCA_SUCCESS != hal_lock_mutex(dev->lock_mutex))
+        {
+            return ATCA_TRACE(ATCA_GEN_FAIL, "hal_lock_mutex - failed");
+        }
+
+        if ((0u < dev->lock_depth) && (owner == dev->lock_owner))
+        {
+            dev->lock_depth++;
+            status = ATCA_SUCCESS;
+        }
+        else if ((0u == dev->lock_depth) && !atca_device_outranked(dev, prio, queued))
+        {
+            dev->lock_owner = owner;
+            dev->lock_depth = 1;
+            if (queued)
+            {
+                dev->lock_waiting[prio]--;
+            }
+            status = ATCA_SUCCESS;
+        }
+        else if ((0u < dev->lock_depth) && hal_owner_preempts(owner, dev->lock_owner))
+        {
+            /* The holder cannot run again until this caller returns */
+            if (queued)
+            {
+                dev->lock_waiting[prio]--;
+            }
+            status = ATCA_FUNC_FAIL;
+        }
+        else if (!queued)
+        {
+            dev->lock_waiting[prio]++;
+            queued = true;
+        }
+        else if ((hal_get_time_ms() - start) >= (uint32_t)ATCA_DEVICE_LOCK_TIMEOUT_MSEC)
+        {
+            dev->lock_waiting[prio]--;
+            status = ATCA_TIMEOUT;
+        }
+        else
+        {
+            /* Still held or outranked, try again later */
+        }
+
+        (void)hal_unlock_mutex(dev->lock_mutex);
+
+        if (ATCA_EXECUTION_PENDING == status)
+        {
+            atca_delay_ms(ATCA_DEVICE_LOCK_RETRY_MSEC);
+        }
+    }
+
+    if (ATCA_TIMEOUT == status)
+    {
+        (void)ATCA_TRACE(status, "atca_device_acquire - timed out");
+    }
+    else if (ATCA_FUNC_FAIL == status)
+    {
+        (void)ATCA_TRACE(status, "atca_device_acquire - held by a preempted owner");
+    }
+
+    return status;
+}
+
+/** \brief Ends one atca_device_acquire() of the holder; the device is free
+ *         once every nested acquire has been relinquished.
+ *
+ *  \param[in] dev  Device context
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atca_device_relinquish(ATCADevice dev)
+{
+    ATCA_STATUS status = ATCA_SUCCESS;
+
+    if (NULL == dev)
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (NULL == dev->lock_mutex)
+    {
+        return ATCA_SUCCESS;
+    }
+
+    if (ATCA_SUCCESS != hal_lock_mutex(dev->lock_mutex))
+    {
+        return ATCA_TRACE(ATCA_GEN_FAIL, "hal_lock_mutex - failed");
+    }
+
+    if ((0u == dev->lock_depth) || (hal_get_owner_id() != dev->lock_owner))
+    {
+        status = ATCA_FUNC_FAIL;
+    }
+    else
+    {
+        dev->lock_depth--;
+    }
+
+    (void)hal_unlock_mutex(dev->lock_mutex);
+
+    if (ATCA_SUCCESS != status)
+    {
+        (void)ATCA_TRACE(status, "Device is not held by the caller");
+    }
+
+    return status;
+}
+
 /** @} */
@@ -48,6 +48,61 @@ typedef enum
     ATCA_DEVICE_STATE_ACTIVE
 } ATCADeviceState;
 
+/** \brief Arbitration priority for atca_device_acquire(); waiters in a
+ *         higher class are always served first
+ */
+typedef enum
+{
+    ATCA_PRIORITY_BACKGROUND = 0,
+    ATCA_PRIORITY_NORMAL,
+    ATCA_PRIORITY_URGENT,
+    ATCA_PRIORITY_COUNT
+} ATCAPriority;
+
+/** \brief Opcodes whose execution time is learned per device
+ *         (CALIB_ADAPTIVE_POLL_EN); further opcodes use plain polling
+ */
+#define ATCA_POLL_ESTIMATE_COUNT    16
+
+/** \brief Number of 32 byte zone blocks cached per device
+ *         (CALIB_ZONE_CACHE_EN): the whole configuration zone plus four more
+ */
+#ifndef ATCA_ZONE_CACHE_BLOCKS
+#define ATCA_ZONE_CACHE_BLOCKS      8
+#endif
+
+/** \brief Opcodes profiled per device (CALIB_PROFILE_EN); further opcodes
+ *         are not counted. The ATECC608 has 24 commands.
+ */
+#ifndef ATCA_PROFILE_OPCODE_COUNT
+#define ATCA_PROFILE_OPCODE_COUNT   24
+#endif
+
+/** \brief Command counters and times of one opcode (CALIB_PROFILE_EN) */
+typedef struct
+{
+    uint8_t  opcode;                /**< 0 when the entry is unused */
+    uint32_t commands;
+    uint32_t failures;              /**< Commands that returned an error */
+    uint32_t wake_retries;          /**< Wake and send attempts after the first */
+    uint32_t polls;                 /**< Response reads that found the device still executing */
+    uint32_t crc_errors;            /**< Responses, or commands seen by the device, with a bad CRC */
+    uint64_t send_usec;             /**< Wake and command send */
+    uint64_t exec_usec;             /**< Waiting for the device to execute */
+    uint64_t receive_usec;          /**< Response reads, busy ones included */
+    uint32_t max_usec;              /**< Longest command, send to response */
+} atca_opcode_stats_t;
+
+/** \brief One cached 32 byte block of the configuration, OTP or data zone */
+typedef struct
+{
+    uint8_t valid;
+    uint8_t zone;
+    uint8_t slot;
+    uint8_t block;
+    uint8_t data[32];
+} atca_zone_cache_block_t;
+
 /** \brief Callback function to clean up the session context
  */
 typedef void (*ctx_cb)(void* ctx);
@@ -66,6 +121,31 @@ struct atca_device
     /* Session Management */
     void * session_ctx;
     ctx_cb session_cb;
+
+    /* Keep-awake command session (CALIB_SESSION_EN) */
+    uint8_t  awake_depth;               /**< Nesting of calib_session_begin calls */
+    uint32_t awake_since_msec;          /**< hal_get_time_ms() at the last wake */
+
+    /* Arbitration between callers (ATCA_DEVICE_LOCK_EN) */
+    void *   lock_mutex;                /**< Guards the fields below, NULL when arbitration is off */
+    uint32_t lock_owner;                /**< hal_get_owner_id() of the holder */
+    uint8_t  lock_depth;                /**< Nesting of the holder's acquires, 0 when free */
+    uint8_t  lock_waiting[ATCA_PRIORITY_COUNT]; /**< Callers queued per priority */
+
+    /* Learned execution times (CALIB_ADAPTIVE_POLL_EN) */
+    uint8_t  poll_opcode[ATCA_POLL_ESTIMATE_COUNT];         /**< Opcode of each estimate, 0 when unused */
+    uint32_t poll_estimate_usec[ATCA_POLL_ESTIMATE_COUNT];  /**< Average time to the response */
+
+    /* Zone reads served from RAM (CALIB_ZONE_CACHE_EN) */
+    atca_zone_cache_block_t zone_cache[ATCA_ZONE_CACHE_BLOCKS];
+    uint8_t                 zone_cache_next;                /**< Next entry to replace when full */
+
+    /* I2C clock stepping (CALIB_I2C_SPEED_STEP_EN) */
+    uint32_t i2c_baud_base;             /**< Configured baud, never stepped below */
+    uint32_t i2c_baud_ceiling;          /**< Fastest baud not yet seen to fail */
+
+    /* Per-opcode command profile (CALIB_PROFILE_EN) */
+    atca_opcode_stats_t profile[ATCA_PROFILE_OPCODE_COUNT];
 };
 
 typedef struct atca_device * ATCADevice;
@@ -79,6 +159,9 @@ ATCA_STATUS releaseATCADevice(ATCADevice ca_dev);
 
 ATCAIface atGetIFace(ATCADevice dev);
 
+ATCA_STATUS atca_device_acquire(ATCADevice dev, ATCAPriority priority);
+ATCA_STATUS atca_device_relinquish(ATCADevice dev);
+
 #ifdef __cplusplus
 }
 #endif
@@ -54,6 +54,9 @@ typedef int ATCA_STATUS;
 /** STATUS (0xD2): response status byte indicates parsing error(status byte = 0x03) */
 #define ATCA_PARSE_ERROR            (-46)
 
+/** STATUS (0xD3): response status byte indicates the watchdog would expire before the command completes (status byte = 0xEE) */
+#define ATCA_STATUS_WATCHDOG        (-45)
+
 /** STATUS (0xD4): response status byte indicates DEVICE did not receive data properly(status byte = 0xFF) */
 #define ATCA_STATUS_CRC             (-44)
 
@@ -66,6 +69,9 @@ typedef int ATCA_STATUS;
 /** STATUS (0xD7): response status byte is Self Test Error, chip in failure mode (status byte = 0x07) */
 #define ATCA_STATUS_SELFTEST_ERROR  (-41)
 
+/** STATUS (0xD8): command submitted with calib_execute_submit is still executing */
+#define ATCA_EXECUTION_PENDING      (-40)
+
 /** STATUS (0xE0): Function could not execute due to incorrect condition / state. */
 #define ATCA_FUNC_FAIL              (-32)
 
@@ -201,6 +201,213 @@ ATCA_STATUS calib_exit(ATCADevice device)
     return calib_idle(device);
 }
 
+#if CALIB_SESSION_EN
+/** \brief Opens a keep-awake session. Commands executed until the matching
+ *         calib_session_end leave the device awake instead of idling it
+ *         after each one, so a burst pays for a single wake. The device is
+ *         idled early (keeping TempKey) when its watchdog gets close.
+ *         Sessions nest.
+ *  \param[in] device     Device context pointer
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS calib_session_begin(ATCADevice device)
+{
+    ATCA_STATUS status;
+
+    if (NULL == device)
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (UINT8_MAX == device->awake_depth)
+    {
+        return ATCA_TRACE(ATCA_FUNC_FAIL, "Session nesting too deep");
+    }
+
+    // The session is also the caller's exclusive use of the device
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return status;
+    }
+
+    device->awake_depth++;
+    return ATCA_SUCCESS;
+}
+
+/** \brief Closes a keep-awake session; the outermost end idles the device.
+ *  \param[in] device     Device context pointer
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS calib_session_end(ATCADevice device)
+{
+    ATCA_STATUS status = ATCA_SUCCESS;
+
+    if (NULL == device)
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (0u == device->awake_depth)
+    {
+        return ATCA_TRACE(ATCA_FUNC_FAIL, "No session open");
+    }
+
+    device->awake_depth--;
+    if ((0u == device->awake_depth) && ((uint8_t)ATCA_DEVICE_STATE_ACTIVE == device->device_state))
+    {
+        status = calib_idle(device);
+        device->device_state = (uint8_t)ATCA_DEVICE_STATE_IDLE;
+    }
+
+    (void)atca_device_relinquish(device);
+    return status;
+}
+#endif
+
+#if CALIB_I2C_SPEED_STEP_EN
+/* Standard and fast mode, then fast mode plus (the ATECC608 maximum) */
+static const uint32_t calib_i2c_speed_steps[] = { 100000u, 400000u, 1000000u };
+
+/** \brief Switches the bus clock; the new baud is also kept in the
+ *         configuration so wakes return to it.
+ */
+static ATCA_STATUS calib_i2c_speed_set(ATCADevice device, uint32_t baud)
+{
+    ATCAIface iface = atGetIFace(device);
+
+    ATCA_IFACECFG_I2C_BAUD(iface->mIfaceCFG) = baud;
+    return atcontrol(iface, (uint8_t)ATCA_HAL_CHANGE_BAUD, &baud, sizeof(baud));
+}
+
+/** \brief Drops the bus clock a step after a transfer failed at a raised
+ *         clock, and caps later probes below the failing step. Called from
+ *         the execution path with the device held.
+ *
+ * \param[in] device  Device context pointer
+ * \param[in] status  Result of the command
+ */
+void calib_i2c_speed_fallback(ATCADevice device, ATCA_STATUS status)
+{
+    ATCAIface iface = atGetIFace(device);
+    uint32_t baud;
+    uint32_t lower;
+    size_t i;
+
+    if ((ATCA_I2C_IFACE != iface->mIfaceCFG->iface_type) || atca_iface_is_kit(iface))
+    {
+        return;
+    }
+
+    switch (status)
+    {
+        case ATCA_STATUS_CRC:
+        case ATCA_RX_CRC_ERROR:
+        case ATCA_RX_FAIL:
+        case ATCA_RX_NO_RESPONSE:
+        case ATCA_COMM_FAIL:
+        case ATCA_TX_FAIL:
+            break;
+        default:
+            return;
+    }
+
+    baud = ATCA_IFACECFG_I2C_BAUD(iface->mIfaceCFG);
+    if (baud <= device->i2c_baud_base)
+    {
+        return;
+    }
+
+    lower = device->i2c_baud_base;
+    for (i = 0; i < sizeof(calib_i2c_speed_steps) / sizeof(calib_i2c_speed_steps[0]); i++)
+    {
+        if ((calib_i2c_speed_steps[i] > lower) && (calib_i2c_speed_steps[i] < baud))
+        {
+            lower = calib_i2c_speed_steps[i];
+        }
+    }
+
+    device->i2c_baud_ceiling = lower;
+    (void)calib_i2c_speed_set(device, lower);
+}
+
+/** \brief Raises the I2C clock as far as the device and bus follow it. An
+ *         Info read is made at the configured baud and after each step up
+ *         to the next of 400 kHz and 1 MHz; the first step that fails is
+ *         undone and becomes the ceiling. Call once after init, with no
+ *         other traffic on the device.
+ *
+ *  \param[in]  device  Device context pointer
+ *  \param[out] baud    Receives the baud in use afterwards. May be NULL.
+ *
+ *  \return ATCA_SUCCESS when the device answered at the configured baud,
+ *          otherwise an error code.
+ */
+ATCA_STATUS calib_i2c_speed_probe(ATCADevice device, uint32_t* baud)
+{
+    ATCA_STATUS status;
+    ATCAIface iface;
+    uint8_t revision[4];
+    size_t i;
+
+    if (NULL == device)
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    iface = atGetIFace(device);
+    if ((ATCA_I2C_IFACE != iface->mIfaceCFG->iface_type) || atca_iface_is_kit(iface))
+    {
+        return ATCA_TRACE(ATCA_UNIMPLEMENTED, "Not an I2C device");
+    }
+
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return status;
+    }
+
+    do
+    {
+        if (ATCA_SUCCESS != (status = calib_info(device, revision)))
+        {
+            (void)ATCA_TRACE(status, "Info at the configured baud - failed");
+            break;
+        }
+
+        for (i = 0; i < sizeof(calib_i2c_speed_steps) / sizeof(calib_i2c_speed_steps[0]); i++)
+        {
+            uint32_t step = calib_i2c_speed_steps[i];
+            uint32_t current = ATCA_IFACECFG_I2C_BAUD(iface->mIfaceCFG);
+
+            if ((step <= current) || (step > device->i2c_baud_ceiling))
+            {
+                continue;
+            }
+
+            if (ATCA_SUCCESS != calib_i2c_speed_set(device, step))
+            {
+                // The HAL cannot change the clock, stay where we are
+                (void)calib_i2c_speed_set(device, current);
+                break;
+            }
+
+            // A failure here has already been stepped back by the execution path
+            if (ATCA_SUCCESS != calib_info(device, revision))
+            {
+                break;
+            }
+        }
+    } while (false);
+
+    if (NULL != baud)
+    {
+        *baud = ATCA_IFACECFG_I2C_BAUD(iface->mIfaceCFG);
+    }
+
+    (void)atca_device_relinquish(device);
+    return status;
+}
+#endif
+
 
 /** \brief Compute the address given the zone, slot, block, and offset
  *  \param[in] zone   Zone to get address from. Config(0), OTP(1), or
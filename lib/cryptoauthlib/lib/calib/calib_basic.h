@@ -24,6 +24,32 @@ ATCA_STATUS calib_wakeup(ATCADevice device);
 ATCA_STATUS calib_idle(ATCADevice device);
 ATCA_STATUS calib_sleep(ATCADevice device);
 ATCA_STATUS calib_exit(ATCADevice device);
+#if CALIB_SESSION_EN
+ATCA_STATUS calib_session_begin(ATCADevice device);
+ATCA_STATUS calib_session_end(ATCADevice device);
+#endif
+#if CALIB_ZONE_CACHE_EN
+/** \brief Bytes needed by calib_zone_cache_export() */
+#define CALIB_ZONE_CACHE_IMAGE_SIZE (sizeof(atca_zone_cache_block_t) * ATCA_ZONE_CACHE_BLOCKS + 2u)
+
+void calib_zone_cache_invalidate(ATCADevice device);
+ATCA_STATUS calib_zone_cache_export(ATCADevice device, uint8_t* image, size_t* image_size);
+ATCA_STATUS calib_zone_cache_import(ATCADevice device, const uint8_t* image, size_t image_size);
+/* Used by calib_read_zone and the command execution path */
+bool calib_zone_cache_read(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint8_t* data, uint8_t len);
+void calib_zone_cache_fill(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block, const uint8_t* data);
+bool calib_zone_cache_allowed(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t len);
+void calib_zone_cache_command(ATCADevice device, uint8_t opcode, uint8_t mode);
+#endif
+#if CALIB_PROFILE_EN
+ATCA_STATUS calib_get_stats(ATCADevice device, atca_opcode_stats_t* stats, size_t* count);
+ATCA_STATUS calib_reset_stats(ATCADevice device);
+#endif
+#if CALIB_I2C_SPEED_STEP_EN
+ATCA_STATUS calib_i2c_speed_probe(ATCADevice device, uint32_t* baud);
+/* Used by the command execution path */
+void calib_i2c_speed_fallback(ATCADevice device, ATCA_STATUS status);
+#endif
 ATCA_STATUS calib_get_addr(uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint16_t* addr);
 ATCA_STATUS calib_get_zone_size(ATCADevice device, uint8_t zone, uint16_t slot, size_t* size);
 
@@ -273,6 +299,57 @@ ATCA_STATUS calib_sha_hmac(ATCADevice device, const uint8_t * data, size_t data_
 #if CALIB_SIGN_EN
 ATCA_STATUS calib_sign_base(ATCADevice device, uint8_t mode, uint16_t key_id, uint8_t *signature);
 ATCA_STATUS calib_sign(ATCADevice device, uint16_t key_id, const uint8_t *msg, uint8_t *signature);
+#if CALIB_ASYNC_EN
+/** \brief State of a sign submitted with calib_sign_submit(): the commands
+ *         of calib_sign() issued one after another from calib_sign_poll()
+ */
+typedef struct
+{
+    calib_async_t  exec;
+    ATCAPacket     packet;
+    calib_async_cb callback;    //!< Called once the signature is ready or failed
+    void*          cb_arg;
+    uint8_t*       signature;
+    uint16_t       key_id;
+    uint8_t        msg[ATCA_SHA256_DIGEST_SIZE];
+    uint8_t        step;
+    ATCA_STATUS    status;      //!< ATCA_EXECUTION_PENDING until complete
+} calib_sign_async_t;
+
+ATCA_STATUS calib_sign_submit(ATCADevice device, calib_sign_async_t* job, uint16_t key_id, const uint8_t *msg,
+                              uint8_t *signature, calib_async_cb callback, void* cb_arg);
+ATCA_STATUS calib_sign_poll(calib_sign_async_t* job);
+uint32_t calib_sign_wait_msec(const calib_sign_async_t* job);
+
+#if CALIB_POOL_EN
+/** \brief Most devices one calib_pool_t dispatches to */
+#ifndef ATCA_POOL_DEVICES_MAX
+#define ATCA_POOL_DEVICES_MAX       4
+#endif
+
+/** \brief Devices that sign in parallel: each sign goes to the least busy
+ *         one (CALIB_POOL_EN)
+ */
+typedef struct
+{
+    ATCADevice          devices[ATCA_POOL_DEVICES_MAX];
+    calib_sign_async_t* running[ATCA_POOL_DEVICES_MAX];   //!< Sign in progress on each device, NULL when free
+    uint32_t            signs[ATCA_POOL_DEVICES_MAX];     //!< Signs dispatched to each device
+    uint32_t            failures[ATCA_POOL_DEVICES_MAX];  //!< Signs that completed with an error
+    uint8_t             count;
+    void*               mutex;                            //!< Guards the fields above
+} calib_pool_t;
+
+ATCA_STATUS calib_pool_init(calib_pool_t* pool, const ATCADevice* devices, uint8_t count);
+ATCA_STATUS calib_pool_release(calib_pool_t* pool);
+ATCA_STATUS calib_pool_sign_submit(calib_pool_t* pool, calib_sign_async_t* job, uint16_t key_id, const uint8_t *msg,
+                                   uint8_t *signature, calib_async_cb callback, void* cb_arg);
+ATCA_STATUS calib_pool_sign_poll(calib_pool_t* pool, calib_sign_async_t* job);
+ATCA_STATUS calib_pool_sign(calib_pool_t* pool, uint16_t key_id, const uint8_t *msg, uint8_t *signature,
+                            uint8_t* device_index);
+int calib_pool_device_index(const calib_pool_t* pool, const calib_sign_async_t* job);
+#endif
+#endif
 #endif
 #if CALIB_SIGN_EN || CALIB_SIGN_CA2_EN
 ATCA_STATUS calib_sign_ext(ATCADevice device, uint16_t key_id, const uint8_t *msg, uint8_t *signature);
@@ -362,8 +439,30 @@ ATCA_STATUS calib_ca2_write_enc(ATCADevice device, uint16_t slot, uint8_t* data,
 #define atcab_wakeup()                          calib_wakeup(g_atcab_device_ptr)
 #define atcab_idle()                            calib_idle(g_atcab_device_ptr)
 #define atcab_sleep()                           calib_sleep(g_atcab_device_ptr)
+#define atcab_session_begin()                   calib_session_begin(g_atcab_device_ptr)
+#define atcab_session_begin_ext                 calib_session_begin
+#define atcab_session_end()                     calib_session_end(g_atcab_device_ptr)
+#define atcab_session_end_ext                   calib_session_end
 #define atcab_get_zone_size(...)                calib_get_zone_size(g_atcab_device_ptr, __VA_ARGS__)
 #define atcab_get_zone_size_ext                 calib_get_zone_size
+#if CALIB_ZONE_CACHE_EN
+#define atcab_zone_cache_invalidate()           calib_zone_cache_invalidate(g_atcab_device_ptr)
+#define atcab_zone_cache_invalidate_ext         calib_zone_cache_invalidate
+#define atcab_zone_cache_export(...)            calib_zone_cache_export(g_atcab_device_ptr, __VA_ARGS__)
+#define atcab_zone_cache_export_ext             calib_zone_cache_export
+#define atcab_zone_cache_import(...)            calib_zone_cache_import(g_atcab_device_ptr, __VA_ARGS__)
+#define atcab_zone_cache_import_ext             calib_zone_cache_import
+#endif
+#if CALIB_PROFILE_EN
+#define atcab_get_stats(...)                    calib_get_stats(g_atcab_device_ptr, __VA_ARGS__)
+#define atcab_get_stats_ext                     calib_get_stats
+#define atcab_reset_stats()                     calib_reset_stats(g_atcab_device_ptr)
+#define atcab_reset_stats_ext                   calib_reset_stats
+#endif
+#if CALIB_I2C_SPEED_STEP_EN
+#define atcab_i2c_speed_probe(...)              calib_i2c_speed_probe(g_atcab_device_ptr, __VA_ARGS__)
+#define atcab_i2c_speed_probe_ext               calib_i2c_speed_probe
+#endif
 
 
 // AES command functions
@@ -554,6 +653,22 @@ ATCA_STATUS calib_ca2_write_enc(ATCADevice device, uint16_t slot, uint8_t* data,
 #define atcab_sign_ext                          calib_sign_ext
 #endif
 
+#if CALIB_ASYNC_EN && CALIB_SIGN_EN
+#define atcab_sign_submit(...)                  calib_sign_submit(g_atcab_device_ptr, __VA_ARGS__)
+#define atcab_sign_submit_ext                   calib_sign_submit
+#define atcab_sign_poll                         calib_sign_poll
+#define atcab_sign_wait_msec                    calib_sign_wait_msec
+#endif
+
+#if CALIB_POOL_EN && CALIB_ASYNC_EN && CALIB_SIGN_EN
+#define atcab_pool_init                         calib_pool_init
+#define atcab_pool_release                      calib_pool_release
+#define atcab_pool_sign_submit                  calib_pool_sign_submit
+#define atcab_pool_sign_poll                    calib_pool_sign_poll
+#define atcab_pool_sign                         calib_pool_sign
+#define atcab_pool_device_index                 calib_pool_device_index
+#endif
+
 #define atcab_sign_internal(...)                calib_sign_internal(g_atcab_device_ptr, __VA_ARGS__)
 
 // UpdateExtra command functions
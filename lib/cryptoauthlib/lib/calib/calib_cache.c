@@ -0,0 +1,309 @@
+/**
+ * \file
+ * \brief Zone cache: 32 byte blocks of the configuration, OTP and data zones
+ *        kept in the device context so repeated reads skip the bus.
+ *
+ * Blocks are cached only for the ATECC608, and data zone blocks only for
+ * slots whose cached SlotConfig is neither secret nor encrypted-read, so
+ * cached data is always the plain EEPROM content. The device can change
+ * that content only through the commands listed in
+ * calib_zone_cache_command(), which empty the cache before they are sent.
+ *
+ * \copyright (c) 2015-2020 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip software
+ * and any derivatives exclusively with Microchip products. It is your
+ * responsibility to comply with third party license terms applicable to your
+ * use of third party software (including open source software) that may
+ * accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+ * PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT,
+ * SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE
+ * OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF
+ * MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE
+ * FORESEEABLE. TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL
+ * LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED
+ * THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR
+ * THIS SOFTWARE.
+ */
+
+#include "cryptoauthlib.h"
+
+#if CALIB_ZONE_CACHE_EN
+
+/** \brief Finds the cached block for a zone address.
+ *
+ * \return The entry, or NULL when the block is not cached.
+ */
+static const atca_zone_cache_block_t* calib_zone_cache_find(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block)
+{
+    size_t i;
+
+    for (i = 0; i < (size_t)ATCA_ZONE_CACHE_BLOCKS; i++)
+    {
+        const atca_zone_cache_block_t* entry = &device->zone_cache[i];
+
+        if ((0u != entry->valid) && (entry->zone == zone) && (entry->slot == (uint8_t)slot) && (entry->block == block))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/** \brief Serves a Read from the cache. The caller holds the device.
+ *
+ * \param[in]  device  Device context pointer
+ * \param[in]  zone    ATCA_ZONE_CONFIG, ATCA_ZONE_OTP or ATCA_ZONE_DATA
+ * \param[in]  slot    Slot number for the data zone, ignored otherwise
+ * \param[in]  block   32 byte block index within the zone or slot
+ * \param[in]  offset  4 byte word index within the block, for 4 byte reads
+ * \param[out] data    Receives the data
+ * \param[in]  len     4 or 32
+ *
+ * \return true when the data came from the cache.
+ */
+bool calib_zone_cache_read(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint8_t* data, uint8_t len)
+{
+    const atca_zone_cache_block_t* entry;
+    size_t start = (len == ATCA_WORD_SIZE) ? ((size_t)offset * ATCA_WORD_SIZE) : 0u;
+
+    if (ATCA_ZONE_DATA != zone)
+    {
+        slot = 0;
+    }
+
+    if ((start + len > ATCA_BLOCK_SIZE) || (NULL == (entry = calib_zone_cache_find(device, zone, slot, block))))
+    {
+        return false;
+    }
+
+    (void)memcpy(data, &entry->data[start], len);
+    return true;
+}
+
+/** \brief Stores a block read from the device. The caller holds the device
+ *         and has checked calib_zone_cache_allowed().
+ */
+void calib_zone_cache_fill(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block, const uint8_t* data)
+{
+    atca_zone_cache_block_t* entry;
+
+    if (ATCA_ZONE_DATA != zone)
+    {
+        slot = 0;
+    }
+
+    if (NULL != calib_zone_cache_find(device, zone, slot, block))
+    {
+        return;
+    }
+
+    entry = &device->zone_cache[device->zone_cache_next];
+    device->zone_cache_next = (uint8_t)((device->zone_cache_next + 1u) % (uint8_t)ATCA_ZONE_CACHE_BLOCKS);
+
+    entry->zone = zone;
+    entry->slot = (uint8_t)slot;
+    entry->block = block;
+    (void)memcpy(entry->data, data, ATCA_BLOCK_SIZE);
+    entry->valid = 1;
+}
+
+/** \brief Whether a Read may be served from (and stored into) the cache. The
+ *         caller holds the device.
+ *
+ * Configuration and OTP zone reads of either size qualify: both zones are
+ * whole blocks, so a word read is widened to its block. Data zone reads
+ * qualify only as whole blocks and only once the slot's SlotConfig is cached
+ * and shows it is read in the clear.
+ */
+bool calib_zone_cache_allowed(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t len)
+{
+    uint8_t slot_config[ATCA_WORD_SIZE];
+    size_t config_offset;
+
+    if (ATECC608 != device->mIface.mIfaceCFG->devtype)
+    {
+        return false;
+    }
+
+    if ((ATCA_ZONE_CONFIG == zone) || (ATCA_ZONE_OTP == zone))
+    {
+        return true;
+    }
+
+    if ((ATCA_ZONE_DATA != zone) || (ATCA_BLOCK_SIZE != len) || (slot > 15u))
+    {
+        return false;
+    }
+
+    config_offset = ATCA_SLOT_CONFIG_OFFSET((size_t)slot);
+    if (!calib_zone_cache_read(device, ATCA_ZONE_CONFIG, 0, (uint8_t)(config_offset / ATCA_BLOCK_SIZE),
+                               (uint8_t)((config_offset % ATCA_BLOCK_SIZE) / ATCA_WORD_SIZE), slot_config, ATCA_WORD_SIZE))
+    {
+        return false;
+    }
+
+    return 0u == (slot_config[config_offset % ATCA_WORD_SIZE] & (ATCA_SLOT_CONFIG_IS_SECRET_MASK | ATCA_SLOT_CONFIG_ENC_READ_MASK));
+}
+
+/** \brief Empties the cache ahead of a command that can change the EEPROM.
+ *         Called from the execution path with the device held.
+ *
+ * \param[in] device  Device context pointer
+ * \param[in] opcode  Command opcode
+ * \param[in] mode    Command mode (param1)
+ */
+void calib_zone_cache_command(ATCADevice device, uint8_t opcode, uint8_t mode)
+{
+    bool writes = false;
+
+    switch (opcode)
+    {
+        case ATCA_WRITE:
+        case ATCA_LOCK:
+        case ATCA_UPDATE_EXTRA:
+        case ATCA_PRIVWRITE:
+        case ATCA_DERIVE_KEY:
+        case ATCA_SECUREBOOT:
+            writes = true;
+            break;
+        case ATCA_COUNTER:
+            // The ATECC608 keeps its counters in the configuration zone
+            writes = (COUNTER_MODE_INCREMENT == mode);
+            break;
+        case ATCA_GENKEY:
+            writes = (0u != (mode & GENKEY_MODE_PRIVATE));
+            break;
+        case ATCA_ECDH:
+            writes = (ECDH_MODE_COPY_EEPROM_SLOT == (mode & ECDH_MODE_COPY_MASK));
+            break;
+        case ATCA_KDF:
+            writes = (KDF_MODE_TARGET_SLOT == (mode & KDF_MODE_TARGET_MASK));
+            break;
+        case ATCA_VERIFY:
+            // Validate and Invalidate rewrite the validity bits of the public key slot
+            writes = (VERIFY_MODE_VALIDATE == (mode & VERIFY_MODE_MASK) ||
+                      VERIFY_MODE_INVALIDATE == (mode & VERIFY_MODE_MASK));
+            break;
+        default:
+            break;
+    }
+
+    if (writes)
+    {
+        (void)memset(device->zone_cache, 0, sizeof(device->zone_cache));
+        device->zone_cache_next = 0;
+    }
+}
+
+/** \brief Drops every cached block, e.g. after the device was changed by
+ *         another bus master.
+ *
+ * \param[in] device  Device context pointer
+ */
+void calib_zone_cache_invalidate(ATCADevice device)
+{
+    if ((NULL == device) || (ATCA_SUCCESS != atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return;
+    }
+
+    (void)memset(device->zone_cache, 0, sizeof(device->zone_cache));
+    device->zone_cache_next = 0;
+
+    (void)atca_device_relinquish(device);
+}
+
+/** \brief Copies the cache into an image the application can persist (for
+ *         example across warm boots) and restore with
+ *         calib_zone_cache_import(). The image ends in a CRC.
+ *
+ * \param[in]     device      Device context pointer
+ * \param[out]    image       Receives the image
+ * \param[in,out] image_size  As input, the size of image. As output, the
+ *                            bytes written (CALIB_ZONE_CACHE_IMAGE_SIZE).
+ *
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS calib_zone_cache_export(ATCADevice device, uint8_t* image, size_t* image_size)
+{
+    ATCA_STATUS status;
+    size_t length = sizeof(device->zone_cache);
+
+    if ((NULL == device) || (NULL == image) || (NULL == image_size))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (*image_size < CALIB_ZONE_CACHE_IMAGE_SIZE)
+    {
+        return ATCA_TRACE(ATCA_SMALL_BUFFER, "Image buffer too small");
+    }
+
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
+    }
+
+    (void)memcpy(image, device->zone_cache, length);
+    atCRC(length, image, &image[length]);
+    *image_size = CALIB_ZONE_CACHE_IMAGE_SIZE;
+
+    (void)atca_device_relinquish(device);
+
+    return ATCA_SUCCESS;
+}
+
+/** \brief Restores an image from calib_zone_cache_export(). The image must
+ *         come from this device: the cache is not re-read to check it.
+ *
+ * \param[in] device      Device context pointer
+ * \param[in] image       Image to restore
+ * \param[in] image_size  Size of image
+ *
+ * \return ATCA_SUCCESS on success, ATCA_RX_CRC_ERROR for a damaged image,
+ *         otherwise an error code.
+ */
+ATCA_STATUS calib_zone_cache_import(ATCADevice device, const uint8_t* image, size_t image_size)
+{
+    ATCA_STATUS status;
+    size_t length = sizeof(device->zone_cache);
+    uint8_t crc[ATCA_CRC_SIZE];
+
+    if ((NULL == device) || (NULL == image))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (CALIB_ZONE_CACHE_IMAGE_SIZE != image_size)
+    {
+        return ATCA_TRACE(ATCA_INVALID_SIZE, "Invalid image size");
+    }
+
+    atCRC(length, image, crc);
+    if ((crc[0] != image[length]) || (crc[1] != image[length + 1u]))
+    {
+        return ATCA_TRACE(ATCA_RX_CRC_ERROR, "Zone cache image damaged");
+    }
+
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
+    }
+
+    (void)memcpy(device->zone_cache, image, length);
+    device->zone_cache_next = 0;
+
+    (void)atca_device_relinquish(device);
+
+    return ATCA_SUCCESS;
+}
+
+#endif  /* CALIB_ZONE_CACHE_EN */
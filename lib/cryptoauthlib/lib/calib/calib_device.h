@@ -162,6 +162,7 @@ typedef struct ATCA_PACKED atecc608_config_s
 #define ATCA_CHIP_MODE_CLK_DIV(v)               (ATCA_CHIP_MODE_CLK_DIV_MASK & ((v) << ATCA_CHIP_MODE_CLK_DIV_SHIFT))
 
 /* General Purpose Slot Config (Not ECC Private Keys) */
+#define ATCA_SLOT_CONFIG_OFFSET(x)              (20UL + (x) * 2u)
 #define ATCA_SLOT_CONFIG_READKEY_SHIFT          (0)
 #define ATCA_SLOT_CONFIG_READKEY_MASK           (0x0Fu << ATCA_SLOT_CONFIG_READKEY_SHIFT)
 #define ATCA_SLOT_CONFIG_READKEY(v)             (ATCA_SLOT_CONFIG_READKEY_MASK & ((v) << ATCA_SLOT_CONFIG_READKEY_SHIFT))
@@ -455,101 +455,523 @@ ATCA_STATUS calib_execute_receive(ATCADevice device, uint8_t device_address, uin
     return status;
 }
 
-/** \brief Wakes up device, sends the packet, waits for command completion,
- *         receives response, and puts the device into the idle state.
+#if CALIB_SESSION_EN
+/** \brief Idles a device held awake by a session once its watchdog is too
+ *         close to expiry for another command. Idle restarts the watchdog
+ *         and keeps TempKey and the other volatile state, so a multi-command
+ *         operation (Nonce then Sign) survives it.
  *
- * \param[in,out] packet  As input, the packet to be sent. As output, the
- *                       data buffer in the packet structure will contain the
- *                       response.
- * \param[in]    device  CryptoAuthentication device to send the command to.
+ * \param[in] device  Device context pointer
+ */
+static void calib_session_refresh(ATCADevice device)
+{
+    if ((0u == device->awake_depth) || ((uint8_t)ATCA_DEVICE_STATE_ACTIVE != device->device_state))
+    {
+        return;
+    }
+
+    if ((hal_get_time_ms() - device->awake_since_msec) >= (uint32_t)ATCA_SESSION_WATCHDOG_MSEC)
+    {
+        (void)calib_idle(device);
+        device->device_state = (uint8_t)ATCA_DEVICE_STATE_IDLE;
+    }
+}
+#endif
+
+/** \brief When to read a command's response */
+typedef struct
+{
+    uint32_t wait_usec;         //!< Initial wait (execution time when not polling)
+    uint32_t poll_usec;         //!< Interval between reads while the device NAKs
+    uint32_t max_delay_count;   //!< Number of polling retries after the first read
+    bool     adaptive;          //!< Completion time feeds the opcode's estimate
+} calib_timing_t;
+
+#if CALIB_ADAPTIVE_POLL_EN && !defined(ATCA_NO_POLL)
+/* Weight of a new observation in the execution time average: 1/8 */
+#define CALIB_POLL_EWMA_SHIFT   3u
+
+/** \brief Finds (or claims) the learned execution time of an opcode.
+ *
+ * \param[in] device  Device context pointer
+ * \param[in] opcode  Command opcode
+ *
+ * \return Index into the device's estimates, or -1 when they are all taken.
+ */
+static int calib_poll_slot(ATCADevice device, uint8_t opcode)
+{
+    int slot;
+
+    for (slot = 0; slot < ATCA_POLL_ESTIMATE_COUNT; slot++)
+    {
+        if (device->poll_opcode[slot] == opcode)
+        {
+            return slot;
+        }
+        if (0u == device->poll_opcode[slot])
+        {
+            device->poll_opcode[slot] = opcode;
+            device->poll_estimate_usec[slot] = 0;
+            return slot;
+        }
+    }
+
+    return -1;
+}
+
+/** \brief Folds a completed command into its opcode's execution time.
+ *
+ * A response on the first read only bounds the execution time from above,
+ * so it nudges the estimate half a polling interval down; otherwise the
+ * command finished within the last interval slept. Either way the average
+ * settles on the shortest wait that the device answers.
+ *
+ * \param[in] device     Device context pointer
+ * \param[in] opcode     Command opcode
+ * \param[in] wait_usec  Initial wait that was used
+ * \param[in] polls      Reads that found the device still executing
+ * \param[in] done_usec  Time from the send to the successful read
+ */
+static void calib_poll_learn(ATCADevice device, uint8_t opcode, uint32_t wait_usec, uint32_t polls, uint32_t done_usec)
+{
+    int slot = calib_poll_slot(device, opcode);
+    uint32_t sample;
+
+    if (0 > slot)
+    {
+        return;
+    }
+
+    if (0u == polls)
+    {
+        sample = (wait_usec > (ATCA_POLLING_FINE_TIME_USEC / 2u)) ? (wait_usec - (ATCA_POLLING_FINE_TIME_USEC / 2u)) : 0u;
+    }
+    else
+    {
+        sample = done_usec;
+    }
+
+    if (0u == device->poll_estimate_usec[slot])
+    {
+        device->poll_estimate_usec[slot] = sample;
+    }
+    else
+    {
+        device->poll_estimate_usec[slot] = device->poll_estimate_usec[slot]
+                                           - (device->poll_estimate_usec[slot] >> CALIB_POLL_EWMA_SHIFT)
+                                           + (sample >> CALIB_POLL_EWMA_SHIFT);
+    }
+}
+#endif
+
+#if CALIB_PROFILE_EN
+/** \brief Adds a finished command to its opcode's counters. Opcodes beyond
+ *         ATCA_PROFILE_OPCODE_COUNT are not counted.
+ *
+ * \param[in] device   Device context pointer
+ * \param[in] opcode   Command opcode
+ * \param[in] status   Result of the command
+ * \param[in] profile  Phase times of the command
+ */
+static void calib_profile_record(ATCADevice device, uint8_t opcode, ATCA_STATUS status, const calib_profile_t* profile)
+{
+    uint32_t total_usec = hal_get_time_us() - profile->start_usec;
+    atca_opcode_stats_t* entry = NULL;
+    size_t i;
+
+    for (i = 0; i < (size_t)ATCA_PROFILE_OPCODE_COUNT; i++)
+    {
+        if ((device->profile[i].opcode == opcode) || (0u == device->profile[i].opcode))
+        {
+            entry = &device->profile[i];
+            break;
+        }
+    }
+
+    if (NULL == entry)
+    {
+        return;
+    }
+
+    entry->opcode = opcode;
+    entry->commands++;
+    entry->wake_retries += (profile->attempts > 1u) ? (profile->attempts - 1u) : 0u;
+    entry->polls += profile->polls;
+    if (ATCA_SUCCESS != status)
+    {
+        entry->failures++;
+    }
+    if ((ATCA_RX_CRC_ERROR == status) || (ATCA_STATUS_CRC == status))
+    {
+        entry->crc_errors++;
+    }
+
+    // Whatever is not the send or a read was spent waiting for the device
+    entry->send_usec += profile->send_usec;
+    entry->receive_usec += profile->receive_usec;
+    if (total_usec > (profile->send_usec + profile->receive_usec))
+    {
+        entry->exec_usec += total_usec - profile->send_usec - profile->receive_usec;
+    }
+    if (total_usec > entry->max_usec)
+    {
+        entry->max_usec = total_usec;
+    }
+}
+
+/** \brief Copies the per-opcode command profile of a device.
+ *
+ * \param[in]     device  Device context pointer
+ * \param[out]    stats   Receives the entries in the order opcodes were
+ *                        first executed
+ * \param[in,out] count   As input, the number of entries stats can hold.
+ *                        As output, the number written.
  *
  * \return ATCA_SUCCESS on success, otherwise an error code.
  */
-ATCA_STATUS calib_execute_command(ATCAPacket* packet, ATCADevice device)
+ATCA_STATUS calib_get_stats(ATCADevice device, atca_opcode_stats_t* stats, size_t* count)
 {
     ATCA_STATUS status;
-    uint32_t execution_or_wait_time;
-    uint32_t max_delay_count;
-    uint16_t rxsize;
-    uint8_t device_address = atcab_get_device_address(device);
-    int32_t retries;
+    size_t used = 0;
 
-    do
+    if ((NULL == device) || (NULL == stats) || (NULL == count))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
+    }
+
+    while ((used < *count) && (used < (size_t)ATCA_PROFILE_OPCODE_COUNT) && (0u != device->profile[used].opcode))
+    {
+        stats[used] = device->profile[used];
+        used++;
+    }
+    *count = used;
+
+    (void)atca_device_relinquish(device);
+    return ATCA_SUCCESS;
+}
+
+/** \brief Clears the per-opcode command profile of a device.
+ *
+ * \param[in] device  Device context pointer
+ *
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS calib_reset_stats(ATCADevice device)
+{
+    ATCA_STATUS status;
+
+    if (NULL == device)
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
     {
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
+    }
+
+    (void)memset(device->profile, 0, sizeof(device->profile));
+
+    (void)atca_device_relinquish(device);
+    return ATCA_SUCCESS;
+}
+#endif
+
+/** \brief Looks up how long to wait before the first response read and how
+ *         often to poll after it.
+ *
+ * \param[in]  packet  Command packet (opcode)
+ * \param[in]  device  Device context pointer
+ * \param[out] timing  Initial wait, polling interval and retries
+ *
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+static ATCA_STATUS calib_execute_timing(ATCAPacket* packet, ATCADevice device, calib_timing_t* timing)
+{
+    ATCA_STATUS status = ATCA_SUCCESS;
+
+    timing->adaptive = false;
+
 #ifdef ATCA_NO_POLL
-        if ((status = calib_get_execution_time(packet->opcode, device)) != ATCA_SUCCESS)
-        {
-            return status;
-        }
-        execution_or_wait_time = device->execution_time_msec;
-        max_delay_count = 0;
+    if ((status = calib_get_execution_time(packet->opcode, device)) == ATCA_SUCCESS)
+    {
+        timing->wait_usec = (uint32_t)device->execution_time_msec * 1000u;
+        timing->poll_usec = 0;
+        timing->max_delay_count = 0;
+    }
 #else
-        execution_or_wait_time = ATCA_POLLING_INIT_TIME_MSEC;
-        max_delay_count = ATCA_POLLING_MAX_TIME_MSEC / ATCA_POLLING_FREQUENCY_TIME_MSEC;
+    timing->wait_usec = (uint32_t)ATCA_POLLING_INIT_TIME_MSEC * 1000u;
+    timing->poll_usec = (uint32_t)ATCA_POLLING_FREQUENCY_TIME_MSEC * 1000u;
+    timing->max_delay_count = ATCA_POLLING_MAX_TIME_MSEC / ATCA_POLLING_FREQUENCY_TIME_MSEC;
 
-    #if ATCA_CA2_SUPPORT
-        if ((ATCA_SWI_GPIO_IFACE == device->mIface.mIfaceCFG->iface_type) && (atcab_is_ca2_device(device->mIface.mIfaceCFG->devtype)))
+    #if CALIB_ADAPTIVE_POLL_EN
+    {
+        int slot = calib_poll_slot(device, packet->opcode);
+
+        if (0 <= slot)
         {
-            if ((status = calib_get_execution_time(packet->opcode, device)) != ATCA_SUCCESS)
+            if (0u != device->poll_estimate_usec[slot])
             {
-                return status;
+                timing->wait_usec = device->poll_estimate_usec[slot];
             }
-            execution_or_wait_time = device->execution_time_msec;
-            max_delay_count = 0;
+            timing->poll_usec = ATCA_POLLING_FINE_TIME_USEC;
+            timing->max_delay_count = ((uint32_t)ATCA_POLLING_MAX_TIME_MSEC * 1000u) / ATCA_POLLING_FINE_TIME_USEC;
+            timing->adaptive = true;
         }
+    }
+    #endif
+
+    #if ATCA_CA2_SUPPORT
+    if ((ATCA_SWI_GPIO_IFACE == device->mIface.mIfaceCFG->iface_type) && (atcab_is_ca2_device(device->mIface.mIfaceCFG->devtype)))
+    {
+        if ((status = calib_get_execution_time(packet->opcode, device)) == ATCA_SUCCESS)
+        {
+            timing->wait_usec = (uint32_t)device->execution_time_msec * 1000u;
+            timing->max_delay_count = 0;
+            timing->adaptive = false;
+        }
+    }
+    #elif !CALIB_ADAPTIVE_POLL_EN
+    (void)packet;
+    (void)device;
     #endif
 #endif
-        retries = atca_iface_get_retries(&device->mIface);
-        do
+
+    return status;
+}
+
+/** \brief Waits whole milliseconds through atca_delay_ms (which may yield)
+ *         and only the remainder through atca_delay_us.
+ */
+static void calib_execute_delay_usec(uint32_t delay_usec)
+{
+    if (1000u <= delay_usec)
+    {
+        atca_delay_ms(delay_usec / 1000u);
+    }
+    if (0u != (delay_usec % 1000u))
+    {
+        atca_delay_us(delay_usec % 1000u);
+    }
+}
+
+/** \brief Wakes up the device if it is not awake and sends the packet.
+ *
+ * \param[in]  packet   Command packet to send
+ * \param[in]  device   Device context pointer
+ * \param[out] profile  Restarted; receives the send time and attempts
+ *
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+static ATCA_STATUS calib_execute_start(ATCAPacket* packet, ATCADevice device, calib_profile_t* profile)
+{
+    ATCA_STATUS status = ATCA_SUCCESS;
+    int32_t retries = atca_iface_get_retries(&device->mIface);
+
+    (void)memset(profile, 0, sizeof(*profile));
+#if CALIB_PROFILE_EN
+    profile->start_usec = hal_get_time_us();
+#endif
+
+#if CALIB_ZONE_CACHE_EN
+    // Before the send: a command that fails may still have written
+    calib_zone_cache_command(device, packet->opcode, packet->param1);
+#endif
+
+    do
+    {
+        profile->attempts++;
+
+        if ((uint8_t)ATCA_DEVICE_STATE_ACTIVE != device->device_state)
         {
-            if ((uint8_t)ATCA_DEVICE_STATE_ACTIVE != device->device_state)
+            if (ATCA_SUCCESS == (status = calib_wakeup(device)))
             {
-                if (ATCA_SUCCESS == (status = calib_wakeup(device)))
-                {
-                    device->device_state = (uint8_t)ATCA_DEVICE_STATE_ACTIVE;
-                }
+                device->device_state = (uint8_t)ATCA_DEVICE_STATE_ACTIVE;
+#if CALIB_SESSION_EN
+                device->awake_since_msec = hal_get_time_ms();
+#endif
             }
+        }
 
-            /* Send the command packet to the device */
-            if ((ATCA_I2C_IFACE == device->mIface.mIfaceCFG->iface_type) || (ATCA_CUSTOM_IFACE == device->mIface.mIfaceCFG->iface_type))
-            {
-                packet->reserved = 0x03;
-            }
-            if (ATCA_SWI_IFACE == device->mIface.mIfaceCFG->iface_type)
+        /* Send the command packet to the device */
+        if ((ATCA_I2C_IFACE == device->mIface.mIfaceCFG->iface_type) || (ATCA_CUSTOM_IFACE == device->mIface.mIfaceCFG->iface_type))
+        {
+            packet->reserved = 0x03;
+        }
+        if (ATCA_SWI_IFACE == device->mIface.mIfaceCFG->iface_type)
+        {
+            packet->reserved = CALIB_SWI_FLAG_CMD;
+        }
+#if ATCA_CA2_SUPPORT
+        if ((ATCA_SWI_GPIO_IFACE == device->mIface.mIfaceCFG->iface_type) && (atcab_is_ca2_device(device->mIface.mIfaceCFG->devtype)))
+        {
+            packet->reserved = 0x03;
+        }
+#endif
+        /* coverity[misra_c_2012_rule_18_1_violation]  calib_execute_send will not update the members of the packet structure */
+        if (ATCA_RX_NO_RESPONSE == (status = calib_execute_send(device, packet->reserved, (uint8_t*)&packet->txsize, (uint16_t)packet->txsize)))
+        {
+            device->device_state = (uint8_t)ATCA_DEVICE_STATE_UNKNOWN;
+        }
+        else
+        {
+            if ((uint8_t)ATCA_DEVICE_STATE_ACTIVE != device->device_state)
             {
-                packet->reserved = CALIB_SWI_FLAG_CMD;
+                device->device_state = (uint8_t)ATCA_DEVICE_STATE_ACTIVE;
             }
-    #if ATCA_CA2_SUPPORT
-            if ((ATCA_SWI_GPIO_IFACE == device->mIface.mIfaceCFG->iface_type) && (atcab_is_ca2_device(device->mIface.mIfaceCFG->devtype)))
+            retries = 0;
+        }
+
+    }
+    /* coverity[cert_int32_c_violation:FALSE]  No overflow possible */
+    while (0 < retries--);
+
+#if CALIB_PROFILE_EN
+    profile->send_usec = hal_get_time_us() - profile->start_usec;
+#endif
+
+    return status;
+}
+
+/** \brief Reads the response into the packet, adding the time spent to the
+ *         command's profile.
+ */
+static ATCA_STATUS calib_execute_read(ATCAPacket* packet, ATCADevice device, uint16_t* rxsize, calib_profile_t* profile)
+{
+    ATCA_STATUS status;
+#if CALIB_PROFILE_EN
+    uint32_t start_usec = hal_get_time_us();
+#endif
+
+    status = calib_execute_receive(device, atcab_get_device_address(device), packet->data, rxsize);
+
+#if CALIB_PROFILE_EN
+    profile->receive_usec += hal_get_time_us() - start_usec;
+#else
+    (void)profile;
+#endif
+
+    return status;
+}
+
+/** \brief Checks a received response: size, CRC and the status byte.
+ *
+ * \param[in]  packet      Packet holding the response
+ * \param[in]  device      Device context pointer
+ * \param[in]  rxsize      Number of bytes received
+ * \param[out] keep_awake  Set when a session may leave the device awake
+ *
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+static ATCA_STATUS calib_execute_check(ATCAPacket* packet, ATCADevice device, uint16_t rxsize, bool* keep_awake)
+{
+    ATCA_STATUS status;
+
+    *keep_awake = false;
+
+    do
+    {
+        // Check response size
+        if (rxsize < 4u)
+        {
+            if (rxsize > 0u)
             {
-                packet->reserved = 0x03;
+                status = ATCA_RX_FAIL;
             }
-    #endif
-            /* coverity[misra_c_2012_rule_18_1_violation]  calib_execute_send will not update the members of the packet structure */
-            if (ATCA_RX_NO_RESPONSE == (status = calib_execute_send(device, packet->reserved, (uint8_t*)&packet->txsize, (uint16_t)packet->txsize)))
+            else
             {
-                device->device_state = (uint8_t)ATCA_DEVICE_STATE_UNKNOWN;
+                status = ATCA_RX_NO_RESPONSE;
             }
-            else
+            break;
+        }
+
+        /* coverity[misra_c_2012_directive_4_14_violation:FALSE] Packet data is handled properly */
+        if ((status = atCheckCrc(packet->data)) != ATCA_SUCCESS)
+        {
+            break;
+        }
+
+#if CALIB_SESSION_EN
+        // An intact response means the device is awake and in sync; a session
+        // may keep it that way unless the watchdog was about to expire
+        *keep_awake = (0u < device->awake_depth);
+#else
+        (void)device;
+#endif
+
+        if ((status = isATCAError(packet->data)) != ATCA_SUCCESS)
+        {
+            if (ATCA_STATUS_WATCHDOG == status)
             {
-                if ((uint8_t)ATCA_DEVICE_STATE_ACTIVE != device->device_state)
-                {
-                    device->device_state = (uint8_t)ATCA_DEVICE_STATE_ACTIVE;
-                }
-                retries = 0;
+                *keep_awake = false;
             }
+            break;
+        }
+    } while (false);
+
+    return status;
+}
+
+/** \brief Idles the device after a command unless a session keeps it awake. */
+static void calib_execute_finish(ATCADevice device, bool keep_awake)
+{
+    // Skip Idle for ECC204 device
+    if (!atcab_is_ca2_device(device->mIface.mIfaceCFG->devtype) && !keep_awake)
+    {
+        (void)calib_idle(device);
+        device->device_state = (uint8_t)ATCA_DEVICE_STATE_IDLE;
+    }
+}
 
+/** \brief Wakes up device, sends the packet, waits for command completion,
+ *         receives response, and puts the device into the idle state. Inside
+ *         a session (calib_session_begin) the device is left awake instead.
+ *
+ * \param[in,out] packet  As input, the packet to be sent. As output, the
+ *                       data buffer in the packet structure will contain the
+ *                       response.
+ * \param[in]    device  CryptoAuthentication device to send the command to.
+ *
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS calib_execute_command(ATCAPacket* packet, ATCADevice device)
+{
+    ATCA_STATUS status;
+    calib_timing_t timing;
+    uint32_t polls = 0;
+    uint16_t rxsize;
+    bool keep_awake = false;
+    calib_profile_t profile = { 0 };
+
+    if ((status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)) != ATCA_SUCCESS)
+    {
+        return status;
+    }
+
+#if CALIB_SESSION_EN
+    calib_session_refresh(device);
+#endif
+
+    do
+    {
+        if ((status = calib_execute_timing(packet, device, &timing)) != ATCA_SUCCESS)
+        {
+            (void)atca_device_relinquish(device);
+            return status;
         }
-        /* coverity[cert_int32_c_violation:FALSE]  No overflow possible */
-        while (0 < retries--);
 
-        if (ATCA_SUCCESS != status)
+        if ((status = calib_execute_start(packet, device, &profile)) != ATCA_SUCCESS)
         {
             break;
         }
 
         // Delay for execution time or initial wait before polling
-        atca_delay_ms(execution_or_wait_time);
+        calib_execute_delay_usec(timing.wait_usec);
 
         do
         {
@@ -557,56 +979,231 @@ ATCA_STATUS calib_execute_command(ATCAPacket* packet, ATCADevice device)
             // receive the response
             rxsize = (uint16_t)sizeof(packet->data);
 
-            if (ATCA_SUCCESS == (status = calib_execute_receive(device, device_address, packet->data, &rxsize)))
+            if (ATCA_SUCCESS == (status = calib_execute_read(packet, device, &rxsize, &profile)))
             {
                 break;
             }
 
 #ifndef ATCA_NO_POLL
             // delay for polling frequency time
-            atca_delay_ms(ATCA_POLLING_FREQUENCY_TIME_MSEC);
+            calib_execute_delay_usec(timing.poll_usec);
+            polls++;
 #endif
         }
         /* coverity[cert_int30_c_violation:FALSE]  No overflow possible */
-        while (max_delay_count-- > 0u);
+        while (timing.max_delay_count-- > 0u);
 
         if (status != ATCA_SUCCESS)
         {
             break;
         }
 
-        // Check response size
-        if (rxsize < 4u)
+        status = calib_execute_check(packet, device, rxsize, &keep_awake);
+
+#if CALIB_ADAPTIVE_POLL_EN && !defined(ATCA_NO_POLL)
+        // Error responses can come back early, only full executions are learned
+        if ((ATCA_SUCCESS == status) && timing.adaptive)
         {
-            if (rxsize > 0u)
-            {
-                status = ATCA_RX_FAIL;
-            }
-            else
-            {
-                status = ATCA_RX_NO_RESPONSE;
-            }
-            break;
+            calib_poll_learn(device, packet->opcode, timing.wait_usec, polls, timing.wait_usec + (polls * timing.poll_usec));
         }
+#endif
+    } while (false);
 
-        /* coverity[misra_c_2012_directive_4_14_violation:FALSE] Packet data is handled properly */
-        if ((status = atCheckCrc(packet->data)) != ATCA_SUCCESS)
+#if CALIB_PROFILE_EN
+    profile.polls = polls;
+    calib_profile_record(device, packet->opcode, status, &profile);
+#endif
+#if CALIB_I2C_SPEED_STEP_EN
+    calib_i2c_speed_fallback(device, status);
+#endif
+    calib_execute_finish(device, keep_awake);
+    (void)atca_device_relinquish(device);
+
+    return status;
+}
+
+#if CALIB_ASYNC_EN
+/** \brief Wakes up the device and sends the packet without waiting for the
+ *         command to execute. Complete it with calib_execute_poll(); the
+ *         packet must stay valid until then. Only the wake (when the device
+ *         is not already awake) and the bus transfers block. The device is
+ *         held for the caller until the command completes, so the polls
+ *         must come from the same thread, task or core.
+ *
+ * \param[out]    job       Execution state, owned by the caller
+ * \param[in,out] packet    As input, the packet to be sent. Once the job has
+ *                          completed, the data buffer holds the response.
+ * \param[in]     device    CryptoAuthentication device to send the command to.
+ * \param[in]     callback  Called from the poll that completes the command;
+ *                          not called when the submit itself fails. May be NULL.
+ * \param[in]     cb_arg    Passed to the callback
+ *
+ * \return ATCA_SUCCESS once the command is executing, otherwise an error code.
+ */
+ATCA_STATUS calib_execute_submit(calib_async_t* job, ATCAPacket* packet, ATCADevice device,
+                                 calib_async_cb callback, void* cb_arg)
+{
+    ATCA_STATUS status;
+    calib_timing_t timing;
+    uint32_t wait_msec;
+
+    if ((NULL == job) || (NULL == packet) || (NULL == device))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    job->device = device;
+    job->packet = packet;
+    job->callback = callback;
+    job->cb_arg = cb_arg;
+
+    if ((status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)) != ATCA_SUCCESS)
+    {
+        job->status = status;
+        return status;
+    }
+
+#if CALIB_SESSION_EN
+    calib_session_refresh(device);
+#endif
+
+    do
+    {
+        if ((status = calib_execute_timing(packet, device, &timing)) != ATCA_SUCCESS)
         {
             break;
         }
 
-        if ((status = isATCAError(packet->data)) != ATCA_SUCCESS)
+        if ((status = calib_execute_start(packet, device, &job->profile)) != ATCA_SUCCESS)
         {
+#if CALIB_PROFILE_EN
+            calib_profile_record(device, packet->opcode, status, &job->profile);
+#endif
+#if CALIB_I2C_SPEED_STEP_EN
+            calib_i2c_speed_fallback(device, status);
+#endif
+            calib_execute_finish(device, false);
             break;
         }
+
+        // Polls go by the millisecond clock, so waits round up to it
+        wait_msec = (timing.wait_usec + 999u) / 1000u;
+        job->start_msec = hal_get_time_ms();
+        job->next_poll_msec = job->start_msec + wait_msec;
+        job->timeout_msec = wait_msec + ((timing.max_delay_count * timing.poll_usec) / 1000u);
+        job->poll_msec = (timing.poll_usec + 999u) / 1000u;
+        job->wait_usec = timing.wait_usec;
+        job->polls = 0;
+        job->adaptive = timing.adaptive;
+        job->status = ATCA_EXECUTION_PENDING;
     } while (false);
 
-    // Skip Idle for ECC204 device
-    if (!atcab_is_ca2_device(device->mIface.mIfaceCFG->devtype))
+    if (ATCA_SUCCESS != status)
     {
-        (void)calib_idle(device);
-        device->device_state = (uint8_t)ATCA_DEVICE_STATE_IDLE;
+        (void)atca_device_relinquish(device);
+        job->status = status;
+    }
+
+    return status;
+}
+
+/** \brief Reads the response of a submitted command if it is due. Returns
+ *         immediately: a device still executing (NAK) is retried on a later
+ *         poll, one polling interval on.
+ *
+ * \param[in,out] job  State from calib_execute_submit()
+ *
+ * \return ATCA_EXECUTION_PENDING while the command executes, otherwise the
+ *         final status (repeated by later polls).
+ */
+ATCA_STATUS calib_execute_poll(calib_async_t* job)
+{
+    ATCA_STATUS status;
+    uint16_t rxsize;
+    uint32_t now;
+    bool keep_awake = false;
+
+    if (NULL == job)
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (ATCA_EXECUTION_PENDING != job->status)
+    {
+        return job->status;
+    }
+
+    now = hal_get_time_ms();
+    if (0 > (int32_t)(now - job->next_poll_msec))
+    {
+        return ATCA_EXECUTION_PENDING;
+    }
+
+    (void)memset(job->packet->data, 0, sizeof(job->packet->data));
+    rxsize = (uint16_t)sizeof(job->packet->data);
+
+    if (ATCA_SUCCESS == (status = calib_execute_read(job->packet, job->device, &rxsize, &job->profile)))
+    {
+        status = calib_execute_check(job->packet, job->device, rxsize, &keep_awake);
+#if CALIB_ADAPTIVE_POLL_EN && !defined(ATCA_NO_POLL)
+        // A late poll says nothing about when the command finished
+        if ((ATCA_SUCCESS == status) && job->adaptive && ((now - job->next_poll_msec) <= job->poll_msec))
+        {
+            calib_poll_learn(job->device, job->packet->opcode, job->wait_usec, job->polls, (now - job->start_msec) * 1000u);
+        }
+#endif
+    }
+    else if ((now - job->start_msec) < job->timeout_msec)
+    {
+        job->next_poll_msec = now + job->poll_msec;
+        job->polls++;
+        return ATCA_EXECUTION_PENDING;
+    }
+    else
+    {
+        /* Out of polling time, report the receive failure */
+    }
+
+#if CALIB_PROFILE_EN
+    job->profile.polls = job->polls;
+    calib_profile_record(job->device, job->packet->opcode, status, &job->profile);
+#endif
+#if CALIB_I2C_SPEED_STEP_EN
+    calib_i2c_speed_fallback(job->device, status);
+#endif
+    calib_execute_finish(job->device, keep_awake);
+    (void)atca_device_relinquish(job->device);
+    job->status = status;
+
+    if (NULL != job->callback)
+    {
+        job->callback(job->cb_arg, status);
     }
 
     return status;
 }
+
+/** \brief Time until a submitted command is next worth polling, for callers
+ *         that sleep or yield between polls.
+ *
+ * \param[in] job  State from calib_execute_submit()
+ *
+ * \return Milliseconds to wait; 0 when a poll is due or the job is complete.
+ */
+uint32_t calib_execute_wait_msec(const calib_async_t* job)
+{
+    uint32_t wait = 0;
+
+    if ((NULL != job) && (ATCA_EXECUTION_PENDING == job->status))
+    {
+        int32_t remaining = (int32_t)(job->next_poll_msec - hal_get_time_ms());
+
+        if (0 < remaining)
+        {
+            wait = (uint32_t)remaining;
+        }
+    }
+
+    return wait;
+}
+#endif
@@ -69,8 +69,49 @@ ATCA_STATUS calib_execute_send(ATCADevice device, uint8_t word_address, uint8_t*
 ATCA_STATUS calib_execute_receive(ATCADevice device, uint8_t device_address, uint8_t* rxdata, uint16_t* rxlength);
 #endif
 
+/** \brief Phase times of one command, for the per-opcode profile
+ *         (CALIB_PROFILE_EN) */
+typedef struct
+{
+    uint32_t start_usec;            //!< hal_get_time_us() before the wake and send
+    uint32_t send_usec;             //!< Wake and send
+    uint32_t receive_usec;          //!< Response reads, busy ones included
+    uint32_t polls;                 //!< Reads that found the device still executing
+    uint32_t attempts;              //!< Wake and send attempts
+} calib_profile_t;
+
 ATCA_STATUS calib_execute_command(ATCAPacket* packet, ATCADevice device);
 
+#if CALIB_ASYNC_EN
+/** \brief Completion callback of a non-blocking command; called once from
+ *         the poll that completes it
+ */
+typedef void (*calib_async_cb)(void* cb_arg, ATCA_STATUS status);
+
+/** \brief State of a command submitted with calib_execute_submit() */
+typedef struct
+{
+    ATCADevice     device;
+    ATCAPacket*    packet;
+    calib_async_cb callback;        //!< May be NULL when the caller only polls
+    void*          cb_arg;
+    uint32_t       start_msec;      //!< Time the command was sent
+    uint32_t       next_poll_msec;  //!< Earliest time worth reading the response
+    uint32_t       timeout_msec;    //!< Give up this long after start_msec
+    uint32_t       poll_msec;       //!< Interval between reads while the device NAKs
+    uint32_t       wait_usec;       //!< Initial wait (learned execution time when adaptive)
+    uint32_t       polls;           //!< Reads that found the device still executing
+    bool           adaptive;        //!< Completion time feeds the opcode's estimate
+    calib_profile_t profile;        //!< Phase times so far
+    ATCA_STATUS    status;          //!< ATCA_EXECUTION_PENDING until complete
+} calib_async_t;
+
+ATCA_STATUS calib_execute_submit(calib_async_t* job, ATCAPacket* packet, ATCADevice device,
+                                 calib_async_cb callback, void* cb_arg);
+ATCA_STATUS calib_execute_poll(calib_async_t* job);
+uint32_t calib_execute_wait_msec(const calib_async_t* job);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
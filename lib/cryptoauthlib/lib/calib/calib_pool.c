@@ -0,0 +1,325 @@
+/**
+ * \file
+ * \brief Device pool: several devices, each with its own ATCADevice, signing
+ *        in parallel.
+ *
+ * A sign runs as calib_sign_submit()/calib_sign_poll() on the device it is
+ * dispatched to, so one caller can keep every device of the pool executing
+ * at once and signatures per second scale with the number of devices. Each
+ * device signs with its own key; calib_pool_device_index() tells the caller
+ * which one, and so which public key, produced a signature.
+ *
+ * \copyright (c) 2015-2020 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip software
+ * and any derivatives exclusively with Microchip products. It is your
+ * responsibility to comply with third party license terms applicable to your
+ * use of third party software (including open source software) that may
+ * accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+ * PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT,
+ * SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE
+ * OF ANY KIND WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF
+ * MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE
+ * FORESEEABLE. TO THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL
+ * LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED
+ * THE AMOUNT OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR
+ * THIS SOFTWARE.
+ */
+
+#include "cryptoauthlib.h"
+
+#if CALIB_POOL_EN && CALIB_ASYNC_EN && CALIB_SIGN_EN
+
+/** \brief Sets up a pool over devices that are already initialized. The
+ *         pool does not own them: they stay usable on their own (their
+ *         device locks arbitrate) and are released by the caller after
+ *         calib_pool_release().
+ *
+ *  \param[out] pool     Pool to set up
+ *  \param[in]  devices  Devices to dispatch to
+ *  \param[in]  count    Number of devices, 1 to ATCA_POOL_DEVICES_MAX
+ *
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS calib_pool_init(calib_pool_t* pool, const ATCADevice* devices, uint8_t count)
+{
+    ATCA_STATUS status;
+    uint8_t i;
+
+    if ((NULL == pool) || (NULL == devices) || (0u == count) || (count > (uint8_t)ATCA_POOL_DEVICES_MAX))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "Invalid pool parameters");
+    }
+
+    (void)memset(pool, 0, sizeof(*pool));
+
+    for (i = 0; i < count; i++)
+    {
+        if (NULL == devices[i])
+        {
+            return ATCA_TRACE(ATCA_BAD_PARAM, "NULL device received");
+        }
+        pool->devices[i] = devices[i];
+    }
+
+    if (ATCA_SUCCESS != (status = hal_create_mutex(&pool->mutex, "atca_pool")))
+    {
+        pool->mutex = NULL;
+        return ATCA_TRACE(status, "hal_create_mutex - failed");
+    }
+
+    pool->count = count;
+    return ATCA_SUCCESS;
+}
+
+/** \brief Frees the pool's resources. Signs still running must have been
+ *         polled to completion first; the devices are left as they are.
+ *
+ *  \param[in] pool  Pool from calib_pool_init()
+ *
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS calib_pool_release(calib_pool_t* pool)
+{
+    if (NULL == pool)
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (NULL != pool->mutex)
+    {
+        (void)hal_destroy_mutex(pool->mutex);
+        pool->mutex = NULL;
+    }
+    pool->count = 0;
+
+    return ATCA_SUCCESS;
+}
+
+/** \brief Picks the least busy device and marks it running the job. A device
+ *         with a pool sign in progress is never picked; among the others one
+ *         nobody holds is preferred, then the one given the fewest signs.
+ *
+ *  \return Index of the device, or -1 when every device is signing.
+ */
+static int calib_pool_claim(calib_pool_t* pool, calib_sign_async_t* job)
+{
+    int best = -1;
+    bool best_held = true;
+    uint8_t i;
+
+    for (i = 0; i < pool->count; i++)
+    {
+        /* Read without the device lock: a holder that comes or goes in the
+           meantime only makes the choice less than ideal */
+        bool held = (0u != pool->devices[i]->lock_depth);
+
+        if (NULL != pool->running[i])
+        {
+            continue;
+        }
+
+        if ((best < 0) || (best_held && !held) ||
+            ((best_held == held) && (pool->signs[i] < pool->signs[best])))
+        {
+            best = (int)i;
+            best_held = held;
+        }
+    }
+
+    if (0 <= best)
+    {
+        pool->running[best] = job;
+        pool->signs[best]++;
+    }
+
+    return best;
+}
+
+/** \brief Marks the device that ran the job free again. */
+static void calib_pool_finish(calib_pool_t* pool, const calib_sign_async_t* job, ATCA_STATUS status)
+{
+    uint8_t i;
+
+    if (ATCA_SUCCESS != hal_lock_mutex(pool->mutex))
+    {
+        return;
+    }
+
+    for (i = 0; i < pool->count; i++)
+    {
+        if (job == pool->running[i])
+        {
+            pool->running[i] = NULL;
+            if (ATCA_SUCCESS != status)
+            {
+                pool->failures[i]++;
+            }
+        }
+    }
+
+    (void)hal_unlock_mutex(pool->mutex);
+}
+
+/** \brief Starts a non-blocking Sign of a 32-byte external message on the
+ *         least busy device of the pool. The job then runs as one from
+ *         calib_sign_submit(): it is advanced with calib_pool_sign_poll()
+ *         from the submitting thread, task or core, and holds its device
+ *         until it completes.
+ *
+ *  \param[in]  pool       Pool from calib_pool_init()
+ *  \param[out] job        Sign state, owned by the caller until complete
+ *  \param[in]  key_id     Slot of the private key on the chosen device
+ *  \param[in]  msg        32-byte message to be signed (copied).
+ *  \param[out] signature  R and S in big-endian format, written when the job
+ *                         completes successfully. 64 bytes for P256 curve.
+ *  \param[in]  callback   Called once from the poll that completes the job;
+ *                         not called when the submit itself fails. May be NULL.
+ *  \param[in]  cb_arg     Passed to the callback
+ *
+ *  \return ATCA_SUCCESS once the sign is running, ATCA_NO_DEVICES while
+ *          every device of the pool is signing, otherwise an error code.
+ */
+ATCA_STATUS calib_pool_sign_submit(calib_pool_t* pool, calib_sign_async_t* job, uint16_t key_id, const uint8_t *msg,
+                                   uint8_t *signature, calib_async_cb callback, void* cb_arg)
+{
+    ATCA_STATUS status;
+    int index;
+
+    if ((NULL == pool) || (NULL == pool->mutex) || (NULL == job))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (ATCA_SUCCESS != hal_lock_mutex(pool->mutex))
+    {
+        return ATCA_TRACE(ATCA_GEN_FAIL, "hal_lock_mutex - failed");
+    }
+    index = calib_pool_claim(pool, job);
+    (void)hal_unlock_mutex(pool->mutex);
+
+    if (0 > index)
+    {
+        /* Not traced: the caller polls its running signs and tries again */
+        return ATCA_NO_DEVICES;
+    }
+
+    if (ATCA_SUCCESS != (status = calib_sign_submit(pool->devices[index], job, key_id, msg, signature, callback, cb_arg)))
+    {
+        calib_pool_finish(pool, job, status);
+    }
+
+    return status;
+}
+
+/** \brief Advances a sign from calib_pool_sign_submit() without waiting and
+ *         frees its device once it completes.
+ *
+ *  \param[in]     pool  Pool the job was submitted to
+ *  \param[in,out] job   State from calib_pool_sign_submit()
+ *
+ *  \return ATCA_EXECUTION_PENDING while the sign is in progress, otherwise
+ *          the final status (repeated by later polls).
+ */
+ATCA_STATUS calib_pool_sign_poll(calib_pool_t* pool, calib_sign_async_t* job)
+{
+    ATCA_STATUS status;
+
+    if ((NULL == pool) || (NULL == job))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (ATCA_EXECUTION_PENDING != (status = calib_sign_poll(job)))
+    {
+        calib_pool_finish(pool, job, status);
+    }
+
+    return status;
+}
+
+/** \brief Signs a 32-byte external message on the least busy device of the
+ *         pool, waiting for one to come free if all are signing. Callers on
+ *         different threads, tasks or cores sign in parallel up to the
+ *         number of devices. Devices on one bus execute in parallel but
+ *         take turns for each transfer, which the platform HAL must
+ *         serialise when the callers run concurrently.
+ *
+ *  \param[in]  pool          Pool from calib_pool_init()
+ *  \param[in]  key_id        Slot of the private key on the chosen device
+ *  \param[in]  msg           32-byte message to be signed
+ *  \param[out] signature     R and S in big-endian format. 64 bytes for P256
+ *                            curve.
+ *  \param[out] device_index  Receives the index of the device that signed.
+ *                            May be NULL.
+ *
+ *  \return ATCA_SUCCESS on success, ATCA_TIMEOUT when no device came free
+ *          within ATCA_DEVICE_LOCK_TIMEOUT_MSEC, otherwise an error code.
+ */
+ATCA_STATUS calib_pool_sign(calib_pool_t* pool, uint16_t key_id, const uint8_t *msg, uint8_t *signature,
+                            uint8_t* device_index)
+{
+    ATCA_STATUS status;
+    calib_sign_async_t job;
+    uint32_t start = hal_get_time_ms();
+
+    while (ATCA_NO_DEVICES == (status = calib_pool_sign_submit(pool, &job, key_id, msg, signature, NULL, NULL)))
+    {
+        if ((hal_get_time_ms() - start) >= (uint32_t)ATCA_DEVICE_LOCK_TIMEOUT_MSEC)
+        {
+            return ATCA_TRACE(ATCA_TIMEOUT, "calib_pool_sign - no device came free");
+        }
+        atca_delay_ms(ATCA_DEVICE_LOCK_RETRY_MSEC);
+    }
+
+    if ((ATCA_SUCCESS == status) && (NULL != device_index))
+    {
+        *device_index = (uint8_t)calib_pool_device_index(pool, &job);
+    }
+
+    while ((ATCA_EXECUTION_PENDING == status) || (ATCA_SUCCESS == status))
+    {
+        atca_delay_ms(calib_sign_wait_msec(&job));
+        if (ATCA_EXECUTION_PENDING != (status = calib_pool_sign_poll(pool, &job)))
+        {
+            break;
+        }
+    }
+
+    return status;
+}
+
+/** \brief Which device of the pool a sign was dispatched to.
+ *
+ *  \param[in] pool  Pool the job was submitted to
+ *  \param[in] job   State from calib_pool_sign_submit()
+ *
+ *  \return Index into the devices given to calib_pool_init(), or -1.
+ */
+int calib_pool_device_index(const calib_pool_t* pool, const calib_sign_async_t* job)
+{
+    int index = -1;
+    uint8_t i;
+
+    if ((NULL != pool) && (NULL != job))
+    {
+        for (i = 0; i < pool->count; i++)
+        {
+            if (job->exec.device == pool->devices[i])
+            {
+                index = (int)i;
+                break;
+            }
+        }
+    }
+
+    return index;
+}
+
+#endif
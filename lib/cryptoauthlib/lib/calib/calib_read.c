@@ -58,7 +58,61 @@
  *
  *  returns ATCA_SUCCESS on success, otherwise an error code.
  */
+#if CALIB_ZONE_CACHE_EN
+static ATCA_STATUS calib_read_zone_device(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint8_t *data, uint8_t len);
+
+ATCA_STATUS calib_read_zone(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint8_t *data, uint8_t len)
+{
+    ATCA_STATUS status;
+    uint8_t block_data[ATCA_BLOCK_SIZE];
+
+    if ((NULL == device) || (NULL == data))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    // The cache is read and filled under the same hold as the Read itself
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
+    }
+
+    do
+    {
+        if (!calib_zone_cache_allowed(device, zone, slot, len))
+        {
+            status = calib_read_zone_device(device, zone, slot, block, offset, data, len);
+            break;
+        }
+
+        if (calib_zone_cache_read(device, zone, slot, block, offset, data, len))
+        {
+            status = ATCA_SUCCESS;
+            break;
+        }
+
+        // Word reads are widened to their block so the whole block is cached
+        if (ATCA_SUCCESS != (status = calib_read_zone_device(device, zone, slot, block, 0, block_data, ATCA_BLOCK_SIZE)))
+        {
+            break;
+        }
+
+        calib_zone_cache_fill(device, zone, slot, block, block_data);
+        (void)memcpy(data, &block_data[(len == ATCA_WORD_SIZE) ? ((size_t)offset * ATCA_WORD_SIZE) : 0u], len);
+    } while (false);
+
+    (void)atca_device_relinquish(device);
+
+    return status;
+}
+
+/** \brief Issues the Read command for calib_read_zone() when the cache
+ *         cannot answer it.
+ */
+static ATCA_STATUS calib_read_zone_device(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint8_t *data, uint8_t len)
+#else
 ATCA_STATUS calib_read_zone(ATCADevice device, uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint8_t *data, uint8_t len)
+#endif
 {
     ATCAPacket * packet = NULL;
     ATCA_STATUS status;
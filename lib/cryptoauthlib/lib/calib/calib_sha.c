@@ -230,6 +230,8 @@ ATCA_STATUS calib_sha(ATCADevice device, uint16_t length, const uint8_t *message
 
 /** \brief Initialize a SHA context for performing a hardware SHA-256 operation
  *          on a device. Note that only one SHA operation can be run at a time.
+ *          When other callers share the device, hold it with
+ *          atca_device_acquire() until calib_hw_sha2_256_finish().
  *
  * \param[in] device   Device context pointer
  * \param[in] ctx      SHA256 context
@@ -390,22 +392,36 @@ ATCA_STATUS calib_hw_sha2_256(ATCADevice device, const uint8_t * data, size_t da
     ATCA_STATUS status = ATCA_SUCCESS;
     atca_sha256_ctx_t ctx;
 
-    if (ATCA_SUCCESS != (status = calib_hw_sha2_256_init(device, &ctx)))
+    // The start/update/end commands share the device's SHA context
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
     {
-        return ATCA_TRACE(status, "calib_hw_sha2_256_init - failed");
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
     }
 
-    if (ATCA_SUCCESS != (status = calib_hw_sha2_256_update(device, &ctx, data, data_size)))
+    do
     {
-        return ATCA_TRACE(status, "calib_hw_sha2_256_update - failed");
-    }
+        if (ATCA_SUCCESS != (status = calib_hw_sha2_256_init(device, &ctx)))
+        {
+            (void)ATCA_TRACE(status, "calib_hw_sha2_256_init - failed");
+            break;
+        }
 
-    if (ATCA_SUCCESS != (status = calib_hw_sha2_256_finish(device, &ctx, digest)))
-    {
-        return ATCA_TRACE(status, "calib_hw_sha2_256_finish - failed");
-    }
+        if (ATCA_SUCCESS != (status = calib_hw_sha2_256_update(device, &ctx, data, data_size)))
+        {
+            (void)ATCA_TRACE(status, "calib_hw_sha2_256_update - failed");
+            break;
+        }
 
-    return ATCA_SUCCESS;
+        if (ATCA_SUCCESS != (status = calib_hw_sha2_256_finish(device, &ctx, digest)))
+        {
+            (void)ATCA_TRACE(status, "calib_hw_sha2_256_finish - failed");
+            break;
+        }
+    } while (false);
+
+    (void)atca_device_relinquish(device);
+
+    return status;
 }
 #endif  /* CALIB_SHA_EN */
 
@@ -562,21 +578,34 @@ ATCA_STATUS calib_sha_hmac(ATCADevice device, const uint8_t * data, size_t data_
     ATCA_STATUS status = ATCA_SUCCESS;
     atca_hmac_sha256_ctx_t ctx;
 
-    if (ATCA_SUCCESS != (status = calib_sha_hmac_init(device, &ctx, key_slot)))
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
     {
-        return ATCA_TRACE(status, "calib_sha_hmac_init - failed");
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
     }
 
-    if (ATCA_SUCCESS != (status = calib_sha_hmac_update(device, &ctx, data, data_size)))
+    do
     {
-        return ATCA_TRACE(status, "calib_sha_hmac_update - failed");
-    }
+        if (ATCA_SUCCESS != (status = calib_sha_hmac_init(device, &ctx, key_slot)))
+        {
+            (void)ATCA_TRACE(status, "calib_sha_hmac_init - failed");
+            break;
+        }
 
-    if (ATCA_SUCCESS != (status = calib_sha_hmac_finish(device, &ctx, digest, target)))
-    {
-        return ATCA_TRACE(status, "calib_sha_hmac_finish - failed");
-    }
+        if (ATCA_SUCCESS != (status = calib_sha_hmac_update(device, &ctx, data, data_size)))
+        {
+            (void)ATCA_TRACE(status, "calib_sha_hmac_update - failed");
+            break;
+        }
 
-    return ATCA_SUCCESS;
+        if (ATCA_SUCCESS != (status = calib_sha_hmac_finish(device, &ctx, digest, target)))
+        {
+            (void)ATCA_TRACE(status, "calib_sha_hmac_finish - failed");
+            break;
+        }
+    } while (false);
+
+    (void)atca_device_relinquish(device);
+
+    return status;
 }
 #endif  /* CALIB_SHA_HMAC_EN */
@@ -129,6 +129,12 @@ ATCA_STATUS calib_sign(ATCADevice device, uint16_t key_id, const uint8_t *msg, u
     uint8_t nonce_target = NONCE_MODE_TARGET_TEMPKEY;
     uint8_t sign_source = SIGN_MODE_SOURCE_TEMPKEY;
 
+    // Nonce and Sign share TempKey/the digest buffer; nobody may run between
+    if ((status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)) != ATCA_SUCCESS)
+    {
+        return status;
+    }
+
     do
     {
 #if CALIB_RANDOM_EN
@@ -162,8 +168,213 @@ ATCA_STATUS calib_sign(ATCADevice device, uint16_t key_id, const uint8_t *msg, u
         }
     } while (false);
 
+    (void)atca_device_relinquish(device);
     return status;
 }
+
+#if CALIB_ASYNC_EN
+/* Steps of a non-blocking sign, in the order calib_sign() issues them */
+#define CALIB_SIGN_STEP_RANDOM  ((uint8_t)0)
+#define CALIB_SIGN_STEP_NONCE   ((uint8_t)1)
+#define CALIB_SIGN_STEP_SIGN    ((uint8_t)2)
+#define CALIB_SIGN_STEP_DONE    ((uint8_t)3)
+
+/** \brief Builds and submits the command of the job's current step. */
+static ATCA_STATUS calib_sign_submit_step(calib_sign_async_t* job)
+{
+    ATCADevice device = job->exec.device;
+    ATCAPacket* packet = &job->packet;
+    ATCA_STATUS status;
+    bool msgdigbuf = false;
+
+#ifdef ATCA_ATECC608_SUPPORT
+    // The ATECC608 signs from the Message Digest Buffer
+    msgdigbuf = (ATECC608 == device->mIface.mIfaceCFG->devtype);
+#endif
+
+    (void)memset(packet, 0x00, sizeof(ATCAPacket));
+
+    switch (job->step)
+    {
+    case CALIB_SIGN_STEP_RANDOM:
+        packet->param1 = RANDOM_SEED_UPDATE;
+        packet->param2 = 0x0000;
+        status = atRandom(atcab_get_device_type_ext(device), packet);
+        break;
+
+    case CALIB_SIGN_STEP_NONCE:
+        packet->param1 = NONCE_MODE_PASSTHROUGH | NONCE_MODE_INPUT_LEN_32 |
+                         (msgdigbuf ? NONCE_MODE_TARGET_MSGDIGBUF : NONCE_MODE_TARGET_TEMPKEY);
+        packet->param2 = 0x0000;
+        (void)memcpy(packet->data, job->msg, sizeof(job->msg));
+        status = atNonce(atcab_get_device_type_ext(device), packet);
+        break;
+
+    case CALIB_SIGN_STEP_SIGN:
+        packet->param1 = SIGN_MODE_EXTERNAL | (msgdigbuf ? SIGN_MODE_SOURCE_MSGDIGBUF : SIGN_MODE_SOURCE_TEMPKEY);
+        packet->param2 = job->key_id;
+        status = atSign(atcab_get_device_type_ext(device), packet);
+        break;
+
+    default:
+        status = ATCA_BAD_PARAM;
+        break;
+    }
+
+    if (ATCA_SUCCESS == status)
+    {
+        status = calib_execute_submit(&job->exec, packet, device, NULL, NULL);
+    }
+
+    return status;
+}
+
+/** \brief Ends a non-blocking sign and reports it to the callback. */
+static ATCA_STATUS calib_sign_complete(calib_sign_async_t* job, ATCA_STATUS status)
+{
+    (void)atca_device_relinquish(job->exec.device);
+    job->step = CALIB_SIGN_STEP_DONE;
+    job->status = status;
+
+    if (NULL != job->callback)
+    {
+        job->callback(job->cb_arg, status);
+    }
+
+    return status;
+}
+
+/** \brief Starts a non-blocking Sign of a 32-byte external message: the
+ *         Random, Nonce and Sign commands of calib_sign() are issued from
+ *         calib_sign_poll() as each one completes, so the caller is never
+ *         held for a command's execution time. Like calib_execute_submit(),
+ *         the device stays held for the caller until the job completes.
+ *
+ *  \param[in]  device     Device context pointer
+ *  \param[out] job        Sign state, owned by the caller until complete
+ *  \param[in]  key_id     Slot of the private key to be used to sign the
+ *                         message.
+ *  \param[in]  msg        32-byte message to be signed (copied).
+ *  \param[out] signature  R and S in big-endian format, written when the job
+ *                         completes successfully. 64 bytes for P256 curve.
+ *  \param[in]  callback   Called once from the poll that completes the job;
+ *                         not called when the submit itself fails. May be NULL.
+ *  \param[in]  cb_arg     Passed to the callback
+ *
+ * \return ATCA_SUCCESS once the sign is running, otherwise an error code.
+ */
+ATCA_STATUS calib_sign_submit(ATCADevice device, calib_sign_async_t* job, uint16_t key_id, const uint8_t *msg,
+                              uint8_t *signature, calib_async_cb callback, void* cb_arg)
+{
+    ATCA_STATUS status;
+
+    if ((NULL == device) || (NULL == job) || (NULL == msg) || (NULL == signature))
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    job->exec.device = device;
+    job->callback = callback;
+    job->cb_arg = cb_arg;
+    job->signature = signature;
+    job->key_id = key_id;
+    (void)memcpy(job->msg, msg, sizeof(job->msg));
+#if CALIB_RANDOM_EN
+    // Make sure RNG has updated its seed
+    job->step = CALIB_SIGN_STEP_RANDOM;
+#else
+    job->step = CALIB_SIGN_STEP_NONCE;
+#endif
+
+    // Held across all three commands, as calib_sign() does
+    if ((status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)) == ATCA_SUCCESS)
+    {
+        if ((status = calib_sign_submit_step(job)) != ATCA_SUCCESS)
+        {
+            (void)atca_device_relinquish(device);
+        }
+    }
+
+    if (ATCA_SUCCESS != status)
+    {
+        job->step = CALIB_SIGN_STEP_DONE;
+        job->status = status;
+        return ATCA_TRACE(status, "calib_sign_submit - failed");
+    }
+
+    job->status = ATCA_EXECUTION_PENDING;
+    return ATCA_SUCCESS;
+}
+
+/** \brief Advances a non-blocking sign without waiting: collects the response
+ *         of the running command once it is ready and submits the next one.
+ *
+ *  \param[in,out] job  State from calib_sign_submit()
+ *
+ * \return ATCA_EXECUTION_PENDING while the sign is in progress, otherwise the
+ *         final status (repeated by later polls).
+ */
+ATCA_STATUS calib_sign_poll(calib_sign_async_t* job)
+{
+    ATCA_STATUS status;
+
+    if (NULL == job)
+    {
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer received");
+    }
+
+    if (ATCA_EXECUTION_PENDING != job->status)
+    {
+        return job->status;
+    }
+
+    if (ATCA_EXECUTION_PENDING == (status = calib_execute_poll(&job->exec)))
+    {
+        return status;
+    }
+
+    if (ATCA_SUCCESS != status)
+    {
+        return calib_sign_complete(job, ATCA_TRACE(status, "calib_sign_poll - execution failed"));
+    }
+
+    if (CALIB_SIGN_STEP_SIGN == job->step)
+    {
+        if (job->packet.data[ATCA_COUNT_IDX] != (ATCA_SIG_SIZE + ATCA_PACKET_OVERHEAD))
+        {
+            return calib_sign_complete(job, ATCA_RX_FAIL);
+        }
+        (void)memcpy(job->signature, &job->packet.data[ATCA_RSP_DATA_IDX], ATCA_SIG_SIZE);
+        return calib_sign_complete(job, ATCA_SUCCESS);
+    }
+
+    job->step++;
+    if ((status = calib_sign_submit_step(job)) != ATCA_SUCCESS)
+    {
+        return calib_sign_complete(job, ATCA_TRACE(status, "calib_sign_poll - submit failed"));
+    }
+
+    return ATCA_EXECUTION_PENDING;
+}
+
+/** \brief Time until a non-blocking sign is next worth polling.
+ *
+ *  \param[in] job  State from calib_sign_submit()
+ *
+ * \return Milliseconds to wait; 0 when a poll is due or the job is complete.
+ */
+uint32_t calib_sign_wait_msec(const calib_sign_async_t* job)
+{
+    uint32_t wait = 0;
+
+    if ((NULL != job) && (ATCA_EXECUTION_PENDING == job->status))
+    {
+        wait = calib_execute_wait_msec(&job->exec);
+    }
+
+    return wait;
+}
+#endif
 #endif
 
 #if CALIB_SIGN_EN || CALIB_SIGN_CA2_EN
@@ -200,16 +200,22 @@ static ATCA_STATUS calib_verify_extern_stored_mac(ATCADevice device, uint8_t mod
     uint8_t mac[SECUREBOOT_MAC_SIZE];
     uint8_t host_mac[SECUREBOOT_MAC_SIZE];
 
-    do
+    if ((is_verified == NULL) || (signature == NULL) || (message == NULL) || (num_in == NULL)
+        || (io_key == NULL) || ((mode & VERIFY_MODE_MASK) == VERIFY_MODE_EXTERNAL && public_key == NULL))
     {
-        if ((is_verified == NULL) || (signature == NULL) || (message == NULL) || (num_in == NULL)
-            || (io_key == NULL) || ((mode & VERIFY_MODE_MASK) == VERIFY_MODE_EXTERNAL && public_key == NULL))
-        {
-            return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer recived");
-        }
+        return ATCA_TRACE(ATCA_BAD_PARAM, "NULL pointer recived");
+    }
+
+    *is_verified = false;
 
-        *is_verified = false;
+    // Verify reads the message and system nonce back out of the digest buffer
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
+    }
 
+    do
+    {
         // When using the message digest buffer as the message source, the
         // second 32 bytes in the buffer will be the MAC system nonce.
         (void)memcpy(&msg_dig_buf[0], message, 32);
@@ -248,6 +254,8 @@ static ATCA_STATUS calib_verify_extern_stored_mac(ATCADevice device, uint8_t mod
         *is_verified = (memcmp(host_mac, mac, MAC_SIZE) == 0);
     } while (false);
 
+    (void)atca_device_relinquish(device);
+
     return status;
 }
 
@@ -342,6 +350,12 @@ ATCA_STATUS calib_verify_extern(ATCADevice device, const uint8_t *message, const
 
     *is_verified = false;
 
+    // Nonce and Verify both depend on the message left in the device
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
+    }
+
     do
     {
         // Load message into device
@@ -366,6 +380,8 @@ ATCA_STATUS calib_verify_extern(ATCADevice device, const uint8_t *message, const
         }
     } while (false);
 
+    (void)atca_device_relinquish(device);
+
     return status;
 }
 #endif  /* CALIB_VERIFY_EXTERN */
@@ -402,6 +418,12 @@ ATCA_STATUS calib_verify_stored(ATCADevice device, const uint8_t *message, const
 
     *is_verified = false;
 
+    // Nonce and Verify both depend on the message left in the device
+    if (ATCA_SUCCESS != (status = atca_device_acquire(device, ATCA_PRIORITY_NORMAL)))
+    {
+        return ATCA_TRACE(status, "atca_device_acquire - failed");
+    }
+
     do
     {
         // Load message into device
@@ -426,6 +448,8 @@ ATCA_STATUS calib_verify_stored(ATCADevice device, const uint8_t *message, const
         }
     } while (false);
 
+    (void)atca_device_relinquish(device);
+
     return status;
 }
 
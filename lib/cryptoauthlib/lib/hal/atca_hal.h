@@ -189,6 +189,30 @@ ATCA_STATUS hal_custom_control(ATCAIface iface, uint8_t option, void* param, siz
 #define ATCA_POLLING_MAX_TIME_MSEC        2500
 #endif
 
+/* Polling interval once the learned execution time has passed
+   (CALIB_ADAPTIVE_POLL_EN) */
+#ifndef ATCA_POLLING_FINE_TIME_USEC
+#define ATCA_POLLING_FINE_TIME_USEC       500
+#endif
+
+/* Latest point after a wake (or idle) at which a session starts another
+   command without idling first. Budgeted against the 0.7 s minimum
+   watchdog rather than the 1.3 s typical one: the longest command
+   (115 ms) and a margin for bus time and polling still fit after it. */
+#ifndef ATCA_SESSION_WATCHDOG_MSEC
+#define ATCA_SESSION_WATCHDOG_MSEC        500
+#endif
+
+/* Longest wait in atca_device_acquire() before giving up with ATCA_TIMEOUT,
+   and the pause between attempts while the device is held elsewhere */
+#ifndef ATCA_DEVICE_LOCK_TIMEOUT_MSEC
+#define ATCA_DEVICE_LOCK_TIMEOUT_MSEC     5000
+#endif
+
+#ifndef ATCA_DEVICE_LOCK_RETRY_MSEC
+#define ATCA_DEVICE_LOCK_RETRY_MSEC       1
+#endif
+
 /* Control Function Options */
 /** \brief Execute the hardware specific wake - generally only for kits */
 #define ATCA_HAL_CONTROL_WAKE       (0U)
@@ -226,6 +250,23 @@ void hal_delay_us(uint32_t delay);
 void hal_rtos_delay_ms(uint32_t ms);
 #endif
 
+/** \brief Free-running millisecond clock implemented at the HAL level,
+ *         required by CALIB_SESSION_EN */
+uint32_t hal_get_time_ms(void);
+
+/** \brief Free-running microsecond clock implemented at the HAL level,
+ *         required by CALIB_PROFILE_EN */
+uint32_t hal_get_time_us(void);
+
+/** \brief Identifies the calling thread, task, core or interrupt context,
+ *         required by ATCA_DEVICE_LOCK_EN to recognise the device holder */
+uint32_t hal_get_owner_id(void);
+
+/** \brief Tells ATCA_DEVICE_LOCK_EN whether the waiter has preempted the
+ *         holder, which then cannot run to relinquish until the waiter
+ *         returns (an interrupt over code on its own core) */
+bool hal_owner_preempts(uint32_t waiter, uint32_t holder);
+
 #if defined(__linux__) || defined(__APPLE__)
     #ifdef ATCA_USE_SHARED_MUTEX
         #include <pthread.h>
@@ -89,6 +89,29 @@ void hal_rtos_delay_ms(uint32_t delay)
 }
 #endif
 
+/**
+ * \brief Identifies the calling task for device arbitration
+ *
+ * \return the task handle as an integer; 0 before the scheduler starts
+ */
+uint32_t hal_get_owner_id(void)
+{
+    return (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+}
+
+/**
+ * \brief The device is only used from tasks, and a waiting task blocks in
+ *        atca_delay_ms, so the holder always gets to run
+ *
+ * \return false
+ */
+bool hal_owner_preempts(uint32_t waiter, uint32_t holder)
+{
+    (void)waiter;
+    (void)holder;
+    return false;
+}
+
 ATCA_STATUS hal_create_mutex(void ** ppMutex, const char* pName)
 {
     (void)pName;
@@ -33,6 +33,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <time.h>
 
 #include "atca_hal.h"
 
@@ -70,6 +71,51 @@ void hal_delay_ms(uint32_t delay)
     }
 }
 
+/** \brief Free-running millisecond clock (CLOCK_MONOTONIC)
+ *
+ * \return milliseconds since an arbitrary start point; wraps at 2^32
+ */
+uint32_t hal_get_time_ms(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000U) + ((uint64_t)ts.tv_nsec / 1000000U));
+}
+
+/** \brief Free-running microsecond clock (CLOCK_MONOTONIC)
+ *
+ * \return microseconds since an arbitrary start point; wraps at 2^32
+ */
+uint32_t hal_get_time_us(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U));
+}
+
+/** \brief Identifies the calling thread for device arbitration
+ *
+ * \return the kernel thread id
+ */
+uint32_t hal_get_owner_id(void)
+{
+    return (uint32_t)hal_get_thread_id();
+}
+
+/** \brief Threads are scheduled independently, so a waiting thread never
+ *         stops the holder from running
+ *
+ * \return false
+ */
+bool hal_owner_preempts(uint32_t waiter, uint32_t holder)
+{
+    (void)waiter;
+    (void)holder;
+    return false;
+}
+
 #ifndef ATCA_USE_RTOS_TIMER
 
 #ifdef ATCA_USE_SHARED_MUTEX
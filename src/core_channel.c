@@ -0,0 +1,219 @@
+#include "core_channel.h"
+#include <string.h>
+#include "pico/stdlib.h"
+
+#ifndef CORE_CHANNEL_NO_DOORBELL
+#include "pico/multicore.h"
+#endif
+
+#define CORE_CHANNEL_MASK   (CORE_CHANNEL_CAPACITY - 1U)
+
+// Value pushed through the SIO FIFO; the payload always travels in the ring
+#define CORE_CHANNEL_DOORBELL   0xD004BE11UL
+
+#define CORE_BYTE_RING_MASK (CORE_BYTE_RING_SIZE - 1U)
+
+_Static_assert((CORE_CHANNEL_CAPACITY & CORE_CHANNEL_MASK) == 0,
+               "CORE_CHANNEL_CAPACITY must be a power of two");
+_Static_assert((CORE_BYTE_RING_SIZE & CORE_BYTE_RING_MASK) == 0,
+               "CORE_BYTE_RING_SIZE must be a power of two");
+
+// Acquire on the other side's index, release on our own: the slot contents
+// are visible before the index that publishes them, and a slot is not
+// reused until the consumer has finished copying it out.
+static inline uint32_t load_acquire(const uint32_t* index)
+{
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(uint32_t* index, uint32_t value)
+{
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+static void ring_doorbell(bool doorbell)
+{
+#ifndef CORE_CHANNEL_NO_DOORBELL
+    // A full FIFO already holds a pending wake-up, so never block here
+    if (doorbell && multicore_fifo_wready()) {
+        multicore_fifo_push_blocking(CORE_CHANNEL_DOORBELL);
+    }
+#else
+    (void)doorbell;
+#endif
+}
+
+static void wait_doorbell(bool doorbell, uint32_t timeout_us)
+{
+#ifndef CORE_CHANNEL_NO_DOORBELL
+    if (doorbell) {
+        // Sleeps in WFE until the producer rings or the timeout expires
+        uint32_t value;
+        multicore_fifo_pop_timeout_us(timeout_us, &value);
+        return;
+    }
+#else
+    (void)doorbell;
+#endif
+
+    sleep_us(timeout_us);
+}
+
+void core_channel_init(core_channel_t* channel, bool doorbell)
+{
+    memset(channel, 0, sizeof(core_channel_t));
+#ifdef CORE_CHANNEL_NO_DOORBELL
+    (void)doorbell;
+    channel->doorbell = false;
+#else
+    channel->doorbell = doorbell;
+#endif
+}
+
+bool core_channel_push(core_channel_t* channel, const core_msg_t* msg)
+{
+    uint32_t head = channel->head;
+    uint32_t tail = load_acquire(&channel->tail);
+
+    if (head - tail >= CORE_CHANNEL_CAPACITY) {
+        channel->dropped++;
+        return false;
+    }
+
+    core_msg_t* slot = &channel->slots[head & CORE_CHANNEL_MASK];
+    *slot = *msg;
+    slot->seq = channel->next_seq++;
+
+    store_release(&channel->head, head + 1);
+    ring_doorbell(channel->doorbell);
+
+    return true;
+}
+
+bool core_channel_peek(core_channel_t* channel, core_msg_t* msg)
+{
+    uint32_t tail = channel->tail;
+    uint32_t head = load_acquire(&channel->head);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *msg = channel->slots[tail & CORE_CHANNEL_MASK];
+    return true;
+}
+
+bool core_channel_pop(core_channel_t* channel, core_msg_t* msg)
+{
+    if (!core_channel_peek(channel, msg)) {
+        return false;
+    }
+
+    store_release(&channel->tail, channel->tail + 1);
+    return true;
+}
+
+bool core_channel_wait(core_channel_t* channel, uint32_t timeout_us)
+{
+    if (core_channel_count(channel) > 0) {
+        return true;
+    }
+
+    wait_doorbell(channel->doorbell, timeout_us);
+    return core_channel_count(channel) > 0;
+}
+
+uint32_t core_channel_count(const core_channel_t* channel)
+{
+    return load_acquire(&channel->head) - load_acquire(&channel->tail);
+}
+
+uint32_t core_channel_get_dropped(const core_channel_t* channel)
+{
+    return __atomic_load_n(&channel->dropped, __ATOMIC_RELAXED);
+}
+
+void core_byte_ring_init(core_byte_ring_t* ring, bool doorbell)
+{
+    memset(ring, 0, sizeof(core_byte_ring_t));
+#ifdef CORE_CHANNEL_NO_DOORBELL
+    (void)doorbell;
+    ring->doorbell = false;
+#else
+    ring->doorbell = doorbell;
+#endif
+}
+
+size_t core_byte_ring_write(core_byte_ring_t* ring, const uint8_t* data, size_t len)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = load_acquire(&ring->tail);
+    size_t space = CORE_BYTE_RING_SIZE - (head - tail);
+
+    if (len > space) {
+        len = space;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    // At most two copies: up to the end of the buffer, then from the start
+    size_t offset = head & CORE_BYTE_RING_MASK;
+    size_t first = CORE_BYTE_RING_SIZE - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&ring->data[offset], data, first);
+    memcpy(&ring->data[0], data + first, len - first);
+
+    store_release(&ring->head, head + (uint32_t)len);
+    ring_doorbell(ring->doorbell);
+
+    return len;
+}
+
+size_t core_byte_ring_read(core_byte_ring_t* ring, uint8_t* data, size_t max_len)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = load_acquire(&ring->head);
+    size_t len = head - tail;
+
+    if (len > max_len) {
+        len = max_len;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    size_t offset = tail & CORE_BYTE_RING_MASK;
+    size_t first = CORE_BYTE_RING_SIZE - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, &ring->data[offset], first);
+    memcpy(data + first, &ring->data[0], len - first);
+
+    store_release(&ring->tail, tail + (uint32_t)len);
+
+    return len;
+}
+
+size_t core_byte_ring_count(const core_byte_ring_t* ring)
+{
+    return load_acquire(&ring->head) - load_acquire(&ring->tail);
+}
+
+size_t core_byte_ring_free(const core_byte_ring_t* ring)
+{
+    return CORE_BYTE_RING_SIZE - core_byte_ring_count(ring);
+}
+
+bool core_byte_ring_wait(core_byte_ring_t* ring, uint32_t timeout_us)
+{
+    if (core_byte_ring_count(ring) > 0) {
+        return true;
+    }
+
+    wait_doorbell(ring->doorbell, timeout_us);
+    return core_byte_ring_count(ring) > 0;
+}
@@ -0,0 +1,217 @@
+#include "device_telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include <malloc.h>
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+#include "hardware/adc.h"
+
+#include "mem_manager.h"
+#include "latency_stats.h"
+#include "upload_pipeline.h"
+#include "wifi_manager.h"
+
+#ifdef FIRMWARE_FREERTOS
+#include "FreeRTOS.h"
+#endif
+
+// ADC input wired to the on-die temperature sensor
+#define TELEMETRY_TEMP_ADC_INPUT    4U
+
+// Internal state structure
+typedef struct {
+    bool initialized;
+    critical_section_t lock;
+    device_telemetry_t snapshot;
+
+    // Written only by the owning core, read by the sampler
+    volatile uint32_t idle_us[2];
+    volatile bool idle_reported[2];
+    uint32_t last_idle_us[2];
+    uint32_t last_sample_us;
+
+    uint32_t heap_peak;
+} device_telemetry_state_t;
+
+static device_telemetry_state_t g_telemetry_state = {
+    .initialized = false,
+    .last_sample_us = 0,
+    .heap_peak = 0
+};
+
+// Forward declarations
+static int16_t read_die_temp_decic(void);
+static void read_heap(uint32_t* free_bytes, uint32_t* used_bytes);
+
+void device_telemetry_init(void)
+{
+    if (g_telemetry_state.initialized) {
+        return;
+    }
+
+    critical_section_init(&g_telemetry_state.lock);
+    memset(&g_telemetry_state.snapshot, 0, sizeof(g_telemetry_state.snapshot));
+
+    adc_init();
+    adc_set_temp_sensor_enabled(true);
+
+    g_telemetry_state.last_sample_us = time_us_32();
+    g_telemetry_state.initialized = true;
+}
+
+void device_telemetry_sample(void)
+{
+    if (!g_telemetry_state.initialized) {
+        return;
+    }
+
+    device_telemetry_t sample = g_telemetry_state.snapshot;
+
+    sample.temp_decic = read_die_temp_decic();
+
+    uint32_t heap_used = 0;
+    read_heap(&sample.heap_free, &heap_used);
+    if (heap_used > g_telemetry_state.heap_peak) {
+        g_telemetry_state.heap_peak = heap_used;
+    }
+    sample.heap_peak = g_telemetry_state.heap_peak;
+
+    mem_stats_t mem;
+    mem_manager_get_stats(&mem);
+    sample.tls_peak = (uint32_t)mem.tls_bytes_peak;
+
+    // Busy share = 1 - time spent waiting in the main loop over the window
+    uint32_t now_us = time_us_32();
+    uint32_t window_us = now_us - g_telemetry_state.last_sample_us;
+    g_telemetry_state.last_sample_us = now_us;
+
+    for (int core = 0; core < 2; core++) {
+        uint32_t idle = g_telemetry_state.idle_us[core];
+        uint32_t idle_delta = idle - g_telemetry_state.last_idle_us[core];
+        g_telemetry_state.last_idle_us[core] = idle;
+
+        if (window_us > 0 && idle_delta <= window_us) {
+            sample.core_util[core] = (uint8_t)(100U - (uint32_t)(((uint64_t)idle_delta * 100U) / window_us));
+        }
+    }
+
+    wifi_link_quality_t link;
+    wifi_manager_get_link_quality(&link);
+    sample.rssi_dbm = link.rssi_dbm;
+    sample.link_score = link.score;
+
+    sample.queue_depth = upload_pipeline_count();
+
+    latency_histogram_t sign;
+    if (latency_stats_get(LATENCY_PHASE_SIGN, &sign)) {
+        sample.atecc_sign_us = sign.last_us;
+        sample.atecc_sign_max_us = sign.max_us;
+    }
+
+    sample.samples++;
+
+    // The upload path formats the snapshot from the async_context
+    critical_section_enter_blocking(&g_telemetry_state.lock);
+    g_telemetry_state.snapshot = sample;
+    critical_section_exit(&g_telemetry_state.lock);
+}
+
+void device_telemetry_note_idle(uint32_t idle_us)
+{
+    uint core = get_core_num();
+
+    g_telemetry_state.idle_us[core] += idle_us;
+    g_telemetry_state.idle_reported[core] = true;
+}
+
+void device_telemetry_get(device_telemetry_t* telemetry)
+{
+    if (!telemetry) {
+        return;
+    }
+
+    if (!g_telemetry_state.initialized) {
+        memset(telemetry, 0, sizeof(*telemetry));
+        return;
+    }
+
+    critical_section_enter_blocking(&g_telemetry_state.lock);
+    *telemetry = g_telemetry_state.snapshot;
+    critical_section_exit(&g_telemetry_state.lock);
+}
+
+int device_telemetry_format_json(char* buffer, size_t buffer_size)
+{
+    if (!buffer || buffer_size == 0) {
+        return -1;
+    }
+
+    device_telemetry_t t;
+    device_telemetry_get(&t);
+
+    int temp_abs = (t.temp_decic < 0) ? -t.temp_decic : t.temp_decic;
+    int len = snprintf(buffer, buffer_size,
+                       "\"dev\":{\"temp\":%s%d.%d,\"heap_free\":%lu,\"heap_peak\":%lu,\"tls_peak\":%lu,"
+                       "\"rssi\":%ld,\"link\":%u,\"queue\":%lu,\"atecc_us\":%lu,\"atecc_max_us\":%lu",
+                       (t.temp_decic < 0) ? "-" : "", temp_abs / 10, temp_abs % 10,
+                       t.heap_free, t.heap_peak, t.tls_peak,
+                       t.rssi_dbm, t.link_score, t.queue_depth, t.atecc_sign_us, t.atecc_sign_max_us);
+
+    // Loop utilisation only for cores whose main loop reports its idle time
+    for (int core = 0; core < 2 && len > 0 && (size_t)len < buffer_size; core++) {
+        if (g_telemetry_state.idle_reported[core]) {
+            len += snprintf(buffer + len, buffer_size - len, ",\"cpu%d\":%u", core, t.core_util[core]);
+        }
+    }
+
+    if (len > 0 && (size_t)len < buffer_size) {
+        len += snprintf(buffer + len, buffer_size - len, "}");
+    }
+
+    return len;
+}
+
+void device_telemetry_print(void)
+{
+    device_telemetry_t t;
+    device_telemetry_get(&t);
+
+    int temp_abs = (t.temp_decic < 0) ? -t.temp_decic : t.temp_decic;
+    printf("Device Telemetry: %s%d.%d C, heap %lu free / %lu peak, TLS peak %lu\n",
+           (t.temp_decic < 0) ? "-" : "", temp_abs / 10, temp_abs % 10,
+           t.heap_free, t.heap_peak, t.tls_peak);
+    printf("Device Telemetry: core 0 %u%%, core 1 %u%% busy, RSSI %ld dBm (link %u), %lu queued\n",
+           t.core_util[0], t.core_util[1], t.rssi_dbm, t.link_score, t.queue_depth);
+    printf("Device Telemetry: ATECC sign last %lu us, max %lu us (%lu samples)\n",
+           t.atecc_sign_us, t.atecc_sign_max_us, t.samples);
+}
+
+// Internal helper functions
+
+static int16_t read_die_temp_decic(void)
+{
+    // RP2040 datasheet 4.9.5: T = 27 - (V - 0.706) / 0.001721
+    adc_select_input(TELEMETRY_TEMP_ADC_INPUT);
+    uint16_t raw = adc_read();
+
+    float volts = raw * (3.3f / (1 << 12));
+    float temp_c = 27.0f - (volts - 0.706f) / 0.001721f;
+
+    return (int16_t)(temp_c * 10.0f);
+}
+
+static void read_heap(uint32_t* free_bytes, uint32_t* used_bytes)
+{
+#ifdef FIRMWARE_FREERTOS
+    *free_bytes = (uint32_t)xPortGetFreeHeapSize();
+    *used_bytes = (uint32_t)(configTOTAL_HEAP_SIZE - xPortGetMinimumEverFreeHeapSize());
+#else
+    // newlib heap grows from the end of .bss towards the stack limit
+    extern char __StackLimit, __bss_end__;
+    uint32_t total = (uint32_t)(&__StackLimit - &__bss_end__);
+    struct mallinfo info = mallinfo();
+
+    *used_bytes = (uint32_t)info.uordblks;
+    *free_bytes = total - (uint32_t)info.uordblks;
+#endif
+}
@@ -1,20 +1,67 @@
 #include <stdlib.h>
 #include <string.h>
 #include "pico/stdlib.h"
+#include "pico/critical_section.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 #include "cryptoauthlib.h"
+#include "hal_pico_i2c.h"
 
-// I2C Configuration
-#define HAL_I2C_INSTANCE    i2c0
-#define HAL_I2C_SDA_PIN     4
-#define HAL_I2C_SCL_PIN     5
-#define HAL_I2C_BAUDRATE    100000  // 100kHz for stability
-#define HAL_I2C_DEVICE_ADDR 0x60    // ATECC608B 7-bit address
+// I2C Configuration (bus and baud come from the ATCAIfaceCfg). i2c1 is only
+// wired on the gateway variant, which has secure elements on both buses.
+#define HAL_I2C0_SDA_PIN    4
+#define HAL_I2C0_SCL_PIN    5
+#define HAL_I2C1_SDA_PIN    6
+#define HAL_I2C1_SCL_PIN    7
+
+// DMA transfers (ATECC_I2C_DMA=ON in CMake). Off by default until the DMA
+// path has been run on a board; every transfer is then fed by the CPU.
+#ifndef HAL_I2C_DMA_EN
+#define HAL_I2C_DMA_EN          0
+#endif
+
+// With DMA, transfers of at least this many bytes (command packets, block
+// reads, signatures) go through it; the length byte, wake reply and status
+// packets are fed by the CPU
+#define HAL_I2C_DMA_MIN_BYTES   16
+
+// Largest transfer: word address plus the longest command packet
+#define HAL_I2C_XFER_MAX        (1 + ATCA_CMD_SIZE_MAX)
+
+// Longest wait for the bus lock: a few of the longest transfers at 100 kHz
+// (about 29 ms each) by the other devices on the bus
+#define HAL_I2C_LOCK_TIMEOUT_US 100000
+
+// Per-bus state, kept in iface->hal_data and shared by every device on the
+// bus. Each transfer holds the bus lock, so devices on one bus can be used
+// from both cores (the device pool) and take turns on the wire while their
+// commands execute in parallel; devices on different buses never wait.
+typedef struct {
+    i2c_inst_t* i2c;
+    uint sda_pin;
+    uint scl_pin;
+    uint8_t users;                          // Devices initialized on the bus
+    // Bus lock: the guard is only held while busy/owner change, the
+    // transfer itself runs with interrupts enabled
+    critical_section_t guard;
+    volatile bool busy;
+    uint32_t owner;                         // hal_get_owner_id() of the holder
+    int tx_dma;                             // Feeds IC_DATA_CMD, -1 without DMA
+    int rx_dma;                             // Drains IC_DATA_CMD into the caller's buffer
+    // IC_DATA_CMD entries for a DMA transfer: the controller takes 32-bit
+    // words (data, read and STOP bits), so bytes cannot be streamed as is
+    uint32_t cmd[HAL_I2C_XFER_MAX];
+    hal_i2c_xfer_stats_t stats;
+} hal_pico_i2c_t;
+
+static hal_pico_i2c_t g_hal_i2c[NUM_I2CS];
 
 // ============================================================================
 // MEMORY MANAGEMENT FUNCTIONS
 // ============================================================================
 
+// The FreeRTOS build takes these (and the mutexes) from hal_freertos.c
+#ifndef FIRMWARE_FREERTOS
 void* hal_malloc(size_t size) {
     return malloc(size);
 }
@@ -24,6 +71,7 @@ void hal_free(void* ptr) {
         free(ptr);
     }
 }
+#endif
 
 // ============================================================================
 // TIMING FUNCTIONS
@@ -39,31 +87,330 @@ void hal_delay_us(uint32_t us) {
 
 // Alternative names that some parts of CryptoAuthLib may expect
 void atca_delay_ms(uint32_t ms) {
-    busy_wait_ms(ms);
+#ifdef FIRMWARE_FREERTOS
+    // Command execution waits yield to other tasks once the scheduler runs
+    hal_rtos_delay_ms(ms);
+#else
+    // Sleep in WFE until an interrupt or the deadline rather than spinning;
+    // inside an IRQ handler the SDK falls back to polling the timer
+    absolute_time_t until = make_timeout_time_ms(ms);
+    while (!best_effort_wfe_or_timeout(until)) {
+        tight_loop_contents();
+    }
+#endif
 }
 
 void atca_delay_us(uint32_t us) {
     busy_wait_us(us);
 }
 
+// Watchdog tracking for keep-awake sessions
+uint32_t hal_get_time_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// Command profile (CALIB_PROFILE_EN)
+uint32_t hal_get_time_us(void) {
+    return time_us_32();
+}
+
+// ============================================================================
+// DEVICE ARBITRATION
+// ============================================================================
+
+#ifndef FIRMWARE_FREERTOS
+// Holder identity for atca_device_acquire: the core, and the exception
+// number when called from an interrupt (the TLS sign runs in the lwIP IRQ on
+// core 1), so an IRQ never counts as re-entering its own core's hold
+uint32_t hal_get_owner_id(void) {
+    return (get_core_num() << 16) | __get_current_exception();
+}
+
+// An interrupt waiting on a different holder on its own core has suspended
+// that holder (thread code or a lower priority IRQ), so waiting would only
+// run into ATCA_DEVICE_LOCK_TIMEOUT_MSEC with the core stalled
+bool hal_owner_preempts(uint32_t waiter, uint32_t holder) {
+    return (waiter != holder) && ((waiter >> 16) == (holder >> 16)) && ((waiter & 0xFFFFu) != 0);
+}
+
+// The device lock's guard is only held while the holder/queue fields change.
+// A critical section (spin lock with interrupts off) rather than a pico
+// mutex: it is taken from both cores and from IRQ context, where a mutex
+// owned by the interrupted code on the same core would never be released.
+ATCA_STATUS hal_create_mutex(void** ppMutex, const char* pName) {
+    (void)pName;
+    if (!ppMutex) {
+        return ATCA_BAD_PARAM;
+    }
+
+    critical_section_t* cs = malloc(sizeof(critical_section_t));
+    if (!cs) {
+        return ATCA_ALLOC_FAILURE;
+    }
+    critical_section_init(cs);
+    *ppMutex = cs;
+    return ATCA_SUCCESS;
+}
+
+ATCA_STATUS hal_destroy_mutex(void* pMutex) {
+    if (!pMutex) {
+        return ATCA_BAD_PARAM;
+    }
+    critical_section_deinit((critical_section_t*)pMutex);
+    free(pMutex);
+    return ATCA_SUCCESS;
+}
+
+ATCA_STATUS hal_lock_mutex(void* pMutex) {
+    if (!pMutex) {
+        return ATCA_BAD_PARAM;
+    }
+    critical_section_enter_blocking((critical_section_t*)pMutex);
+    return ATCA_SUCCESS;
+}
+
+ATCA_STATUS hal_unlock_mutex(void* pMutex) {
+    if (!pMutex) {
+        return ATCA_BAD_PARAM;
+    }
+    critical_section_exit((critical_section_t*)pMutex);
+    return ATCA_SUCCESS;
+}
+#endif
+
 // ============================================================================
 // I2C HAL IMPLEMENTATION
 // ============================================================================
 
+// Word address of a command packet; the per-command transfer time runs
+// from its write to the next one
+#define HAL_I2C_WORD_COMMAND    0x03
+
+static hal_pico_i2c_t* hal_i2c_bus(ATCAIface iface) {
+    return (hal_pico_i2c_t*)atgetifacehaldat(iface);
+}
+
+// Takes the bus for one transfer. Fails at once when the holder is the code
+// this interrupt preempted on its own core, which cannot finish first.
+static bool hal_i2c_lock(hal_pico_i2c_t* bus) {
+    uint32_t owner = hal_get_owner_id();
+    absolute_time_t deadline = make_timeout_time_us(HAL_I2C_LOCK_TIMEOUT_US);
+    bool waited = false;
+
+    while (true) {
+        critical_section_enter_blocking(&bus->guard);
+        bool taken = !bus->busy;
+        bool failed = !taken && (hal_owner_preempts(owner, bus->owner) || time_reached(deadline));
+        if (taken) {
+            bus->busy = true;
+            bus->owner = owner;
+        } else if (!waited) {
+            bus->stats.lock_waits++;
+            waited = true;
+        }
+        if (failed) {
+            bus->stats.lock_failures++;
+        }
+        critical_section_exit(&bus->guard);
+
+        if (taken || failed) {
+            return taken;
+        }
+#ifdef FIRMWARE_FREERTOS
+        // Let a holder on this core run
+        hal_rtos_delay_ms(1);
+#else
+        tight_loop_contents();
+#endif
+    }
+}
+
+static void hal_i2c_unlock(hal_pico_i2c_t* bus) {
+    critical_section_enter_blocking(&bus->guard);
+    bus->busy = false;
+    critical_section_exit(&bus->guard);
+}
+
+// SDA held low for 80 µs wakes the part at any bus speed (and every other
+// part on the bus; those idle out on their watchdog). Only the pulse holds
+// the bus, not the wait for the part to come up.
+static bool hal_i2c_wake_pulse(hal_pico_i2c_t* bus) {
+    if (!hal_i2c_lock(bus)) {
+        return false;
+    }
+
+    gpio_set_function(bus->sda_pin, GPIO_FUNC_SIO);      // Switch to GPIO
+    gpio_set_dir(bus->sda_pin, GPIO_OUT);                // Set as output
+    gpio_put(bus->sda_pin, 0);                           // Drive SDA LOW
+
+    busy_wait_us(80);                                    // Hold low for 80µs
+
+    gpio_put(bus->sda_pin, 1);                           // Release SDA
+    gpio_set_function(bus->sda_pin, GPIO_FUNC_I2C);      // Switch back to I2C
+    gpio_pull_up(bus->sda_pin);
+    hal_i2c_unlock(bus);
+
+    busy_wait_ms(2);                                     // Wait 2ms for wake
+    return true;
+}
+
+// Twice the bus time at 9 clocks a byte, plus a millisecond for clock
+// stretching and the STOP
+static uint32_t hal_i2c_timeout_us(const hal_pico_i2c_t* bus, size_t bytes) {
+    return (uint32_t)((uint64_t)(bytes + 1) * 18u * 1000000u / bus->stats.baud) + 1000u;
+}
+
+// Addresses the target and clears what the previous transfer left behind
+static void hal_i2c_begin(hal_pico_i2c_t* bus, uint8_t address) {
+    i2c_hw_t* hw = i2c_get_hw(bus->i2c);
+
+    hw->enable = 0;
+    hw->tar = address;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+}
+
+// Waits for the STOP that ends the transfer; the controller also sends one
+// after a NAK. DMA still queued for a failed transfer is cancelled before
+// the abort is cleared, or it would start a new one.
+static bool hal_i2c_end(hal_pico_i2c_t* bus, absolute_time_t deadline) {
+    i2c_hw_t* hw = i2c_get_hw(bus->i2c);
+    bool stopped;
+
+    while (!(stopped = (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS) != 0) &&
+           !time_reached(deadline)) {
+        tight_loop_contents();
+    }
+
+    bool aborted = (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) != 0;
+
+    if ((!stopped || aborted) && bus->tx_dma >= 0) {
+        dma_channel_abort((uint)bus->tx_dma);
+        dma_channel_abort((uint)bus->rx_dma);
+    }
+    if (!stopped) {
+        // Stuck bus: disabling the controller flushes its FIFOs
+        hw->enable = 0;
+    }
+
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+    return stopped && !aborted;
+}
+
+// Short writes: word address, then the payload straight from the caller's
+// buffer, one FIFO entry at a time
+static bool hal_i2c_write_cpu(hal_pico_i2c_t* bus, uint8_t word_address, const uint8_t* data, size_t len,
+                              absolute_time_t deadline) {
+    i2c_hw_t* hw = i2c_get_hw(bus->i2c);
+
+    for (size_t i = 0; i <= len; i++) {
+        uint32_t entry = (i == 0) ? word_address : data[i - 1];
+        if (i == len) {
+            entry |= I2C_IC_DATA_CMD_STOP_BITS;
+        }
+        while (i2c_get_write_available(bus->i2c) == 0) {
+            if ((hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) || time_reached(deadline)) {
+                return false;
+            }
+        }
+        hw->data_cmd = entry;
+    }
+    return true;
+}
+
+static void hal_i2c_dma_tx(hal_pico_i2c_t* bus, size_t count, bool start) {
+    dma_channel_config c = dma_channel_get_default_config((uint)bus->tx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(bus->i2c, true));
+    dma_channel_configure((uint)bus->tx_dma, &c, &i2c_get_hw(bus->i2c)->data_cmd, bus->cmd, count, start);
+}
+
+// Packet writes: word address and payload gathered into one list of
+// IC_DATA_CMD entries and paced into the TX FIFO by DMA
+static void hal_i2c_write_dma(hal_pico_i2c_t* bus, uint8_t word_address, const uint8_t* data, size_t len) {
+    bus->cmd[0] = word_address;
+    for (size_t i = 0; i < len; i++) {
+        bus->cmd[i + 1] = data[i];
+    }
+    bus->cmd[len] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    hal_i2c_dma_tx(bus, len + 1, true);
+}
+
+// Response reads: one channel queues the read commands, the other moves
+// each received byte straight into the caller's buffer
+static void hal_i2c_read_dma(hal_pico_i2c_t* bus, uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        bus->cmd[i] = I2C_IC_DATA_CMD_CMD_BITS;
+    }
+    bus->cmd[len - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    dma_channel_config c = dma_channel_get_default_config((uint)bus->rx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, i2c_get_dreq(bus->i2c, false));
+    dma_channel_configure((uint)bus->rx_dma, &c, data, &i2c_get_hw(bus->i2c)->data_cmd, len, false);
+
+    hal_i2c_dma_tx(bus, len, false);
+    dma_start_channel_mask((1u << bus->rx_dma) | (1u << bus->tx_dma));
+}
+
 /**
- * @brief Initialize I2C interface for ATECC608B
+ * @brief Initialize the I2C bus for ATECC608B at the configured baud
+ *
+ * The bus number selects i2c0/i2c1 and its HAL_I2Cn pins. The first device
+ * on a bus sets it up; later ones (other addresses) share it, clock
+ * included. With HAL_I2C_DMA_EN two DMA channels are claimed per bus when
+ * free, otherwise every transfer is fed by the CPU.
  */
 ATCA_STATUS hal_i2c_init(ATCAIface iface, ATCAIfaceCfg* cfg) {
-    printf("HAL: I2C init called\n");
-    
-    // Initialize I2C hardware
-    i2c_init(HAL_I2C_INSTANCE, HAL_I2C_BAUDRATE);
-    gpio_set_function(HAL_I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(HAL_I2C_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(HAL_I2C_SDA_PIN);
-    gpio_pull_up(HAL_I2C_SCL_PIN);
-    
-    printf("HAL: I2C initialized at %d kHz\n", HAL_I2C_BAUDRATE / 1000);
+    uint8_t bus_num = ATCA_IFACECFG_VALUE(cfg, atcai2c.bus);
+    uint32_t baud = ATCA_IFACECFG_VALUE(cfg, atcai2c.baud);
+
+    if (bus_num >= NUM_I2CS || baud == 0) {
+        return ATCA_BAD_PARAM;
+    }
+
+    hal_pico_i2c_t* bus = &g_hal_i2c[bus_num];
+    if (bus->users > 0) {
+        bus->users++;
+        iface->hal_data = bus;
+        return ATCA_SUCCESS;
+    }
+
+    memset(bus, 0, sizeof(*bus));
+    bus->i2c = i2c_get_instance(bus_num);
+    bus->sda_pin = (bus_num == 0) ? HAL_I2C0_SDA_PIN : HAL_I2C1_SDA_PIN;
+    bus->scl_pin = (bus_num == 0) ? HAL_I2C0_SCL_PIN : HAL_I2C1_SCL_PIN;
+    bus->users = 1;
+    critical_section_init(&bus->guard);
+    bus->tx_dma = HAL_I2C_DMA_EN ? dma_claim_unused_channel(false) : -1;
+    bus->rx_dma = HAL_I2C_DMA_EN ? dma_claim_unused_channel(false) : -1;
+    if (bus->tx_dma < 0 || bus->rx_dma < 0) {
+        if (bus->tx_dma >= 0) {
+            dma_channel_unclaim((uint)bus->tx_dma);
+        }
+        if (bus->rx_dma >= 0) {
+            dma_channel_unclaim((uint)bus->rx_dma);
+        }
+        bus->tx_dma = bus->rx_dma = -1;
+    }
+
+    bus->stats.baud = i2c_init(bus->i2c, baud);
+    gpio_set_function(bus->sda_pin, GPIO_FUNC_I2C);
+    gpio_set_function(bus->scl_pin, GPIO_FUNC_I2C);
+    gpio_pull_up(bus->sda_pin);
+    gpio_pull_up(bus->scl_pin);
+
+    iface->hal_data = bus;
+
+    printf("HAL: I2C%u initialized at %lu kHz, %s\n", bus_num, (unsigned long)(bus->stats.baud / 1000),
+           bus->tx_dma >= 0 ? "DMA" : (HAL_I2C_DMA_EN ? "no DMA channel free" : "CPU transfers"));
     return ATCA_SUCCESS;
 }
 
@@ -76,120 +423,192 @@ ATCA_STATUS hal_i2c_post_init(ATCAIface iface) {
 }
 
 /**
- * @brief Send data over I2C to ATECC608B
- * 
- * Handles special cases:
- * - Wake sequence (address 0x00/0x01 with 0 bytes)
- * - Word address prepending (0x02/0x03)
- * - Regular command transmission
+ * @brief Send a word address and optional data to ATECC608B
+ *
+ * The wake is the library's general call (device address 0), done as a
+ * GPIO pulse. Idle and sleep are a bare word address.
  */
-ATCA_STATUS hal_i2c_send(ATCAIface iface, uint8_t address, uint8_t* data, int len) {
-    // SPECIAL CASE 1: Wake sequence detection
-    // CryptoAuthLib sends to 0x00 or 0x01 with 0 bytes to trigger wake
-    if ((address == 0x00 || address == 0x01) && len == 0) {
-        
-        // Execute GPIO-based wake pulse
-        gpio_set_function(HAL_I2C_SDA_PIN, GPIO_FUNC_SIO);   // Switch to GPIO
-        gpio_set_dir(HAL_I2C_SDA_PIN, GPIO_OUT);             // Set as output
-        gpio_put(HAL_I2C_SDA_PIN, 0);                        // Drive SDA LOW
-        
-        busy_wait_us(80);                                    // Hold low for 80µs
-        
-        gpio_put(HAL_I2C_SDA_PIN, 1);                        // Release SDA
-        gpio_set_function(HAL_I2C_SDA_PIN, GPIO_FUNC_I2C);   // Switch back to I2C
-        gpio_pull_up(HAL_I2C_SDA_PIN);
-        
-        busy_wait_ms(2);                                     // Wait 2ms for wake
-        
-        return ATCA_SUCCESS;
-    }
-    
-    // Validate parameters for regular transmission
-    if (!data || len <= 0) {
+ATCA_STATUS hal_i2c_send(ATCAIface iface, uint8_t word_address, uint8_t* txdata, int txlength) {
+    hal_pico_i2c_t* bus = hal_i2c_bus(iface);
+    uint8_t address = ATCA_IFACECFG_VALUE(iface->mIfaceCFG, atcai2c.address);
+
+    if (!bus || txlength < 0 || (txlength > 0 && !txdata) || txlength + 1 > HAL_I2C_XFER_MAX) {
         return ATCA_BAD_PARAM;
     }
-    
-    // SPECIAL CASE 2: Word address prepending
-    // Some CryptoAuthLib operations use 0x02/0x03 as word addresses
-    if (address == 0x02 || address == 0x03) {
-        // Create buffer with word address prepended
-        uint8_t full_cmd[len + 1];
-        full_cmd[0] = address;              // Word address first
-        memcpy(full_cmd + 1, data, len);    // Then command data
-        
-        // Send to device address 0x60
-        int result = i2c_write_blocking(HAL_I2C_INSTANCE, HAL_I2C_DEVICE_ADDR, full_cmd, len + 1, false);
-        
-        return (result == len + 1) ? ATCA_SUCCESS : ATCA_COMM_FAIL;
-    }
-    
-    // REGULAR CASE: Standard I2C transmission
-    int result = i2c_write_blocking(HAL_I2C_INSTANCE, address, data, len, false);
-    
-    if (result == len) {
-        return ATCA_SUCCESS;
-    } else {
+
+    if (address == 0) {
+        return hal_i2c_wake_pulse(bus) ? ATCA_SUCCESS : ATCA_COMM_FAIL;
+    }
+    if (!hal_i2c_lock(bus)) {
         return ATCA_COMM_FAIL;
     }
+
+    size_t bytes = (size_t)txlength + 1;
+    absolute_time_t deadline = make_timeout_time_us(hal_i2c_timeout_us(bus, bytes));
+    uint32_t start = time_us_32();
+    bool ok = true;
+
+    hal_i2c_begin(bus, address);
+    if (bus->tx_dma >= 0 && bytes >= HAL_I2C_DMA_MIN_BYTES) {
+        hal_i2c_write_dma(bus, word_address, txdata, (size_t)txlength);
+        bus->stats.dma_transfers++;
+    } else {
+        ok = hal_i2c_write_cpu(bus, word_address, txdata, (size_t)txlength, deadline);
+    }
+    ok = hal_i2c_end(bus, deadline) && ok;
+
+    uint32_t elapsed = time_us_32() - start;
+    bus->stats.total_us += elapsed;
+    if (word_address == HAL_I2C_WORD_COMMAND) {
+        bus->stats.commands++;
+        bus->stats.last_tx_bytes = (uint32_t)bytes;
+        bus->stats.last_tx_us = elapsed;
+        bus->stats.last_rx_bytes = 0;
+        bus->stats.last_rx_us = 0;
+    }
+    hal_i2c_unlock(bus);
+
+    return ok ? ATCA_SUCCESS : ATCA_COMM_FAIL;
 }
 
 /**
  * @brief Receive data over I2C from ATECC608B
  */
 ATCA_STATUS hal_i2c_receive(ATCAIface iface, uint8_t address, uint8_t* data, uint16_t* len) {
+    hal_pico_i2c_t* bus = hal_i2c_bus(iface);
+
     // Validate parameters
-    if (!data || !len || *len == 0) {
+    if (!bus || !data || !len || *len == 0) {
         return ATCA_BAD_PARAM;
     }
-    
-    // Perform blocking I2C read
-    int result = i2c_read_blocking(HAL_I2C_INSTANCE, address, data, *len, false);
-    
-    if (result == *len) {
-        return ATCA_SUCCESS;
-    } else {
-        *len = (result > 0) ? result : 0;
+    if (!hal_i2c_lock(bus)) {
+        *len = 0;
         return ATCA_COMM_FAIL;
     }
+
+    uint32_t timeout_us = hal_i2c_timeout_us(bus, *len);
+    uint32_t start = time_us_32();
+    bool ok;
+
+    if (bus->tx_dma >= 0 && *len >= HAL_I2C_DMA_MIN_BYTES && *len <= HAL_I2C_XFER_MAX) {
+        absolute_time_t deadline = make_timeout_time_us(timeout_us);
+
+        hal_i2c_begin(bus, address);
+        hal_i2c_read_dma(bus, data, *len);
+        ok = hal_i2c_end(bus, deadline);
+        // The last byte can still be on its way out of the RX FIFO
+        while (ok && dma_channel_is_busy((uint)bus->rx_dma)) {
+            if (time_reached(deadline)) {
+                dma_channel_abort((uint)bus->rx_dma);
+                ok = false;
+            }
+        }
+        if (!ok) {
+            *len = 0;
+        }
+        bus->stats.dma_transfers++;
+    } else {
+        int result = i2c_read_timeout_us(bus->i2c, address, data, *len, false, timeout_us);
+        ok = (result == *len);
+        if (!ok) {
+            *len = (result > 0) ? result : 0;
+        }
+    }
+
+    uint32_t elapsed = time_us_32() - start;
+    bus->stats.total_us += elapsed;
+    bus->stats.last_rx_bytes += ok ? *len : 0;
+    bus->stats.last_rx_us += elapsed;
+    if (bus->stats.last_tx_us + bus->stats.last_rx_us > bus->stats.max_command_us) {
+        bus->stats.max_command_us = bus->stats.last_tx_us + bus->stats.last_rx_us;
+    }
+    hal_i2c_unlock(bus);
+
+    return ok ? ATCA_SUCCESS : ATCA_COMM_FAIL;
 }
 
 ATCA_STATUS hal_i2c_control(ATCAIface iface, uint8_t option, void* param, size_t paramlen) {
-    // Handle wake operation (option 0x01)
-    if (option == 0x01) {
-        printf("HAL: Performing GPIO wake pulse\n");
-        
-        gpio_set_function(HAL_I2C_SDA_PIN, GPIO_FUNC_SIO);  // Switch to GPIO
-        gpio_set_dir(HAL_I2C_SDA_PIN, GPIO_OUT);             // Set as output
-        gpio_put(HAL_I2C_SDA_PIN, 0);                        // Drive SDA LOW
-        
-        busy_wait_us(80);                                        // Hold low for 80µs
-        
-        gpio_put(HAL_I2C_SDA_PIN, 1);                        // Release SDA
-        gpio_set_function(HAL_I2C_SDA_PIN, GPIO_FUNC_I2C);   // Switch back to I2C
-        gpio_pull_up(HAL_I2C_SDA_PIN);
-        
-        busy_wait_ms(2);                                         // Wait 2ms for wake
-        
-        printf("HAL: Wake pulse complete\n");
-        return ATCA_SUCCESS;
+    hal_pico_i2c_t* bus = hal_i2c_bus(iface);
+
+    if (!bus) {
+        return ATCA_BAD_PARAM;
+    }
+
+    switch (option) {
+        case ATCA_HAL_CONTROL_WAKE:
+            return hal_i2c_wake_pulse(bus) ? ATCA_SUCCESS : ATCA_COMM_FAIL;
+        case ATCA_HAL_CHANGE_BAUD:
+            // The wake drops to 100 kHz and comes back through here; the
+            // speed probe steps up to 400 kHz and 1 MHz the same way
+            if (!param || paramlen != sizeof(uint32_t)) {
+                return ATCA_BAD_PARAM;
+            }
+            // Not in the middle of another device's transfer
+            if (!hal_i2c_lock(bus)) {
+                return ATCA_COMM_FAIL;
+            }
+            bus->stats.baud = i2c_set_baudrate(bus->i2c, *(uint32_t*)param);
+            hal_i2c_unlock(bus);
+            return ATCA_SUCCESS;
+        case ATCA_HAL_CONTROL_SELECT:
+        case ATCA_HAL_CONTROL_DESELECT:
+            return ATCA_SUCCESS;
+        default:
+            return ATCA_UNIMPLEMENTED;
     }
-    
-    // For other control options, return success
-    return ATCA_SUCCESS;
 }
 
 ATCA_STATUS hal_i2c_release(void* hal_data) {
+    hal_pico_i2c_t* bus = (hal_pico_i2c_t*)hal_data;
+
     printf("HAL: I2C release called\n");
-    // No cleanup needed for Pico I2C
+    if (!bus || bus->users == 0 || --bus->users > 0) {
+        return ATCA_SUCCESS;
+    }
+    if (bus->tx_dma >= 0) {
+        dma_channel_unclaim((uint)bus->tx_dma);
+        dma_channel_unclaim((uint)bus->rx_dma);
+        bus->tx_dma = bus->rx_dma = -1;
+    }
+    critical_section_deinit(&bus->guard);
     return ATCA_SUCCESS;
 }
 
+void hal_i2c_get_xfer_stats(uint8_t bus_num, hal_i2c_xfer_stats_t* stats) {
+    if (stats && bus_num < NUM_I2CS) {
+        *stats = g_hal_i2c[bus_num].stats;
+    }
+}
+
+void hal_i2c_print_xfer_stats(void) {
+    for (uint8_t bus_num = 0; bus_num < NUM_I2CS; bus_num++) {
+        const hal_pico_i2c_t* bus = &g_hal_i2c[bus_num];
+        hal_i2c_xfer_stats_t stats = bus->stats;
+        uint32_t avg_us = stats.commands ? (uint32_t)(stats.total_us / stats.commands) : 0;
+
+        if (bus->users == 0) {
+            continue;
+        }
+
+        printf("ATECC I2C%u: %lu kHz, %u device(s), %s, %lu commands, %lu DMA transfers\n", bus_num,
+               (unsigned long)(stats.baud / 1000), bus->users, bus->tx_dma >= 0 ? "DMA" : "CPU only",
+               (unsigned long)stats.commands, (unsigned long)stats.dma_transfers);
+        printf("ATECC I2C%u: bus time per command avg %lu us, max %lu us\n", bus_num,
+               (unsigned long)avg_us, (unsigned long)stats.max_command_us);
+        printf("ATECC I2C%u: last command %lu bytes out in %lu us, %lu bytes in over %lu us\n", bus_num,
+               (unsigned long)stats.last_tx_bytes, (unsigned long)stats.last_tx_us,
+               (unsigned long)stats.last_rx_bytes, (unsigned long)stats.last_rx_us);
+        printf("ATECC I2C%u: %lu transfers waited for the bus, %lu gave up\n", bus_num,
+               (unsigned long)stats.lock_waits, (unsigned long)stats.lock_failures);
+    }
+}
+
 /**
  * @brief Discover available I2C buses
  */
 ATCA_STATUS hal_i2c_discover_buses(int* buses_found, int max_buses) {
     if (buses_found) {
-        *buses_found = 1;  // Only i2c0 is used
+        *buses_found = NUM_I2CS;  // i2c1 only has devices on the gateway variant
     }
     return ATCA_SUCCESS;
 }
@@ -201,12 +620,12 @@ ATCA_STATUS hal_i2c_discover_devices(int bus_num, uint8_t* devices_found, int ma
     // Simple device discovery - check if ATECC608B responds at 0x60
     if (devices_found && max_devices > 0) {
         uint8_t dummy = 0;
-        int result = i2c_write_timeout_us(HAL_I2C_INSTANCE, HAL_I2C_DEVICE_ADDR, 
+        int result = i2c_write_timeout_us(i2c_get_instance((uint)bus_num), ATCA_I2C_ECC_ADDRESS,
                                           &dummy, 0, false, 50000);
         if (result >= 0) {
-            devices_found[0] = HAL_I2C_DEVICE_ADDR;
+            devices_found[0] = ATCA_I2C_ECC_ADDRESS;
             return ATCA_SUCCESS;
         }
     }
     return ATCA_COMM_FAIL;
-}
\ No newline at end of file
+}
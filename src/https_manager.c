@@ -3,6 +3,7 @@
 #include <string.h>
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
+#include "pico/async_context.h"
 #include "hardware/gpio.h"
 
 #include "lwip/altcp_tcp.h"
@@ -15,6 +16,19 @@
 #include "lwip/prot/iana.h"
 #include "lwip/dns.h"
 #include "mbedtls/ssl.h"
+#include "mbedtls/ssl_internal.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/platform_util.h"
+
+#include "latency_stats.h"
+#include "wifi_manager.h"
+
+// Request buffers live in static storage: they are built from lwIP
+// callbacks, which run in the async_context IRQ on the core 1 stack
+#define HTTPS_BODY_MAX_LEN      1024
+#define HTTPS_REQUEST_MAX_LEN   1280
+#define HTTPS_EXTRA_MAX_LEN     352
+#define HTTPS_STATUS_LINE_LEN   16
 
 // Internal state structure
 typedef struct {
@@ -29,11 +43,33 @@ typedef struct {
     bool request_sent;
     uint16_t bytes_received;
     
-    uint32_t operation_start_time;
-    https_post_data_t pending_data;
+    // Start of the response, enough for "HTTP/1.1 200 "; only a 2xx counts
+    // as delivered
+    char status_line[HTTPS_STATUS_LINE_LEN];
+    uint8_t status_line_len;
+    uint16_t http_status;        // 0 until the status line has been read
+    
+    https_post_data_t pending[HTTPS_BATCH_MAX_RECORDS];
+    uint32_t pending_count;
+    bool holding;                // Last batch_size() call held records back
     
     ip_addr_t resolved_ip;
-    bool dns_complete;
+    
+    // Operation timeout, runs on the cyw43 async_context
+    async_at_time_worker_t timeout_worker;
+    
+    // Phase timestamps (time_us_32)
+    uint32_t upload_start_us;
+    uint32_t phase_start_us;
+    bool first_response_seen;
+    bool tcp_recorded;
+    
+    // Original TLS transport send, wrapped to timestamp the ClientHello
+    mbedtls_ssl_send_t* bio_send;
+    
+    // max_fragment_length negotiation
+    bool mfl_offered;
+    bool mfl_disabled;
 } https_manager_state_t;
 
 // For mTLS with ATECC integration
@@ -53,16 +89,31 @@ static https_manager_state_t g_https_state = {
     .connected = false,
     .request_sent = false,
     .bytes_received = 0,
-    .dns_complete = false
+    .mfl_offered = false,
+    .mfl_disabled = false
 };
 
+static char g_json_body[HTTPS_BODY_MAX_LEN];
+static char g_request[HTTPS_REQUEST_MAX_LEN];
+static char g_extra_json[HTTPS_EXTRA_MAX_LEN];
+
 // Forward declarations
 static void cleanup_connection(void);
 static void update_leds(void);
+static void start_connect(void);
+static bool send_request(void);
+static void finish_operation(https_state_t final_state);
 static void dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg);
 static err_t https_connected_callback(void* arg, struct altcp_pcb* tpcb, err_t err);
 static err_t https_recv_callback(void* arg, struct altcp_pcb* tpcb, struct pbuf* p, err_t err);
 static void https_err_callback(void* arg, err_t err);
+static void timeout_worker_fn(async_context_t* context, async_at_time_worker_t* worker);
+static int tls_bio_send_hook(void* ctx, const unsigned char* buf, size_t len);
+static void configure_max_fragment_len(void);
+static bool restore_input_buffer(mbedtls_ssl_context* ssl);
+static void handle_handshake_failure(struct altcp_pcb* pcb);
+static int format_body(const char* extra);
+static uint16_t parse_status_code(const char* line, size_t len);
 
 bool https_manager_init(const https_config_t* config)
 {
@@ -96,6 +147,9 @@ bool https_manager_init(const https_config_t* config)
         gpio_put(g_https_state.config.mtls_led_pin, 0);
     }
 
+    g_https_state.timeout_worker.do_work = timeout_worker_fn;
+    g_https_state.timeout_worker.user_data = &g_https_state;
+
     g_https_state.initialized = true;
     g_https_state.state = HTTPS_STATE_IDLE;
     
@@ -108,7 +162,10 @@ bool https_manager_init(const https_config_t* config)
 
 void https_manager_deinit(void)
 {
+    cyw43_arch_lwip_begin();
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &g_https_state.timeout_worker);
     cleanup_connection();
+    cyw43_arch_lwip_end();
     
     if (g_https_state.config.dns_led_pin > 0) {
         gpio_put(g_https_state.config.dns_led_pin, 0);
@@ -124,6 +181,11 @@ void https_manager_deinit(void)
 }
 
 bool https_manager_post_json(const https_post_data_t* data)
+{
+    return https_manager_post_batch(data, 1);
+}
+
+bool https_manager_post_batch(const https_post_data_t* records, uint32_t count)
 {
     if (!g_https_state.initialized) {
         printf("HTTPS Manager: Not initialized\n");
@@ -135,22 +197,48 @@ bool https_manager_post_json(const https_post_data_t* data)
         return false;
     }
 
-    printf("HTTPS Manager: POST[%lu]...\n", data->sample);
+    if (!records || count == 0 || count > HTTPS_BATCH_MAX_RECORDS) {
+        printf("HTTPS Manager: Invalid batch (%lu records)\n", count);
+        return false;
+    }
+
+    if (count == 1) {
+        printf("HTTPS Manager: POST[%lu]...\n", records[0].sample);
+    } else {
+        printf("HTTPS Manager: POST[%lu..%lu] (%lu records)...\n",
+               records[0].sample, records[count - 1].sample, count);
+    }
     
     // Save data for later use
-    g_https_state.pending_data = *data;
-    g_https_state.operation_start_time = to_ms_since_boot(get_absolute_time());
+    memcpy(g_https_state.pending, records, count * sizeof(https_post_data_t));
+    g_https_state.pending_count = count;
+    g_https_state.upload_start_us = latency_stats_start();
+    g_https_state.first_response_seen = false;
+    g_https_state.tcp_recorded = false;
     g_https_state.bytes_received = 0;
-    g_https_state.dns_complete = false;
+    g_https_state.status_line_len = 0;
+    g_https_state.http_status = 0;
     g_https_state.resolved_ip.addr = 0;
     
     // Reset LEDs
     update_leds();
 
+    // Radio stays out of power save for the handshake and response;
+    // finish_operation() hands it back
+    wifi_manager_power_request();
+
+    // Everything from here on is driven by lwIP callbacks on the async_context
+    cyw43_arch_lwip_begin();
+
+    async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(),
+                                           &g_https_state.timeout_worker,
+                                           g_https_state.config.operation_timeout_ms);
+
     // Step 1: DNS Resolution
     g_https_state.state = HTTPS_STATE_DNS_RESOLVING;
     printf("HTTPS Manager: Resolving %s...\n", g_https_state.config.hostname);
     
+    g_https_state.phase_start_us = latency_stats_start();
     err_t dns_err = dns_gethostbyname(
         g_https_state.config.hostname,
         &g_https_state.resolved_ip,
@@ -158,27 +246,136 @@ bool https_manager_post_json(const https_post_data_t* data)
         &g_https_state.resolved_ip
     );
     
-    if (dns_err == ERR_INPROGRESS) {
-        // DNS query in progress, wait for callback
-        int timeout = 0;
-        while (!g_https_state.dns_complete && timeout < 100) {
-            cyw43_arch_poll();
-            sleep_ms(100);
-            timeout++;
-        }
-    } else if (dns_err == ERR_OK) {
+    if (dns_err == ERR_OK) {
         // Already cached
-        g_https_state.dns_complete = true;
+        latency_stats_stop(LATENCY_PHASE_DNS, g_https_state.phase_start_us);
+        start_connect();
+    } else if (dns_err != ERR_INPROGRESS) {
+        printf("HTTPS Manager: DNS request failed: %d\n", dns_err);
+        finish_operation(HTTPS_STATE_ERROR);
     }
 
-    if (g_https_state.resolved_ip.addr == 0) {
-        printf("HTTPS Manager: DNS resolution failed\n");
-        g_https_state.state = HTTPS_STATE_ERROR;
-        update_leds();
-        cleanup_connection();
-        return false;
+    bool started = (g_https_state.state != HTTPS_STATE_ERROR);
+    cyw43_arch_lwip_end();
+
+    return started;
+}
+
+int https_manager_format_json(const https_post_data_t* data, const char* extra_fields,
+                              char* buffer, size_t buffer_size)
+{
+    if (!data || !buffer || buffer_size == 0) {
+        return -1;
+    }
+    
+    return snprintf(buffer, buffer_size,
+                    "{\"sample\":%lu,\"timestamp\":%lu,\"device\":\"%s\","
+                    "\"cpu\":%.1f,\"mem\":%.1f,\"disk\":%.1f,"
+                    "\"net_in\":%.1f,\"net_out\":%.1f,\"proc\":%d%s%s}",
+                    data->sample,
+                    data->timestamp,
+                    data->device,
+                    data->cpu,
+                    data->memory,
+                    data->disk,
+                    data->net_in,
+                    data->net_out,
+                    data->processes,
+                    extra_fields ? "," : "",
+                    extra_fields ? extra_fields : "");
+}
+
+uint32_t https_manager_batch_size(uint32_t pending, uint32_t oldest_age_ms)
+{
+    if (pending == 0) {
+        return 0;
     }
 
+    uint32_t batch = (pending < HTTPS_BATCH_MAX_RECORDS) ? pending : HTTPS_BATCH_MAX_RECORDS;
+    bool overdue = oldest_age_ms >= HTTPS_DEFER_MAX_MS;
+    bool send;
+
+    switch (wifi_manager_get_link_class()) {
+        case WIFI_LINK_GOOD:
+            // Also the recovery path: the whole backlog goes in one handshake
+            send = true;
+            break;
+        case WIFI_LINK_FAIR:
+            send = overdue || pending >= HTTPS_BATCH_FAIR_RECORDS;
+            break;
+        case WIFI_LINK_POOR:
+        default:
+            // A handshake on a poor link mostly ends in a timeout
+            send = overdue;
+            break;
+    }
+
+    if (!send && !g_https_state.holding) {
+        printf("HTTPS Manager: Link quality %u, holding %lu records\n",
+               wifi_manager_get_link_score(), pending);
+    }
+    g_https_state.holding = !send;
+
+    return send ? batch : 0;
+}
+
+bool https_manager_is_busy(void)
+{
+    return g_https_state.state != HTTPS_STATE_IDLE && 
+           g_https_state.state != HTTPS_STATE_COMPLETE &&
+           g_https_state.state != HTTPS_STATE_ERROR;
+}
+
+https_state_t https_manager_get_state(void)
+{
+    return g_https_state.state;
+}
+
+uint16_t https_manager_get_bytes_received(void)
+{
+    return g_https_state.bytes_received;
+}
+
+void https_manager_abort(void)
+{
+    printf("HTTPS Manager: Aborting operation\n");
+    cyw43_arch_lwip_begin();
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &g_https_state.timeout_worker);
+    cleanup_connection();
+    g_https_state.state = HTTPS_STATE_IDLE;
+    cyw43_arch_lwip_end();
+}
+
+void https_manager_task(void)
+{
+    if (!g_https_state.initialized) {
+        return;
+    }
+
+    // Timeouts are handled by timeout_worker_fn on the async_context
+
+    // Auto-cleanup after completion or error
+    if (g_https_state.state == HTTPS_STATE_COMPLETE || 
+        g_https_state.state == HTTPS_STATE_ERROR) {
+        
+        static uint32_t cleanup_time = 0;
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        
+        if (cleanup_time == 0) {
+            cleanup_time = now;
+        } else if (now - cleanup_time > 1000) {
+            // Reset to idle after 1 second
+            g_https_state.state = HTTPS_STATE_IDLE;
+            cleanup_time = 0;
+        }
+    }
+}
+
+// Internal helper functions
+
+// Steps 2-6, called with the lwIP lock held once the address is known
+static void start_connect(void)
+{
     printf("HTTPS Manager: Resolved to %s\n", ip4addr_ntoa(&g_https_state.resolved_ip));
     if (g_https_state.config.dns_led_pin > 0) {
         gpio_put(g_https_state.config.dns_led_pin, 1);
@@ -200,10 +397,8 @@ bool https_manager_post_json(const https_post_data_t* data)
 
     if (!g_https_state.tls_config) {
         printf("HTTPS Manager: TLS config creation failed\n");
-        g_https_state.state = HTTPS_STATE_ERROR;
-        update_leds();
-        cleanup_connection();
-        return false;
+        finish_operation(HTTPS_STATE_ERROR);
+        return;
     }
 
     // Inject ATECC PK context if mTLS is enabled
@@ -219,8 +414,8 @@ bool https_manager_post_json(const https_post_data_t* data)
                 cfg_internal->cert_chain = (mbedtls_x509_crt*)malloc(sizeof(mbedtls_x509_crt));
                 if (cfg_internal->cert_chain == NULL) {
                     printf("HTTPS Manager: Failed to allocate cert chain\n");
-                    cleanup_connection();
-                    return false;
+                    finish_operation(HTTPS_STATE_ERROR);
+                    return;
                 }
             }
             
@@ -237,8 +432,8 @@ bool https_manager_post_json(const https_post_data_t* data)
                 printf("HTTPS Manager: Failed to parse client cert: %d\n", ret);
                 free(cfg_internal->cert_chain);
                 cfg_internal->cert_chain = NULL;
-                cleanup_connection();
-                return false;
+                finish_operation(HTTPS_STATE_ERROR);
+                return;
             }
             
             // Inject ATECC PK context
@@ -258,31 +453,32 @@ bool https_manager_post_json(const https_post_data_t* data)
         }
     }
 
+    configure_max_fragment_len();
+
     // Step 3: Create new PCB
     g_https_state.pcb = altcp_tls_new(g_https_state.tls_config, IPADDR_TYPE_V4);
     
     if (!g_https_state.pcb) {
         printf("HTTPS Manager: PCB creation failed\n");
-        g_https_state.state = HTTPS_STATE_ERROR;
-        update_leds();
-        cleanup_connection();
-        return false;
+        finish_operation(HTTPS_STATE_ERROR);
+        return;
     }
 
     // Step 4: Set SNI hostname
-    int mbedtls_err = mbedtls_ssl_set_hostname(
-        &(((altcp_mbedtls_state_t*)(g_https_state.pcb->state))->ssl_context),
-        g_https_state.config.hostname
-    );
+    mbedtls_ssl_context* ssl = &((altcp_mbedtls_state_t*)g_https_state.pcb->state)->ssl_context;
+    int mbedtls_err = mbedtls_ssl_set_hostname(ssl, g_https_state.config.hostname);
 
     if (mbedtls_err != 0) {
         printf("HTTPS Manager: SNI setup failed\n");
-        g_https_state.state = HTTPS_STATE_ERROR;
-        update_leds();
-        cleanup_connection();
-        return false;
+        finish_operation(HTTPS_STATE_ERROR);
+        return;
     }
 
+    // altcp_tls writes the ClientHello as soon as TCP is up; wrapping its
+    // transport send splits TCP connect time from handshake time
+    g_https_state.bio_send = ssl->f_send;
+    mbedtls_ssl_set_bio(ssl, ssl->p_bio, tls_bio_send_hook, ssl->f_recv, ssl->f_recv_timeout);
+
     // Step 5: Set callbacks
     g_https_state.connected = false;
     g_https_state.request_sent = false;
@@ -295,7 +491,8 @@ bool https_manager_post_json(const https_post_data_t* data)
            g_https_state.config.hostname, 
            g_https_state.config.port);
     
-    // Step 6: Connect
+    // Step 6: Connect; the handshake completes in https_connected_callback
+    g_https_state.phase_start_us = latency_stats_start();
     err_t connect_err = altcp_connect(
         g_https_state.pcb,
         &g_https_state.resolved_ip,
@@ -305,47 +502,45 @@ bool https_manager_post_json(const https_post_data_t* data)
 
     if (connect_err != ERR_OK) {
         printf("HTTPS Manager: Connection failed: %d\n", connect_err);
-        g_https_state.state = HTTPS_STATE_ERROR;
-        update_leds();
-        cleanup_connection();
-        return false;
+        finish_operation(HTTPS_STATE_ERROR);
     }
+}
 
-    // Step 7: Wait for TLS handshake
-    int timeout = 0;
-    while (!g_https_state.connected && timeout < 1000) {
-        cyw43_arch_poll();
-        sleep_ms(100);
-        timeout++;
+// Steps 7-8, called from the connected callback
+static bool send_request(void)
+{
+    g_https_state.state = HTTPS_STATE_SENDING;
+    
+    // Optionally piggyback the previous upload's phase timings and device telemetry
+    const char* extra = NULL;
+    int extra_len = 0;
+    if (g_https_state.config.include_latency) {
+        int n = latency_stats_format_json(g_extra_json, sizeof(g_extra_json));
+        extra_len = (n > 0 && n < (int)sizeof(g_extra_json)) ? n : 0;
+    }
+    if (g_https_state.config.format_extra && extra_len + 1 < (int)sizeof(g_extra_json)) {
+        char* out = g_extra_json + extra_len + (extra_len > 0 ? 1 : 0);
+        size_t room = sizeof(g_extra_json) - (size_t)(out - g_extra_json);
+        int n = g_https_state.config.format_extra(out, room);
+        if (n > 0 && (size_t)n < room) {
+            if (extra_len > 0) {
+                g_extra_json[extra_len] = ',';
+            }
+            extra_len = (int)(out - g_extra_json) + n;
+        }
     }
-
-    if (!g_https_state.connected) {
-        g_https_state.state = HTTPS_STATE_ERROR;
-        update_leds();
-        cleanup_connection();
+    g_extra_json[extra_len] = '\0';
+    if (extra_len > 0) {
+        extra = g_extra_json;
+    }
+    
+    int body_len = format_body(extra);
+    if (body_len < 0) {
+        printf("HTTPS Manager: Body too large\n");
         return false;
     }
 
-    // Step 8: Build and send POST request
-    g_https_state.state = HTTPS_STATE_SENDING;
-    
-    char json_body[256];
-    int body_len = snprintf(json_body, sizeof(json_body),
-                            "{\"sample\":%lu,\"timestamp\":%lu,\"device\":\"%s\","
-                            "\"cpu\":%.1f,\"mem\":%.1f,\"disk\":%.1f,"
-                            "\"net_in\":%.1f,\"net_out\":%.1f,\"proc\":%d}",
-                            g_https_state.pending_data.sample,
-                            g_https_state.pending_data.timestamp,
-                            g_https_state.pending_data.device,
-                            g_https_state.pending_data.cpu,
-                            g_https_state.pending_data.memory,
-                            g_https_state.pending_data.disk,
-                            g_https_state.pending_data.net_in,
-                            g_https_state.pending_data.net_out,
-                            g_https_state.pending_data.processes);
-
-    char request[2048];
-    int req_len = snprintf(request, sizeof(request),
+    int req_len = snprintf(g_request, sizeof(g_request),
                            "POST /%s HTTP/1.1\r\n"
                            "Host: %s\r\n"
                            "Content-Type: application/json\r\n"
@@ -356,101 +551,86 @@ bool https_manager_post_json(const https_post_data_t* data)
                            g_https_state.config.webhook_token,
                            g_https_state.config.hostname,
                            body_len,
-                           json_body);
+                           g_json_body);
 
-    printf("HTTPS Manager: Sending request...\n");
-
-    err_t write_err = altcp_write(g_https_state.pcb, request, req_len, TCP_WRITE_FLAG_COPY);
+    if (req_len < 0 || req_len >= (int)sizeof(g_request)) {
+        printf("HTTPS Manager: Request too large (%d bytes)\n", req_len);
+        return false;
+    }
 
-    if (write_err == ERR_OK) {
-        altcp_output(g_https_state.pcb);
-        g_https_state.request_sent = true;
-        g_https_state.state = HTTPS_STATE_RECEIVING;
+    printf("HTTPS Manager: Sending request...\n");
 
-        // Wait for response
-        for (int i = 0; i < 500; i++) {
-            cyw43_arch_poll();
-            sleep_ms(100);
-        }
+    g_https_state.phase_start_us = latency_stats_start();
+    err_t write_err = altcp_write(g_https_state.pcb, g_request, req_len, TCP_WRITE_FLAG_COPY);
 
-        printf("HTTPS Manager: OK (%d bytes)\n", g_https_state.bytes_received);
-        g_https_state.state = HTTPS_STATE_COMPLETE;
-    } else {
+    if (write_err != ERR_OK) {
         printf("HTTPS Manager: Write failed: %d\n", write_err);
-        g_https_state.state = HTTPS_STATE_ERROR;
+        return false;
     }
 
-    // Cleanup
-    cleanup_connection();
+    altcp_output(g_https_state.pcb);
+    latency_stats_stop(LATENCY_PHASE_SEND, g_https_state.phase_start_us);
     
-    return (g_https_state.state == HTTPS_STATE_COMPLETE);
+    // The server answers and closes (Connection: close); see https_recv_callback
+    g_https_state.phase_start_us = latency_stats_start();
+    g_https_state.request_sent = true;
+    g_https_state.state = HTTPS_STATE_RECEIVING;
+    
+    return true;
 }
 
-bool https_manager_is_busy(void)
+// One record as an object, a batch as an array; extra fields go on the last record
+static int format_body(const char* extra)
 {
-    return g_https_state.state != HTTPS_STATE_IDLE && 
-           g_https_state.state != HTTPS_STATE_COMPLETE &&
-           g_https_state.state != HTTPS_STATE_ERROR;
-}
+    uint32_t count = g_https_state.pending_count;
+    size_t len = 0;
 
-https_state_t https_manager_get_state(void)
-{
-    return g_https_state.state;
-}
+    if (count > 1) {
+        g_json_body[len++] = '[';
+    }
 
-uint16_t https_manager_get_bytes_received(void)
-{
-    return g_https_state.bytes_received;
-}
+    for (uint32_t i = 0; i < count; i++) {
+        int n = https_manager_format_json(&g_https_state.pending[i], (i == count - 1) ? extra : NULL,
+                                          g_json_body + len, sizeof(g_json_body) - len);
+        if (n < 0 || (size_t)n + 2 >= sizeof(g_json_body) - len) {
+            return -1;
+        }
+        len += (size_t)n;
 
-void https_manager_abort(void)
-{
-    printf("HTTPS Manager: Aborting operation\n");
-    cleanup_connection();
-    g_https_state.state = HTTPS_STATE_IDLE;
+        if (count > 1) {
+            g_json_body[len++] = (i == count - 1) ? ']' : ',';
+        }
+    }
+
+    g_json_body[len] = '\0';
+    return (int)len;
 }
 
-void https_manager_task(void)
+// Single exit point for every upload, called with the lwIP lock held
+static void finish_operation(https_state_t final_state)
 {
-    if (!g_https_state.initialized) {
-        return;
-    }
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &g_https_state.timeout_worker);
 
-    // Check for timeout
-    if (https_manager_is_busy()) {
-        uint32_t now = to_ms_since_boot(get_absolute_time());
-        uint32_t elapsed = now - g_https_state.operation_start_time;
-        
-        if (elapsed > g_https_state.config.operation_timeout_ms) {
-            printf("HTTPS Manager: Operation timeout (%lu ms)\n", elapsed);
-            cleanup_connection();
-            g_https_state.state = HTTPS_STATE_ERROR;
-        }
+    if (final_state == HTTPS_STATE_COMPLETE) {
+        printf("HTTPS Manager: OK, HTTP %u (%d bytes)\n", g_https_state.http_status,
+               g_https_state.bytes_received);
+        latency_stats_stop(LATENCY_PHASE_TOTAL, g_https_state.upload_start_us);
     }
 
-    // Auto-cleanup after completion or error
-    if (g_https_state.state == HTTPS_STATE_COMPLETE || 
-        g_https_state.state == HTTPS_STATE_ERROR) {
-        
-        static uint32_t cleanup_time = 0;
-        uint32_t now = to_ms_since_boot(get_absolute_time());
-        
-        if (cleanup_time == 0) {
-            cleanup_time = now;
-        } else if (now - cleanup_time > 1000) {
-            // Reset to idle after 1 second
-            g_https_state.state = HTTPS_STATE_IDLE;
-            cleanup_time = 0;
-        }
-    }
-}
+    cleanup_connection();
+    g_https_state.state = final_state;
+    update_leds();
 
-// Internal helper functions
+    wifi_manager_power_release();
+}
 
 static void cleanup_connection(void)
 {
     // Close PCB
     if (g_https_state.pcb != NULL) {
+        altcp_arg(g_https_state.pcb, NULL);
+        altcp_recv(g_https_state.pcb, NULL);
+        altcp_err(g_https_state.pcb, NULL);
         altcp_close(g_https_state.pcb);
         g_https_state.pcb = NULL;
     }
@@ -461,16 +641,94 @@ static void cleanup_connection(void)
         g_https_state.tls_config = NULL;
     }
     
-    // Give lwIP time to clean up
-    for (int i = 0; i < 5; i++) {
-        cyw43_arch_poll();
-        sleep_ms(50);
-    }
-    
     g_https_state.connected = false;
     g_https_state.request_sent = false;
 }
 
+static void configure_max_fragment_len(void)
+{
+    g_https_state.mfl_offered = false;
+    
+    if (g_https_state.config.max_fragment_len == 0 || g_https_state.mfl_disabled) {
+        return;
+    }
+    
+    altcp_tls_config_internal_t* cfg_internal = 
+        (altcp_tls_config_internal_t*)g_https_state.tls_config;
+    
+    int ret = mbedtls_ssl_conf_max_frag_len(&cfg_internal->conf, 
+                                            g_https_state.config.max_fragment_len);
+    if (ret != 0) {
+        printf("HTTPS Manager: Invalid max fragment length code %d\n", 
+               g_https_state.config.max_fragment_len);
+        return;
+    }
+    
+    g_https_state.mfl_offered = true;
+}
+
+static bool restore_input_buffer(mbedtls_ssl_context* ssl)
+{
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    // The library shrinks IN to the requested fragment length when the
+    // handshake ends, whether or not the server agreed. Grow it back to
+    // full size, keeping anything already read, as its own resizing does.
+    if (ssl->in_buf == NULL || ssl->in_buf_len >= MBEDTLS_SSL_IN_BUFFER_LEN) {
+        return true;
+    }
+    
+    unsigned char* old_buf = ssl->in_buf;
+    unsigned char* new_buf = mbedtls_calloc(1, MBEDTLS_SSL_IN_BUFFER_LEN);
+    if (new_buf == NULL) {
+        printf("HTTPS Manager: No room for a full-size input buffer\n");
+        return false;
+    }
+    memcpy(new_buf, old_buf, ssl->in_buf_len);
+    
+    ssl->in_ctr = new_buf + (ssl->in_ctr - old_buf);
+    ssl->in_hdr = new_buf + (ssl->in_hdr - old_buf);
+    ssl->in_len = new_buf + (ssl->in_len - old_buf);
+    ssl->in_iv = new_buf + (ssl->in_iv - old_buf);
+    ssl->in_msg = new_buf + (ssl->in_msg - old_buf);
+    if (ssl->in_offt != NULL) {
+        ssl->in_offt = new_buf + (ssl->in_offt - old_buf);
+    }
+    
+    mbedtls_platform_zeroize(old_buf, ssl->in_buf_len);
+    mbedtls_free(old_buf);
+    ssl->in_buf = new_buf;
+    ssl->in_buf_len = MBEDTLS_SSL_IN_BUFFER_LEN;
+#else
+    (void)ssl;
+#endif
+    
+    return true;
+}
+
+// Called while the TLS PCB still exists (error callback, timeout). Some
+// servers abort instead of ignoring an extension they do not support: they
+// answer the ClientHello with a fatal alert, or with a ServerHello that does
+// not parse. Only then stop offering max_fragment_length; a TCP error, RST
+// or timeout on a poor link says nothing about the extension.
+static void handle_handshake_failure(struct altcp_pcb* pcb)
+{
+    if (!g_https_state.mfl_offered || pcb == NULL || pcb->state == NULL) {
+        return;
+    }
+    
+    // ssl->state only moves past SERVER_HELLO once the ServerHello parsed;
+    // in_msglen is 0 until the server's first record has been read
+    const mbedtls_ssl_context* ssl = &((altcp_mbedtls_state_t*)pcb->state)->ssl_context;
+    bool rejected = ssl->state == MBEDTLS_SSL_SERVER_HELLO && ssl->in_msglen > 0 &&
+                    (ssl->in_msgtype == MBEDTLS_SSL_MSG_ALERT || ssl->in_msgtype == MBEDTLS_SSL_MSG_HANDSHAKE);
+    
+    if (rejected) {
+        printf("HTTPS Manager: Server rejected the ClientHello with max_fragment_length, "
+               "falling back to full records\n");
+        g_https_state.mfl_disabled = true;
+    }
+}
+
 static void update_leds(void)
 {
     // DNS LED
@@ -490,14 +748,21 @@ static void update_leds(void)
 
 static void dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg)
 {
+    (void)name;
+
+    // A late answer after a timeout or abort is ignored
+    if (g_https_state.state != HTTPS_STATE_DNS_RESOLVING) {
+        return;
+    }
+
     if (ipaddr) {
         ip_addr_t* result = (ip_addr_t*)arg;
         *result = *ipaddr;
-        g_https_state.dns_complete = true;
-        printf("HTTPS Manager: DNS resolved: %s\n", ip4addr_ntoa(ipaddr));
+        latency_stats_stop(LATENCY_PHASE_DNS, g_https_state.phase_start_us);
+        start_connect();
     } else {
         printf("HTTPS Manager: DNS resolution failed\n");
-        g_https_state.dns_complete = true;
+        finish_operation(HTTPS_STATE_ERROR);
     }
 }
 
@@ -508,21 +773,45 @@ static err_t https_connected_callback(void* arg, struct altcp_pcb* tpcb, err_t e
     if (err == ERR_OK) {
         state->connected = true;
         state->state = HTTPS_STATE_CONNECTED;
+        latency_stats_stop(LATENCY_PHASE_HANDSHAKE, state->phase_start_us);
         printf("HTTPS Manager: TLS handshake complete!\n");
         
+        bool buffers_ok = true;
+        if (state->mfl_offered) {
+            // mbedtls_ssl_get_input_max_frag_len() reports our own request on
+            // a client; only the session says whether the server echoed it
+            mbedtls_ssl_context* ssl = &((altcp_mbedtls_state_t*)tpcb->state)->ssl_context;
+            
+            if (ssl->session != NULL && ssl->session->mfl_code == state->config.max_fragment_len) {
+                printf("HTTPS Manager: Max fragment length %u negotiated\n",
+                       (unsigned)mbedtls_ssl_get_input_max_frag_len(ssl));
+            } else {
+                // The server may send full 16 KB records; stop asking from now on
+                printf("HTTPS Manager: Server declined max fragment length\n");
+                state->mfl_disabled = true;
+                buffers_ok = restore_input_buffer(ssl);
+            }
+        }
+        
         if (g_https_state.config.mtls_led_pin > 0) {
             gpio_put(g_https_state.config.mtls_led_pin, 1);
         }
-    } else {
-        printf("HTTPS Manager: Connection failed: %d\n", err);
-        state->state = HTTPS_STATE_ERROR;
         
-        if (g_https_state.config.mtls_led_pin > 0) {
-            gpio_put(g_https_state.config.mtls_led_pin, 0);
+        if (buffers_ok && send_request()) {
+            return ERR_OK;
         }
+    } else {
+        printf("HTTPS Manager: Connection failed: %d\n", err);
+        handle_handshake_failure(tpcb);
     }
     
-    return ERR_OK;
+    // Closing from inside the callback is not allowed; abort and tell lwIP
+    altcp_err(tpcb, NULL);
+    altcp_abort(tpcb);
+    state->pcb = NULL;
+    finish_operation(HTTPS_STATE_ERROR);
+    
+    return ERR_ABRT;
 }
 
 static err_t https_recv_callback(void* arg, struct altcp_pcb* tpcb, struct pbuf* p, err_t err)
@@ -531,10 +820,32 @@ static err_t https_recv_callback(void* arg, struct altcp_pcb* tpcb, struct pbuf*
     
     if (p == NULL) {
         printf("HTTPS Manager: Connection closed by server\n");
-        state->state = HTTPS_STATE_COMPLETE;
+        // Anything but a 2xx leaves the records queued for another attempt
+        bool delivered = state->request_sent && state->http_status >= 200 && state->http_status < 300;
+        if (state->request_sent && !delivered) {
+            if (state->http_status != 0) {
+                printf("HTTPS Manager: Server answered HTTP %u\n", state->http_status);
+            } else {
+                printf("HTTPS Manager: No HTTP status line in the response\n");
+            }
+        }
+        finish_operation(delivered ? HTTPS_STATE_COMPLETE : HTTPS_STATE_ERROR);
         return ERR_OK;
     }
     
+    if (!state->first_response_seen && state->request_sent) {
+        latency_stats_stop(LATENCY_PHASE_ACK, state->phase_start_us);
+        state->first_response_seen = true;
+    }
+    
+    // The status line can arrive split over several pbufs
+    if (state->http_status == 0 && state->status_line_len < sizeof(state->status_line)) {
+        uint16_t n = pbuf_copy_partial(p, state->status_line + state->status_line_len,
+                                       (uint16_t)(sizeof(state->status_line) - state->status_line_len), 0);
+        state->status_line_len += (uint8_t)n;
+        state->http_status = parse_status_code(state->status_line, state->status_line_len);
+    }
+    
     state->bytes_received += p->tot_len;
     
     altcp_recved(tpcb, p->tot_len);
@@ -543,14 +854,67 @@ static err_t https_recv_callback(void* arg, struct altcp_pcb* tpcb, struct pbuf*
     return ERR_OK;
 }
 
+// "HTTP/1.1 201 Created": the code once its three digits are in, else 0
+static uint16_t parse_status_code(const char* line, size_t len)
+{
+    if (len < 5 || memcmp(line, "HTTP/", 5) != 0) {
+        return 0;
+    }
+    
+    const char* space = memchr(line, ' ', len);
+    if (space == NULL || (size_t)(space - line) + 4 > len) {
+        return 0;
+    }
+    
+    uint16_t code = 0;
+    for (int i = 1; i <= 3; i++) {
+        if (space[i] < '0' || space[i] > '9') {
+            return 0;
+        }
+        code = (uint16_t)(code * 10 + (space[i] - '0'));
+    }
+    return code;
+}
+
 static void https_err_callback(void* arg, err_t err)
 {
     printf("HTTPS Manager: Connection error: %d\n", err);
     https_manager_state_t* state = (https_manager_state_t*)arg;
-    state->connected = false;
-    state->state = HTTPS_STATE_ERROR;
     
-    if (g_https_state.config.mtls_led_pin > 0) {
-        gpio_put(g_https_state.config.mtls_led_pin, 0);
+    // A failed handshake reports here before altcp_tls closes the PCB, so its
+    // TLS state can still be read; the PCB is gone once this returns
+    if (state->state == HTTPS_STATE_CONNECTING) {
+        handle_handshake_failure(state->pcb);
     }
-}
\ No newline at end of file
+    state->pcb = NULL;
+    finish_operation(HTTPS_STATE_ERROR);
+}
+
+static void timeout_worker_fn(async_context_t* context, async_at_time_worker_t* worker)
+{
+    (void)context;
+    https_manager_state_t* state = (https_manager_state_t*)worker->user_data;
+    
+    if (!https_manager_is_busy()) {
+        return;
+    }
+    
+    printf("HTTPS Manager: Operation timeout (%lu ms, state %d)\n",
+           state->config.operation_timeout_ms, state->state);
+    
+    if (state->state == HTTPS_STATE_CONNECTING) {
+        handle_handshake_failure(state->pcb);
+    }
+    finish_operation(HTTPS_STATE_ERROR);
+}
+
+static int tls_bio_send_hook(void* ctx, const unsigned char* buf, size_t len)
+{
+    if (!g_https_state.tcp_recorded) {
+        latency_stats_stop(LATENCY_PHASE_TCP, g_https_state.phase_start_us);
+        g_https_state.phase_start_us = latency_stats_start();
+        g_https_state.tcp_recorded = true;
+    }
+    
+    return g_https_state.bio_send(ctx, buf, len);
+}
@@ -0,0 +1,83 @@
+#ifndef CORE_CHANNEL_H
+#define CORE_CHANNEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Slots per channel, must be a power of two
+#define CORE_CHANNEL_CAPACITY   8U
+
+// Bytes per raw byte ring, must be a power of two
+#define CORE_BYTE_RING_SIZE     2048U
+
+// Message kinds
+typedef enum {
+    CORE_MSG_STATUS             // Core 1 -> core 0: state change or result
+} core_msg_type_t;
+
+typedef enum {
+    CORE_STATUS_WIFI,           // value: 1 = fully connected, 0 = not
+    CORE_STATUS_UPLOAD_DONE     // value: 1 = success, 0 = failure; arg: sample
+} core_status_t;
+
+typedef struct {
+    uint8_t type;               // core_msg_type_t
+    uint32_t seq;               // Assigned by core_channel_push
+    union {
+        struct {
+            uint8_t status;     // core_status_t
+            int32_t value;
+            uint32_t arg;
+        } status;
+    };
+} core_msg_t;
+
+// Single-producer single-consumer ring. head is only written by the
+// producer and tail only by the consumer; both increase monotonically and
+// are masked on access.
+typedef struct {
+    core_msg_t slots[CORE_CHANNEL_CAPACITY];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t next_seq;
+    uint32_t dropped;
+    bool doorbell;              // Ring the SIO FIFO on push (consumer blocks in core_channel_wait)
+} core_channel_t;
+
+// Single-producer single-consumer byte stream, same index discipline as
+// core_channel_t. Used for raw CDC input from core 0 to the parser on core 1.
+typedef struct {
+    uint8_t data[CORE_BYTE_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    bool doorbell;
+} core_byte_ring_t;
+
+void core_channel_init(core_channel_t* channel, bool doorbell);
+
+bool core_channel_push(core_channel_t* channel, const core_msg_t* msg);
+
+bool core_channel_pop(core_channel_t* channel, core_msg_t* msg);
+
+bool core_channel_peek(core_channel_t* channel, core_msg_t* msg);
+
+bool core_channel_wait(core_channel_t* channel, uint32_t timeout_us);
+
+uint32_t core_channel_count(const core_channel_t* channel);
+
+uint32_t core_channel_get_dropped(const core_channel_t* channel);
+
+void core_byte_ring_init(core_byte_ring_t* ring, bool doorbell);
+
+size_t core_byte_ring_write(core_byte_ring_t* ring, const uint8_t* data, size_t len);
+
+size_t core_byte_ring_read(core_byte_ring_t* ring, uint8_t* data, size_t max_len);
+
+size_t core_byte_ring_count(const core_byte_ring_t* ring);
+
+size_t core_byte_ring_free(const core_byte_ring_t* ring);
+
+bool core_byte_ring_wait(core_byte_ring_t* ring, uint32_t timeout_us);
+
+#endif // CORE_CHANNEL_H
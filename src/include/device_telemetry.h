@@ -0,0 +1,44 @@
+#ifndef DEVICE_TELEMETRY_H
+#define DEVICE_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Period at which device_telemetry_sample should be scheduled (core 1)
+#define DEVICE_TELEMETRY_SAMPLE_MS  5000U
+
+// Longest "dev" object device_telemetry_format_json produces
+#define DEVICE_TELEMETRY_JSON_MAX   192U
+
+// One sample of on-device metrics, merged into every upload
+typedef struct {
+    int16_t temp_decic;            // RP2040 die temperature, 0.1 C
+    uint32_t heap_free;            // C heap (FreeRTOS heap in the RTOS build), bytes
+    uint32_t heap_peak;            // Most heap ever in use, bytes
+    uint32_t tls_peak;             // TLS arena high-water, bytes
+    uint8_t core_util[2];          // Busy share of each core's loop over the last window, %
+    int32_t rssi_dbm;
+    uint8_t link_score;
+    uint32_t queue_depth;          // Upload records waiting
+    uint32_t atecc_sign_us;        // Last ATECC608B sign
+    uint32_t atecc_sign_max_us;
+    uint32_t samples;
+} device_telemetry_t;
+
+void device_telemetry_init(void);
+
+// Reads every source and publishes a new snapshot
+void device_telemetry_sample(void);
+
+// Called by each core's main loop with the time it just spent waiting
+void device_telemetry_note_idle(uint32_t idle_us);
+
+void device_telemetry_get(device_telemetry_t* telemetry);
+
+// "dev":{...} for https_config_t.format_extra; safe from lwIP callbacks
+int device_telemetry_format_json(char* buffer, size_t buffer_size);
+
+void device_telemetry_print(void);
+
+#endif // DEVICE_TELEMETRY_H
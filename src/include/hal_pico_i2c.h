@@ -5,12 +5,28 @@
 #include <stdint.h>
 #include <stddef.h>
 
-// HAL function declarations
-ATCA_STATUS hal_i2c_init(void* hal, ATCAIfaceCfg* cfg);
-ATCA_STATUS hal_i2c_send(void* hal, uint8_t device_address, uint8_t* data, int len);
-ATCA_STATUS hal_i2c_receive(void* hal, uint8_t device_address, uint8_t* data, uint16_t len);
-ATCA_STATUS hal_i2c_wake(void* hal);
-ATCA_STATUS hal_i2c_release(void* hal);
+// The hal_i2c_init/send/receive/control/release entry points are declared
+// in atca_hal.h
+
+// Bus time of the ATECC transfers on one bus (all of its devices). A command's time is its packet write
+// plus the response reads that follow it, NAKed polls included.
+typedef struct {
+    uint32_t baud;              // Clock now in use (after speed stepping)
+    uint32_t commands;          // Command packets written
+    uint32_t dma_transfers;
+    uint32_t last_tx_bytes;     // Last command packet, word address included
+    uint32_t last_tx_us;
+    uint32_t last_rx_bytes;     // Response bytes read since the last command
+    uint32_t last_rx_us;
+    uint32_t max_command_us;
+    uint64_t total_us;          // Every transfer, wakes and idles included
+    uint32_t lock_waits;        // Transfers that found another device's on the bus
+    uint32_t lock_failures;     // Gave up on the bus lock (timeout or preempted holder)
+} hal_i2c_xfer_stats_t;
+
+void hal_i2c_get_xfer_stats(uint8_t bus_num, hal_i2c_xfer_stats_t* stats);
+void hal_i2c_print_xfer_stats(void);
+
 ATCA_STATUS hal_i2c_discover_buses(int* buses_found, int max_buses);
 ATCA_STATUS hal_i2c_discover_devices(int bus_num, uint8_t* devices_found, int max_devices);
 
@@ -21,11 +37,6 @@ void hal_free(void* ptr);
 // Timing functions
 void hal_delay_ms(uint32_t ms);
 void hal_delay_us(uint32_t us);
+uint32_t hal_get_time_ms(void);
 
-// HAL registration function
-ATCA_STATUS hal_i2c_register_hal(void);
-
-// External HAL structure declaration
-extern const ATCAHAL_t hal_i2c_pico;
-
-#endif // HAL_PICO_I2C_H
\ No newline at end of file
+#endif // HAL_PICO_I2C_H
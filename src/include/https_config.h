@@ -7,6 +7,19 @@
 #define WIFI_SSID "Zzz"
 #define WIFI_PASSWORD "i6b22krm"
 
+// Optional fixed address; skips DHCP on every join (leave undefined for DHCP)
+// #define WIFI_STATIC_IP "192.168.1.50"
+// #define WIFI_STATIC_NETMASK "255.255.255.0"
+// #define WIFI_STATIC_GATEWAY "192.168.1.1"
+// #define WIFI_STATIC_DNS "192.168.1.1"
+
+// MQTT broker configuration (UPLOAD_TRANSPORT=MQTT builds)
+#define MQTT_BROKER_HOSTNAME WEBHOOK_HOSTNAME
+#define MQTT_BROKER_PORT 8883
+#define MQTT_CLIENT_ID "pico-w-health"
+#define MQTT_TOPIC "devices/pico-w/health"
+#define MQTT_QOS 1
+
 // Local mTLS web cert
 #define CA_CERT \
 "-----BEGIN CERTIFICATE-----\n" \
@@ -5,6 +5,11 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// Link-quality batching (see https_manager_batch_size)
+#define HTTPS_BATCH_MAX_RECORDS     4U
+#define HTTPS_BATCH_FAIR_RECORDS    2U      // Fair link: hold a lone record until this many queue up
+#define HTTPS_DEFER_MAX_MS          60000U  // Oldest record age that forces a flush on any link
+
 // Forward declarations for lwIP types
 struct altcp_tls_config;
 struct altcp_pcb;
@@ -37,6 +42,16 @@ typedef struct {
     size_t client_cert_len;
     void* atecc_pk_context;  // mbedtls_pk_context* if using ATECC
     
+    // Record size negotiation (MBEDTLS_SSL_MAX_FRAG_LEN_* code, 0 = full 16 KB records)
+    uint8_t max_fragment_len;
+    
+    // Append the previous upload's per-phase latencies to the JSON body
+    bool include_latency;
+    
+    // Optional extra fields for the JSON body (e.g. device telemetry). Runs in
+    // lwIP callbacks; writes "key":value pairs without the enclosing braces.
+    int (*format_extra)(char* buffer, size_t buffer_size);
+    
     // LED indicators (optional, 0 = disabled)
     uint8_t dns_led_pin;
     uint8_t mtls_led_pin;
@@ -64,6 +79,17 @@ void https_manager_deinit(void);
 
 bool https_manager_post_json(const https_post_data_t* data);
 
+// One POST carrying count records as a JSON array (a single record is sent as an object)
+bool https_manager_post_batch(const https_post_data_t* records, uint32_t count);
+
+// Records the next POST should carry, from the link-quality score: the whole
+// backlog on a good link, batches on a fair one, nothing on a poor one until
+// the oldest record is HTTPS_DEFER_MAX_MS old. 0 = hold the records.
+uint32_t https_manager_batch_size(uint32_t pending, uint32_t oldest_age_ms);
+
+int https_manager_format_json(const https_post_data_t* data, const char* extra_fields,
+                              char* buffer, size_t buffer_size);
+
 bool https_manager_is_busy(void);
 
 https_state_t https_manager_get_state(void);
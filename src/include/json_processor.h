@@ -19,6 +19,7 @@ typedef struct {
     uint32_t min_post_interval_ms;      // Minimum interval between posts (ms)
     void (*on_data_received)(health_data_t* data);  // Optional callback when data is parsed
     void (*on_post_trigger)(health_data_t* data);   // Optional callback to trigger webhook post
+    void (*on_command)(const char* line);           // Optional handler for non-JSON lines (CDC commands)
 } json_processor_config_t;
 
 bool json_processor_init(const json_processor_config_t *config);
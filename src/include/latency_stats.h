@@ -0,0 +1,52 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Bucket i holds samples in [2^i, 2^(i+1)) us; the last bucket is open-ended (>= ~8 s)
+#define LATENCY_BUCKET_COUNT    24U
+
+// Upload path phases
+typedef enum {
+    LATENCY_PHASE_DNS,          // dns_gethostbyname -> answer
+    LATENCY_PHASE_TCP,          // altcp_connect -> TCP established
+    LATENCY_PHASE_HANDSHAKE,    // TCP established -> TLS handshake complete
+    LATENCY_PHASE_SIGN,         // ATECC608B ECDSA sign (inside the handshake)
+    LATENCY_PHASE_SEND,         // Request encrypted and handed to TCP
+    LATENCY_PHASE_ACK,          // Request sent -> first response byte
+    LATENCY_PHASE_TOTAL,        // Whole upload
+    LATENCY_PHASE_COUNT
+} latency_phase_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t last_us;
+    uint64_t total_us;
+    uint32_t buckets[LATENCY_BUCKET_COUNT];
+} latency_histogram_t;
+
+void latency_stats_init(void);
+
+uint32_t latency_stats_start(void);
+
+void latency_stats_stop(latency_phase_t phase, uint32_t start_us);
+
+void latency_stats_record(latency_phase_t phase, uint32_t elapsed_us);
+
+bool latency_stats_get(latency_phase_t phase, latency_histogram_t* histogram);
+
+uint32_t latency_stats_percentile(const latency_histogram_t* histogram, uint8_t percentile);
+
+const char* latency_stats_phase_name(latency_phase_t phase);
+
+int latency_stats_format_json(char* buffer, size_t buffer_size);
+
+void latency_stats_print(void);
+
+void latency_stats_reset(void);
+
+#endif // LATENCY_STATS_H
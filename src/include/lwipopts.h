@@ -12,12 +12,11 @@
 #ifndef LWIP_SOCKET
 #define LWIP_SOCKET                 0
 #endif
-#if PICO_CYW43_ARCH_POLL
-#define MEM_LIBC_MALLOC             1
-#else
-// MEM_LIBC_MALLOC is incompatible with non polling versions
+// lwIP uses its own fixed heap and memp pools rather than libc malloc, so
+// long-running churn cannot fragment the heap shared with the rest of the
+// firmware (MEM_LIBC_MALLOC is also incompatible with threadsafe_background)
 #define MEM_LIBC_MALLOC             0
-#endif
+#define MEMP_MEM_MALLOC             0
 #define MEM_ALIGNMENT               4
 #define MEM_SIZE                    4000
 #define MEMP_NUM_TCP_SEG            32
@@ -35,10 +34,14 @@
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
 #define LWIP_NETCONN                0
-#define MEM_STATS                   0
+// Heap/pool high-water marks are reported by mem_manager
+#define LWIP_STATS                  1
+#define MEM_STATS                   1
 #define SYS_STATS                   0
-#define MEMP_STATS                  0
+#define MEMP_STATS                  1
 #define LINK_STATS                  0
+// TCP segment and retransmit counters feed the WiFi link-quality score
+#define MIB2_STATS                  1
 // #define ETH_PAD_SIZE                2
 #define IP_FORWARD                  0
 #define IP_OPTIONS_ALLOWED          0
@@ -92,7 +95,6 @@
 
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
-#define LWIP_STATS                  1
 #define LWIP_STATS_DISPLAY          1
 #endif
 
@@ -108,6 +110,11 @@
 /* UDP options */
 #define LWIP_UDP                    1
 
+/* MQTT options (one extra cyclic timer for the MQTT keep-alive) */
+#define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 1)
+#define MQTT_OUTPUT_RINGBUF_SIZE    1024
+#define MQTT_REQ_MAX_IN_FLIGHT      4
+
 /* ALTCP TLS options */
 #define LWIP_ALTCP                  1
 #define LWIP_ALTCP_TLS              1
@@ -116,4 +123,19 @@
 /* Mbed TLS authentication */
 #define ALTCP_MBEDTLS_AUTHMODE      MBEDTLS_SSL_VERIFY_REQUIRED
 
+/* Mbed TLS allocations go to the mem_manager TLS arena, not the lwIP heap */
+#define ALTCP_MBEDTLS_PLATFORM_ALLOC 0
+
+/* FreeRTOS variant (pico_cyw43_arch_lwip_sys_freertos builds with NO_SYS=0) */
+#if !NO_SYS
+#define TCPIP_THREAD_STACKSIZE      2048
+#define DEFAULT_THREAD_STACKSIZE    1024
+#define DEFAULT_RAW_RECVMBOX_SIZE   8
+#define DEFAULT_UDP_RECVMBOX_SIZE   8
+#define DEFAULT_TCP_RECVMBOX_SIZE   8
+#define TCPIP_MBOX_SIZE             8
+#define LWIP_TIMEVAL_PRIVATE        0
+#define LWIP_TCPIP_CORE_LOCKING_INPUT 1
+#endif
+
 #endif /* __LWIPOPTS_H__ */
\ No newline at end of file
@@ -33,6 +33,17 @@
 #define MBEDTLS_SSL_SERVER_NAME_INDICATION
 #define MBEDTLS_SSL_ENCRYPT_THEN_MAC
 #define MBEDTLS_SSL_EXTENDED_MASTER_SECRET
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+
+/* Record buffers
+ * IN stays at the full 16 KB so a server that declines max_fragment_length
+ * still works. With variable buffer length mbedTLS shrinks it to the
+ * requested fragment size once the handshake completes; https_manager grows
+ * it back when the server did not agree. OUT only has to hold our own
+ * handshake messages and the POST request. */
+#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+#define MBEDTLS_SSL_IN_CONTENT_LEN  16384
+#define MBEDTLS_SSL_OUT_CONTENT_LEN 2048
 
 /* Protocols */
 #define MBEDTLS_SSL_PROTO_TLS1_2
@@ -89,6 +100,9 @@
 #define MBEDTLS_ERROR_C
 #define MBEDTLS_PLATFORM_C
 
+/* Memory - calloc/free are redirected to the mem_manager TLS arena */
+#define MBEDTLS_PLATFORM_MEMORY
+
 //added
 #define MBEDTLS_DEBUG_C
 #define MBEDTLS_SSL_DEBUG_ALL
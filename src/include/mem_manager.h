@@ -0,0 +1,46 @@
+#ifndef MEM_MANAGER_H
+#define MEM_MANAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Per size-class view of the TLS arena
+typedef struct {
+    uint16_t block_size;
+    uint16_t block_count;
+    uint16_t used;
+    uint16_t peak;
+    uint32_t spills;        // Requests served by a larger class because this one was full
+} mem_pool_stats_t;
+
+// Combined TLS arena and lwIP heap/pool statistics
+typedef struct {
+    size_t tls_bytes_used;
+    size_t tls_bytes_peak;
+    size_t tls_arena_size;
+    uint32_t tls_alloc_count;
+    uint32_t tls_alloc_failures;
+
+    uint32_t lwip_heap_used;
+    uint32_t lwip_heap_peak;
+    uint32_t lwip_heap_errors;
+    uint32_t lwip_memp_errors;
+} mem_stats_t;
+
+// Must run before anything allocates through mbedTLS
+bool mem_manager_init(void);
+
+void* mem_manager_tls_calloc(size_t count, size_t size);
+
+void mem_manager_tls_free(void* ptr);
+
+void mem_manager_get_stats(mem_stats_t* stats);
+
+int mem_manager_get_pool_count(void);
+
+bool mem_manager_get_pool_stats(int index, mem_pool_stats_t* stats);
+
+void mem_manager_print_stats(void);
+
+#endif // MEM_MANAGER_H
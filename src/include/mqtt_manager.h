@@ -0,0 +1,67 @@
+#ifndef MQTT_MANAGER_H
+#define MQTT_MANAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "https_manager.h"
+
+// MQTT connection states
+typedef enum {
+    MQTT_STATE_IDLE,
+    MQTT_STATE_DNS_RESOLVING,
+    MQTT_STATE_CONNECTING,
+    MQTT_STATE_CONNECTED,
+    MQTT_STATE_PUBLISHING,
+    MQTT_STATE_ERROR
+} mqtt_state_t;
+
+// MQTT configuration structure
+typedef struct {
+    const char* hostname;
+    uint16_t port;                // Default 8883
+    const char* client_id;
+    const char* topic;
+    uint16_t keep_alive_s;        // PINGREQ interval, default 60 s
+    uint8_t qos;                  // 0 or 1
+
+    // TLS configuration
+    const uint8_t* ca_cert;
+    size_t ca_cert_len;
+
+    // mTLS configuration (optional)
+    bool enable_mtls;
+    const uint8_t* client_cert;
+    size_t client_cert_len;
+    void* atecc_pk_context;       // mbedtls_pk_context* if using ATECC
+
+    // LED indicators (optional, 0 = disabled)
+    uint8_t dns_led_pin;
+    uint8_t mtls_led_pin;
+
+    // Timeouts
+    uint32_t operation_timeout_ms;
+} mqtt_config_t;
+
+bool mqtt_manager_init(const mqtt_config_t* config);
+
+void mqtt_manager_deinit(void);
+
+// Starts one PUBLISH (connecting first if the session dropped); the rest runs
+// in the cyw43 async_context. false = could not be started.
+bool mqtt_manager_publish_json(const https_post_data_t* data);
+
+// Outcome of the last publish once mqtt_manager_is_busy() turns false:
+// queued for output (QoS 0) or PUBACKed (QoS 1)
+bool mqtt_manager_publish_succeeded(void);
+
+bool mqtt_manager_is_connected(void);
+
+bool mqtt_manager_is_busy(void);
+
+mqtt_state_t mqtt_manager_get_state(void);
+
+void mqtt_manager_task(void);
+
+#endif // MQTT_MANAGER_H
@@ -0,0 +1,83 @@
+#ifndef RTOS_APP_H
+#define RTOS_APP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "https_manager.h"
+
+// FreeRTOS variant of the ingest/upload path. Hardware-free, so the same
+// file runs on the RP2040 SMP port and the POSIX simulator (host/rtos_bench).
+
+// Task priorities: USB transport must never queue behind TLS work
+#define RTOS_PRIO_USB           (tskIDLE_PRIORITY + 4)
+#define RTOS_PRIO_INGEST        (tskIDLE_PRIORITY + 3)
+#define RTOS_PRIO_HID           (tskIDLE_PRIORITY + 2)
+#define RTOS_PRIO_WIFI          (tskIDLE_PRIORITY + 2)
+#define RTOS_PRIO_UPLOAD        (tskIDLE_PRIORITY + 1)
+
+// Core affinity masks, same split as the bare-metal build
+#define RTOS_CORE_TRANSPORT     (1U << 0)
+#define RTOS_CORE_NETWORK       (1U << 1)
+
+// Stack depths in words
+#define RTOS_STACK_USB          (configMINIMAL_STACK_SIZE * 2)
+#define RTOS_STACK_HID          (configMINIMAL_STACK_SIZE * 2)
+#define RTOS_STACK_WIFI         (configMINIMAL_STACK_SIZE * 4)
+#define RTOS_STACK_INGEST       (configMINIMAL_STACK_SIZE * 4)
+#define RTOS_STACK_UPLOAD       (configMINIMAL_STACK_SIZE * 4)
+
+// Raw CDC bytes between the USB and ingest tasks
+#define RTOS_INGEST_BUFFER_LEN  2048U
+
+// How long the ingest task waits for bytes before retrying the upload hand-off
+#define RTOS_INGEST_IDLE_MS     100U
+
+// Wait after a failed upload before its record is handed off again
+#define RTOS_UPLOAD_RETRY_MS    2000U
+
+// Runs in the upload task and blocks until the batch has been delivered or failed
+typedef bool (*rtos_upload_fn_t)(const https_post_data_t* records, uint32_t count);
+
+// Runs in the ingest task: how many of the pending (oldest first) records to
+// hand off as one upload, 0 to hold them for now
+typedef uint32_t (*rtos_batch_size_fn_t)(const https_post_data_t* records, uint32_t pending);
+
+typedef struct {
+    const char* device;
+    bool enable_auto_post;               // Close an upload record on every accepted sample
+    uint32_t min_post_interval_ms;
+    rtos_upload_fn_t upload;
+    rtos_batch_size_fn_t batch_size;     // NULL = one record per upload
+    void (*on_command)(const char* line);  // Non-JSON CDC lines, runs in the ingest task
+} rtos_app_config_t;
+
+typedef struct {
+    uint32_t bytes_ingested;
+    uint32_t bytes_dropped;              // USB side found the stream buffer full
+    uint32_t records_handed_off;         // Retries of a failed batch count again
+    uint32_t uploads_ok;
+    uint32_t uploads_failed;
+    uint32_t handoff_max_us;             // Batch queued -> picked up by the upload task
+    uint64_t handoff_total_us;
+} rtos_app_stats_t;
+
+bool rtos_app_init(const rtos_app_config_t* config);
+
+bool rtos_app_create_task(TaskFunction_t task, const char* name, configSTACK_DEPTH_TYPE stack_words,
+                          void* arg, UBaseType_t priority, UBaseType_t core_mask, TaskHandle_t* handle);
+
+size_t rtos_app_ingest(const uint8_t* data, size_t len, TickType_t wait);
+
+void rtos_app_set_link_up(bool up);
+
+bool rtos_app_is_link_up(void);
+
+void rtos_app_get_stats(rtos_app_stats_t* stats);
+
+void rtos_app_print_stats(void);
+
+#endif // RTOS_APP_H
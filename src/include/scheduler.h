@@ -0,0 +1,56 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Three-level hashed timer wheel with 1 ms ticks: level 0 covers 64 ms,
+// level 1 4.1 s and level 2 262 s. Longer delays are parked in the last
+// level 2 slot and re-filed when they cascade.
+#define SCHED_WHEEL_BITS    6U
+#define SCHED_WHEEL_SLOTS   (1U << SCHED_WHEEL_BITS)
+#define SCHED_WHEEL_LEVELS  3U
+
+#define SCHED_NO_DEADLINE   UINT32_MAX
+
+typedef void (*sched_callback_t)(void* arg);
+
+// Tasks are owned by the caller (usually static) and linked into the wheel
+typedef struct sched_task {
+    struct sched_task* next;
+    struct sched_task** slot;
+    sched_callback_t callback;
+    void* arg;
+    uint32_t expires_ms;
+    uint32_t period_ms;          // 0 = one-shot
+} sched_task_t;
+
+// One scheduler per core; it must only be used from the core that runs it
+typedef struct {
+    sched_task_t* wheel[SCHED_WHEEL_LEVELS][SCHED_WHEEL_SLOTS];
+    uint32_t current_ms;         // Next tick to process
+    bool initialized;
+} scheduler_t;
+
+void scheduler_init(scheduler_t* sched);
+
+void scheduler_add_periodic(scheduler_t* sched, sched_task_t* task,
+                            sched_callback_t callback, void* arg, uint32_t period_ms);
+
+void scheduler_add_oneshot(scheduler_t* sched, sched_task_t* task,
+                           sched_callback_t callback, void* arg, uint32_t delay_ms);
+
+void scheduler_cancel(scheduler_t* sched, sched_task_t* task);
+
+bool scheduler_is_pending(const sched_task_t* task);
+
+void scheduler_run(scheduler_t* sched);
+
+uint32_t scheduler_next_deadline_ms(const scheduler_t* sched);
+
+void scheduler_wait(scheduler_t* sched, uint32_t max_wait_ms);
+
+void scheduler_run_for(scheduler_t* sched, uint32_t duration_ms);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,42 @@
+#ifndef UPLOAD_PIPELINE_H
+#define UPLOAD_PIPELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "json_processor.h"
+#include "https_manager.h"
+
+// Ready-to-send records held while an upload is in flight
+#define UPLOAD_PIPELINE_DEPTH   4U
+
+typedef struct {
+    uint32_t samples_aggregated;   // Parsed samples folded into records
+    uint32_t records_queued;
+    uint32_t records_coalesced;    // Records merged into the newest one because the queue was full
+    uint32_t records_held;         // Commits left in the window because every queued record was in flight
+    uint32_t records_sent;
+    uint32_t send_failures;        // Sends that failed; their records stayed queued for a retry
+} upload_pipeline_stats_t;
+
+bool upload_pipeline_init(const char* device);
+
+void upload_pipeline_add_sample(const health_data_t* data);
+
+bool upload_pipeline_commit(uint32_t sample, uint32_t timestamp_ms);
+
+// Copies up to max of the oldest records, returns how many
+uint32_t upload_pipeline_peek_batch(https_post_data_t* records, uint32_t max);
+
+// The oldest count records are being sent: they stay queued, and commit
+// no longer merges into them, until upload_pipeline_end_send()
+void upload_pipeline_begin_send(uint32_t count);
+
+// Pops the in-flight records if they were delivered, otherwise keeps them for a retry
+void upload_pipeline_end_send(bool delivered);
+
+uint32_t upload_pipeline_count(void);
+
+void upload_pipeline_get_stats(upload_pipeline_stats_t* stats);
+
+#endif // UPLOAD_PIPELINE_H
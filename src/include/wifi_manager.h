@@ -5,6 +5,100 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// Period at which wifi_manager_task should be scheduled. It drives the
+// join/rejoin state machine from the netif link and status callbacks.
+#define WIFI_MANAGER_CHECK_INTERVAL_MS  250U
+
+// Directed joins skip the scan; one that has not associated by then falls
+// back to a full scan straight away
+#define WIFI_DIRECTED_JOIN_TIMEOUT_MS   5000U
+
+// A cached lease with less than this left is not reused at boot
+#define WIFI_LEASE_REUSE_MIN_S          300U
+
+// The RAM copy of the cache counts the lease down this often, so after a
+// soft reset it is at most this far behind
+#define WIFI_LEASE_AGE_INTERVAL_MS      60000U
+
+// CYW43 power-save modes. The driver's own names are shifted by one:
+// PERFORMANCE here is CYW43_NONE_PM, BALANCED is the driver default
+// (CYW43_PERFORMANCE_PM, PM2) and SAVING is CYW43_AGGRESSIVE_PM (PM1).
+typedef enum {
+    WIFI_POWER_BALANCED,
+    WIFI_POWER_PERFORMANCE,
+    WIFI_POWER_SAVING,
+    WIFI_POWER_MODE_COUNT
+} wifi_power_mode_t;
+
+// Burst mode is held this long after a release, so back-to-back uploads
+// do not bounce the radio between modes
+#define WIFI_POWER_LINGER_MS            2000U
+
+// Nominal board current per mode while associated (mA), used for the
+// average-current estimate. Replace with bench measurements per deployment.
+#ifndef WIFI_POWER_EST_MA_BALANCED
+#define WIFI_POWER_EST_MA_BALANCED      32U
+#endif
+#ifndef WIFI_POWER_EST_MA_PERFORMANCE
+#define WIFI_POWER_EST_MA_PERFORMANCE   48U
+#endif
+#ifndef WIFI_POWER_EST_MA_SAVING
+#define WIFI_POWER_EST_MA_SAVING        24U
+#endif
+
+// Link quality: RSSI and the TCP retransmit rate are sampled this often
+// while connected and folded into a 0-100 score
+#define WIFI_LINK_SAMPLE_MS             2000U
+#define WIFI_LINK_RSSI_FLOOR_DBM        (-85)  // Scores 0
+#define WIFI_LINK_RSSI_CEIL_DBM         (-55)  // Scores 100
+#define WIFI_LINK_MIN_SEGMENTS          8U     // Fewer segments in a window say nothing about loss
+#define WIFI_LINK_SCORE_GOOD            60U
+#define WIFI_LINK_SCORE_POOR            30U
+
+typedef enum {
+    WIFI_LINK_POOR,
+    WIFI_LINK_FAIR,
+    WIFI_LINK_GOOD
+} wifi_link_class_t;
+
+typedef struct {
+    uint8_t score;                 // 0-100, 0 while disconnected
+    wifi_link_class_t link_class;
+    int32_t rssi_dbm;
+    uint16_t retransmit_permille;  // Smoothed TCP retransmits per 1000 segments sent
+    uint32_t samples;
+} wifi_link_quality_t;
+
+// Fixed IPv4 profile, dotted-quad strings (all four required)
+typedef struct {
+    const char* address;
+    const char* netmask;
+    const char* gateway;
+    const char* dns;
+} wifi_ip_profile_t;
+
+// IPv4 settings in lwIP (network) byte order
+typedef struct {
+    uint32_t ip;
+    uint32_t netmask;
+    uint32_t gateway;
+    uint32_t dns;
+} wifi_ip_config_t;
+
+// Join hints from the last association: lets a (re)join skip the channel
+// scan and, at boot, the DHCP exchange. Kept in RAM that survives a soft
+// reset; the optional hooks below can keep a copy on flash or SD. A copy
+// loaded from there has been off for an unknown time, so only its BSSID
+// and channel are used.
+typedef struct {
+    uint32_t magic;
+    uint8_t bssid[6];
+    uint16_t channel;            // 0 = unknown, join by BSSID only
+    wifi_ip_config_t lease;
+    uint32_t lease_s;            // Lease time left, counted down in RAM (0 = no lease)
+    uint32_t checksum;
+} wifi_join_cache_t;
+
 // WiFi manager configuration structure
 typedef struct {
     const char* ssid;
@@ -12,8 +106,31 @@ typedef struct {
     uint32_t reconnect_delay_ms;
     uint32_t connection_timeout_ms;
     uint8_t led_pin;  // Optional LED for status indication (0 = disabled)
+    const wifi_ip_profile_t* static_ip;  // Optional, NULL = DHCP
+    wifi_power_mode_t idle_power_mode;   // Between uploads (default BALANCED)
+    wifi_power_mode_t burst_power_mode;  // While an upload holds a request
+    bool (*cache_load)(wifi_join_cache_t* cache);        // Optional, called once at init
+    void (*cache_save)(const wifi_join_cache_t* cache);  // Optional, called when the cache changes
 } wifi_config_t;
 
+typedef struct {
+    uint32_t joins;
+    uint32_t directed_joins;
+    uint32_t directed_fallbacks;   // Directed joins that ended in a full scan
+    uint32_t leases_reused;
+    uint32_t last_join_ms;         // Join request -> link up with an address
+    uint32_t boot_to_upload_ms;    // 0 until the first upload
+    uint32_t drop_to_upload_ms;    // Last link drop -> first upload after it
+} wifi_manager_stats_t;
+
+// Per power mode; bursts are counted against the mode they ran in
+typedef struct {
+    uint32_t time_ms;              // Time spent in the mode
+    uint32_t bursts;
+    uint32_t burst_total_ms;       // Request -> release
+    uint32_t burst_max_ms;
+} wifi_power_stats_t;
+
 // WiFi connection states
 typedef enum {
     WIFI_STATE_DISCONNECTED,
@@ -27,12 +144,11 @@ bool wifi_manager_init(const wifi_config_t* config);
 
 void wifi_manager_deinit(void);
 
+// Starts an asynchronous join; wifi_manager_task reports the outcome
 bool wifi_manager_connect(void);
 
 void wifi_manager_task(void);
 
-void wifi_manager_poll(void);
-
 wifi_state_t wifi_manager_get_state(void);
 
 bool wifi_manager_is_connected(void);
@@ -45,4 +161,33 @@ uint32_t wifi_manager_get_ip(void);
 
 bool wifi_manager_reconnect(void);
 
+// Call after each successful upload; feeds the time-to-first-upload metrics
+void wifi_manager_note_upload(void);
+
+void wifi_manager_get_stats(wifi_manager_stats_t* stats);
+
+void wifi_manager_print_stats(void);
+
+// Switches to the burst power mode now (task context only)
+void wifi_manager_power_request(void);
+
+// Ends the burst; safe from lwIP callbacks. The idle mode returns after
+// WIFI_POWER_LINGER_MS unless another request comes first.
+void wifi_manager_power_release(void);
+
+void wifi_manager_set_power_policy(wifi_power_mode_t idle_mode, wifi_power_mode_t burst_mode);
+
+void wifi_manager_get_power_stats(wifi_power_stats_t stats[WIFI_POWER_MODE_COUNT]);
+
+void wifi_manager_print_power_stats(void);
+
+const char* wifi_manager_power_mode_name(wifi_power_mode_t mode);
+
+// Latest link-quality score (0-100), safe from any task
+uint8_t wifi_manager_get_link_score(void);
+
+wifi_link_class_t wifi_manager_get_link_class(void);
+
+void wifi_manager_get_link_quality(wifi_link_quality_t* quality);
+
 #endif // WIFI_MANAGER_H
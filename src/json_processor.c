@@ -27,6 +27,7 @@ typedef struct {
     // Callbacks
     void (*on_data_received)(health_data_t* data);
     void (*on_post_trigger)(health_data_t* data);
+    void (*on_command)(const char* line);
 } json_processor_state_t;
 
 static json_processor_state_t json_state = {
@@ -40,7 +41,8 @@ static json_processor_state_t json_state = {
     .min_post_interval_ms = 0,
     .last_post_time = 0,
     .on_data_received = NULL,
-    .on_post_trigger = NULL
+    .on_post_trigger = NULL,
+    .on_command = NULL
 };
 
 static void parse_json_data(char *json)
@@ -119,6 +121,7 @@ bool json_processor_init(const json_processor_config_t *config)
     json_state.last_post_time = 0;
     json_state.on_data_received = config->on_data_received;
     json_state.on_post_trigger = config->on_post_trigger;
+    json_state.on_command = config->on_command;
     
     json_state.is_initialized = true;
     
@@ -150,6 +153,10 @@ void json_processor_process_char(int c)
         if (json_state.rx_index > 0 && json_state.rx_buffer[0] == '{') {
             parse_json_data(json_state.rx_buffer);
         }
+        // Anything else is treated as a command line
+        else if (json_state.rx_index > 0 && json_state.on_command) {
+            json_state.on_command(json_state.rx_buffer);
+        }
         
         // Reset buffer
         json_state.rx_index = 0;
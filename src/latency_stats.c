@@ -0,0 +1,197 @@
+#include "latency_stats.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+
+// Internal state structure
+typedef struct {
+    bool initialized;
+    critical_section_t lock;
+    latency_histogram_t phases[LATENCY_PHASE_COUNT];
+} latency_stats_state_t;
+
+static latency_stats_state_t g_latency_state = {
+    .initialized = false
+};
+
+static const char* const g_phase_names[LATENCY_PHASE_COUNT] = {
+    [LATENCY_PHASE_DNS]       = "dns",
+    [LATENCY_PHASE_TCP]       = "tcp",
+    [LATENCY_PHASE_HANDSHAKE] = "tls",
+    [LATENCY_PHASE_SIGN]      = "sign",
+    [LATENCY_PHASE_SEND]      = "send",
+    [LATENCY_PHASE_ACK]       = "ack",
+    [LATENCY_PHASE_TOTAL]     = "total"
+};
+
+static uint8_t bucket_index(uint32_t elapsed_us)
+{
+    if (elapsed_us == 0) {
+        return 0;
+    }
+
+    uint8_t index = (uint8_t)(31 - __builtin_clz(elapsed_us));
+    return (index < LATENCY_BUCKET_COUNT) ? index : (LATENCY_BUCKET_COUNT - 1);
+}
+
+static void clear_histograms(void)
+{
+    memset(g_latency_state.phases, 0, sizeof(g_latency_state.phases));
+    for (int i = 0; i < LATENCY_PHASE_COUNT; i++) {
+        g_latency_state.phases[i].min_us = UINT32_MAX;
+    }
+}
+
+void latency_stats_init(void)
+{
+    if (g_latency_state.initialized) {
+        return;
+    }
+
+    critical_section_init(&g_latency_state.lock);
+    clear_histograms();
+    g_latency_state.initialized = true;
+}
+
+uint32_t latency_stats_start(void)
+{
+    return time_us_32();
+}
+
+void latency_stats_stop(latency_phase_t phase, uint32_t start_us)
+{
+    latency_stats_record(phase, time_us_32() - start_us);
+}
+
+void latency_stats_record(latency_phase_t phase, uint32_t elapsed_us)
+{
+    if (!g_latency_state.initialized || phase >= LATENCY_PHASE_COUNT) {
+        return;
+    }
+
+    critical_section_enter_blocking(&g_latency_state.lock);
+
+    latency_histogram_t* hist = &g_latency_state.phases[phase];
+    hist->count++;
+    hist->total_us += elapsed_us;
+    hist->last_us = elapsed_us;
+    if (elapsed_us < hist->min_us) {
+        hist->min_us = elapsed_us;
+    }
+    if (elapsed_us > hist->max_us) {
+        hist->max_us = elapsed_us;
+    }
+    hist->buckets[bucket_index(elapsed_us)]++;
+
+    critical_section_exit(&g_latency_state.lock);
+}
+
+bool latency_stats_get(latency_phase_t phase, latency_histogram_t* histogram)
+{
+    if (!g_latency_state.initialized || !histogram || phase >= LATENCY_PHASE_COUNT) {
+        return false;
+    }
+
+    critical_section_enter_blocking(&g_latency_state.lock);
+    *histogram = g_latency_state.phases[phase];
+    critical_section_exit(&g_latency_state.lock);
+
+    return histogram->count > 0;
+}
+
+uint32_t latency_stats_percentile(const latency_histogram_t* histogram, uint8_t percentile)
+{
+    if (!histogram || histogram->count == 0) {
+        return 0;
+    }
+
+    // Upper edge of the bucket containing the requested rank, clamped to the observed max
+    uint32_t rank = (uint32_t)(((uint64_t)histogram->count * percentile + 99) / 100);
+    uint32_t seen = 0;
+
+    for (uint32_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            if (i == LATENCY_BUCKET_COUNT - 1) {
+                break;
+            }
+            uint32_t upper = (1UL << (i + 1)) - 1;
+            return (upper < histogram->max_us) ? upper : histogram->max_us;
+        }
+    }
+
+    return histogram->max_us;
+}
+
+const char* latency_stats_phase_name(latency_phase_t phase)
+{
+    return (phase < LATENCY_PHASE_COUNT) ? g_phase_names[phase] : "?";
+}
+
+int latency_stats_format_json(char* buffer, size_t buffer_size)
+{
+    if (!buffer || buffer_size == 0) {
+        return -1;
+    }
+
+    // Most recent value per phase, in microseconds
+    int len = snprintf(buffer, buffer_size, "\"lat\":{");
+
+    for (int i = 0; i < LATENCY_PHASE_COUNT && len > 0 && (size_t)len < buffer_size; i++) {
+        latency_histogram_t hist = {0};
+        latency_stats_get((latency_phase_t)i, &hist);
+        len += snprintf(buffer + len, buffer_size - len, "%s\"%s\":%lu",
+                        (i == 0) ? "" : ",", g_phase_names[i], hist.last_us);
+    }
+
+    if (len > 0 && (size_t)len < buffer_size) {
+        len += snprintf(buffer + len, buffer_size - len, "}");
+    }
+
+    return len;
+}
+
+void latency_stats_print(void)
+{
+    printf("Latency Stats (us):\n");
+    printf("  %-6s %6s %9s %9s %9s %9s %9s\n",
+           "phase", "count", "min", "p50", "p90", "p99", "max");
+
+    for (int i = 0; i < LATENCY_PHASE_COUNT; i++) {
+        latency_histogram_t hist;
+        if (!latency_stats_get((latency_phase_t)i, &hist)) {
+            printf("  %-6s %6d\n", g_phase_names[i], 0);
+            continue;
+        }
+
+        printf("  %-6s %6lu %9lu %9lu %9lu %9lu %9lu\n",
+               g_phase_names[i],
+               hist.count,
+               hist.min_us,
+               latency_stats_percentile(&hist, 50),
+               latency_stats_percentile(&hist, 90),
+               latency_stats_percentile(&hist, 99),
+               hist.max_us);
+
+        // Non-empty log2 buckets: lower edge in us and count
+        printf("        ");
+        for (uint32_t b = 0; b < LATENCY_BUCKET_COUNT; b++) {
+            if (hist.buckets[b] != 0) {
+                printf(" %lu:%lu", (b == 0) ? 0UL : (1UL << b), hist.buckets[b]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+void latency_stats_reset(void)
+{
+    if (!g_latency_state.initialized) {
+        return;
+    }
+
+    critical_section_enter_blocking(&g_latency_state.lock);
+    clear_histograms();
+    critical_section_exit(&g_latency_state.lock);
+}
@@ -22,10 +22,10 @@
 #include "mbedtls/ssl.h"
 #include "https_config.h"
 
-#include "hardware/i2c.h"
 #include "cryptoauthlib.h"
 #include "atca_basic.h"
 #include "atca_mbedtls_wrap.h"
+#include "hal_pico_i2c.h"
 #include <mbedtls/error.h>
 #include "mbedtls/ecdsa.h"
 #include "mbedtls/pk.h"
@@ -38,6 +38,20 @@
 #include "json_processor.h"
 #include "wifi_manager.h"
 #include "https_manager.h"
+#include "mem_manager.h"
+#include "latency_stats.h"
+#include "device_telemetry.h"
+#include "core_channel.h"
+#include "upload_pipeline.h"
+#include "scheduler.h"
+#ifdef UPLOAD_TRANSPORT_MQTT
+#include "mqtt_manager.h"
+#endif
+#ifdef FIRMWARE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_app.h"
+#endif
 
 
 #define MBEDTLS_ECDSA_SIGN_ALT
@@ -48,9 +62,8 @@
 
 
 // ATECC Configuration
-#define I2C_BUS_ID      i2c0
-#define I2C_SDA_PIN     4
-#define I2C_SCL_PIN     5
+// Starting clock; atcab_i2c_speed_probe() steps it up after init. The bus
+// pins are set in hal_pico_i2c.c.
 #define I2C_BAUDRATE    100000
 
 #define TARGET_SLOT 0
@@ -60,6 +73,31 @@
 #define DATA_TIMEOUT_MS 20000
 #define WIFI_RECONNECT_DELAY_MS 5000
 
+// Radio power-save policy: idle between samples, no power save during uploads
+#define WIFI_IDLE_POWER_MODE    WIFI_POWER_SAVING
+#define WIFI_BURST_POWER_MODE   WIFI_POWER_PERFORMANCE
+
+#ifdef WIFI_STATIC_IP
+static const wifi_ip_profile_t g_wifi_static_ip = {
+    .address = WIFI_STATIC_IP,
+    .netmask = WIFI_STATIC_NETMASK,
+    .gateway = WIFI_STATIC_GATEWAY,
+    .dns = WIFI_STATIC_DNS
+};
+#define WIFI_STATIC_PROFILE (&g_wifi_static_ip)
+#else
+#define WIFI_STATIC_PROFILE NULL
+#endif
+
+// Scheduler periods and idle caps
+#define WIFI_LED_INTERVAL_MS        50
+#define UPLOAD_TASK_INTERVAL_MS     100
+#define CORE0_MAX_IDLE_MS           10
+#define CORE1_MAX_IDLE_MS           100
+
+// A failed upload keeps its records queued; they are retried after this
+#define UPLOAD_RETRY_DELAY_MS       2000
+
 // POST CONFIGURATION
 #define AUTO_POST_ON_SAMPLE
 #define MIN_POST_INTERVAL_MS 6000
@@ -86,12 +124,38 @@ ATCAIfaceCfg cfg_atecc608_pico = {
     .cfg_data   = NULL
 };
 
-// Inter-core communication
-static volatile bool webhook_trigger = false;
-static volatile bool webhook_in_progress = false;
+#ifdef FIRMWARE_FREERTOS
+// Reconnect requests from the CDC command handler to the WiFi task
+#define WIFI_NOTIFY_RECONNECT   (1U << 0)
+
+static TaskHandle_t g_wifi_task_handle = NULL;
+#else
+// Inter-core communication: raw CDC bytes to core 1, status back to core 0
+static core_byte_ring_t g_cdc_ring;
+static core_channel_t g_to_core0;
+
+// Core 0's view of the WiFi state, updated from CORE_STATUS_WIFI messages
+static bool wifi_fully_connected = false;
+
+// Per-core schedulers and their tasks
+static scheduler_t g_core0_sched;
+static sched_task_t g_hid_task;
+
+static scheduler_t g_core1_sched;
+static sched_task_t g_wifi_check_task;
+static sched_task_t g_wifi_led_task;
+static sched_task_t g_upload_task;
+static sched_task_t g_telemetry_task;
 
-// Auto-trigger variables
-static volatile bool wifi_fully_connected = false;
+// WiFi LED blink half-period on core 1; 0 = solid on
+static uint32_t g_wifi_led_blink_ms = 100;
+static bool g_wifi_reported = false;
+
+// Upload started by core 1 whose outcome has not been reported yet
+static bool g_upload_in_flight = false;
+static uint32_t g_upload_sample = 0;
+static uint32_t g_upload_retry_at = 0;      // 0 = no failed upload waiting
+#endif // FIRMWARE_FREERTOS
 
 // mTLS state
 static bool g_atecc_pk_initialized = false;
@@ -100,6 +164,113 @@ bool init_atecc_pk_context(void);
 
 // [------------------------------------------------------------------------- ATECC608B - Signing -------------------------------------------------------------------------]
 
+// Sign state; signs hold the device (atcab_acquire), so one job is enough and
+// it stays off the handshake's stack
+static calib_sign_async_t g_atecc_sign_job;
+
+// Random, Nonce and Sign through the non-blocking calib API: between polls
+// atca_delay_ms gives the core away (other tasks under FreeRTOS, WFE sleep
+// bare-metal) instead of spinning for the ~60 ms of device time
+static ATCA_STATUS atecc_sign_yielding(const uint8_t* msg, uint8_t* signature)
+{
+    ATCA_STATUS status = atcab_sign_submit(&g_atecc_sign_job, TARGET_SLOT, msg, signature, NULL, NULL);
+    if (status != ATCA_SUCCESS) {
+        return status;
+    }
+
+    while ((status = atcab_sign_poll(&g_atecc_sign_job)) == ATCA_EXECUTION_PENDING) {
+        atca_delay_ms(atcab_sign_wait_msec(&g_atecc_sign_job));
+    }
+    return status;
+}
+
+// The TLS sign, shared by both mbedTLS hooks. A handshake is waiting on it,
+// so it queues for the device ahead of any other caller, then runs Random,
+// Nonce and Sign under one wake.
+static ATCA_STATUS atecc_sign_digest(const uint8_t* msg, uint8_t* signature)
+{
+    ATCA_STATUS status = atcab_acquire(ATCA_PRIORITY_URGENT);
+    if (status != ATCA_SUCCESS) {
+        return status;
+    }
+
+    uint32_t sign_start = latency_stats_start();
+    atcab_session_begin();
+    status = atecc_sign_yielding(msg, signature);
+    atcab_session_end();
+    latency_stats_stop(LATENCY_PHASE_SIGN, sign_start);
+
+    atcab_relinquish();
+    return status;
+}
+
+// "crcbench": time atCRC on this core for the packet sizes the TLS path
+// sends and receives (status, 32 byte block read, signature, Verify command)
+static void atecc_crc_bench(void)
+{
+    static const size_t sizes[] = { 2, 33, 65, 133 };
+    static uint8_t data[133];
+    const uint32_t reps = 10000;
+    uint8_t crc_le[ATCA_CRC_SIZE];
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37u + 11u);
+    }
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        uint32_t start = time_us_32();
+        for (uint32_t rep = 0; rep < reps; rep++) {
+            atCRC(sizes[i], data, crc_le);
+        }
+        uint32_t elapsed_us = time_us_32() - start;
+        printf("ATECC CRC: %3u bytes %lu ns\n", (unsigned)sizes[i],
+               (unsigned long)((uint64_t)elapsed_us * 1000u / reps));
+    }
+}
+
+static const char* atecc_opcode_name(uint8_t opcode)
+{
+    switch (opcode) {
+        case ATCA_COUNTER: return "Counter";
+        case ATCA_ECDH:    return "ECDH";
+        case ATCA_GENKEY:  return "GenKey";
+        case ATCA_INFO:    return "Info";
+        case ATCA_NONCE:   return "Nonce";
+        case ATCA_RANDOM:  return "Random";
+        case ATCA_READ:    return "Read";
+        case ATCA_SHA:     return "SHA";
+        case ATCA_SIGN:    return "Sign";
+        case ATCA_VERIFY:  return "Verify";
+        case ATCA_WRITE:   return "Write";
+        default:           return "Other";
+    }
+}
+
+// "atecc": per-opcode command counts and average phase times since boot or
+// the last "atecc reset", as seen by calib_execute_command
+static void atecc_print_profile(void)
+{
+    static atca_opcode_stats_t stats[ATCA_PROFILE_OPCODE_COUNT];
+    size_t count = ATCA_PROFILE_OPCODE_COUNT;
+
+    if (atcab_get_stats(stats, &count) != ATCA_SUCCESS) {
+        printf("ATECC Profile: unavailable\n");
+        return;
+    }
+
+    printf("ATECC Profile: %-7s %6s %5s %5s %6s %4s %8s %8s %8s %8s\n", "opcode", "cmds", "fail",
+           "wake", "polls", "crc", "send us", "exec us", "recv us", "max us");
+    for (size_t i = 0; i < count; i++) {
+        const atca_opcode_stats_t* op = &stats[i];
+        uint32_t n = op->commands ? op->commands : 1;
+        printf("ATECC Profile: %-7s %6lu %5lu %5lu %6lu %4lu %8lu %8lu %8lu %8lu\n",
+               atecc_opcode_name(op->opcode), (unsigned long)op->commands, (unsigned long)op->failures,
+               (unsigned long)op->wake_retries, (unsigned long)op->polls, (unsigned long)op->crc_errors,
+               (unsigned long)(op->send_usec / n), (unsigned long)(op->exec_usec / n),
+               (unsigned long)(op->receive_usec / n), (unsigned long)op->max_usec);
+    }
+}
+
 int atca_mbedtls_ecdsa_sign(const mbedtls_mpi* data, mbedtls_mpi* r, mbedtls_mpi* s,
                             const unsigned char* msg, size_t msg_len)
 {
@@ -110,7 +281,7 @@ int atca_mbedtls_ecdsa_sign(const mbedtls_mpi* data, mbedtls_mpi* r, mbedtls_mpi
     }
 
     uint8_t signature[64];
-    ATCA_STATUS status = atcab_sign(TARGET_SLOT, msg, signature);
+    ATCA_STATUS status = atecc_sign_digest(msg, signature);
 
     if (status != ATCA_SUCCESS) {
         printf("❌ ATECC sign failed: 0x%02X\n", status);
@@ -142,7 +313,6 @@ int mbedtls_ecdsa_sign(mbedtls_ecp_group *grp,
     ATCA_STATUS status;
     
     uint8_t hash[32];
-    status = atcab_random(hash);
     if (blen != 32) {
             printf("❌ Expected 32-byte hash, got %zu\n", blen);
         return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
@@ -150,10 +320,11 @@ int mbedtls_ecdsa_sign(mbedtls_ecp_group *grp,
     memcpy(hash, buf, 32);
     
     uint8_t signature[64];
-    status = atcab_sign(TARGET_SLOT, hash, signature);
+    status = atecc_sign_digest(hash, signature);
     
     if (status != ATCA_SUCCESS) {
             printf("❌ ATECC sign failed: 0x%02X\n", status);
+        return MBEDTLS_ERR_PK_ALLOC_FAILED;
     }
     
     int ret = mbedtls_mpi_read_binary(r, signature, 32);
@@ -171,38 +342,257 @@ int mbedtls_ecdsa_sign(mbedtls_ecp_group *grp,
 
 // [------------------------------------------------------------------------- HTTPS - POST -------------------------------------------------------------------------]
 
+// Records per upload, shared by the core 1 loop and the FreeRTOS ingest task
+static uint32_t upload_batch_size(const https_post_data_t* records, uint32_t pending)
+{
+#ifdef UPLOAD_TRANSPORT_MQTT
+    (void)records;
+    return pending > 0 ? 1 : 0;
+#else
+    // Link quality decides between draining, batching and holding
+    uint32_t oldest_age_ms = to_ms_since_boot(get_absolute_time()) - records[0].timestamp;
+    return https_manager_batch_size(pending, oldest_age_ms);
+#endif
+}
+
+#ifndef FIRMWARE_FREERTOS
+
+// JSON processor callbacks, both run on core 1
+void aggregate_sample(health_data_t* data)
+{
+    upload_pipeline_add_sample(data);
+}
+
 void trigger_webhook_post(health_data_t* data)
 {
     (void)data;
-    
-    if (!webhook_in_progress) {
-        webhook_trigger = true;
+
+    // Closes the aggregation window into a ready-to-send record
+    upload_pipeline_commit(json_processor_get_sample_count(),
+                           to_ms_since_boot(get_absolute_time()));
+}
+
+static bool upload_ready(void)
+{
+    if (g_upload_retry_at != 0 && (int32_t)(to_ms_since_boot(get_absolute_time()) - g_upload_retry_at) < 0) {
+        return false;
+    }
+    g_upload_retry_at = 0;
+
+#ifdef UPLOAD_TRANSPORT_MQTT
+    return !g_upload_in_flight && !mqtt_manager_is_busy();
+#else
+    // COMPLETE/ERROR are held briefly before the manager accepts a new POST
+    return !g_upload_in_flight && https_manager_get_state() == HTTPS_STATE_IDLE;
+#endif
+}
+
+static void report_upload_done(uint32_t sample, bool success)
+{
+    // Records leave the pipeline only once delivered
+    upload_pipeline_end_send(success);
+
+    if (success) {
+        wifi_manager_note_upload();
+    } else {
+        g_upload_retry_at = to_ms_since_boot(get_absolute_time()) + UPLOAD_RETRY_DELAY_MS;
+    }
+
+    core_msg_t status = {
+        .type = CORE_MSG_STATUS,
+        .status = {
+            .status = CORE_STATUS_UPLOAD_DONE,
+            .value = success ? 1 : 0,
+            .arg = sample
+        }
+    };
+    core_channel_push(&g_to_core0, &status);
+}
+
+void send_webhook_post(const https_post_data_t* records, uint32_t count)
+{
+#ifdef UPLOAD_TRANSPORT_MQTT
+    // Always one record: the session stays up, so there is no handshake to share.
+    // The publish runs in the cyw43 async_context; check_upload_done() reports the outcome
+    (void)count;
+    if (mqtt_manager_publish_json(&records[0])) {
+        g_upload_in_flight = true;
+        g_upload_sample = records[0].sample;
+    } else {
+        report_upload_done(records[0].sample, false);
+    }
+#else
+    // The POST runs in the cyw43 async_context; check_upload_done() reports the outcome
+    uint32_t last_sample = records[count - 1].sample;
+    if (https_manager_post_batch(records, count)) {
+        g_upload_in_flight = true;
+        g_upload_sample = last_sample;
+    } else {
+        report_upload_done(last_sample, false);
     }
+#endif
 }
 
-void send_webhook_post(health_data_t* data)
+static void check_upload_done(void)
 {
+    if (!g_upload_in_flight) {
+        return;
+    }
+
+#ifdef UPLOAD_TRANSPORT_MQTT
+    if (mqtt_manager_is_busy()) {
+        return;
+    }
+
+    // The outcome is kept apart from the state, which upload_task may already have moved on
+    g_upload_in_flight = false;
+    report_upload_done(g_upload_sample, mqtt_manager_publish_succeeded());
+#else
     if (https_manager_is_busy()) {
         return;
     }
 
-    webhook_in_progress = true;
+    // COMPLETE/ERROR are held for a second, far longer than one core 1 loop pass
+    g_upload_in_flight = false;
+    report_upload_done(g_upload_sample, https_manager_get_state() == HTTPS_STATE_COMPLETE);
+#endif
+}
 
-    https_post_data_t post_data = {
-        .sample = json_processor_get_sample_count(),
-        .timestamp = to_ms_since_boot(get_absolute_time()),
-        .device = "Pico-W",
-        .cpu = data->cpu,
-        .memory = data->memory,
-        .disk = data->disk,
-        .net_in = data->net_in,
-        .net_out = data->net_out,
-        .processes = data->processes
+static void send_wifi_status(bool connected)
+{
+    core_msg_t status = {
+        .type = CORE_MSG_STATUS,
+        .status = {
+            .status = CORE_STATUS_WIFI,
+            .value = connected ? 1 : 0
+        }
     };
+    core_channel_push(&g_to_core0, &status);
+}
 
-    https_manager_post_json(&post_data);
+static void handle_core0_message(const core_msg_t* msg)
+{
+    if (msg->type != CORE_MSG_STATUS) {
+        return;
+    }
 
-    webhook_in_progress = false;
+    switch (msg->status.status) {
+        case CORE_STATUS_WIFI:
+            wifi_fully_connected = (msg->status.value != 0);
+            break;
+        case CORE_STATUS_UPLOAD_DONE:
+            if (msg->status.value == 0) {
+                printf("Core 0: Upload of sample %lu failed\n", msg->status.arg);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+#endif // FIRMWARE_FREERTOS
+
+// [------------------------------------------------------------------------- CDC - Commands -------------------------------------------------------------------------]
+
+// "power <idle> <burst>", e.g. "power saving performance"
+static void set_power_policy(const char* args)
+{
+    char idle[16], burst[16];
+    wifi_power_mode_t modes[2];
+    const char* names[2] = { idle, burst };
+
+    if (sscanf(args, "%15s %15s", idle, burst) != 2) {
+        printf("Usage: power <idle> <burst> (balanced, performance, saving)\n");
+        return;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        int mode = 0;
+        while (mode < WIFI_POWER_MODE_COUNT &&
+               strcmp(names[i], wifi_manager_power_mode_name((wifi_power_mode_t)mode)) != 0) {
+            mode++;
+        }
+        if (mode == WIFI_POWER_MODE_COUNT) {
+            printf("Unknown power mode '%s'\n", names[i]);
+            return;
+        }
+        modes[i] = (wifi_power_mode_t)mode;
+    }
+
+    // The WiFi manager is owned by core 1, which parses commands
+    wifi_manager_set_power_policy(modes[0], modes[1]);
+    printf("WiFi power policy: idle %s, burst %s\n", idle, burst);
+}
+
+// The CDC commands that take the ATECC run in thread context on the lwIP
+// core. Hold off lwIP while they do, so the TLS sign in the lwIP IRQ never
+// finds the device held by the code it interrupted.
+static inline void atecc_cdc_begin(void)
+{
+#ifndef FIRMWARE_FREERTOS
+    cyw43_arch_lwip_begin();
+#endif
+}
+
+static inline void atecc_cdc_end(void)
+{
+#ifndef FIRMWARE_FREERTOS
+    cyw43_arch_lwip_end();
+#endif
+}
+
+void handle_cdc_command(const char* line)
+{
+    if (strcmp(line, "stats") == 0) {
+        latency_stats_print();
+    } else if (strcmp(line, "stats reset") == 0) {
+        latency_stats_reset();
+        printf("Latency stats cleared\n");
+    } else if (strcmp(line, "mem") == 0) {
+        mem_manager_print_stats();
+    } else if (strcmp(line, "crcbench") == 0) {
+        atecc_crc_bench();
+    } else if (strcmp(line, "atecc") == 0) {
+        atecc_cdc_begin();
+        atecc_print_profile();
+        atecc_cdc_end();
+    } else if (strcmp(line, "atecc reset") == 0) {
+        atecc_cdc_begin();
+        atcab_reset_stats();
+        atecc_cdc_end();
+        printf("ATECC profile cleared\n");
+    } else if (strcmp(line, "i2c") == 0) {
+        hal_i2c_print_xfer_stats();
+    } else if (strcmp(line, "telemetry") == 0) {
+        device_telemetry_print();
+    } else if (strcmp(line, "reconnect") == 0) {
+#ifdef FIRMWARE_FREERTOS
+        // The WiFi task owns the WiFi manager
+        printf("Reconnect requested\n");
+        xTaskNotify(g_wifi_task_handle, WIFI_NOTIFY_RECONNECT, eSetBits);
+#else
+        // Commands are parsed on core 1, which owns the WiFi manager
+        printf("Core 1: Reconnect requested\n");
+        wifi_manager_reconnect();
+#endif
+    } else if (strcmp(line, "wifi") == 0) {
+        wifi_manager_print_stats();
+    } else if (strcmp(line, "power") == 0) {
+        wifi_manager_print_power_stats();
+    } else if (strncmp(line, "power ", 6) == 0) {
+        set_power_policy(line + 6);
+    } else if (strcmp(line, "pipeline") == 0) {
+        upload_pipeline_stats_t stats;
+        upload_pipeline_get_stats(&stats);
+        printf("Upload Pipeline: %lu samples, %lu records queued, %lu coalesced, %lu held, "
+               "%lu sent, %lu failed sends, %lu pending\n",
+               stats.samples_aggregated, stats.records_queued, stats.records_coalesced,
+               stats.records_held, stats.records_sent, stats.send_failures, upload_pipeline_count());
+#ifdef FIRMWARE_FREERTOS
+    } else if (strcmp(line, "rtos") == 0) {
+        rtos_app_print_stats();
+#endif
+    }
 }
 
 bool init_atecc_pk_context(void){
@@ -218,8 +608,66 @@ bool init_atecc_pk_context(void){
     return true;
 }
 
+#ifndef FIRMWARE_FREERTOS
+
 // [------------------------------------------------------------------------- Core 1 - WiFi Handler -------------------------------------------------------------------------]
 
+static void wifi_led_task(void* arg)
+{
+    (void)arg;
+
+    if (g_wifi_led_blink_ms == 0) {
+        gpio_put(WIFI_LED_PIN, 1);
+        return;
+    }
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    gpio_put(WIFI_LED_PIN, ((now / g_wifi_led_blink_ms) % 2) == 0);
+}
+
+static void wifi_check_task(void* arg)
+{
+    (void)arg;
+
+    wifi_manager_task();
+
+    wifi_state_t state = wifi_manager_get_state();
+    if (state == WIFI_STATE_CONNECTED) {
+        // Solid ON when connected
+        g_wifi_led_blink_ms = 0;
+    } else if (state == WIFI_STATE_RECONNECTING) {
+        // Slow blink while waiting to reconnect
+        g_wifi_led_blink_ms = 500;
+    } else {
+        // Fast blink during connection attempt
+        g_wifi_led_blink_ms = 100;
+    }
+
+    bool wifi_now = wifi_manager_is_fully_connected();
+    if (wifi_now != g_wifi_reported) {
+        g_wifi_reported = wifi_now;
+        send_wifi_status(wifi_now);
+    }
+}
+
+static void telemetry_task(void* arg)
+{
+    (void)arg;
+    device_telemetry_sample();
+}
+
+static void upload_task(void* arg)
+{
+    (void)arg;
+
+    // Timeouts and COMPLETE/ERROR -> IDLE, on the core that runs the uploads
+#ifdef UPLOAD_TRANSPORT_MQTT
+    mqtt_manager_task();
+#else
+    https_manager_task();
+#endif
+}
+
 void core1_entry(void)
 {
     sleep_ms(1000);
@@ -229,96 +677,222 @@ void core1_entry(void)
         .password = WIFI_PASSWORD,
         .reconnect_delay_ms = WIFI_RECONNECT_DELAY_MS,
         .connection_timeout_ms = 30000,
-        .led_pin = WIFI_LED_PIN
+        .led_pin = WIFI_LED_PIN,
+        .static_ip = WIFI_STATIC_PROFILE,
+        .idle_power_mode = WIFI_IDLE_POWER_MODE,
+        .burst_power_mode = WIFI_BURST_POWER_MODE
     };
 
-    bool wifi_init_success = false;
-    int attempt_count = 0;
+    scheduler_init(&g_core1_sched);
+    scheduler_add_periodic(&g_core1_sched, &g_wifi_led_task, wifi_led_task, NULL, WIFI_LED_INTERVAL_MS);
 
-    while (!wifi_init_success)
+    // Only bringing up the CYW43 is retried here; joins and rejoins run
+    // asynchronously in wifi_check_task, so core 1 keeps serving CDC data
+    int attempt_count = 1;
+    g_wifi_led_blink_ms = 100;
+    while (!wifi_manager_init(&wifi_cfg))
     {
-        if (attempt_count > 0)
-        {
-            printf("Core 1: Retry attempt %d in %d seconds...\n", 
-                   attempt_count + 1, 
-                   WIFI_RECONNECT_DELAY_MS / 1000);
-            
-            int blink_cycles = WIFI_RECONNECT_DELAY_MS / 500;
-            for (int i = 0; i < blink_cycles; i++) {
-                gpio_put(WIFI_LED_PIN, 1);
-                sleep_ms(250);
-                gpio_put(WIFI_LED_PIN, 0);
-                sleep_ms(250);
-            }
-        }
-
-        if (!wifi_manager_init(&wifi_cfg)) {
-            attempt_count++;
-            continue;
-        }
-
-        wifi_init_success = wifi_manager_connect();
-        attempt_count++;
-        
-        if (!wifi_init_success) {
-            for (int i = 0; i < 5; i++) {
-                gpio_put(WIFI_LED_PIN, 1);
-                sleep_ms(100);
-                gpio_put(WIFI_LED_PIN, 0);
-                sleep_ms(100);
-            }
-            
-            wifi_manager_deinit();
-        }
+        printf("Core 1: CYW43 init retry %d in %d seconds...\n",
+               ++attempt_count, WIFI_RECONNECT_DELAY_MS / 1000);
+        g_wifi_led_blink_ms = 250;
+        scheduler_run_for(&g_core1_sched, WIFI_RECONNECT_DELAY_MS);
     }
 
-    printf("Core 1: WiFi connected after %d attempts!\n", attempt_count);
-    gpio_put(WIFI_LED_PIN, 1);
-    
-    wifi_fully_connected = true;
+    wifi_manager_connect();
+
+    scheduler_add_periodic(&g_core1_sched, &g_wifi_check_task, wifi_check_task, NULL,
+                           WIFI_MANAGER_CHECK_INTERVAL_MS);
+    scheduler_add_periodic(&g_core1_sched, &g_upload_task, upload_task, NULL,
+                           UPLOAD_TASK_INTERVAL_MS);
+    scheduler_add_periodic(&g_core1_sched, &g_telemetry_task, telemetry_task, NULL,
+                           DEVICE_TELEMETRY_SAMPLE_MS);
 
     // Core 1 main loop
     while (true)
     {
-        wifi_manager_poll();
-        wifi_manager_task();
-        
-        wifi_fully_connected = wifi_manager_is_fully_connected();
+        // lwIP and cyw43 are serviced by the SDK async_context, so there is nothing to poll here.
+        // Collect the upload outcome before upload_task can move COMPLETE/ERROR back to IDLE.
+        check_upload_done();
+        scheduler_run(&g_core1_sched);
         
-        wifi_state_t state = wifi_manager_get_state();
-        if (state == WIFI_STATE_CONNECTED)
+        // Stage 1: tokenize and aggregate whatever core 0 has forwarded
+        uint8_t rx[64];
+        size_t rx_len;
+        while ((rx_len = core_byte_ring_read(&g_cdc_ring, rx, sizeof(rx))) > 0)
         {
-            // Solid ON when connected
-            gpio_put(WIFI_LED_PIN, 1);
+            for (size_t i = 0; i < rx_len; i++) {
+                json_processor_process_char(rx[i]);
+            }
         }
-        else if (state == WIFI_STATE_RECONNECTING)
+
+        // Stage 2: records stay queued until the link and the transport can take them
+        if (upload_pipeline_count() > 0 && wifi_manager_is_connected() && upload_ready())
         {
-            // Slow blink while waiting to reconnect
-            uint32_t now = to_ms_since_boot(get_absolute_time());
-            gpio_put(WIFI_LED_PIN, ((now / 500) % 2) == 0);
+            https_post_data_t records[UPLOAD_PIPELINE_DEPTH];
+            uint32_t pending = upload_pipeline_peek_batch(records, UPLOAD_PIPELINE_DEPTH);
+            uint32_t count = upload_batch_size(records, pending);
+            if (count > 0) {
+                upload_pipeline_begin_send(count);
+                send_webhook_post(records, count);
+            }
         }
-        else
-        {
-            // Fast blink during connection attempt
-            uint32_t now = to_ms_since_boot(get_absolute_time());
-            gpio_put(WIFI_LED_PIN, ((now / 100) % 2) == 0);
+
+        // Sleep until the next timer, woken early by the doorbell when core 0 forwards CDC bytes
+        uint32_t idle_ms = scheduler_next_deadline_ms(&g_core1_sched);
+        if (idle_ms > CORE1_MAX_IDLE_MS) {
+            idle_ms = CORE1_MAX_IDLE_MS;
         }
-        
-        // Handle webhook trigger
-        if (webhook_trigger && wifi_manager_is_connected() && !webhook_in_progress)
-        {
-            webhook_trigger = false;
-            const health_data_t* health = json_processor_get_health_data();
-            if (health->valid) {
-                health_data_t data_copy = *health;
-                send_webhook_post(&data_copy);
+        if (idle_ms > 0) {
+            uint32_t idle_start = time_us_32();
+            core_byte_ring_wait(&g_cdc_ring, idle_ms * 1000);
+            device_telemetry_note_idle(time_us_32() - idle_start);
+        }
+    }
+}
+
+static void hid_task(void* arg)
+{
+    (void)arg;
+    hid_manager_task(wifi_fully_connected, msc_manager_is_mounted());
+}
+
+#else
+
+// [------------------------------------------------------------------------- FreeRTOS SMP - Tasks -------------------------------------------------------------------------]
+
+// Runs in the upload task (core 1) and blocks until the transport is done
+static bool rtos_upload(const https_post_data_t* records, uint32_t count)
+{
+#ifdef UPLOAD_TRANSPORT_MQTT
+    // Always one record (upload_batch_size): the session stays up
+    (void)count;
+    mqtt_manager_task();
+    bool success = mqtt_manager_publish_json(&records[0]);
+    while (success && mqtt_manager_is_busy()) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    success = success && mqtt_manager_publish_succeeded();
+#else
+    bool success = https_manager_post_batch(records, count);
+    while (success && https_manager_is_busy()) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    success = success && https_manager_get_state() == HTTPS_STATE_COMPLETE;
+
+    // COMPLETE/ERROR are held briefly before the manager accepts a new POST
+    while (https_manager_get_state() != HTTPS_STATE_IDLE) {
+        vTaskDelay(pdMS_TO_TICKS(UPLOAD_TASK_INTERVAL_MS));
+        https_manager_task();
+    }
+#endif
+
+    if (success) {
+        wifi_manager_note_upload();
+    }
+
+    return success;
+}
+
+static void usb_task(void* arg)
+{
+    (void)arg;
+
+    while (true) {
+        tud_task();
+
+        // Raw CDC bytes to the ingest task; block briefly rather than drop when it lags
+        uint8_t rx[64];
+        size_t rx_len = 0;
+        while (rx_len < sizeof(rx)) {
+            int c = getchar_timeout_us(0);
+            if (c == PICO_ERROR_TIMEOUT) {
+                break;
             }
+            rx[rx_len++] = (uint8_t)c;
         }
-        
-        sleep_ms(50);
+        if (rx_len > 0) {
+            rtos_app_ingest(rx, rx_len, pdMS_TO_TICKS(CORE0_MAX_IDLE_MS));
+        }
+
+        vTaskDelay(1);
+    }
+}
+
+static void hid_task(void* arg)
+{
+    (void)arg;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (true) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(HID_UPDATE_INTERVAL_MS));
+
+        // TinyUSB is not thread-safe; both USB tasks are pinned to core 0,
+        // so suspending this core's scheduler keeps tud_task() out
+        vTaskSuspendAll();
+        hid_manager_task(rtos_app_is_link_up(), msc_manager_is_mounted());
+        xTaskResumeAll();
+    }
+}
+
+static void wifi_task(void* arg)
+{
+    (void)arg;
+
+    wifi_config_t wifi_cfg = {
+        .ssid = WIFI_SSID,
+        .password = WIFI_PASSWORD,
+        .reconnect_delay_ms = WIFI_RECONNECT_DELAY_MS,
+        .connection_timeout_ms = 30000,
+        .led_pin = WIFI_LED_PIN,
+        .static_ip = WIFI_STATIC_PROFILE,
+        .idle_power_mode = WIFI_IDLE_POWER_MODE,
+        .burst_power_mode = WIFI_BURST_POWER_MODE
+    };
+
+    // cyw43_arch_init() must run from a task once the scheduler is up
+    int attempt_count = 1;
+    while (!wifi_manager_init(&wifi_cfg)) {
+        printf("WiFi Task: CYW43 init retry %d in %d seconds...\n",
+               ++attempt_count, WIFI_RECONNECT_DELAY_MS / 1000);
+        vTaskDelay(pdMS_TO_TICKS(WIFI_RECONNECT_DELAY_MS));
     }
+
+    // Joins and rejoins are asynchronous; wifi_manager_task drives them
+    wifi_manager_connect();
+
+    TickType_t telemetry_at = xTaskGetTickCount();
+
+    while (true) {
+        uint32_t notified = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &notified, pdMS_TO_TICKS(WIFI_MANAGER_CHECK_INTERVAL_MS));
+
+        if (notified & WIFI_NOTIFY_RECONNECT) {
+            wifi_manager_reconnect();
+        }
+
+        wifi_manager_task();
+        rtos_app_set_link_up(wifi_manager_is_fully_connected());
+
+        if (xTaskGetTickCount() - telemetry_at >= pdMS_TO_TICKS(DEVICE_TELEMETRY_SAMPLE_MS)) {
+            telemetry_at = xTaskGetTickCount();
+            device_telemetry_sample();
+        }
+    }
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t task, char* name)
+{
+    (void)task;
+    panic("Stack overflow in task '%s'", name);
+}
+
+void vApplicationMallocFailedHook(void)
+{
+    panic("FreeRTOS heap exhausted");
 }
 
+#endif // FIRMWARE_FREERTOS
+
 // [------------------------------------------------------------------------- MAIN -------------------------------------------------------------------------]
 
 int main(void)
@@ -328,6 +902,10 @@ int main(void)
     stdio_init_all();
     tud_init(BOARD_TUD_RHPORT);
 
+    // TLS arena must be in place before the first mbedTLS allocation
+    mem_manager_init();
+    latency_stats_init();
+
     // Initialize GPIOs
     gpio_init(WIFI_LED_PIN);
     gpio_set_dir(WIFI_LED_PIN, GPIO_OUT);
@@ -341,19 +919,22 @@ int main(void)
     gpio_set_dir(MTLS_LED_PIN, GPIO_OUT);
     gpio_put(MTLS_LED_PIN, 0);
 
-    // ATECC608B Initialization
-    i2c_init(I2C_BUS_ID, I2C_BAUDRATE);
-    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA_PIN);
-    gpio_pull_up(I2C_SCL_PIN);
-
+    // ATECC608B Initialization (the HAL brings up the I2C bus)
     ATCA_STATUS status = atcab_init(&cfg_atecc608_pico);
     if (status != ATCA_SUCCESS) {
         printf("CryptoAuthLib init failed: %d\n", status);
     } else {
         printf("ATECC608B initialized\n");
-        
+
+        // Step the bus up from 100 kHz as far as the part answers Info
+        // cleanly; the probe's Info commands share one wake
+        uint32_t baud = 0;
+        atcab_session_begin();
+        if (atcab_i2c_speed_probe(&baud) == ATCA_SUCCESS) {
+            printf("ATECC608B I2C at %lu kHz\n", (unsigned long)(baud / 1000));
+        }
+        atcab_session_end();
+
         if (!init_atecc_pk_context()){
             printf("ATECC PK context initialization failed\n");
         }
@@ -376,6 +957,30 @@ int main(void)
 
     hid_manager_build_sequence();
 
+#ifdef UPLOAD_TRANSPORT_MQTT
+    mqtt_config_t mqtt_cfg = {
+        .hostname = MQTT_BROKER_HOSTNAME,
+        .port = MQTT_BROKER_PORT,
+        .client_id = MQTT_CLIENT_ID,
+        .topic = MQTT_TOPIC,
+        .keep_alive_s = 60,
+        .qos = MQTT_QOS,
+        
+        .ca_cert = (const uint8_t*)CA_CERT,
+        .ca_cert_len = sizeof(CA_CERT),
+        
+        .enable_mtls = true,
+        .client_cert = (const uint8_t*)CLIENT_CERT,
+        .client_cert_len = sizeof(CLIENT_CERT),
+        .atecc_pk_context = g_atecc_pk_initialized ? &g_atecc_pk_ctx : NULL,
+        
+        .dns_led_pin = DNS_LED_PIN,
+        .mtls_led_pin = MTLS_LED_PIN,
+        .operation_timeout_ms = DATA_TIMEOUT_MS
+    };
+    
+    mqtt_manager_init(&mqtt_cfg);
+#else
     https_config_t https_cfg = {
         .hostname = WEBHOOK_HOSTNAME,
         .webhook_token = WEBHOOK_TOKEN,
@@ -388,6 +993,9 @@ int main(void)
         .client_cert = (const uint8_t*)CLIENT_CERT,
         .client_cert_len = sizeof(CLIENT_CERT),
         .atecc_pk_context = g_atecc_pk_initialized ? &g_atecc_pk_ctx : NULL,
+        .max_fragment_len = MBEDTLS_SSL_MAX_FRAG_LEN_1024,
+        .include_latency = true,
+        .format_extra = device_telemetry_format_json,
         
         .dns_led_pin = DNS_LED_PIN,
         .mtls_led_pin = MTLS_LED_PIN,
@@ -395,12 +1003,45 @@ int main(void)
     };
     
     https_manager_init(&https_cfg);
+#endif
+
+    device_telemetry_init();
+
+#ifdef FIRMWARE_FREERTOS
+    rtos_app_config_t rtos_cfg = {
+        .device = "Pico-W",
+    #ifdef AUTO_POST_ON_SAMPLE
+        .enable_auto_post = true,
+        .min_post_interval_ms = MIN_POST_INTERVAL_MS,
+    #else
+        .enable_auto_post = false,
+        .min_post_interval_ms = 0,
+    #endif
+        .upload = rtos_upload,
+        .batch_size = upload_batch_size,
+        .on_command = handle_cdc_command
+    };
+
+    // Ingest and upload tasks on core 1, USB and HID on core 0, as in the bare-metal split
+    if (!rtos_app_init(&rtos_cfg) ||
+        !rtos_app_create_task(usb_task, "usb", RTOS_STACK_USB, NULL,
+                              RTOS_PRIO_USB, RTOS_CORE_TRANSPORT, NULL) ||
+        !rtos_app_create_task(hid_task, "hid", RTOS_STACK_HID, NULL,
+                              RTOS_PRIO_HID, RTOS_CORE_TRANSPORT, NULL) ||
+        !rtos_app_create_task(wifi_task, "wifi", RTOS_STACK_WIFI, NULL,
+                              RTOS_PRIO_WIFI, RTOS_CORE_NETWORK, &g_wifi_task_handle)) {
+        panic("FreeRTOS task setup failed");
+    }
+
+    vTaskStartScheduler();
+#else
+    // Channels must be ready before core 1 starts using them
+    core_byte_ring_init(&g_cdc_ring, true);
+    core_channel_init(&g_to_core0, false);
+
+    // Initialize the core 1 pipeline stages (JSON parsing, aggregation)
+    upload_pipeline_init("Pico-W");
 
-    // Launch WiFi on Core 1
-    multicore_launch_core1(core1_entry);
-    sleep_ms(2000);
-    
-    // Initialize JSON Processor
     json_processor_config_t json_cfg = {
     #ifdef AUTO_POST_ON_SAMPLE
         .enable_auto_post = true,
@@ -411,26 +1052,53 @@ int main(void)
         .min_post_interval_ms = 0,
         .on_post_trigger = NULL,
     #endif
-        .on_data_received = NULL
+        .on_data_received = aggregate_sample,
+        .on_command = handle_cdc_command
     };
 
     json_processor_init(&json_cfg);
 
+    // Launch WiFi and the upload pipeline on Core 1
+    multicore_launch_core1(core1_entry);
+    sleep_ms(2000);
+
+    scheduler_init(&g_core0_sched);
+    scheduler_add_periodic(&g_core0_sched, &g_hid_task, hid_task, NULL, HID_UPDATE_INTERVAL_MS);
+
     // Core 0 main loop
     while (true)
     {
         tud_task();
-        hid_manager_task(wifi_fully_connected, msc_manager_is_mounted());
-        https_manager_task();
 
-        int c = getchar_timeout_us(0);
-        if (c != PICO_ERROR_TIMEOUT)
+        core_msg_t msg;
+        while (core_channel_pop(&g_to_core0, &msg)) {
+            handle_core0_message(&msg);
+        }
+
+        scheduler_run(&g_core0_sched);
+
+        // Raw CDC bytes only; never read more than core 1 has room for
+        uint8_t rx[64];
+        size_t rx_len = 0;
+        size_t rx_room = core_byte_ring_free(&g_cdc_ring);
+        while (rx_len < sizeof(rx) && rx_len < rx_room)
         {
-            json_processor_process_char(c);
+            int c = getchar_timeout_us(0);
+            if (c == PICO_ERROR_TIMEOUT) {
+                break;
+            }
+            rx[rx_len++] = (uint8_t)c;
+        }
+        if (rx_len > 0) {
+            core_byte_ring_write(&g_cdc_ring, rx, rx_len);
         }
 
-        tight_loop_contents();
+        // USB interrupts end the wait early, so tud_task still runs promptly
+        uint32_t idle_start = time_us_32();
+        scheduler_wait(&g_core0_sched, CORE0_MAX_IDLE_MS);
+        device_telemetry_note_idle(time_us_32() - idle_start);
     }
+#endif // FIRMWARE_FREERTOS
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "mem_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "mbedtls/platform.h"
+
+// TLS arena size classes: X(block size, block count)
+// Block sizes must be multiples of 8 and in ascending order. A full class
+// spills into the next one up. Counts are for one connection plus the
+// long-lived TLS config, with struct sizes as on the 32-bit target:
+//   32     P-256 bignum limbs (ECDH, ECDSA verify, comb tables), ASN.1
+//          name and sequence nodes of the parsed certificates
+//   64     P-256 products, P-384 limbs from an ECDSA P-384 chain
+//   128..1024  hash, cipher and x509 objects, RSA-2048/4096 bignums
+//   2048   certificate DER copies (CA, client, peer chain), handshake params,
+//          and the IN/OUT record buffers once max_fragment_length is agreed
+//   2560   OUT record buffer during the handshake
+//   4096   one oversized certificate; nothing in the handshake needs it
+//   17408  IN record buffer during the handshake. It has to stay: a server
+//          that declines max_fragment_length sends 16 KB records.
+// Peaks and spills are printed by the "mem" command on target. Host
+// figures from https_bench -s overstate the small classes, since
+// pointers are 8 bytes there.
+#ifndef MEM_TLS_POOL_LAYOUT
+#define MEM_TLS_POOL_LAYOUT(X) \
+    X(32,    160) \
+    X(64,    64)  \
+    X(128,   48)  \
+    X(256,   32)  \
+    X(512,   16)  \
+    X(1024,  12)  \
+    X(2048,  6)   \
+    X(2560,  2)   \
+    X(4096,  1)   \
+    X(17408, 1)
+#endif
+
+#define MEM_POOL_BYTES(size, count)  + ((size) * (count))
+#define MEM_POOL_ENTRY(size, count)  { (size), (count) },
+#define MEM_POOL_ONE(size, count)    + 1
+
+#define MEM_TLS_ARENA_SIZE  (0 MEM_TLS_POOL_LAYOUT(MEM_POOL_BYTES))
+#define MEM_TLS_POOL_COUNT  (0 MEM_TLS_POOL_LAYOUT(MEM_POOL_ONE))
+
+typedef struct mem_block {
+    struct mem_block* next;
+} mem_block_t;
+
+typedef struct {
+    uint16_t block_size;
+    uint16_t block_count;
+} mem_pool_layout_t;
+
+typedef struct {
+    uint8_t* start;
+    uint8_t* end;
+    mem_block_t* free_list;
+    uint16_t used;
+    uint16_t peak;
+    uint32_t spills;
+} mem_pool_t;
+
+// Internal state structure
+typedef struct {
+    bool initialized;
+    critical_section_t lock;
+    mem_pool_t pools[MEM_TLS_POOL_COUNT];
+    size_t bytes_used;
+    size_t bytes_peak;
+    uint32_t alloc_count;
+    uint32_t alloc_failures;
+} mem_manager_state_t;
+
+static const mem_pool_layout_t g_pool_layout[MEM_TLS_POOL_COUNT] = {
+    MEM_TLS_POOL_LAYOUT(MEM_POOL_ENTRY)
+};
+
+static uint8_t g_tls_arena[MEM_TLS_ARENA_SIZE] __attribute__((aligned(8)));
+
+// Global state
+static mem_manager_state_t g_mem_state = {
+    .initialized = false,
+    .bytes_used = 0,
+    .bytes_peak = 0,
+    .alloc_count = 0,
+    .alloc_failures = 0
+};
+
+bool mem_manager_init(void)
+{
+    if (g_mem_state.initialized) {
+        return true;
+    }
+
+    critical_section_init(&g_mem_state.lock);
+
+    // Carve the arena into per-class free lists
+    uint8_t* cursor = g_tls_arena;
+    for (int i = 0; i < MEM_TLS_POOL_COUNT; i++) {
+        mem_pool_t* pool = &g_mem_state.pools[i];
+        const mem_pool_layout_t* layout = &g_pool_layout[i];
+
+        pool->start = cursor;
+        pool->end = cursor + (size_t)layout->block_size * layout->block_count;
+        pool->free_list = NULL;
+        pool->used = 0;
+        pool->peak = 0;
+        pool->spills = 0;
+
+        // Push in reverse so the lowest addresses are handed out first
+        for (int b = layout->block_count - 1; b >= 0; b--) {
+            mem_block_t* block = (mem_block_t*)(cursor + (size_t)b * layout->block_size);
+            block->next = pool->free_list;
+            pool->free_list = block;
+        }
+
+        cursor = pool->end;
+    }
+
+    int ret = mbedtls_platform_set_calloc_free(mem_manager_tls_calloc, mem_manager_tls_free);
+    if (ret != 0) {
+        printf("Memory Manager: Failed to install mbedTLS allocator: %d\n", ret);
+        return false;
+    }
+
+    g_mem_state.initialized = true;
+
+    printf("Memory Manager: TLS arena %u bytes in %d size classes\n",
+           (unsigned)MEM_TLS_ARENA_SIZE, MEM_TLS_POOL_COUNT);
+
+    return true;
+}
+
+void* mem_manager_tls_calloc(size_t count, size_t size)
+{
+    if (count == 0 || size == 0) {
+        return NULL;
+    }
+    if (count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    size_t total = count * size;
+    void* ptr = NULL;
+
+    critical_section_enter_blocking(&g_mem_state.lock);
+
+    // Smallest class that fits, spilling upwards if it is exhausted
+    bool spilled = false;
+    for (int i = 0; i < MEM_TLS_POOL_COUNT; i++) {
+        mem_pool_t* pool = &g_mem_state.pools[i];
+        if (g_pool_layout[i].block_size < total) {
+            continue;
+        }
+        if (pool->free_list == NULL) {
+            if (!spilled) {
+                pool->spills++;
+                spilled = true;
+            }
+            continue;
+        }
+
+        mem_block_t* block = pool->free_list;
+        pool->free_list = block->next;
+        pool->used++;
+        if (pool->used > pool->peak) {
+            pool->peak = pool->used;
+        }
+
+        g_mem_state.bytes_used += g_pool_layout[i].block_size;
+        if (g_mem_state.bytes_used > g_mem_state.bytes_peak) {
+            g_mem_state.bytes_peak = g_mem_state.bytes_used;
+        }
+        g_mem_state.alloc_count++;
+
+        ptr = block;
+        break;
+    }
+
+    if (ptr == NULL) {
+        g_mem_state.alloc_failures++;
+    }
+
+    critical_section_exit(&g_mem_state.lock);
+
+    if (ptr == NULL) {
+        printf("Memory Manager: TLS allocation of %u bytes failed\n", (unsigned)total);
+        return NULL;
+    }
+
+    memset(ptr, 0, total);
+    return ptr;
+}
+
+void mem_manager_tls_free(void* ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    uint8_t* p = (uint8_t*)ptr;
+
+    // Anything outside the arena was allocated by libc before init
+    if (p < g_tls_arena || p >= g_tls_arena + MEM_TLS_ARENA_SIZE) {
+        free(ptr);
+        return;
+    }
+
+    critical_section_enter_blocking(&g_mem_state.lock);
+
+    for (int i = 0; i < MEM_TLS_POOL_COUNT; i++) {
+        mem_pool_t* pool = &g_mem_state.pools[i];
+        if (p < pool->start || p >= pool->end) {
+            continue;
+        }
+
+        mem_block_t* block = (mem_block_t*)ptr;
+        block->next = pool->free_list;
+        pool->free_list = block;
+        pool->used--;
+        g_mem_state.bytes_used -= g_pool_layout[i].block_size;
+        break;
+    }
+
+    critical_section_exit(&g_mem_state.lock);
+}
+
+void mem_manager_get_stats(mem_stats_t* stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(mem_stats_t));
+
+    critical_section_enter_blocking(&g_mem_state.lock);
+    stats->tls_bytes_used = g_mem_state.bytes_used;
+    stats->tls_bytes_peak = g_mem_state.bytes_peak;
+    stats->tls_alloc_count = g_mem_state.alloc_count;
+    stats->tls_alloc_failures = g_mem_state.alloc_failures;
+    critical_section_exit(&g_mem_state.lock);
+
+    stats->tls_arena_size = MEM_TLS_ARENA_SIZE;
+
+#if MEM_STATS
+    stats->lwip_heap_used = lwip_stats.mem.used;
+    stats->lwip_heap_peak = lwip_stats.mem.max;
+    stats->lwip_heap_errors = lwip_stats.mem.err;
+#endif
+#if MEMP_STATS
+    for (int i = 0; i < MEMP_MAX; i++) {
+        if (lwip_stats.memp[i] != NULL) {
+            stats->lwip_memp_errors += lwip_stats.memp[i]->err;
+        }
+    }
+#endif
+}
+
+int mem_manager_get_pool_count(void)
+{
+    return MEM_TLS_POOL_COUNT;
+}
+
+bool mem_manager_get_pool_stats(int index, mem_pool_stats_t* stats)
+{
+    if (!stats || index < 0 || index >= MEM_TLS_POOL_COUNT) {
+        return false;
+    }
+
+    critical_section_enter_blocking(&g_mem_state.lock);
+    stats->block_size = g_pool_layout[index].block_size;
+    stats->block_count = g_pool_layout[index].block_count;
+    stats->used = g_mem_state.pools[index].used;
+    stats->peak = g_mem_state.pools[index].peak;
+    stats->spills = g_mem_state.pools[index].spills;
+    critical_section_exit(&g_mem_state.lock);
+
+    return true;
+}
+
+void mem_manager_print_stats(void)
+{
+    mem_stats_t stats;
+    mem_manager_get_stats(&stats);
+
+    printf("Memory Manager: TLS %u/%u bytes (peak %u), %lu allocs, %lu failed\n",
+           (unsigned)stats.tls_bytes_used,
+           (unsigned)stats.tls_arena_size,
+           (unsigned)stats.tls_bytes_peak,
+           stats.tls_alloc_count,
+           stats.tls_alloc_failures);
+
+    for (int i = 0; i < MEM_TLS_POOL_COUNT; i++) {
+        mem_pool_stats_t pool;
+        mem_manager_get_pool_stats(i, &pool);
+        printf("  [%5u] %3u/%3u used, peak %3u, spills %lu\n",
+               pool.block_size, pool.used, pool.block_count, pool.peak, pool.spills);
+    }
+
+    printf("Memory Manager: lwIP heap %lu (peak %lu), heap errors %lu, pool errors %lu\n",
+           stats.lwip_heap_used,
+           stats.lwip_heap_peak,
+           stats.lwip_heap_errors,
+           stats.lwip_memp_errors);
+}
@@ -0,0 +1,540 @@
+#include "mqtt_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "pico/async_context.h"
+#include "hardware/gpio.h"
+
+#include "lwip/altcp_tls.h"
+#include "lwip/dns.h"
+#include "lwip/apps/mqtt.h"
+#include "lwip/apps/mqtt_priv.h"  // client->conn for SNI
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+
+#define MQTT_PAYLOAD_MAX 256
+
+// Internal state structure
+typedef struct {
+    mqtt_config_t config;
+    mqtt_state_t state;
+    bool initialized;
+
+    struct altcp_tls_config* tls_config;
+    mqtt_client_t* client;
+
+    // Publish in progress, sent once the session is up
+    char payload[MQTT_PAYLOAD_MAX];
+    u16_t payload_len;
+    bool publish_ok;
+
+    uint32_t publish_count;
+    async_at_time_worker_t timeout_worker;
+
+    ip_addr_t resolved_ip;
+} mqtt_manager_state_t;
+
+// For mTLS with ATECC integration
+typedef struct {
+    mbedtls_ssl_config conf;
+    mbedtls_x509_crt *cert;
+    mbedtls_x509_crt *cert_chain;
+    mbedtls_pk_context *pkey;
+} altcp_tls_config_internal_t;
+
+// Global state
+static mqtt_manager_state_t g_mqtt_state = {
+    .state = MQTT_STATE_IDLE,
+    .initialized = false,
+    .tls_config = NULL,
+    .client = NULL,
+    .publish_ok = false,
+    .publish_count = 0
+};
+
+// Forward declarations
+static bool create_tls_config(void);
+static void start_resolve(void);
+static void start_connect(void);
+static void start_publish(void);
+static void finish_publish(bool ok);
+static void dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg);
+static void mqtt_connection_callback(mqtt_client_t* client, void* arg, mqtt_connection_status_t status);
+static void mqtt_publish_callback(void* arg, err_t err);
+static void timeout_worker_fn(async_context_t* context, async_at_time_worker_t* worker);
+
+bool mqtt_manager_init(const mqtt_config_t* config)
+{
+    if (!config || !config->hostname || !config->topic || !config->ca_cert) {
+        printf("MQTT Manager: Invalid configuration\n");
+        return false;
+    }
+
+    printf("MQTT Manager: Initializing...\n");
+
+    // Copy configuration
+    g_mqtt_state.config = *config;
+
+    // Set default values
+    if (g_mqtt_state.config.port == 0) {
+        g_mqtt_state.config.port = 8883;
+    }
+    if (g_mqtt_state.config.client_id == NULL) {
+        g_mqtt_state.config.client_id = "pico-w";
+    }
+    if (g_mqtt_state.config.keep_alive_s == 0) {
+        g_mqtt_state.config.keep_alive_s = 60;
+    }
+    if (g_mqtt_state.config.qos > 1) {
+        g_mqtt_state.config.qos = 1;
+    }
+    if (g_mqtt_state.config.operation_timeout_ms == 0) {
+        g_mqtt_state.config.operation_timeout_ms = 20000;
+    }
+
+    // Initialize LED pins if specified
+    if (g_mqtt_state.config.dns_led_pin > 0) {
+        gpio_init(g_mqtt_state.config.dns_led_pin);
+        gpio_set_dir(g_mqtt_state.config.dns_led_pin, GPIO_OUT);
+        gpio_put(g_mqtt_state.config.dns_led_pin, 0);
+    }
+    if (g_mqtt_state.config.mtls_led_pin > 0) {
+        gpio_init(g_mqtt_state.config.mtls_led_pin);
+        gpio_set_dir(g_mqtt_state.config.mtls_led_pin, GPIO_OUT);
+        gpio_put(g_mqtt_state.config.mtls_led_pin, 0);
+    }
+
+    g_mqtt_state.timeout_worker.do_work = timeout_worker_fn;
+    g_mqtt_state.timeout_worker.user_data = &g_mqtt_state;
+
+    g_mqtt_state.initialized = true;
+    g_mqtt_state.state = MQTT_STATE_IDLE;
+
+    printf("MQTT Manager: Initialized for %s:%d topic '%s' (QoS %d)\n",
+           g_mqtt_state.config.hostname,
+           g_mqtt_state.config.port,
+           g_mqtt_state.config.topic,
+           g_mqtt_state.config.qos);
+
+    return true;
+}
+
+void mqtt_manager_deinit(void)
+{
+    cyw43_arch_lwip_begin();
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &g_mqtt_state.timeout_worker);
+    if (g_mqtt_state.client != NULL) {
+        mqtt_disconnect(g_mqtt_state.client);
+        mqtt_client_free(g_mqtt_state.client);
+        g_mqtt_state.client = NULL;
+    }
+
+    if (g_mqtt_state.tls_config != NULL) {
+        altcp_tls_free_config(g_mqtt_state.tls_config);
+        g_mqtt_state.tls_config = NULL;
+    }
+    cyw43_arch_lwip_end();
+
+    if (g_mqtt_state.config.dns_led_pin > 0) {
+        gpio_put(g_mqtt_state.config.dns_led_pin, 0);
+    }
+    if (g_mqtt_state.config.mtls_led_pin > 0) {
+        gpio_put(g_mqtt_state.config.mtls_led_pin, 0);
+    }
+
+    g_mqtt_state.initialized = false;
+    g_mqtt_state.state = MQTT_STATE_IDLE;
+
+    printf("MQTT Manager: Deinitialized\n");
+}
+
+bool mqtt_manager_publish_json(const https_post_data_t* data)
+{
+    if (!g_mqtt_state.initialized || !data) {
+        printf("MQTT Manager: Not initialized\n");
+        return false;
+    }
+
+    if (mqtt_manager_is_busy()) {
+        printf("MQTT Manager: Busy (state: %d)\n", g_mqtt_state.state);
+        return false;
+    }
+
+    int payload_len = https_manager_format_json(data, NULL, g_mqtt_state.payload, sizeof(g_mqtt_state.payload));
+    if (payload_len <= 0 || payload_len >= (int)sizeof(g_mqtt_state.payload)) {
+        printf("MQTT Manager: Payload too large\n");
+        return false;
+    }
+    g_mqtt_state.payload_len = (u16_t)payload_len;
+    g_mqtt_state.publish_ok = false;
+
+    printf("MQTT Manager: PUBLISH[%lu] %s...\n", data->sample, g_mqtt_state.config.topic);
+
+    // Everything from here on is driven by lwIP callbacks on the async_context
+    cyw43_arch_lwip_begin();
+
+    async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(),
+                                           &g_mqtt_state.timeout_worker,
+                                           g_mqtt_state.config.operation_timeout_ms);
+
+    // Session persists between samples; only reconnect when it dropped
+    if (g_mqtt_state.client != NULL && mqtt_client_is_connected(g_mqtt_state.client)) {
+        start_publish();
+    } else {
+        start_resolve();
+    }
+
+    bool started = (g_mqtt_state.state != MQTT_STATE_ERROR);
+    cyw43_arch_lwip_end();
+
+    return started;
+}
+
+bool mqtt_manager_publish_succeeded(void)
+{
+    return g_mqtt_state.publish_ok;
+}
+
+bool mqtt_manager_is_connected(void)
+{
+    if (g_mqtt_state.client == NULL) {
+        return false;
+    }
+
+    cyw43_arch_lwip_begin();
+    bool connected = mqtt_client_is_connected(g_mqtt_state.client) != 0;
+    cyw43_arch_lwip_end();
+
+    return connected;
+}
+
+bool mqtt_manager_is_busy(void)
+{
+    return g_mqtt_state.state == MQTT_STATE_DNS_RESOLVING ||
+           g_mqtt_state.state == MQTT_STATE_CONNECTING ||
+           g_mqtt_state.state == MQTT_STATE_PUBLISHING;
+}
+
+mqtt_state_t mqtt_manager_get_state(void)
+{
+    return g_mqtt_state.state;
+}
+
+void mqtt_manager_task(void)
+{
+    if (!g_mqtt_state.initialized) {
+        return;
+    }
+
+    // Timeouts are handled by timeout_worker_fn on the async_context
+
+    // Broker dropped the session; the next publish reconnects
+    if (g_mqtt_state.state == MQTT_STATE_CONNECTED && !mqtt_manager_is_connected()) {
+        printf("MQTT Manager: Connection lost\n");
+        g_mqtt_state.state = MQTT_STATE_IDLE;
+
+        if (g_mqtt_state.config.mtls_led_pin > 0) {
+            gpio_put(g_mqtt_state.config.mtls_led_pin, 0);
+        }
+    }
+
+    if (g_mqtt_state.state == MQTT_STATE_ERROR && !mqtt_manager_is_busy()) {
+        g_mqtt_state.state = mqtt_manager_is_connected() ? MQTT_STATE_CONNECTED : MQTT_STATE_IDLE;
+    }
+}
+
+// Internal helper functions
+
+// Step 1, called with the lwIP lock held when the session is down
+static void start_resolve(void)
+{
+    g_mqtt_state.state = MQTT_STATE_DNS_RESOLVING;
+    g_mqtt_state.resolved_ip.addr = 0;
+
+    err_t dns_err = dns_gethostbyname(
+        g_mqtt_state.config.hostname,
+        &g_mqtt_state.resolved_ip,
+        dns_callback,
+        &g_mqtt_state.resolved_ip
+    );
+
+    if (dns_err == ERR_OK) {
+        // Already cached
+        start_connect();
+    } else if (dns_err != ERR_INPROGRESS) {
+        printf("MQTT Manager: DNS request failed: %d\n", dns_err);
+        finish_publish(false);
+    }
+}
+
+// Steps 2-4, called with the lwIP lock held once the address is known;
+// the publish follows from mqtt_connection_callback
+static void start_connect(void)
+{
+    if (g_mqtt_state.config.dns_led_pin > 0) {
+        gpio_put(g_mqtt_state.config.dns_led_pin, 1);
+    }
+
+    // Step 2: TLS config is created once and kept across reconnects
+    g_mqtt_state.state = MQTT_STATE_CONNECTING;
+
+    if (g_mqtt_state.tls_config == NULL && !create_tls_config()) {
+        finish_publish(false);
+        return;
+    }
+
+    // Step 3: MQTT client
+    if (g_mqtt_state.client == NULL) {
+        g_mqtt_state.client = mqtt_client_new();
+        if (g_mqtt_state.client == NULL) {
+            printf("MQTT Manager: Client allocation failed\n");
+            finish_publish(false);
+            return;
+        }
+    }
+
+    struct mqtt_connect_client_info_t client_info = {
+        .client_id = g_mqtt_state.config.client_id,
+        .client_user = NULL,
+        .client_pass = NULL,
+        .keep_alive = g_mqtt_state.config.keep_alive_s,
+        .will_topic = NULL,
+        .will_msg = NULL,
+        .will_qos = 0,
+        .will_retain = 0,
+        .tls_config = g_mqtt_state.tls_config
+    };
+
+    printf("MQTT Manager: Connecting to %s:%d...\n",
+           g_mqtt_state.config.hostname,
+           g_mqtt_state.config.port);
+
+    // Step 4: Connect (TCP + TLS + CONNECT/CONNACK)
+    err_t connect_err = mqtt_client_connect(
+        g_mqtt_state.client,
+        &g_mqtt_state.resolved_ip,
+        g_mqtt_state.config.port,
+        mqtt_connection_callback,
+        &g_mqtt_state,
+        &client_info
+    );
+
+    if (connect_err != ERR_OK) {
+        printf("MQTT Manager: Connection failed: %d\n", connect_err);
+        finish_publish(false);
+        return;
+    }
+
+    // The lock is still held, so SNI is set before the ClientHello can leave
+    mbedtls_ssl_set_hostname(altcp_tls_context(g_mqtt_state.client->conn),
+                             g_mqtt_state.config.hostname);
+}
+
+// Step 5, called with the lwIP lock held on an open session
+static void start_publish(void)
+{
+    g_mqtt_state.state = MQTT_STATE_PUBLISHING;
+
+    err_t pub_err = mqtt_publish(
+        g_mqtt_state.client,
+        g_mqtt_state.config.topic,
+        g_mqtt_state.payload,
+        g_mqtt_state.payload_len,
+        g_mqtt_state.config.qos,
+        0,
+        mqtt_publish_callback,
+        &g_mqtt_state
+    );
+
+    if (pub_err != ERR_OK) {
+        printf("MQTT Manager: Publish failed: %d\n", pub_err);
+        finish_publish(false);
+    }
+}
+
+// Single exit point for every publish, called with the lwIP lock held
+static void finish_publish(bool ok)
+{
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &g_mqtt_state.timeout_worker);
+
+    g_mqtt_state.publish_ok = ok;
+    if (ok) {
+        g_mqtt_state.publish_count++;
+        g_mqtt_state.state = MQTT_STATE_CONNECTED;
+        printf("MQTT Manager: OK (%lu published)\n", g_mqtt_state.publish_count);
+    } else {
+        g_mqtt_state.state = MQTT_STATE_ERROR;
+    }
+}
+
+static bool create_tls_config(void)
+{
+    if (g_mqtt_state.config.enable_mtls && g_mqtt_state.config.client_cert) {
+        g_mqtt_state.tls_config = altcp_tls_create_config_client_2wayauth(
+            g_mqtt_state.config.ca_cert,
+            g_mqtt_state.config.ca_cert_len,
+            NULL, 0,  // Private key handled separately
+            NULL, 0,
+            g_mqtt_state.config.client_cert,
+            g_mqtt_state.config.client_cert_len
+        );
+    } else {
+        g_mqtt_state.tls_config = altcp_tls_create_config_client(
+            g_mqtt_state.config.ca_cert,
+            g_mqtt_state.config.ca_cert_len
+        );
+    }
+
+    if (!g_mqtt_state.tls_config) {
+        printf("MQTT Manager: TLS config creation failed\n");
+        return false;
+    }
+
+    altcp_tls_config_internal_t* cfg_internal =
+        (altcp_tls_config_internal_t*)g_mqtt_state.tls_config;
+
+    // No max_fragment_length here: lwIP's MQTT client owns the connection, so
+    // a declined offer could not be detected and the IN buffer regrown the
+    // way https_manager does it. Records stay at the full size.
+
+    // Inject ATECC PK context if mTLS is enabled
+    if (g_mqtt_state.config.enable_mtls && g_mqtt_state.config.atecc_pk_context) {
+        mbedtls_ssl_conf_authmode(&cfg_internal->conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+
+        if (cfg_internal->cert_chain == NULL) {
+            cfg_internal->cert_chain = (mbedtls_x509_crt*)malloc(sizeof(mbedtls_x509_crt));
+            if (cfg_internal->cert_chain == NULL) {
+                printf("MQTT Manager: Failed to allocate cert chain\n");
+                return false;
+            }
+        }
+
+        mbedtls_x509_crt_init(cfg_internal->cert_chain);
+
+        int ret = mbedtls_x509_crt_parse(
+            cfg_internal->cert_chain,
+            g_mqtt_state.config.client_cert,
+            g_mqtt_state.config.client_cert_len
+        );
+
+        if (ret != 0) {
+            printf("MQTT Manager: Failed to parse client cert: %d\n", ret);
+            free(cfg_internal->cert_chain);
+            cfg_internal->cert_chain = NULL;
+            return false;
+        }
+
+        cfg_internal->pkey = (mbedtls_pk_context*)g_mqtt_state.config.atecc_pk_context;
+
+        ret = mbedtls_ssl_conf_own_cert(
+            &cfg_internal->conf,
+            cfg_internal->cert_chain,
+            cfg_internal->pkey
+        );
+
+        if (ret != 0) {
+            printf("MQTT Manager: ATECC injection failed: -0x%04x\n", -ret);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Callback functions
+
+static void dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg)
+{
+    (void)name;
+
+    // A late answer after a timeout is ignored
+    if (g_mqtt_state.state != MQTT_STATE_DNS_RESOLVING) {
+        return;
+    }
+
+    if (ipaddr) {
+        ip_addr_t* result = (ip_addr_t*)arg;
+        *result = *ipaddr;
+        printf("MQTT Manager: DNS resolved: %s\n", ip4addr_ntoa(ipaddr));
+        start_connect();
+    } else {
+        printf("MQTT Manager: DNS resolution failed\n");
+        finish_publish(false);
+    }
+}
+
+static void mqtt_connection_callback(mqtt_client_t* client, void* arg, mqtt_connection_status_t status)
+{
+    (void)client;
+    mqtt_manager_state_t* state = (mqtt_manager_state_t*)arg;
+
+    if (status == MQTT_CONNECT_ACCEPTED) {
+        printf("MQTT Manager: Connected, session established\n");
+
+        if (state->config.mtls_led_pin > 0) {
+            gpio_put(state->config.mtls_led_pin, 1);
+        }
+
+        // Step 5: the publish that opened the session
+        if (state->state == MQTT_STATE_CONNECTING) {
+            start_publish();
+        } else {
+            state->state = MQTT_STATE_CONNECTED;
+        }
+    } else {
+        printf("MQTT Manager: Connection closed (status %d)\n", status);
+
+        if (state->config.mtls_led_pin > 0) {
+            gpio_put(state->config.mtls_led_pin, 0);
+        }
+
+        // lwIP drops queued requests without calling them back, so a
+        // connect or publish in progress has failed
+        if (mqtt_manager_is_busy()) {
+            finish_publish(false);
+        } else {
+            state->state = MQTT_STATE_IDLE;
+        }
+    }
+}
+
+static void mqtt_publish_callback(void* arg, err_t err)
+{
+    mqtt_manager_state_t* state = (mqtt_manager_state_t*)arg;
+
+    if (state->state != MQTT_STATE_PUBLISHING) {
+        return;
+    }
+
+    // QoS 0 completes once sent, QoS 1 on PUBACK
+    if (err != ERR_OK) {
+        printf("MQTT Manager: Publish not acknowledged (%d)\n", err);
+    }
+    finish_publish(err == ERR_OK);
+}
+
+static void timeout_worker_fn(async_context_t* context, async_at_time_worker_t* worker)
+{
+    (void)context;
+    mqtt_manager_state_t* state = (mqtt_manager_state_t*)worker->user_data;
+
+    if (!mqtt_manager_is_busy()) {
+        return;
+    }
+
+    printf("MQTT Manager: Operation timeout (%lu ms, state %d)\n",
+           state->config.operation_timeout_ms, state->state);
+
+    // Dropping the session discards lwIP's queued requests without a
+    // callback, so a late PUBACK cannot complete the next publish
+    if (state->client != NULL) {
+        mqtt_disconnect(state->client);
+    }
+    if (state->config.mtls_led_pin > 0) {
+        gpio_put(state->config.mtls_led_pin, 0);
+    }
+
+    finish_publish(false);
+}
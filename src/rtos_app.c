@@ -0,0 +1,299 @@
+#include "rtos_app.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "queue.h"
+#include "stream_buffer.h"
+#include "event_groups.h"
+
+#include "json_processor.h"
+#include "upload_pipeline.h"
+
+// USB task -> stream buffer -> ingest task (JSON parser + aggregation)
+// -> upload queue -> upload task -> result queue -> ingest task. One upload
+// is in flight at a time, sized by config.batch_size as on bare metal. Its
+// records stay in upload_pipeline until the upload task reports them
+// delivered, and new samples queue or coalesce behind them. Only the
+// ingest task touches upload_pipeline.
+
+#define RTOS_LINK_UP_BIT        (1U << 0)
+#define RTOS_UPLOAD_QUEUE_LEN   1U
+#define RTOS_RESULT_QUEUE_LEN   1U
+
+typedef struct {
+    https_post_data_t records[UPLOAD_PIPELINE_DEPTH];
+    uint32_t count;
+    uint32_t queued_us;
+} rtos_upload_msg_t;
+
+// Internal state structure
+typedef struct {
+    bool initialized;
+    rtos_app_config_t config;
+    StreamBufferHandle_t ingest_buffer;
+    QueueHandle_t upload_queue;
+    QueueHandle_t result_queue;          // Upload outcomes (bool delivered)
+    EventGroupHandle_t link_events;
+    TaskHandle_t ingest_task;
+    TaskHandle_t upload_task;
+    bool upload_in_flight;               // Ingest task only
+    uint32_t retry_at_ms;                // Ingest task only; 0 = no failed upload waiting
+    rtos_app_stats_t stats;
+} rtos_app_state_t;
+
+static rtos_app_state_t g_rtos_state = {
+    .initialized = false,
+    .ingest_buffer = NULL,
+    .upload_queue = NULL,
+    .result_queue = NULL,
+    .link_events = NULL
+};
+
+// JSON processor callbacks, both run in the ingest task
+
+static void ingest_sample(health_data_t* data)
+{
+    upload_pipeline_add_sample(data);
+}
+
+static void ingest_commit(health_data_t* data)
+{
+    (void)data;
+    upload_pipeline_commit(json_processor_get_sample_count(),
+                           to_ms_since_boot(get_absolute_time()));
+}
+
+// Collects the outcome of the upload in flight, then hands the oldest
+// records to the upload task. Runs at least every RTOS_INGEST_IDLE_MS, which
+// bounds both the outcome pickup and how late a held batch is released.
+static void hand_off_records(void)
+{
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+
+    if (g_rtos_state.upload_in_flight) {
+        bool delivered;
+        if (xQueueReceive(g_rtos_state.result_queue, &delivered, 0) != pdPASS) {
+            return;
+        }
+
+        // Records leave the pipeline only once delivered
+        upload_pipeline_end_send(delivered);
+        g_rtos_state.upload_in_flight = false;
+        if (!delivered) {
+            g_rtos_state.retry_at_ms = now_ms + RTOS_UPLOAD_RETRY_MS;
+        }
+    }
+
+    if (g_rtos_state.retry_at_ms != 0 && (int32_t)(now_ms - g_rtos_state.retry_at_ms) < 0) {
+        return;
+    }
+    g_rtos_state.retry_at_ms = 0;
+
+    rtos_upload_msg_t msg;
+    uint32_t pending = upload_pipeline_peek_batch(msg.records, UPLOAD_PIPELINE_DEPTH);
+    if (pending == 0) {
+        return;
+    }
+
+    // Link quality decides between draining, batching and holding
+    msg.count = g_rtos_state.config.batch_size ? g_rtos_state.config.batch_size(msg.records, pending) : 1;
+    if (msg.count == 0) {
+        return;
+    }
+    if (msg.count > pending) {
+        msg.count = pending;
+    }
+
+    // Nothing else is in flight, so the queue has room
+    msg.queued_us = time_us_32();
+    upload_pipeline_begin_send(msg.count);
+    xQueueSend(g_rtos_state.upload_queue, &msg, 0);
+    g_rtos_state.upload_in_flight = true;
+
+    taskENTER_CRITICAL();
+    g_rtos_state.stats.records_handed_off += msg.count;
+    taskEXIT_CRITICAL();
+}
+
+static void ingest_task(void* arg)
+{
+    (void)arg;
+    uint8_t rx[64];
+
+    while (true) {
+        size_t rx_len = xStreamBufferReceive(g_rtos_state.ingest_buffer, rx, sizeof(rx),
+                                             pdMS_TO_TICKS(RTOS_INGEST_IDLE_MS));
+        for (size_t i = 0; i < rx_len; i++) {
+            json_processor_process_char(rx[i]);
+        }
+
+        hand_off_records();
+    }
+}
+
+static void upload_task(void* arg)
+{
+    (void)arg;
+    rtos_upload_msg_t msg;
+
+    while (true) {
+        xQueueReceive(g_rtos_state.upload_queue, &msg, portMAX_DELAY);
+        uint32_t handoff_us = time_us_32() - msg.queued_us;
+
+        // Records wait here, not in the parser, while the link is down
+        xEventGroupWaitBits(g_rtos_state.link_events, RTOS_LINK_UP_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+
+        bool success = g_rtos_state.config.upload(msg.records, msg.count);
+
+        taskENTER_CRITICAL();
+        if (success) {
+            g_rtos_state.stats.uploads_ok++;
+        } else {
+            g_rtos_state.stats.uploads_failed++;
+        }
+        g_rtos_state.stats.handoff_total_us += handoff_us;
+        if (handoff_us > g_rtos_state.stats.handoff_max_us) {
+            g_rtos_state.stats.handoff_max_us = handoff_us;
+        }
+        taskEXIT_CRITICAL();
+
+        // The ingest task pops or keeps the records; the queue always has room
+        xQueueSend(g_rtos_state.result_queue, &success, portMAX_DELAY);
+    }
+}
+
+bool rtos_app_create_task(TaskFunction_t task, const char* name, configSTACK_DEPTH_TYPE stack_words,
+                          void* arg, UBaseType_t priority, UBaseType_t core_mask, TaskHandle_t* handle)
+{
+    BaseType_t created;
+
+#if (configNUMBER_OF_CORES > 1) && (configUSE_CORE_AFFINITY == 1)
+    created = xTaskCreateAffinitySet(task, name, stack_words, arg, priority, core_mask, handle);
+#else
+    (void)core_mask;
+    created = xTaskCreate(task, name, stack_words, arg, priority, handle);
+#endif
+
+    if (created != pdPASS) {
+        printf("RTOS App: Failed to create task '%s'\n", name);
+        return false;
+    }
+
+    return true;
+}
+
+bool rtos_app_init(const rtos_app_config_t* config)
+{
+    if (g_rtos_state.initialized) {
+        return true;
+    }
+
+    if (!config || !config->upload) {
+        printf("RTOS App: Invalid configuration\n");
+        return false;
+    }
+
+    g_rtos_state.config = *config;
+    memset(&g_rtos_state.stats, 0, sizeof(g_rtos_state.stats));
+
+    g_rtos_state.ingest_buffer = xStreamBufferCreate(RTOS_INGEST_BUFFER_LEN, 1);
+    g_rtos_state.upload_queue = xQueueCreate(RTOS_UPLOAD_QUEUE_LEN, sizeof(rtos_upload_msg_t));
+    g_rtos_state.result_queue = xQueueCreate(RTOS_RESULT_QUEUE_LEN, sizeof(bool));
+    g_rtos_state.link_events = xEventGroupCreate();
+    g_rtos_state.upload_in_flight = false;
+    g_rtos_state.retry_at_ms = 0;
+
+    if (!g_rtos_state.ingest_buffer || !g_rtos_state.upload_queue || !g_rtos_state.result_queue ||
+        !g_rtos_state.link_events) {
+        printf("RTOS App: Queue allocation failed\n");
+        return false;
+    }
+
+    upload_pipeline_init(config->device);
+
+    json_processor_config_t json_cfg = {
+        .enable_auto_post = config->enable_auto_post,
+        .min_post_interval_ms = config->min_post_interval_ms,
+        .on_post_trigger = config->enable_auto_post ? ingest_commit : NULL,
+        .on_data_received = ingest_sample,
+        .on_command = config->on_command
+    };
+    json_processor_init(&json_cfg);
+
+    if (!rtos_app_create_task(ingest_task, "ingest", RTOS_STACK_INGEST, NULL,
+                              RTOS_PRIO_INGEST, RTOS_CORE_NETWORK, &g_rtos_state.ingest_task) ||
+        !rtos_app_create_task(upload_task, "upload", RTOS_STACK_UPLOAD, NULL,
+                              RTOS_PRIO_UPLOAD, RTOS_CORE_NETWORK, &g_rtos_state.upload_task)) {
+        return false;
+    }
+
+    g_rtos_state.initialized = true;
+    printf("RTOS App: Ingest and upload tasks created\n");
+
+    return true;
+}
+
+size_t rtos_app_ingest(const uint8_t* data, size_t len, TickType_t wait)
+{
+    if (!g_rtos_state.initialized || len == 0) {
+        return 0;
+    }
+
+    // Single writer (the USB task), single reader (the ingest task)
+    size_t sent = xStreamBufferSend(g_rtos_state.ingest_buffer, data, len, wait);
+
+    taskENTER_CRITICAL();
+    g_rtos_state.stats.bytes_ingested += sent;
+    g_rtos_state.stats.bytes_dropped += len - sent;
+    taskEXIT_CRITICAL();
+
+    return sent;
+}
+
+void rtos_app_set_link_up(bool up)
+{
+    if (!g_rtos_state.initialized) {
+        return;
+    }
+
+    if (up) {
+        xEventGroupSetBits(g_rtos_state.link_events, RTOS_LINK_UP_BIT);
+    } else {
+        xEventGroupClearBits(g_rtos_state.link_events, RTOS_LINK_UP_BIT);
+    }
+}
+
+bool rtos_app_is_link_up(void)
+{
+    if (!g_rtos_state.initialized) {
+        return false;
+    }
+
+    return (xEventGroupGetBits(g_rtos_state.link_events) & RTOS_LINK_UP_BIT) != 0;
+}
+
+void rtos_app_get_stats(rtos_app_stats_t* stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *stats = g_rtos_state.stats;
+    taskEXIT_CRITICAL();
+}
+
+void rtos_app_print_stats(void)
+{
+    rtos_app_stats_t stats;
+    rtos_app_get_stats(&stats);
+
+    uint32_t uploads = stats.uploads_ok + stats.uploads_failed;
+    uint32_t handoff_avg_us = uploads ? (uint32_t)(stats.handoff_total_us / uploads) : 0;
+
+    printf("RTOS App: %lu bytes ingested (%lu dropped), %lu records handed off\n",
+           stats.bytes_ingested, stats.bytes_dropped, stats.records_handed_off);
+    printf("RTOS App: %lu uploads ok, %lu failed, hand-off avg %lu us, max %lu us\n",
+           stats.uploads_ok, stats.uploads_failed, handoff_avg_us, stats.handoff_max_us);
+}
@@ -0,0 +1,230 @@
+#include "scheduler.h"
+#include <string.h>
+#include "pico/stdlib.h"
+
+#define SCHED_WHEEL_MASK    (SCHED_WHEEL_SLOTS - 1U)
+
+static inline uint32_t now_ms(void)
+{
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static inline uint32_t level_shift(uint32_t level)
+{
+    return level * SCHED_WHEEL_BITS;
+}
+
+static void link_task(scheduler_t* sched, sched_task_t* task)
+{
+    uint32_t delta = task->expires_ms - sched->current_ms;
+    uint32_t level = 0;
+
+    // Lowest level whose span still covers the delay
+    while (level < SCHED_WHEEL_LEVELS - 1 &&
+           delta >= (SCHED_WHEEL_SLOTS << level_shift(level))) {
+        level++;
+    }
+
+    uint32_t when = task->expires_ms;
+    if (level == SCHED_WHEEL_LEVELS - 1 &&
+        delta >= (SCHED_WHEEL_SLOTS << level_shift(level))) {
+        // Beyond the top level: park in its furthest slot and re-file later
+        when = sched->current_ms + ((SCHED_WHEEL_SLOTS - 1) << level_shift(level));
+    }
+
+    sched_task_t** slot = &sched->wheel[level][(when >> level_shift(level)) & SCHED_WHEEL_MASK];
+    task->next = *slot;
+    task->slot = slot;
+    *slot = task;
+}
+
+static void unlink_task(sched_task_t* task)
+{
+    if (task->slot == NULL) {
+        return;
+    }
+
+    for (sched_task_t** link = task->slot; *link != NULL; link = &(*link)->next) {
+        if (*link == task) {
+            *link = task->next;
+            break;
+        }
+    }
+
+    task->next = NULL;
+    task->slot = NULL;
+}
+
+// Re-file every task in a higher-level slot now that it is within reach
+static void cascade(scheduler_t* sched, uint32_t level)
+{
+    uint32_t index = (sched->current_ms >> level_shift(level)) & SCHED_WHEEL_MASK;
+    sched_task_t* task = sched->wheel[level][index];
+    sched->wheel[level][index] = NULL;
+
+    while (task != NULL) {
+        sched_task_t* next = task->next;
+        link_task(sched, task);
+        task = next;
+    }
+}
+
+static void run_tick(scheduler_t* sched, uint32_t now)
+{
+    for (uint32_t level = SCHED_WHEEL_LEVELS - 1; level > 0; level--) {
+        if ((sched->current_ms & ((1UL << level_shift(level)) - 1)) == 0) {
+            cascade(sched, level);
+        }
+    }
+
+    sched_task_t** slot = &sched->wheel[0][sched->current_ms & SCHED_WHEEL_MASK];
+    sched_task_t* task = *slot;
+    *slot = NULL;
+
+    while (task != NULL) {
+        sched_task_t* next = task->next;
+        task->next = NULL;
+        task->slot = NULL;
+
+        if (task->expires_ms != sched->current_ms) {
+            // Parked long delay that is not due yet
+            link_task(sched, task);
+            task = next;
+            continue;
+        }
+
+        if (task->period_ms != 0) {
+            // Skip whole periods missed while the core was busy
+            do {
+                task->expires_ms += task->period_ms;
+            } while ((int32_t)(task->expires_ms - now) <= 0);
+            link_task(sched, task);
+        }
+
+        // Called after re-arming so the callback may cancel or re-add itself
+        task->callback(task->arg);
+        task = next;
+    }
+}
+
+void scheduler_init(scheduler_t* sched)
+{
+    memset(sched, 0, sizeof(scheduler_t));
+    sched->current_ms = now_ms();
+    sched->initialized = true;
+}
+
+static void add_task(scheduler_t* sched, sched_task_t* task, sched_callback_t callback,
+                     void* arg, uint32_t delay_ms, uint32_t period_ms)
+{
+    unlink_task(task);
+
+    task->callback = callback;
+    task->arg = arg;
+    task->period_ms = period_ms;
+
+    // Never schedule into a tick that has already been processed
+    uint32_t base = now_ms();
+    if ((int32_t)(base - sched->current_ms) < 0) {
+        base = sched->current_ms;
+    }
+    task->expires_ms = base + (delay_ms == 0 ? 1 : delay_ms);
+    if ((int32_t)(task->expires_ms - sched->current_ms) < 0) {
+        task->expires_ms = sched->current_ms;
+    }
+
+    link_task(sched, task);
+}
+
+void scheduler_add_periodic(scheduler_t* sched, sched_task_t* task,
+                            sched_callback_t callback, void* arg, uint32_t period_ms)
+{
+    add_task(sched, task, callback, arg, period_ms, period_ms == 0 ? 1 : period_ms);
+}
+
+void scheduler_add_oneshot(scheduler_t* sched, sched_task_t* task,
+                           sched_callback_t callback, void* arg, uint32_t delay_ms)
+{
+    add_task(sched, task, callback, arg, delay_ms, 0);
+}
+
+void scheduler_cancel(scheduler_t* sched, sched_task_t* task)
+{
+    (void)sched;
+    unlink_task(task);
+}
+
+bool scheduler_is_pending(const sched_task_t* task)
+{
+    return task->slot != NULL;
+}
+
+void scheduler_run(scheduler_t* sched)
+{
+    uint32_t now = now_ms();
+
+    while ((int32_t)(now - sched->current_ms) >= 0) {
+        run_tick(sched, now);
+        sched->current_ms++;
+    }
+}
+
+static uint32_t wait_until(uint32_t tick, uint32_t now)
+{
+    int32_t delta = (int32_t)(tick - now);
+    return (delta > 0) ? (uint32_t)delta : 0;
+}
+
+uint32_t scheduler_next_deadline_ms(const scheduler_t* sched)
+{
+    uint32_t now = now_ms();
+
+    // Level 0 slots map one-to-one onto the next 64 ticks
+    for (uint32_t i = 0; i < SCHED_WHEEL_SLOTS; i++) {
+        if (sched->wheel[0][(sched->current_ms + i) & SCHED_WHEEL_MASK] != NULL) {
+            return wait_until(sched->current_ms + i, now);
+        }
+    }
+
+    // Higher levels: wake when the first occupied slot cascades. The slot
+    // under the cursor has already cascaded unless we sit on its boundary.
+    for (uint32_t level = 1; level < SCHED_WHEEL_LEVELS; level++) {
+        uint32_t shift = level_shift(level);
+        uint32_t base = sched->current_ms >> shift;
+        uint32_t first = ((sched->current_ms & ((1UL << shift) - 1)) == 0) ? 0 : 1;
+
+        for (uint32_t i = first; i < first + SCHED_WHEEL_SLOTS; i++) {
+            if (sched->wheel[level][(base + i) & SCHED_WHEEL_MASK] != NULL) {
+                return wait_until((base + i) << shift, now);
+            }
+        }
+    }
+
+    return SCHED_NO_DEADLINE;
+}
+
+void scheduler_wait(scheduler_t* sched, uint32_t max_wait_ms)
+{
+    uint32_t wait_ms = scheduler_next_deadline_ms(sched);
+    if (wait_ms > max_wait_ms) {
+        wait_ms = max_wait_ms;
+    }
+    if (wait_ms == 0) {
+        return;
+    }
+
+    // Any interrupt (USB, timer, SEV from the other core) ends the wait early
+    best_effort_wfe_or_timeout(make_timeout_time_ms(wait_ms));
+}
+
+void scheduler_run_for(scheduler_t* sched, uint32_t duration_ms)
+{
+    uint32_t start = now_ms();
+
+    while (now_ms() - start < duration_ms) {
+        scheduler_run(sched);
+
+        uint32_t remaining = duration_ms - (now_ms() - start);
+        scheduler_wait(sched, remaining);
+    }
+}
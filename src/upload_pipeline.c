@@ -0,0 +1,188 @@
+#include "upload_pipeline.h"
+#include <stdio.h>
+#include <string.h>
+
+// Runs entirely on core 1: the JSON parser feeds samples in, the upload
+// loop takes records out (on FreeRTOS, both from the ingest task). No
+// locking is needed.
+
+typedef struct {
+    float cpu;
+    float memory;
+    float disk;
+    float net_in;
+    float net_out;
+    int processes;
+    uint32_t count;
+} upload_aggregate_t;
+
+// Internal state structure
+typedef struct {
+    bool initialized;
+    const char* device;
+    upload_aggregate_t window;
+    https_post_data_t records[UPLOAD_PIPELINE_DEPTH];
+    uint32_t record_samples[UPLOAD_PIPELINE_DEPTH];
+    uint8_t head;
+    uint8_t count;
+    uint8_t in_flight;           // Oldest records handed to the transport, not yet delivered
+    upload_pipeline_stats_t stats;
+} upload_pipeline_state_t;
+
+static upload_pipeline_state_t g_pipeline_state = {
+    .initialized = false,
+    .device = NULL,
+    .head = 0,
+    .count = 0,
+    .in_flight = 0
+};
+
+bool upload_pipeline_init(const char* device)
+{
+    memset(&g_pipeline_state, 0, sizeof(g_pipeline_state));
+    g_pipeline_state.device = device;
+    g_pipeline_state.initialized = true;
+
+    return true;
+}
+
+void upload_pipeline_add_sample(const health_data_t* data)
+{
+    if (!g_pipeline_state.initialized || !data->valid) {
+        return;
+    }
+
+    upload_aggregate_t* window = &g_pipeline_state.window;
+    window->cpu += data->cpu;
+    window->memory += data->memory;
+    window->disk += data->disk;
+    window->net_in += data->net_in;
+    window->net_out += data->net_out;
+    window->processes = data->processes;
+    window->count++;
+
+    g_pipeline_state.stats.samples_aggregated++;
+}
+
+// Weighted merge of a newer record into an older one
+static void merge_record(https_post_data_t* into, uint32_t into_samples,
+                         const https_post_data_t* from, uint32_t from_samples)
+{
+    float total = (float)(into_samples + from_samples);
+    float wi = (float)into_samples / total;
+    float wf = (float)from_samples / total;
+
+    into->cpu = into->cpu * wi + from->cpu * wf;
+    into->memory = into->memory * wi + from->memory * wf;
+    into->disk = into->disk * wi + from->disk * wf;
+    into->net_in = into->net_in * wi + from->net_in * wf;
+    into->net_out = into->net_out * wi + from->net_out * wf;
+    into->processes = from->processes;
+    into->sample = from->sample;
+    into->timestamp = from->timestamp;
+}
+
+bool upload_pipeline_commit(uint32_t sample, uint32_t timestamp_ms)
+{
+    upload_aggregate_t* window = &g_pipeline_state.window;
+
+    if (!g_pipeline_state.initialized || window->count == 0) {
+        return false;
+    }
+
+    // A record being sent must go out as it was built. With nothing else to
+    // merge into, the samples stay in the window for the next commit.
+    if (g_pipeline_state.count == UPLOAD_PIPELINE_DEPTH &&
+        g_pipeline_state.in_flight == UPLOAD_PIPELINE_DEPTH) {
+        g_pipeline_state.stats.records_held++;
+        return false;
+    }
+
+    // Mean over every sample parsed since the previous record
+    https_post_data_t record = {
+        .sample = sample,
+        .timestamp = timestamp_ms,
+        .device = g_pipeline_state.device,
+        .cpu = window->cpu / window->count,
+        .memory = window->memory / window->count,
+        .disk = window->disk / window->count,
+        .net_in = window->net_in / window->count,
+        .net_out = window->net_out / window->count,
+        .processes = window->processes
+    };
+    uint32_t samples = window->count;
+    memset(window, 0, sizeof(upload_aggregate_t));
+
+    if (g_pipeline_state.count == UPLOAD_PIPELINE_DEPTH) {
+        // Never drop data: fold into the newest queued record instead
+        uint8_t newest = (g_pipeline_state.head + g_pipeline_state.count - 1) % UPLOAD_PIPELINE_DEPTH;
+        merge_record(&g_pipeline_state.records[newest], g_pipeline_state.record_samples[newest],
+                     &record, samples);
+        g_pipeline_state.record_samples[newest] += samples;
+        g_pipeline_state.stats.records_coalesced++;
+
+        printf("Upload Pipeline: Queue full, sample %lu merged into pending record\n", sample);
+        return true;
+    }
+
+    uint8_t slot = (g_pipeline_state.head + g_pipeline_state.count) % UPLOAD_PIPELINE_DEPTH;
+    g_pipeline_state.records[slot] = record;
+    g_pipeline_state.record_samples[slot] = samples;
+    g_pipeline_state.count++;
+    g_pipeline_state.stats.records_queued++;
+
+    return true;
+}
+
+static void pop_record(void)
+{
+    if (g_pipeline_state.count == 0) {
+        return;
+    }
+
+    g_pipeline_state.head = (g_pipeline_state.head + 1) % UPLOAD_PIPELINE_DEPTH;
+    g_pipeline_state.count--;
+    g_pipeline_state.stats.records_sent++;
+}
+
+uint32_t upload_pipeline_peek_batch(https_post_data_t* records, uint32_t max)
+{
+    uint32_t count = (g_pipeline_state.count < max) ? g_pipeline_state.count : max;
+
+    for (uint32_t i = 0; i < count; i++) {
+        records[i] = g_pipeline_state.records[(g_pipeline_state.head + i) % UPLOAD_PIPELINE_DEPTH];
+    }
+
+    return count;
+}
+
+void upload_pipeline_begin_send(uint32_t count)
+{
+    g_pipeline_state.in_flight = (count < g_pipeline_state.count) ? count : g_pipeline_state.count;
+}
+
+void upload_pipeline_end_send(bool delivered)
+{
+    if (delivered) {
+        while (g_pipeline_state.in_flight > 0) {
+            pop_record();
+            g_pipeline_state.in_flight--;
+        }
+    } else if (g_pipeline_state.in_flight > 0) {
+        g_pipeline_state.stats.send_failures++;
+    }
+
+    g_pipeline_state.in_flight = 0;
+}
+
+uint32_t upload_pipeline_count(void)
+{
+    return g_pipeline_state.count;
+}
+
+void upload_pipeline_get_stats(upload_pipeline_stats_t* stats)
+{
+    if (stats) {
+        *stats = g_pipeline_state.stats;
+    }
+}
@@ -5,15 +5,57 @@
 #include "pico/cyw43_arch.h"
 #include "hardware/gpio.h"
 
+#include "lwip/netif.h"
+#include "lwip/dhcp.h"
+#include "lwip/dns.h"
+#include "lwip/ip4_addr.h"
+#include "lwip/stats.h"
+
+#ifndef CYW43_IOCTL_GET_CHANNEL
+#define CYW43_IOCTL_GET_CHANNEL (0x3a)
+#endif
+
+#define WIFI_CACHE_MAGIC        0x574A4331U  // "WJC1"
+
+// Link events posted by the lwIP netif link callback (async_context) and
+// consumed by wifi_manager_task
+#define WIFI_EVENT_LINK_UP      (1U << 0)
+#define WIFI_EVENT_LINK_DOWN    (1U << 1)
+
 // Internal state structure
 typedef struct {
     wifi_config_t config;
     wifi_state_t state;
     bool initialized;
     bool cyw43_initialized;
-    uint32_t last_check_time;
+    volatile uint8_t events;
+    bool retry_pending;
+    uint32_t retry_at;
+    uint32_t join_start_time;
     uint32_t disconnect_time;
-    bool reconnect_pending;
+    bool use_static_ip;
+    wifi_ip_config_t static_ip;
+    bool address_prepared;       // Static profile or cached lease applied (first join only)
+    bool directed_join;          // Current attempt uses the cached BSSID and channel
+    bool skip_directed;          // Last directed join failed; scan on the next attempt
+    bool lease_reused;           // Address came from the cache, DHCP has not confirmed it yet
+    uint32_t lease_aged_at;      // Last time the cached lease was counted down
+    bool upload_window_open;     // Waiting for the first upload since boot or a link drop
+    bool upload_window_is_boot;
+    uint32_t upload_window_start;
+    volatile uint32_t upload_done_at;
+    wifi_manager_stats_t stats;
+    wifi_power_mode_t power_mode;       // Mode the radio is in now
+    uint32_t power_mode_since;
+    bool burst_active;
+    uint32_t burst_start;
+    volatile uint32_t burst_end;        // Set by wifi_manager_power_release(), 0 = still running
+    uint32_t linger_until;
+    wifi_power_stats_t power_stats[WIFI_POWER_MODE_COUNT];
+    wifi_link_quality_t link;
+    uint32_t link_sampled_at;
+    uint32_t tcp_out_segs;              // lwIP MIB2 counters at the last sample
+    uint32_t tcp_retrans_segs;
 } wifi_manager_state_t;
 
 // Global state
@@ -21,12 +63,55 @@ static wifi_manager_state_t g_wifi_state = {
     .state = WIFI_STATE_DISCONNECTED,
     .initialized = false,
     .cyw43_initialized = false,
-    .last_check_time = 0,
+    .events = 0,
+    .retry_pending = false,
+    .retry_at = 0,
+    .join_start_time = 0,
     .disconnect_time = 0,
-    .reconnect_pending = false
+    .use_static_ip = false,
+    .address_prepared = false,
+    .directed_join = false,
+    .skip_directed = false,
+    .lease_reused = false,
+    .lease_aged_at = 0,
+    .upload_window_open = true,
+    .upload_window_is_boot = true,
+    .upload_window_start = 0,
+    .upload_done_at = 0,
+    .power_mode = WIFI_POWER_BALANCED,
+    .power_mode_since = 0,
+    .burst_active = false,
+    .burst_start = 0,
+    .burst_end = 0,
+    .linger_until = 0,
+    .link = { .score = 0, .link_class = WIFI_LINK_POOR },
+    .link_sampled_at = 0
 };
 
+// Survives a watchdog or soft reset; validated by magic and checksum
+static wifi_join_cache_t __uninitialized_ram(g_join_cache);
+
 // Forward declarations
+static bool start_join(void);
+static void schedule_retry(uint32_t now, uint32_t delay_ms);
+static void enter_connected(uint32_t now);
+static void fall_back_to_scan(uint32_t now);
+static void note_link_drop(uint32_t now);
+static void prepare_address(void);
+static void apply_fixed_address(const wifi_ip_config_t* ip);
+static bool parse_ip_profile(const wifi_ip_profile_t* profile, wifi_ip_config_t* ip);
+static void update_join_cache(void);
+static void age_join_cache(uint32_t now);
+static uint32_t dhcp_lease_left_s(struct netif* netif);
+static bool join_cache_valid(const wifi_join_cache_t* cache);
+static uint32_t join_cache_checksum(const wifi_join_cache_t* cache);
+static void check_first_upload(void);
+static void apply_power_mode(wifi_power_mode_t mode, uint32_t now);
+static void update_power_policy(uint32_t now);
+static uint32_t power_mode_value(wifi_power_mode_t mode);
+static void sample_link_quality(uint32_t now);
+static void reset_link_quality(void);
+static void netif_link_callback(struct netif* netif);
 static void update_led_status(void);
 static void print_link_status(int link_status);
 
@@ -37,11 +122,9 @@ bool wifi_manager_init(const wifi_config_t* config)
         return false;
     }
 
-    printf("WiFi Manager: Initializing...\n");
-
     // Copy configuration
     g_wifi_state.config = *config;
-    
+
     // Set default values if not specified
     if (g_wifi_state.config.reconnect_delay_ms == 0) {
         g_wifi_state.config.reconnect_delay_ms = 5000;
@@ -50,6 +133,29 @@ bool wifi_manager_init(const wifi_config_t* config)
         g_wifi_state.config.connection_timeout_ms = 30000;
     }
 
+    if (g_wifi_state.config.idle_power_mode >= WIFI_POWER_MODE_COUNT) {
+        g_wifi_state.config.idle_power_mode = WIFI_POWER_BALANCED;
+    }
+    if (g_wifi_state.config.burst_power_mode >= WIFI_POWER_MODE_COUNT) {
+        g_wifi_state.config.burst_power_mode = WIFI_POWER_BALANCED;
+    }
+
+    g_wifi_state.use_static_ip = false;
+    if (g_wifi_state.config.static_ip) {
+        if (parse_ip_profile(g_wifi_state.config.static_ip, &g_wifi_state.static_ip)) {
+            g_wifi_state.use_static_ip = true;
+        } else {
+            printf("WiFi Manager: Invalid static IP profile, using DHCP\n");
+        }
+    }
+
+    // The chip is brought up once; joins and rejoins never reset it
+    if (g_wifi_state.cyw43_initialized) {
+        return true;
+    }
+
+    printf("WiFi Manager: Initializing...\n");
+
     // Initialize LED if specified
     if (g_wifi_state.config.led_pin > 0) {
         gpio_init(g_wifi_state.config.led_pin);
@@ -57,14 +163,6 @@ bool wifi_manager_init(const wifi_config_t* config)
         gpio_put(g_wifi_state.config.led_pin, 0);
     }
 
-    // Deinitialize previous instance if exists
-    if (g_wifi_state.cyw43_initialized) {
-        printf("WiFi Manager: Deinitializing previous instance...\n");
-        cyw43_arch_deinit();
-        g_wifi_state.cyw43_initialized = false;
-        sleep_ms(1000);
-    }
-
     // Initialize CYW43
     if (cyw43_arch_init()) {
         printf("WiFi Manager: CYW43 initialization FAILED\n");
@@ -77,9 +175,50 @@ bool wifi_manager_init(const wifi_config_t* config)
     cyw43_arch_enable_sta_mode();
     printf("WiFi Manager: STA mode enabled\n");
 
+    // enable_sta_mode leaves the driver default (BALANCED) in place
+    g_wifi_state.power_mode = WIFI_POWER_BALANCED;
+    g_wifi_state.power_mode_since = to_ms_since_boot(get_absolute_time());
+    memset(g_wifi_state.power_stats, 0, sizeof(g_wifi_state.power_stats));
+    apply_power_mode(g_wifi_state.config.idle_power_mode, g_wifi_state.power_mode_since);
+
+    // The STA netif is added by enable_sta_mode, so the callback goes on afterwards
+    cyw43_arch_lwip_begin();
+    struct netif* netif = &cyw43_state.netif[CYW43_ITF_STA];
+    netif_set_link_callback(netif, netif_link_callback);
+    cyw43_arch_lwip_end();
+
+    // RAM copy first: it is newer than anything on flash after a soft reset.
+    // Its lease was counted down until the reset; take off the time since.
+    uint32_t uptime_ms = to_ms_since_boot(get_absolute_time());
+    if (join_cache_valid(&g_join_cache)) {
+        uint32_t uptime_s = uptime_ms / 1000;
+        g_join_cache.lease_s = g_join_cache.lease_s > uptime_s ? g_join_cache.lease_s - uptime_s : 0;
+        g_join_cache.checksum = join_cache_checksum(&g_join_cache);
+    } else {
+        memset(&g_join_cache, 0, sizeof(g_join_cache));
+        if (g_wifi_state.config.cache_load && g_wifi_state.config.cache_load(&g_join_cache) &&
+            !join_cache_valid(&g_join_cache)) {
+            memset(&g_join_cache, 0, sizeof(g_join_cache));
+        }
+        // No telling how long the saved copy was off for: keep the join hints only
+        if (g_join_cache.lease_s != 0) {
+            g_join_cache.lease_s = 0;
+            g_join_cache.checksum = join_cache_checksum(&g_join_cache);
+        }
+    }
+    g_wifi_state.lease_aged_at = uptime_ms;
+    if (join_cache_valid(&g_join_cache)) {
+        printf("WiFi Manager: Join cache: BSSID %02x:%02x:%02x:%02x:%02x:%02x, channel %u, lease %lu s\n",
+               g_join_cache.bssid[0], g_join_cache.bssid[1], g_join_cache.bssid[2],
+               g_join_cache.bssid[3], g_join_cache.bssid[4], g_join_cache.bssid[5],
+               g_join_cache.channel, g_join_cache.lease_s);
+    }
+
     g_wifi_state.initialized = true;
     g_wifi_state.state = WIFI_STATE_DISCONNECTED;
-    
+    g_wifi_state.events = 0;
+    g_wifi_state.retry_pending = false;
+
     return true;
 }
 
@@ -96,7 +235,8 @@ void wifi_manager_deinit(void)
 
     g_wifi_state.initialized = false;
     g_wifi_state.state = WIFI_STATE_DISCONNECTED;
-    
+    g_wifi_state.retry_pending = false;
+
     printf("WiFi Manager: Deinitialized\n");
 }
 
@@ -107,42 +247,12 @@ bool wifi_manager_connect(void)
         return false;
     }
 
-    printf("WiFi Manager: Connecting to '%s'...\n", g_wifi_state.config.ssid);
-    g_wifi_state.state = WIFI_STATE_CONNECTING;
-    update_led_status();
-
-    // Print current link status
-    int link_status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
-    printf("WiFi Manager: Current link status: ");
-    print_link_status(link_status);
-
-    // Attempt connection
-    int connect_result = cyw43_arch_wifi_connect_timeout_ms(
-        g_wifi_state.config.ssid,
-        g_wifi_state.config.password,
-        CYW43_AUTH_WPA2_AES_PSK,
-        g_wifi_state.config.connection_timeout_ms
-    );
-
-    if (connect_result != 0) {
-        printf("WiFi Manager: Connection FAILED (error %d)\n", connect_result);
-        g_wifi_state.state = WIFI_STATE_DISCONNECTED;
-        update_led_status();
-        return false;
+    if (g_wifi_state.state == WIFI_STATE_CONNECTED || g_wifi_state.state == WIFI_STATE_CONNECTING) {
+        return true;
     }
 
-    printf("WiFi Manager: Connected successfully!\n");
-
-    // Print IP address
-    uint32_t ip = cyw43_state.netif[0].ip_addr.addr;
-    printf("WiFi Manager: IP Address: %lu.%lu.%lu.%lu\n",
-           ip & 0xFF, (ip >> 8) & 0xFF, (ip >> 16) & 0xFF, (ip >> 24) & 0xFF);
-
-    g_wifi_state.state = WIFI_STATE_CONNECTED;
-    g_wifi_state.reconnect_pending = false;
-    update_led_status();
-    
-    return true;
+    g_wifi_state.retry_pending = false;
+    return start_join();
 }
 
 void wifi_manager_task(void)
@@ -151,58 +261,91 @@ void wifi_manager_task(void)
         return;
     }
 
+    // Called every WIFI_MANAGER_CHECK_INTERVAL_MS by the core 1 scheduler
     uint32_t now = to_ms_since_boot(get_absolute_time());
 
-    // Rate limit checks to every 5 seconds
-    if (now - g_wifi_state.last_check_time < 5000) {
-        return;
+    cyw43_arch_lwip_begin();
+    uint8_t events = g_wifi_state.events;
+    g_wifi_state.events = 0;
+    cyw43_arch_lwip_end();
+
+    if ((events & WIFI_EVENT_LINK_DOWN) && g_wifi_state.state == WIFI_STATE_CONNECTED) {
+        // Rejoin straight away; the radio stays up and the join is directed,
+        // and lwIP renews its existing lease rather than starting over
+        printf("\nWiFi Manager: Connection lost!\n");
+        note_link_drop(now);
+        schedule_retry(now, 0);
     }
 
-    g_wifi_state.last_check_time = now;
+    age_join_cache(now);
+
+    check_first_upload();
+    update_power_policy(now);
 
-    // Check link status
     int link_status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
 
-    if (link_status != CYW43_LINK_UP) {
-        // Connection lost
-        if (g_wifi_state.state == WIFI_STATE_CONNECTED) {
-            printf("\nWiFi Manager: Connection lost!\n");
-            g_wifi_state.state = WIFI_STATE_DISCONNECTED;
-            g_wifi_state.disconnect_time = now;
-            g_wifi_state.reconnect_pending = true;
-            update_led_status();
-        }
-        // Handle reconnection
-        else if (g_wifi_state.reconnect_pending && 
-                 (now - g_wifi_state.disconnect_time >= g_wifi_state.config.reconnect_delay_ms)) {
-            printf("WiFi Manager: Attempting reconnection...\n");
-            g_wifi_state.reconnect_pending = false;
-            g_wifi_state.state = WIFI_STATE_RECONNECTING;
-            update_led_status();
-            
-            if (wifi_manager_connect()) {
-                printf("WiFi Manager: Reconnected successfully!\n");
-            } else {
-                g_wifi_state.disconnect_time = now;
-                g_wifi_state.reconnect_pending = true;
-                printf("WiFi Manager: Reconnection failed, will retry...\n");
+    switch (g_wifi_state.state) {
+        case WIFI_STATE_CONNECTING:
+            if (link_status == CYW43_LINK_UP) {
+                // Associated with an address: DHCP bound, or a static/cached one applied up front
+                enter_connected(now);
+            } else if (link_status == CYW43_LINK_FAIL ||
+                       link_status == CYW43_LINK_NONET ||
+                       link_status == CYW43_LINK_BADAUTH) {
+                printf("WiFi Manager: Join failed: ");
+                print_link_status(link_status);
+                if (g_wifi_state.directed_join) {
+                    fall_back_to_scan(now);
+                } else {
+                    schedule_retry(now, g_wifi_state.config.reconnect_delay_ms);
+                }
+            } else if (g_wifi_state.directed_join && link_status != CYW43_LINK_NOIP &&
+                       now - g_wifi_state.join_start_time >= WIFI_DIRECTED_JOIN_TIMEOUT_MS) {
+                printf("WiFi Manager: Directed join not associated after %lu ms\n",
+                       now - g_wifi_state.join_start_time);
+                fall_back_to_scan(now);
+            } else if (now - g_wifi_state.join_start_time >= g_wifi_state.config.connection_timeout_ms) {
+                printf("WiFi Manager: Join timed out after %lu ms\n", now - g_wifi_state.join_start_time);
+                schedule_retry(now, g_wifi_state.config.reconnect_delay_ms);
             }
-        }
-    } else {
-        // Connection restored
-        if (g_wifi_state.state != WIFI_STATE_CONNECTED) {
-            g_wifi_state.state = WIFI_STATE_CONNECTED;
-            g_wifi_state.reconnect_pending = false;
-            update_led_status();
-            printf("WiFi Manager: Link restored!\n");
-        }
-    }
-}
+            break;
 
-void wifi_manager_poll(void)
-{
-    if (g_wifi_state.cyw43_initialized) {
-        cyw43_arch_poll();
+        case WIFI_STATE_CONNECTED:
+            // Backstop for a link-down callback that never came
+            if (link_status != CYW43_LINK_UP) {
+                printf("\nWiFi Manager: Connection lost!\n");
+                note_link_drop(now);
+                schedule_retry(now, 0);
+                break;
+            }
+
+            if (now - g_wifi_state.link_sampled_at >= WIFI_LINK_SAMPLE_MS) {
+                sample_link_quality(now);
+            }
+
+            if (g_wifi_state.lease_reused) {
+                // The reused address stays until DHCP binds; then cache what it granted
+                cyw43_arch_lwip_begin();
+                bool bound = dhcp_supplied_address(&cyw43_state.netif[CYW43_ITF_STA]);
+                cyw43_arch_lwip_end();
+                if (bound) {
+                    g_wifi_state.lease_reused = false;
+                    printf("WiFi Manager: DHCP confirmed lease after %lu ms\n",
+                           now - g_wifi_state.join_start_time);
+                    update_join_cache();
+                }
+            }
+            break;
+
+        case WIFI_STATE_DISCONNECTED:
+        case WIFI_STATE_RECONNECTING:
+        case WIFI_STATE_ERROR:
+            if (g_wifi_state.retry_pending && (int32_t)(now - g_wifi_state.retry_at) >= 0) {
+                printf("WiFi Manager: Attempting reconnection...\n");
+                g_wifi_state.retry_pending = false;
+                start_join();
+            }
+            break;
     }
 }
 
@@ -218,8 +361,8 @@ bool wifi_manager_is_connected(void)
 
 bool wifi_manager_is_fully_connected(void)
 {
-    return g_wifi_state.initialized && 
-           g_wifi_state.cyw43_initialized && 
+    return g_wifi_state.initialized &&
+           g_wifi_state.cyw43_initialized &&
            g_wifi_state.state == WIFI_STATE_CONNECTED;
 }
 
@@ -237,7 +380,7 @@ bool wifi_manager_get_ip_string(char* buffer, size_t buffer_size)
     uint32_t ip = cyw43_state.netif[0].ip_addr.addr;
     snprintf(buffer, buffer_size, "%lu.%lu.%lu.%lu",
              ip & 0xFF, (ip >> 8) & 0xFF, (ip >> 16) & 0xFF, (ip >> 24) & 0xFF);
-    
+
     return true;
 }
 
@@ -246,7 +389,7 @@ uint32_t wifi_manager_get_ip(void)
     if (!wifi_manager_is_connected()) {
         return 0;
     }
-    
+
     return cyw43_state.netif[0].ip_addr.addr;
 }
 
@@ -257,16 +400,599 @@ bool wifi_manager_reconnect(void)
     }
 
     printf("WiFi Manager: Forcing reconnection...\n");
-    
-    // Reset reconnection flags
-    g_wifi_state.reconnect_pending = false;
-    g_wifi_state.disconnect_time = 0;
-    
-    return wifi_manager_connect();
+
+    g_wifi_state.retry_pending = false;
+    note_link_drop(to_ms_since_boot(get_absolute_time()));
+
+    return start_join();
+}
+
+void wifi_manager_note_upload(void)
+{
+    // May run on another task; wifi_manager_task does the bookkeeping
+    if (g_wifi_state.upload_done_at == 0) {
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        g_wifi_state.upload_done_at = now ? now : 1;
+    }
+}
+
+void wifi_manager_get_stats(wifi_manager_stats_t* stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    *stats = g_wifi_state.stats;
+}
+
+void wifi_manager_print_stats(void)
+{
+    wifi_manager_stats_t stats;
+    wifi_manager_get_stats(&stats);
+
+    printf("WiFi Manager: %lu joins (%lu directed, %lu fell back to scan), %lu leases reused\n",
+           stats.joins, stats.directed_joins, stats.directed_fallbacks, stats.leases_reused);
+    printf("WiFi Manager: last join %lu ms, boot -> first upload %lu ms, drop -> first upload %lu ms\n",
+           stats.last_join_ms, stats.boot_to_upload_ms, stats.drop_to_upload_ms);
+    printf("WiFi Manager: link quality %u, RSSI %ld dBm, %u.%u%% retransmits (%lu samples)\n",
+           g_wifi_state.link.score, g_wifi_state.link.rssi_dbm,
+           g_wifi_state.link.retransmit_permille / 10U, g_wifi_state.link.retransmit_permille % 10U,
+           g_wifi_state.link.samples);
+}
+
+void wifi_manager_power_request(void)
+{
+    if (!g_wifi_state.cyw43_initialized) {
+        return;
+    }
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+
+    // A request during the linger period picks the burst mode straight back up
+    g_wifi_state.burst_active = true;
+    g_wifi_state.burst_start = now;
+    g_wifi_state.burst_end = 0;
+    apply_power_mode(g_wifi_state.config.burst_power_mode, now);
+}
+
+void wifi_manager_power_release(void)
+{
+    // Only a timestamp: this may run in the async_context, where an ioctl
+    // to the chip is not welcome. wifi_manager_task does the switch.
+    if (g_wifi_state.burst_active && g_wifi_state.burst_end == 0) {
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        g_wifi_state.burst_end = now ? now : 1;
+    }
+}
+
+void wifi_manager_set_power_policy(wifi_power_mode_t idle_mode, wifi_power_mode_t burst_mode)
+{
+    if (idle_mode >= WIFI_POWER_MODE_COUNT || burst_mode >= WIFI_POWER_MODE_COUNT) {
+        return;
+    }
+
+    g_wifi_state.config.idle_power_mode = idle_mode;
+    g_wifi_state.config.burst_power_mode = burst_mode;
+
+    if (g_wifi_state.cyw43_initialized && !g_wifi_state.burst_active) {
+        apply_power_mode(idle_mode, to_ms_since_boot(get_absolute_time()));
+    }
+}
+
+void wifi_manager_get_power_stats(wifi_power_stats_t stats[WIFI_POWER_MODE_COUNT])
+{
+    if (!stats) {
+        return;
+    }
+
+    memcpy(stats, g_wifi_state.power_stats, sizeof(g_wifi_state.power_stats));
+
+    // Include the time spent in the current mode so far
+    if (g_wifi_state.cyw43_initialized) {
+        stats[g_wifi_state.power_mode].time_ms +=
+            to_ms_since_boot(get_absolute_time()) - g_wifi_state.power_mode_since;
+    }
+}
+
+void wifi_manager_print_power_stats(void)
+{
+    static const uint32_t est_ma[WIFI_POWER_MODE_COUNT] = {
+        [WIFI_POWER_BALANCED] = WIFI_POWER_EST_MA_BALANCED,
+        [WIFI_POWER_PERFORMANCE] = WIFI_POWER_EST_MA_PERFORMANCE,
+        [WIFI_POWER_SAVING] = WIFI_POWER_EST_MA_SAVING
+    };
+
+    wifi_power_stats_t stats[WIFI_POWER_MODE_COUNT];
+    wifi_manager_get_power_stats(stats);
+
+    uint64_t total_ms = 0;
+    uint64_t charge = 0;
+
+    printf("WiFi Power: idle %s, burst %s\n",
+           wifi_manager_power_mode_name(g_wifi_state.config.idle_power_mode),
+           wifi_manager_power_mode_name(g_wifi_state.config.burst_power_mode));
+
+    for (int mode = 0; mode < WIFI_POWER_MODE_COUNT; mode++) {
+        uint32_t avg_ms = stats[mode].bursts ? stats[mode].burst_total_ms / stats[mode].bursts : 0;
+
+        printf("WiFi Power: %-11s %8lu ms, %lu uploads, avg %lu ms, max %lu ms\n",
+               wifi_manager_power_mode_name((wifi_power_mode_t)mode), stats[mode].time_ms,
+               stats[mode].bursts, avg_ms, stats[mode].burst_max_ms);
+
+        total_ms += stats[mode].time_ms;
+        charge += (uint64_t)stats[mode].time_ms * est_ma[mode];
+    }
+
+    if (total_ms > 0) {
+        printf("WiFi Power: estimated average current %lu mA\n", (uint32_t)(charge / total_ms));
+    }
+}
+
+const char* wifi_manager_power_mode_name(wifi_power_mode_t mode)
+{
+    switch (mode) {
+        case WIFI_POWER_BALANCED:
+            return "balanced";
+        case WIFI_POWER_PERFORMANCE:
+            return "performance";
+        case WIFI_POWER_SAVING:
+            return "saving";
+        default:
+            return "unknown";
+    }
+}
+
+uint8_t wifi_manager_get_link_score(void)
+{
+    return g_wifi_state.link.score;
+}
+
+wifi_link_class_t wifi_manager_get_link_class(void)
+{
+    return g_wifi_state.link.link_class;
+}
+
+void wifi_manager_get_link_quality(wifi_link_quality_t* quality)
+{
+    if (!quality) {
+        return;
+    }
+
+    *quality = g_wifi_state.link;
 }
 
 // Internal helper functions
 
+static bool start_join(void)
+{
+    // Drop any half-finished association before joining again
+    if (g_wifi_state.state != WIFI_STATE_DISCONNECTED) {
+        cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+    }
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    int err;
+
+    prepare_address();
+
+    g_wifi_state.directed_join = !g_wifi_state.skip_directed && join_cache_valid(&g_join_cache);
+
+    if (g_wifi_state.directed_join) {
+        const uint8_t* bssid = g_join_cache.bssid;
+        printf("WiFi Manager: Connecting to '%s' via %02x:%02x:%02x:%02x:%02x:%02x on channel %u...\n",
+               g_wifi_state.config.ssid, bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5],
+               g_join_cache.channel);
+
+        // Same call cyw43_arch_wifi_connect_bssid_async() makes, plus the channel
+        err = cyw43_wifi_join(&cyw43_state,
+                              strlen(g_wifi_state.config.ssid), (const uint8_t*)g_wifi_state.config.ssid,
+                              strlen(g_wifi_state.config.password), (const uint8_t*)g_wifi_state.config.password,
+                              CYW43_AUTH_WPA2_AES_PSK, bssid,
+                              g_join_cache.channel ? g_join_cache.channel : CYW43_CHANNEL_NONE);
+        g_wifi_state.stats.directed_joins++;
+    } else {
+        printf("WiFi Manager: Connecting to '%s'...\n", g_wifi_state.config.ssid);
+
+        err = cyw43_arch_wifi_connect_async(
+            g_wifi_state.config.ssid,
+            g_wifi_state.config.password,
+            CYW43_AUTH_WPA2_AES_PSK
+        );
+    }
+
+    g_wifi_state.stats.joins++;
+
+    if (err != 0) {
+        printf("WiFi Manager: Join request FAILED (error %d)\n", err);
+        schedule_retry(now, g_wifi_state.config.reconnect_delay_ms);
+        return false;
+    }
+
+    g_wifi_state.state = WIFI_STATE_CONNECTING;
+    g_wifi_state.join_start_time = now;
+    update_led_status();
+
+    return true;
+}
+
+static void schedule_retry(uint32_t now, uint32_t delay_ms)
+{
+    reset_link_quality();
+    g_wifi_state.state = WIFI_STATE_RECONNECTING;
+    g_wifi_state.retry_pending = true;
+    g_wifi_state.retry_at = now + delay_ms;
+    update_led_status();
+}
+
+static void enter_connected(uint32_t now)
+{
+    g_wifi_state.state = WIFI_STATE_CONNECTED;
+    g_wifi_state.retry_pending = false;
+    g_wifi_state.skip_directed = false;
+    g_wifi_state.stats.last_join_ms = now - g_wifi_state.join_start_time;
+    update_led_status();
+
+    uint32_t ip = cyw43_state.netif[CYW43_ITF_STA].ip_addr.addr;
+    printf("WiFi Manager: Connected in %lu ms, IP Address: %lu.%lu.%lu.%lu\n",
+           now - g_wifi_state.join_start_time,
+           ip & 0xFF, (ip >> 8) & 0xFF, (ip >> 16) & 0xFF, (ip >> 24) & 0xFF);
+
+    if (g_wifi_state.disconnect_time != 0) {
+        printf("WiFi Manager: Link restored %lu ms after drop\n", now - g_wifi_state.disconnect_time);
+        g_wifi_state.disconnect_time = 0;
+    }
+
+    if (g_wifi_state.lease_reused) {
+        // Uploads can go out on the cached address; DHCP checks it in the background
+        cyw43_arch_lwip_begin();
+        dhcp_start(&cyw43_state.netif[CYW43_ITF_STA]);
+        cyw43_arch_lwip_end();
+    }
+
+    update_join_cache();
+
+    // First sample straight away so uploads do not wait on a stale score
+    sample_link_quality(now);
+}
+
+static void fall_back_to_scan(uint32_t now)
+{
+    printf("WiFi Manager: Falling back to a full scan\n");
+    g_wifi_state.skip_directed = true;
+    g_wifi_state.stats.directed_fallbacks++;
+    schedule_retry(now, 0);
+}
+
+static void note_link_drop(uint32_t now)
+{
+    g_wifi_state.disconnect_time = now;
+
+    // Restart the time-to-first-upload measurement from the drop
+    g_wifi_state.upload_window_open = true;
+    g_wifi_state.upload_window_is_boot = false;
+    g_wifi_state.upload_window_start = now;
+    g_wifi_state.upload_done_at = 0;
+}
+
+static void prepare_address(void)
+{
+    // Once per boot: after that the netif keeps the static address, and the
+    // lwIP DHCP client renews its own lease when the link comes back
+    if (g_wifi_state.address_prepared) {
+        return;
+    }
+    g_wifi_state.address_prepared = true;
+
+    if (g_wifi_state.use_static_ip) {
+        apply_fixed_address(&g_wifi_state.static_ip);
+        printf("WiFi Manager: Using static IP profile\n");
+    } else if (join_cache_valid(&g_join_cache) && g_join_cache.lease.ip != 0 &&
+               g_join_cache.lease_s >= WIFI_LEASE_REUSE_MIN_S) {
+        apply_fixed_address(&g_join_cache.lease);
+        g_wifi_state.lease_reused = true;
+        g_wifi_state.stats.leases_reused++;
+        printf("WiFi Manager: Reusing cached DHCP lease\n");
+    }
+}
+
+static void apply_fixed_address(const wifi_ip_config_t* ip)
+{
+    ip4_addr_t addr, netmask, gateway;
+    ip_addr_t dns_server;
+
+    ip4_addr_set_u32(&addr, ip->ip);
+    ip4_addr_set_u32(&netmask, ip->netmask);
+    ip4_addr_set_u32(&gateway, ip->gateway);
+    ip_addr_set_ip4_u32(&dns_server, ip->dns);
+
+    cyw43_arch_lwip_begin();
+    struct netif* netif = &cyw43_state.netif[CYW43_ITF_STA];
+    dhcp_stop(netif);
+    netif_set_addr(netif, &addr, &netmask, &gateway);
+    if (ip->dns != 0) {
+        dns_setserver(0, &dns_server);
+    }
+    cyw43_arch_lwip_end();
+}
+
+static bool parse_ip_profile(const wifi_ip_profile_t* profile, wifi_ip_config_t* ip)
+{
+    ip4_addr_t addr, netmask, gateway, dns_server;
+
+    if (!profile->address || !profile->netmask || !profile->gateway || !profile->dns ||
+        !ip4addr_aton(profile->address, &addr) ||
+        !ip4addr_aton(profile->netmask, &netmask) ||
+        !ip4addr_aton(profile->gateway, &gateway) ||
+        !ip4addr_aton(profile->dns, &dns_server)) {
+        return false;
+    }
+
+    ip->ip = ip4_addr_get_u32(&addr);
+    ip->netmask = ip4_addr_get_u32(&netmask);
+    ip->gateway = ip4_addr_get_u32(&gateway);
+    ip->dns = ip4_addr_get_u32(&dns_server);
+
+    return true;
+}
+
+static void update_join_cache(void)
+{
+    wifi_join_cache_t cache;
+
+    if (join_cache_valid(&g_join_cache)) {
+        cache = g_join_cache;
+    } else {
+        memset(&cache, 0, sizeof(cache));
+    }
+
+    if (cyw43_wifi_get_bssid(&cyw43_state, cache.bssid) != 0) {
+        return;
+    }
+
+    // channel_info_t: hw_channel comes first
+    uint32_t channel_info[3] = {0};
+    if (cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(channel_info),
+                    (uint8_t*)channel_info, CYW43_ITF_STA) == 0 && channel_info[0] <= 165) {
+        cache.channel = (uint16_t)channel_info[0];
+    } else {
+        cache.channel = 0;
+    }
+
+    // While a reused lease is unconfirmed the cached one is kept as is
+    cyw43_arch_lwip_begin();
+    struct netif* netif = &cyw43_state.netif[CYW43_ITF_STA];
+    if (g_wifi_state.use_static_ip) {
+        memset(&cache.lease, 0, sizeof(cache.lease));
+        cache.lease_s = 0;
+    } else if (dhcp_supplied_address(netif)) {
+        cache.lease.ip = ip4_addr_get_u32(netif_ip4_addr(netif));
+        cache.lease.netmask = ip4_addr_get_u32(netif_ip4_netmask(netif));
+        cache.lease.gateway = ip4_addr_get_u32(netif_ip4_gw(netif));
+        cache.lease.dns = ip4_addr_get_u32(ip_2_ip4(dns_getserver(0)));
+        cache.lease_s = dhcp_lease_left_s(netif);
+    }
+    cyw43_arch_lwip_end();
+
+    cache.magic = WIFI_CACHE_MAGIC;
+    cache.checksum = join_cache_checksum(&cache);
+
+    // Only hand real changes to the save hook; flash wears out. The time
+    // left drops on every call, so that alone is not a change.
+    wifi_join_cache_t previous = g_join_cache;
+    previous.lease_s = cache.lease_s;
+    previous.checksum = join_cache_checksum(&previous);
+    bool changed = memcmp(&cache, &previous, sizeof(cache)) != 0;
+
+    g_join_cache = cache;
+    g_wifi_state.lease_aged_at = to_ms_since_boot(get_absolute_time());
+    if (changed && g_wifi_state.config.cache_save) {
+        g_wifi_state.config.cache_save(&g_join_cache);
+    }
+}
+
+static void age_join_cache(uint32_t now)
+{
+    uint32_t elapsed_ms = now - g_wifi_state.lease_aged_at;
+    if (elapsed_ms < WIFI_LEASE_AGE_INTERVAL_MS) {
+        return;
+    }
+    g_wifi_state.lease_aged_at = now;
+
+    if (!join_cache_valid(&g_join_cache) || g_join_cache.lease_s == 0) {
+        return;
+    }
+
+    // While DHCP holds the cached address it knows the time left; otherwise
+    // (link down, reused lease not yet confirmed) count down on the clock
+    uint32_t elapsed_s = elapsed_ms / 1000;
+    uint32_t left = g_join_cache.lease_s > elapsed_s ? g_join_cache.lease_s - elapsed_s : 0;
+    cyw43_arch_lwip_begin();
+    struct netif* netif = &cyw43_state.netif[CYW43_ITF_STA];
+    if (dhcp_supplied_address(netif) &&
+        ip4_addr_get_u32(netif_ip4_addr(netif)) == g_join_cache.lease.ip) {
+        left = dhcp_lease_left_s(netif);
+    }
+    cyw43_arch_lwip_end();
+
+    // RAM only: the flash copy's lease is never reused, so no save
+    g_join_cache.lease_s = left;
+    g_join_cache.checksum = join_cache_checksum(&g_join_cache);
+}
+
+static uint32_t dhcp_lease_left_s(struct netif* netif)
+{
+    // lease_used counts coarse timer ticks since the last ACK
+    const struct dhcp* dhcp = netif_dhcp_data(netif);
+    uint32_t used_s = (uint32_t)dhcp->lease_used * DHCP_COARSE_TIMER_SECS;
+
+    return dhcp->offered_t0_lease > used_s ? dhcp->offered_t0_lease - used_s : 0;
+}
+
+static bool join_cache_valid(const wifi_join_cache_t* cache)
+{
+    return cache->magic == WIFI_CACHE_MAGIC && cache->checksum == join_cache_checksum(cache);
+}
+
+static uint32_t join_cache_checksum(const wifi_join_cache_t* cache)
+{
+    // FNV-1a over everything before the checksum field
+    const uint8_t* bytes = (const uint8_t*)cache;
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < offsetof(wifi_join_cache_t, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+static void apply_power_mode(wifi_power_mode_t mode, uint32_t now)
+{
+    if (mode == g_wifi_state.power_mode) {
+        return;
+    }
+
+    if (cyw43_wifi_pm(&cyw43_state, power_mode_value(mode)) != 0) {
+        printf("WiFi Manager: Failed to set power mode %s\n", wifi_manager_power_mode_name(mode));
+        return;
+    }
+
+    g_wifi_state.power_stats[g_wifi_state.power_mode].time_ms += now - g_wifi_state.power_mode_since;
+    g_wifi_state.power_mode = mode;
+    g_wifi_state.power_mode_since = now;
+}
+
+static void update_power_policy(uint32_t now)
+{
+    uint32_t burst_end = g_wifi_state.burst_end;
+
+    if (g_wifi_state.burst_active && burst_end != 0) {
+        // Charged to the mode the burst actually ran in
+        wifi_power_stats_t* stats = &g_wifi_state.power_stats[g_wifi_state.power_mode];
+        uint32_t elapsed = burst_end - g_wifi_state.burst_start;
+
+        stats->bursts++;
+        stats->burst_total_ms += elapsed;
+        if (elapsed > stats->burst_max_ms) {
+            stats->burst_max_ms = elapsed;
+        }
+
+        g_wifi_state.burst_active = false;
+        g_wifi_state.linger_until = burst_end + WIFI_POWER_LINGER_MS;
+    }
+
+    if (!g_wifi_state.burst_active && g_wifi_state.power_mode != g_wifi_state.config.idle_power_mode &&
+        (int32_t)(now - g_wifi_state.linger_until) >= 0) {
+        apply_power_mode(g_wifi_state.config.idle_power_mode, now);
+    }
+}
+
+static uint32_t power_mode_value(wifi_power_mode_t mode)
+{
+    switch (mode) {
+        case WIFI_POWER_PERFORMANCE:
+            return CYW43_NONE_PM;
+        case WIFI_POWER_SAVING:
+            return CYW43_AGGRESSIVE_PM;
+        case WIFI_POWER_BALANCED:
+        default:
+            return CYW43_DEFAULT_PM;
+    }
+}
+
+static void sample_link_quality(uint32_t now)
+{
+    wifi_link_quality_t* link = &g_wifi_state.link;
+    wifi_link_class_t previous = link->link_class;
+    bool first = (link->samples == 0);
+
+    g_wifi_state.link_sampled_at = now;
+
+    int32_t rssi = 0;
+    if (cyw43_wifi_get_rssi(&cyw43_state, &rssi) == 0) {
+        link->rssi_dbm = rssi;
+    }
+
+    cyw43_arch_lwip_begin();
+    uint32_t out_segs = lwip_stats.mib2.tcpoutsegs;
+    uint32_t retrans_segs = lwip_stats.mib2.tcpretranssegs;
+    cyw43_arch_lwip_end();
+
+    uint32_t sent = out_segs - g_wifi_state.tcp_out_segs;
+    uint32_t retrans = retrans_segs - g_wifi_state.tcp_retrans_segs;
+    g_wifi_state.tcp_out_segs = out_segs;
+    g_wifi_state.tcp_retrans_segs = retrans_segs;
+
+    // EWMA (1/4) over windows with enough traffic; idle windows decay the
+    // rate, so a link whose uploads are being held back can still recover
+    if (!first && sent >= WIFI_LINK_MIN_SEGMENTS) {
+        uint32_t window = (retrans * 1000U) / sent;
+        if (window > 1000U) {
+            window = 1000U;
+        }
+        link->retransmit_permille = (uint16_t)((link->retransmit_permille * 3U + window) / 4U);
+    } else {
+        link->retransmit_permille = (uint16_t)((link->retransmit_permille * 3U) / 4U);
+    }
+
+    // Signal sets the ceiling; every 1% of retransmits takes 4 points off it
+    int32_t rssi_score = ((link->rssi_dbm - WIFI_LINK_RSSI_FLOOR_DBM) * 100) /
+                         (WIFI_LINK_RSSI_CEIL_DBM - WIFI_LINK_RSSI_FLOOR_DBM);
+    if (rssi_score < 0) {
+        rssi_score = 0;
+    } else if (rssi_score > 100) {
+        rssi_score = 100;
+    }
+
+    int32_t score = rssi_score - (int32_t)(link->retransmit_permille * 4U / 10U);
+    link->score = (uint8_t)(score < 0 ? 0 : score);
+    link->link_class = (link->score >= WIFI_LINK_SCORE_GOOD) ? WIFI_LINK_GOOD :
+                       (link->score >= WIFI_LINK_SCORE_POOR) ? WIFI_LINK_FAIR : WIFI_LINK_POOR;
+    link->samples++;
+
+    if (first || link->link_class != previous) {
+        static const char* const class_names[] = { "poor", "fair", "good" };
+        printf("WiFi Manager: Link quality %u (%s), RSSI %ld dBm, %u.%u%% retransmits\n",
+               link->score, class_names[link->link_class], link->rssi_dbm,
+               link->retransmit_permille / 10U, link->retransmit_permille % 10U);
+    }
+}
+
+static void reset_link_quality(void)
+{
+    g_wifi_state.link.score = 0;
+    g_wifi_state.link.link_class = WIFI_LINK_POOR;
+    g_wifi_state.link.retransmit_permille = 0;
+    g_wifi_state.link.samples = 0;
+}
+
+static void check_first_upload(void)
+{
+    uint32_t upload_at = g_wifi_state.upload_done_at;
+
+    if (!g_wifi_state.upload_window_open || upload_at == 0) {
+        return;
+    }
+
+    uint32_t elapsed = upload_at - g_wifi_state.upload_window_start;
+    g_wifi_state.upload_window_open = false;
+
+    if (g_wifi_state.upload_window_is_boot) {
+        g_wifi_state.stats.boot_to_upload_ms = elapsed;
+        printf("WiFi Manager: First upload %lu ms after boot\n", elapsed);
+    } else {
+        g_wifi_state.stats.drop_to_upload_ms = elapsed;
+        printf("WiFi Manager: First upload %lu ms after link drop\n", elapsed);
+    }
+}
+
+// Callback functions (async_context, lwIP lock held)
+
+static void netif_link_callback(struct netif* netif)
+{
+    g_wifi_state.events |= netif_is_link_up(netif) ? WIFI_EVENT_LINK_UP : WIFI_EVENT_LINK_DOWN;
+}
+
 static void update_led_status(void)
 {
     if (g_wifi_state.config.led_pin == 0) {
@@ -278,7 +1004,7 @@ static void update_led_status(void)
             // Solid ON when connected
             gpio_put(g_wifi_state.config.led_pin, 1);
             break;
-            
+
         case WIFI_STATE_DISCONNECTED:
         case WIFI_STATE_CONNECTING:
         case WIFI_STATE_RECONNECTING:
@@ -318,4 +1044,4 @@ static void print_link_status(int link_status)
             printf("UNKNOWN (%d)\n", link_status);
             break;
     }
-}
\ No newline at end of file
+}